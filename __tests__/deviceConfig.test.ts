@@ -0,0 +1,36 @@
+import { deviceConfigChanged } from '../src/core/deviceConfig';
+import type { DeviceConfig } from '../src/core/types';
+
+// Keep the suite away from the config file in the home directory
+jest.mock('../src/core/persistentStorage', () => ({
+	getValue: jest.fn(),
+	setValue: jest.fn(),
+	getAllValues: jest.fn(() => ({})),
+	unsetValue: jest.fn(),
+}));
+
+const printer: DeviceConfig = {
+	deviceType: 'printer',
+	brand: 'Epson',
+	model: 'TM-T20III',
+	baudrate: 'not-supported',
+	setToDefault: false,
+};
+
+describe('deviceConfigChanged', () => {
+	it('is false for an identical config', () => {
+		expect(deviceConfigChanged(printer, { ...printer })).toBe(false);
+	});
+
+	it.each<[string, Partial<DeviceConfig>]>([
+		['brand', { brand: 'Star' }],
+		['model', { model: 'TM-T88VI' }],
+		['group', { group: 'kitchen' }],
+		['transport', { transport: 'tcp://10.0.0.5:9100' }],
+		['profile', { profile: 'escpos-58mm' }],
+		['lowLatency', { lowLatency: 'prefer' }],
+	])('notices a changed %s', (_field, change) => {
+		expect(deviceConfigChanged(printer, { ...printer, ...change })).toBe(true);
+		expect(deviceConfigChanged({ ...printer, ...change }, printer)).toBe(true);
+	});
+});
@@ -0,0 +1,31 @@
+// Client side of the print broker test, run in a process of its own:
+//   brokerClient.ts <socketPath> <transportUri> <payloadBytes>
+// Prints a small receipt, one of payloadBytes (shared with the broker
+// rather than sent inline) and one to a transport the broker does not
+// allow, then writes the outcome of each as one JSON line.
+import { PrintBrokerClient } from '../../src/managers/printBrokerClient';
+
+const [socketPath, uri, payloadBytes] = process.argv.slice(2);
+
+const outcome = (job: Promise<boolean>) =>
+	job.then(
+		() => ({ ok: true }),
+		(error: Error) => ({ ok: false, name: error.name, message: error.message }),
+	);
+
+const main = async () => {
+	const client = await PrintBrokerClient.connect(socketPath);
+	const large = `${'x'.repeat(Number(payloadBytes) - 4)}END\n`;
+	const results = {
+		small: await outcome(client.printToTransport(uri, 'small receipt\n')),
+		large: await outcome(client.printToTransport(uri, large)),
+		denied: await outcome(client.printToTransport('file:///etc/passwd', 'x')),
+	};
+	client.close();
+	process.stdout.write(`${JSON.stringify(results)}\n`);
+};
+
+main().catch((error) => {
+	process.stderr.write(`${error}\n`);
+	process.exit(1);
+});
@@ -0,0 +1,112 @@
+import { type ChildProcessWithoutNullStreams, spawn } from 'node:child_process';
+import { createInterface } from 'node:readline';
+
+// Node cannot allocate a pseudo-terminal itself, so a small Python helper
+// holds the master side, reads from it only when told to and writes to it
+// on request. The slave side is raw with VMIN=1/VTIME=0, as serialport's
+// unix binding leaves a port it opened.
+const PTY_HELPER = `
+import os, pty, select, sys, tty
+master, slave = pty.openpty()
+tty.setraw(master)
+print(os.ttyname(slave), flush=True)
+reading, total, pending = False, 0, b''
+while True:
+    fds = [0, master] if reading else [0]
+    ready = select.select(fds, [], [])[0]
+    if master in ready:
+        try:
+            total += len(os.read(master, 65536))
+        except OSError:
+            pass
+    if 0 in ready:
+        data = os.read(0, 1024)
+        if not data:
+            break
+        pending += data
+        while b'\\n' in pending:
+            line, pending = pending.split(b'\\n', 1)
+            command = line.decode().strip()
+            if command == 'read':
+                reading = True
+            elif command == 'hold':
+                reading = False
+            elif command.startswith('type '):
+                os.write(master, bytes.fromhex(command[5:]))
+            print(total, flush=True)
+`;
+
+export interface PtyPair {
+	/** Slave side, opened by the code under test like a serial port */
+	path: string;
+	/** Start draining the master side, like a printer that keeps up */
+	read(): Promise<void>;
+	/** Stop draining, like a printer out of paper */
+	hold(): Promise<void>;
+	/** Bytes read from the master side so far */
+	received(): Promise<number>;
+	/** Write to the master side, like a scanner sending a frame */
+	type(data: string | Buffer): Promise<void>;
+	close(): void;
+}
+
+/**
+ * Allocate a pty pair, or null where python3 or ptys are unavailable
+ */
+export async function openPtyPair(): Promise<PtyPair | null> {
+	if (process.platform === 'win32') {
+		return null;
+	}
+
+	let child: ChildProcessWithoutNullStreams;
+	try {
+		child = spawn('python3', ['-c', PTY_HELPER]);
+	} catch {
+		return null;
+	}
+
+	const lines = createInterface({ input: child.stdout });
+	const waiting: ((line: string) => void)[] = [];
+	let first: ((line: string | null) => void) | undefined;
+	lines.on('line', (line) => {
+		if (first) {
+			first(line);
+			first = undefined;
+			return;
+		}
+		waiting.shift()?.(line);
+	});
+
+	const path = await new Promise<string | null>((resolve) => {
+		first = resolve;
+		child.once('error', () => resolve(null));
+		child.once('exit', () => resolve(null));
+	});
+	if (!path) {
+		return null;
+	}
+
+	const send = (command: string) =>
+		new Promise<number>((resolve) => {
+			waiting.push((line) => resolve(Number(line)));
+			child.stdin.write(`${command}\n`);
+		});
+
+	return {
+		path,
+		read: async () => {
+			await send('read');
+		},
+		hold: async () => {
+			await send('hold');
+		},
+		received: () => send('count'),
+		type: async (data) => {
+			await send(`type ${Buffer.from(data).toString('hex')}`);
+		},
+		close: () => {
+			lines.close();
+			child.kill();
+		},
+	};
+}
@@ -0,0 +1,33 @@
+// Preloaded (--import) into workerAbortClient.ts and so into its device
+// worker: a printer DeviceManager never detected, on an emulated transport
+// that drains at 9600 bit/s so a job is still writing when it is aborted.
+import type { TerminalDevice } from '../../src/core/types';
+import { DeviceManager } from '../../src/managers/deviceManager';
+
+export const VIRTUAL_PRINTER_ID = 'virtual-printer';
+
+const printer: TerminalDevice = {
+	id: VIRTUAL_PRINTER_ID,
+	vid: '0000',
+	pid: '0000',
+	path: '',
+	name: 'Virtual printer',
+	serialNumber: '',
+	manufacturer: '',
+	meta: {
+		deviceType: 'printer',
+		brand: '',
+		model: '',
+		baudrate: 'not-supported',
+		setToDefault: false,
+		transport: 'emu://worker-abort?bps=9600',
+	},
+	capabilities: ['write'],
+};
+
+const { getDevice } = DeviceManager.prototype;
+DeviceManager.prototype.getDevice = function (deviceId: string) {
+	return deviceId === VIRTUAL_PRINTER_ID
+		? printer
+		: getDevice.call(this, deviceId);
+};
@@ -0,0 +1,44 @@
+// Main thread of the worker proxy test, run in a process of its own so the
+// device worker loads TypeScript the way this process does:
+//   tsx --import ./virtualPrinter.ts workerAbortClient.ts
+// Queues two jobs on one printer, each with its own signal, aborts the
+// first and writes the outcome of each as one JSON line.
+import { createWorkerDeviceManagers } from '../../src/managers/workerProxy';
+import { VIRTUAL_PRINTER_ID } from './virtualPrinter';
+
+const outcome = (job: Promise<boolean>) =>
+	job.then(
+		() => ({ ok: true }),
+		(error: Error) => ({ ok: false, name: error.name, message: error.message }),
+	);
+
+const main = async () => {
+	const { deviceManager, printerManager } = createWorkerDeviceManagers({});
+	const aborted = new AbortController();
+	const kept = new AbortController();
+
+	// About four seconds of writing at 9600 bit/s
+	const first = outcome(
+		printerManager.printToDevice(
+			VIRTUAL_PRINTER_ID,
+			`${'x'.repeat(4000)}\n`,
+			false,
+			{ signal: aborted.signal },
+		),
+	);
+	const second = outcome(
+		printerManager.printToDevice(VIRTUAL_PRINTER_ID, 'next\n', false, {
+			signal: kept.signal,
+		}),
+	);
+	setTimeout(() => aborted.abort(), 500);
+
+	const results = { first: await first, second: await second };
+	await deviceManager.terminate();
+	process.stdout.write(`${JSON.stringify(results)}\n`);
+};
+
+main().catch((error) => {
+	process.stderr.write(`${error}\n`);
+	process.exit(1);
+});
@@ -0,0 +1,53 @@
+import { readFileSync } from 'node:fs';
+import { join } from 'node:path';
+import { decodeEvdevRecording } from '../src/adaptor/hidScannerAdaptor';
+import { loadNativeAddon } from '../src/core/nativeAddon';
+
+const addon = loadNativeAddon();
+// The fixtures hold struct input_event as x86_64 and arm64 Linux write it:
+// 24 bytes per record, little-endian
+const describeRecorded =
+	addon?.decodeEvdevEvents && ['x64', 'arm64'].includes(process.arch)
+		? describe
+		: describe.skip;
+
+// A keyboard-wedge scanner reports every key transition as MSC_SCAN,
+// EV_KEY and SYN_REPORT, 4 ms apart
+const recording = (name: string) =>
+	readFileSync(join(__dirname, 'fixtures', 'evdev', `${name}.bin`));
+
+describeRecorded('decodeEvdevRecording', () => {
+	it('applies either shift key to the keys pressed while it is held', () => {
+		// Left Shift held over a and b (with an autorepeat in between), c
+		// alone, Right Shift over 1, then - plain and shifted, Enter
+		expect(decodeEvdevRecording(recording('shift'))).toEqual(['ABc!-_']);
+	});
+
+	it('ends a scan at Enter or keypad Enter and nowhere else', () => {
+		// An EAN-13 ended by Enter, 0123 by keypad Enter, a bare Enter, then
+		// 999 without a terminator and half a record cut off
+		expect(decodeEvdevRecording(recording('enter'))).toEqual([
+			'4006381333931',
+			'0123',
+		]);
+	});
+
+	it('ignores key codes the keymap has no characters for', () => {
+		// F1, Left Meta and KEY_PLAYCD (200) pressed between 1 and 2
+		expect(decodeEvdevRecording(recording('unknown'))).toEqual(['12']);
+	});
+
+	it('decodes key codes added by a keymap', () => {
+		const scans = decodeEvdevRecording(recording('unknown'), {
+			200: ['é', 'É'],
+		});
+
+		expect(scans).toEqual(['1é2']);
+	});
+
+	it('finds no scans in a partial record', () => {
+		const partial = recording('enter').subarray(0, 23);
+
+		expect(decodeEvdevRecording(partial)).toEqual([]);
+	});
+});
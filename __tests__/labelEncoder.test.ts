@@ -0,0 +1,116 @@
+import { inflateSync } from 'node:zlib';
+import type { MonoBitmap } from '../src/core/jobBuilder';
+import {
+	encodeAcs,
+	encodeTspl,
+	encodeZ64,
+	encodeZpl,
+} from '../src/core/labelEncoder';
+import {
+	getPrinterProfile,
+	type PrinterProfile,
+} from '../src/core/printerProfile';
+
+const profile = (id: string): PrinterProfile => {
+	const found = getPrinterProfile(id);
+	if (!found) {
+		throw new Error(`No profile ${id}`);
+	}
+	return found;
+};
+
+// 32 dots wide: two black rows, a white one, then black at both edges
+const FRAME = Buffer.from([
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,
+	0xf0, 0x00, 0x00, 0x0f,
+]);
+
+describe('encodeZ64', () => {
+	it('appends the CRC-16/XMODEM of the base64 text', () => {
+		// Blank rows deflate to the same bytes on every zlib build; the CRC
+		// was checked against Python's binascii.crc_hqx
+		expect(encodeZ64(Buffer.alloc(64))).toBe(':Z64:eJxjYKAMAAAAQAAB:8020');
+	});
+
+	it('carries the raster deflated and base64 encoded', () => {
+		const match = /^:Z64:([A-Za-z0-9+/=]+):([0-9A-F]{4})$/.exec(
+			encodeZ64(FRAME),
+		);
+
+		expect(match).not.toBeNull();
+		expect(inflateSync(Buffer.from(match?.[1] ?? '', 'base64'))).toEqual(
+			FRAME,
+		);
+	});
+});
+
+describe('encodeAcs', () => {
+	it('collapses repeated rows and trailing runs of 0 or F', () => {
+		// FFFFFFFF, the same row again, 00000000, then F000000F: one F, six
+		// 0s (L) and a trailing F
+		expect(encodeAcs(FRAME, 4)).toBe('!:,FL0!');
+	});
+
+	it('adds up repeat counts of 20 and more', () => {
+		// 44 A nibbles are h (40) and J (4); 420 nibbles of 5 are z (400)
+		// and g (20)
+		const short = Buffer.concat([
+			Buffer.alloc(22, 0xaa),
+			Buffer.from([0x01, 0x23]),
+		]);
+		const long = Buffer.concat([Buffer.alloc(210, 0x55), Buffer.from([0x01])]);
+
+		expect(encodeAcs(short, short.length)).toBe('hJA0123');
+		expect(encodeAcs(long, long.length)).toBe('zg501');
+	});
+
+	it('counts runs of three nibbles and writes shorter ones out', () => {
+		// 11, 2, then three 3s as I3
+		expect(encodeAcs(Buffer.from([0x11, 0x23, 0x33]), 3)).toBe('112I3');
+	});
+});
+
+// 12 dots wide, 2 bytes a row, with a blank third row
+const BITMAP: MonoBitmap = {
+	width: 12,
+	height: 4,
+	data: Buffer.from([0x80, 0x00, 0xff, 0xf0, 0x00, 0x00, 0x01, 0x10]),
+};
+
+describe('label rasters', () => {
+	it('encodes a raster as ZPL ^GFA in ACS without Z64 support', () => {
+		const acsOnly = { ...profile('zpl-203dpi'), capabilities: {} };
+
+		const label = encodeZpl(
+			[{ type: 'raster', bitmap: BITMAP, align: 'left' }],
+			acsOnly,
+		);
+
+		expect(label.toString('ascii')).toBe(
+			'^XA\n^CI28\n^PW832\n^LL44\n^LH0,0\n' +
+				'^FO0,16^GFA,8,8,2,8,IF,,011,^FS\n' +
+				'^XZ\n',
+		);
+	});
+
+	it('encodes a raster as TSPL BITMAP bands with inverted bits', () => {
+		const label = encodeTspl(
+			[{ type: 'raster', bitmap: BITMAP, align: 'left' }],
+			profile('tspl-203dpi'),
+		);
+
+		// A 0 bit prints black; the blank row is left to CLS
+		expect(label).toEqual(
+			Buffer.concat([
+				Buffer.from(
+					'SIZE 104 mm,6 mm\r\nGAP 2 mm,0 mm\r\nCODEPAGE UTF-8\r\nCLS\r\n' +
+						'BITMAP 0,16,2,2,0,',
+				),
+				Buffer.from([0x7f, 0xff, 0x00, 0x0f]),
+				Buffer.from('\r\nBITMAP 0,19,2,1,0,'),
+				Buffer.from([0xfe, 0xef]),
+				Buffer.from('\r\nPRINT 1,1\r\n'),
+			]),
+		);
+	});
+});
@@ -0,0 +1,151 @@
+import {
+	configureLogging,
+	flushLogs,
+	formatLogRecord,
+	getLogger,
+	getRecentLogs,
+	type LogRecord,
+} from '../src/core/logger';
+
+// Subsystem names are unique per test: loggers and the ring are shared
+// by the whole process
+let nextSubsystem = 0;
+const subsystem = () => `test-${nextSubsystem++}`;
+
+const captureSink = () => {
+	const batches: LogRecord[][] = [];
+	configureLogging({
+		sink: (records) => {
+			batches.push(records);
+		},
+	});
+	return batches;
+};
+
+describe('logger', () => {
+	beforeEach(async () => {
+		// Start every test with nothing pending
+		await flushLogs();
+	});
+
+	afterEach(async () => {
+		await flushLogs();
+		configureLogging({ level: 'info', sink: () => {}, capacity: 1024 });
+	});
+
+	it('skips levels below the subsystem threshold', () => {
+		const name = subsystem();
+		const log = getLogger(name);
+		configureLogging({ subsystems: { [name]: 'warn' } });
+
+		log.debug('hidden');
+		log.info('hidden');
+		log.warn('shown');
+
+		expect(log.isEnabled('info')).toBe(false);
+		const records = getRecentLogs().filter((r) => r.subsystem === name);
+		expect(records.map((r) => r.message)).toEqual(['shown']);
+	});
+
+	it('lets a subsystem level override the default', () => {
+		const quiet = getLogger(subsystem());
+		const verbose = getLogger(subsystem());
+		configureLogging({
+			level: 'error',
+			subsystems: { [verbose.subsystem]: 'trace' },
+		});
+
+		quiet.warn('dropped');
+		verbose.trace('kept');
+
+		const names = [quiet.subsystem, verbose.subsystem];
+		const messages = getRecentLogs()
+			.filter((r) => names.includes(r.subsystem))
+			.map((r) => r.message);
+		expect(messages).toEqual(['kept']);
+	});
+
+	it('hands records to the sink after the call returns', async () => {
+		const batches = captureSink();
+		const log = getLogger(subsystem());
+
+		log.info('queued', { deviceId: 'lp0', bytes: 42 });
+		expect(batches).toHaveLength(0);
+
+		await flushLogs();
+		expect(batches).toHaveLength(1);
+		expect(batches[0]).toEqual([
+			expect.objectContaining({
+				level: 'info',
+				subsystem: log.subsystem,
+				message: 'queued',
+				fields: { deviceId: 'lp0', bytes: 42 },
+			}),
+		]);
+	});
+
+	it('holds the next batch until a pending sink settles', async () => {
+		const batches: LogRecord[][] = [];
+		const releases: Array<() => void> = [];
+		configureLogging({
+			sink: (records) => {
+				batches.push(records);
+				return new Promise<void>((resolve) => releases.push(resolve));
+			},
+		});
+		const log = getLogger(subsystem());
+
+		log.info('first');
+		const first = flushLogs();
+		log.info('second');
+		const second = flushLogs();
+		await new Promise((resolve) => setImmediate(resolve));
+		expect(batches).toHaveLength(1);
+
+		releases[0]();
+		await first;
+		await new Promise((resolve) => setImmediate(resolve));
+		releases[1]?.();
+		await second;
+		expect(batches.map((batch) => batch.map((r) => r.message))).toEqual([
+			['first'],
+			['second'],
+		]);
+	});
+
+	it('drops the oldest records when the sink falls a ring behind', async () => {
+		const batches = captureSink();
+		configureLogging({ capacity: 16 });
+		const log = getLogger(subsystem());
+
+		for (let index = 0; index < 40; index++) {
+			log.info(`record ${index}`);
+		}
+		await flushLogs();
+
+		const [batch] = batches;
+		expect(batch[0]).toMatchObject({
+			level: 'warn',
+			subsystem: 'logger',
+			fields: { dropped: 24 },
+		});
+		expect(batch.slice(1).map((r) => r.message)).toEqual(
+			Array.from({ length: 16 }, (_, index) => `record ${index + 24}`),
+		);
+	});
+
+	it('formats records as one line with their fields', () => {
+		const line = formatLogRecord({
+			time: Date.UTC(2026, 0, 1, 10),
+			level: 'warn',
+			subsystem: 'printer',
+			message: 'Print failed',
+			fields: { deviceId: 'lp0', reason: 'out of paper', attempts: 3 },
+		});
+
+		expect(line).toBe(
+			'2026-01-01T10:00:00.000Z WARN  [printer] Print failed ' +
+				'deviceId=lp0 reason="out of paper" attempts=3',
+		);
+	});
+});
@@ -0,0 +1,111 @@
+import { jobBufferPool } from '../src/core/bufferPool';
+import { PreparedJobStore } from '../src/core/preparedJobs';
+import { PrintJobError } from '../src/core/windows_printer';
+
+const bytesInUse = () => jobBufferPool.stats().bytesInUse;
+
+describe('PreparedJobStore', () => {
+	let baseline: number;
+
+	beforeEach(() => {
+		baseline = bytesInUse();
+	});
+
+	afterEach(() => {
+		jest.useRealTimers();
+	});
+
+	it('holds a rendering until its job is committed', () => {
+		const store = new PreparedJobStore();
+		const buffer = jobBufferPool.acquire(100);
+
+		const job = store.add('p1', 'receipt', false, buffer);
+
+		expect(job).toMatchObject({ deviceId: 'p1', data: 'receipt', bytes: 100 });
+		expect(store.stats()).toEqual({ jobs: 1, bytes: 100, evicted: 0 });
+		expect(store.take(job)).toBe(buffer);
+		expect(store.stats()).toEqual({ jobs: 0, bytes: 0, evicted: 0 });
+		jobBufferPool.release(buffer);
+	});
+
+	it('drops a rendering once its TTL passes and keeps the handle', () => {
+		jest.useFakeTimers();
+		const store = new PreparedJobStore({ ttlMs: 1000 });
+		const job = store.add('p1', 'receipt', false, jobBufferPool.acquire(100));
+		const short = store.add(
+			'p1',
+			'ticket',
+			false,
+			jobBufferPool.acquire(100),
+			200,
+		);
+
+		expect(job.expiresAt - Date.now()).toBe(1000);
+		jest.advanceTimersByTime(200);
+		expect(store.stats()).toEqual({ jobs: 1, bytes: 100, evicted: 1 });
+		jest.advanceTimersByTime(800);
+		expect(store.stats()).toEqual({ jobs: 0, bytes: 0, evicted: 2 });
+		expect(bytesInUse()).toBe(baseline);
+
+		// Committing still works; the caller encodes the job again
+		expect(store.take(job)).toBeUndefined();
+		expect(store.take(short)).toBeUndefined();
+	});
+
+	it('evicts the oldest renderings to stay within its budget', () => {
+		const store = new PreparedJobStore({ maxBytes: 250 });
+		const first = store.add('p1', 'a', false, jobBufferPool.acquire(100));
+		const second = store.add('p1', 'b', false, jobBufferPool.acquire(100));
+		const third = store.add('p2', 'c', false, jobBufferPool.acquire(100));
+
+		expect(store.stats()).toEqual({ jobs: 2, bytes: 200, evicted: 1 });
+		expect(store.take(first)).toBeUndefined();
+		for (const job of [second, third]) {
+			const buffer = store.take(job);
+			expect(buffer).toHaveLength(100);
+			jobBufferPool.release(buffer as Buffer);
+		}
+		expect(bytesInUse()).toBe(baseline);
+	});
+
+	it('does not hold a rendering larger than its whole budget', () => {
+		const store = new PreparedJobStore({ maxBytes: 50 });
+
+		const job = store.add('p1', 'a', false, jobBufferPool.acquire(100));
+
+		expect(job.bytes).toBe(0);
+		expect(store.stats().jobs).toBe(0);
+		expect(bytesInUse()).toBe(baseline);
+		expect(store.take(job)).toBeUndefined();
+	});
+
+	it('refuses to commit a job twice or after discarding it', () => {
+		const store = new PreparedJobStore();
+		const committed = store.add('p1', 'a', false, jobBufferPool.acquire(10));
+		const discarded = store.add('p1', 'b', false, undefined);
+
+		jobBufferPool.release(store.take(committed) as Buffer);
+		store.discard(discarded);
+
+		expect(() => store.take(committed)).toThrow(PrintJobError);
+		expect(() => store.take(discarded)).toThrow(
+			'Prepared job was already committed or discarded',
+		);
+	});
+
+	it('frees every rendering on trim and keeps the handles', () => {
+		const store = new PreparedJobStore();
+		const jobs = [
+			store.add('p1', 'a', false, jobBufferPool.acquire(100)),
+			store.add('p2', 'b', false, jobBufferPool.acquire(50)),
+		];
+
+		expect(store.trim()).toBe(150);
+		expect(store.stats()).toEqual({ jobs: 0, bytes: 0, evicted: 2 });
+		expect(bytesInUse()).toBe(baseline);
+		expect(jobs.map((job) => store.take(job))).toEqual([
+			undefined,
+			undefined,
+		]);
+	});
+});
@@ -0,0 +1,115 @@
+import { execFile } from 'node:child_process';
+import { mkdtempSync, rmSync, statSync } from 'node:fs';
+import { tmpdir } from 'node:os';
+import { join } from 'node:path';
+import { promisify } from 'node:util';
+import { loadNativeAddon } from '../src/core/nativeAddon';
+import {
+	handoffSocketPath,
+	SHARED_PAYLOAD_THRESHOLD,
+} from '../src/managers/brokerProtocol';
+import type { DeviceManager } from '../src/managers/deviceManager';
+import { PrintBroker } from '../src/managers/printBroker';
+import { PrintBrokerClient } from '../src/managers/printBrokerClient';
+import type { PrinterManager } from '../src/managers/printerManager';
+
+const addon = loadNativeAddon();
+const describeNative =
+	addon?.Transport && addon.DescriptorReceiver && process.platform !== 'win32'
+		? describe
+		: describe.skip;
+
+const CLIENT_SCRIPT = join(__dirname, 'helpers', 'brokerClient.ts');
+
+// The broker only subscribes to device events and reads queue depths
+const fakeDeviceManager = () =>
+	({
+		onDeviceConnect: () => {},
+		onDeviceDisconnect: () => {},
+		getEventEmitter: () => ({ onDeviceError: () => {} }),
+	}) as unknown as DeviceManager;
+
+const fakePrinterManager = () =>
+	({
+		getPrinterDevices: () => [],
+		getPrintQueueDepth: () => 0,
+	}) as unknown as PrinterManager;
+
+describeNative('PrintBroker', () => {
+	let dir: string;
+	let socketPath: string;
+	let broker: PrintBroker;
+
+	beforeEach(async () => {
+		dir = mkdtempSync(join(tmpdir(), 'escpos-broker-'));
+		socketPath = join(dir, 'broker.sock');
+		broker = new PrintBroker(fakeDeviceManager(), fakePrinterManager(), {
+			socketPath,
+			transports: [/^emu:\/\//],
+		});
+		await broker.start();
+	});
+
+	afterEach(async () => {
+		await broker.stop();
+		rmSync(dir, { recursive: true, force: true });
+	});
+
+	it('creates both sockets for the owner only', () => {
+		expect(statSync(socketPath).mode & 0o777).toBe(0o600);
+		expect(statSync(handoffSocketPath(socketPath)).mode & 0o777).toBe(0o600);
+	});
+
+	it('prints jobs from another process through an emu transport', async () => {
+		const uri = 'emu://broker-test';
+		const payloadBytes = 2 * SHARED_PAYLOAD_THRESHOLD;
+		const { stdout } = await promisify(execFile)(
+			process.execPath,
+			[
+				require.resolve('tsx/cli'),
+				CLIENT_SCRIPT,
+				socketPath,
+				uri,
+				String(payloadBytes),
+			],
+			{ timeout: 30_000 },
+		);
+		const results = JSON.parse(stdout);
+
+		expect(results.small).toEqual({ ok: true });
+		expect(results.large).toEqual({ ok: true });
+		expect(results.denied.ok).toBe(false);
+		expect(results.denied.message).toMatch(/not allowed/);
+
+		const metrics = broker.getMetrics();
+		expect(metrics.completed).toBe(2);
+		expect(metrics.failed).toBe(1);
+		// The large job arrived as a descriptor, not through the socket
+		expect(metrics.sharedPayloads).toBe(1);
+		expect(metrics.sharedBytes).toBe(payloadBytes);
+		expect(metrics.inlineBytes).toBeLessThan(SHARED_PAYLOAD_THRESHOLD);
+
+		const client = await PrintBrokerClient.connect(socketPath);
+		try {
+			const output = await client.takeOutput(uri);
+			expect(output.includes(Buffer.from('small receipt'))).toBe(true);
+			expect(output.includes(Buffer.from('xxxxEND'))).toBe(true);
+		} finally {
+			client.close();
+		}
+	}, 60_000);
+
+	it('refuses transports it was not configured with', async () => {
+		const client = await PrintBrokerClient.connect(socketPath);
+		try {
+			await expect(
+				client.printToTransport('tcp://127.0.0.1:9100', 'x'),
+			).rejects.toThrow('not allowed');
+			await expect(client.takeOutput('file:///etc/passwd')).rejects.toThrow(
+				'not allowed',
+			);
+		} finally {
+			client.close();
+		}
+	});
+});
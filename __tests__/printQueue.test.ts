@@ -0,0 +1,229 @@
+import { jobBufferPool } from '../src/core/bufferPool';
+import { type PrintJobContext, PrintQueue } from '../src/core/printQueue';
+import { PrintJobCancelledError } from '../src/core/windows_printer';
+
+const deferred = <T>() => {
+	let resolve!: (value: T) => void;
+	const promise = new Promise<T>((done) => {
+		resolve = done;
+	});
+	return { promise, resolve };
+};
+
+// Lets pending prepares settle and the queue react to them
+const settle = () => new Promise((resolve) => setImmediate(resolve));
+
+// A job that prints until finish() is called, and what it was given
+const blockingJob = () => {
+	const { promise, resolve } = deferred<void>();
+	const contexts: PrintJobContext[] = [];
+	return {
+		contexts,
+		finish: resolve,
+		run: (context: PrintJobContext) => {
+			contexts.push(context);
+			return promise;
+		},
+	};
+};
+
+// A preparer whose render ends when resolve() is called, with a pooled
+// buffer of the given size
+const pendingRender = (size: number) => {
+	const { promise, resolve } = deferred<void>();
+	const prepare = jest.fn<Promise<Buffer | undefined>, []>(async () => {
+		await promise;
+		return jobBufferPool.acquire(size);
+	});
+	return { prepare, resolve: () => resolve() };
+};
+
+const renderNow = (size: number) =>
+	jest.fn<Promise<Buffer | undefined>, []>(async () =>
+		jobBufferPool.acquire(size),
+	);
+
+const bytesInUse = () => jobBufferPool.stats().bytesInUse;
+
+// Runners that release what they were given, as the adapters do
+const consume = async (context: PrintJobContext) => {
+	const buffer = await context.prepared;
+	if (buffer) {
+		jobBufferPool.release(buffer);
+	}
+};
+
+describe('PrintQueue lookahead', () => {
+	it('renders up to lookahead jobs behind the one printing', async () => {
+		const queue = new PrintQueue({ lookahead: 2 });
+		const first = blockingJob();
+		const prepares: jest.Mock<Promise<Buffer | undefined>, []>[] = [];
+
+		const done = [queue.enqueue('p1', first.run)];
+		for (let i = 0; i < 3; i++) {
+			const prepare = renderNow(100);
+			prepares.push(prepare);
+			done.push(queue.enqueue('p1', consume, {}, prepare));
+		}
+		await settle();
+
+		expect(prepares.map((prepare) => prepare.mock.calls.length)).toEqual([
+			1, 1, 0,
+		]);
+		expect(queue.getPreparedBytes()).toBe(200);
+
+		first.finish();
+		await Promise.all(done);
+		// Rendered when the queue moved up, then sent as it was
+		expect(prepares[2]).toHaveBeenCalledTimes(1);
+		expect(queue.getPreparedBytes()).toBe(0);
+	});
+
+	it('renders nothing ahead with a lookahead of 0', async () => {
+		const queue = new PrintQueue({ lookahead: 0 });
+		const first = blockingJob();
+		const prepare = renderNow(100);
+
+		const done = [
+			queue.enqueue('p1', first.run),
+			queue.enqueue('p1', consume, {}, prepare),
+		];
+		await settle();
+
+		expect(prepare).not.toHaveBeenCalled();
+		first.finish();
+		await Promise.all(done);
+	});
+
+	it('stops rendering ahead once the byte budget is used', async () => {
+		const queue = new PrintQueue({ lookahead: 3, lookaheadBytes: 150 });
+		const first = blockingJob();
+		const prepares = [renderNow(100), renderNow(100), renderNow(100)];
+
+		const done = [queue.enqueue('p1', first.run)];
+		for (const prepare of prepares) {
+			done.push(queue.enqueue('p1', consume, {}, prepare));
+		}
+		await settle();
+
+		// The second render went 50 bytes over; nothing started after it
+		expect(queue.getPreparedBytes()).toBe(200);
+		expect(prepares[2]).not.toHaveBeenCalled();
+
+		first.finish();
+		await Promise.all(done);
+	});
+
+	it('renders one job at a time to know the bytes it holds', async () => {
+		const queue = new PrintQueue({ lookahead: 3, lookaheadBytes: 100 });
+		const first = blockingJob();
+		const second = pendingRender(100);
+		const third = pendingRender(100);
+
+		const done = [
+			queue.enqueue('p1', first.run),
+			queue.enqueue('p1', consume, {}, second.prepare),
+			queue.enqueue('p1', consume, {}, third.prepare),
+		];
+		await settle();
+
+		// The size of the second job is not known yet, so the third waits
+		expect(second.prepare).toHaveBeenCalledTimes(1);
+		expect(third.prepare).not.toHaveBeenCalled();
+
+		second.resolve();
+		await settle();
+		expect(queue.getPreparedBytes()).toBe(100);
+		expect(third.prepare).not.toHaveBeenCalled();
+
+		first.finish();
+		third.resolve();
+		await Promise.all(done);
+	});
+
+	it('returns the rendering of a cancelled job to the pool', async () => {
+		const queue = new PrintQueue();
+		const first = blockingJob();
+		const render = pendingRender(100);
+		const controller = new AbortController();
+		const baseline = bytesInUse();
+
+		const done = queue.enqueue('p1', first.run);
+		const cancelled = queue.enqueue(
+			'p1',
+			consume,
+			{ signal: controller.signal },
+			render.prepare,
+		);
+		await settle();
+		controller.abort();
+		await expect(cancelled).rejects.toBeInstanceOf(PrintJobCancelledError);
+
+		// Still rendering when it was dropped
+		render.resolve();
+		await settle();
+		expect(bytesInUse()).toBe(baseline);
+		expect(queue.getPreparedBytes()).toBe(0);
+
+		first.finish();
+		await done;
+	});
+
+	it('returns a rendering to the pool when its job has to reset', async () => {
+		const queue = new PrintQueue();
+		const first = blockingJob();
+		const second = blockingJob();
+		const render = pendingRender(100);
+		const controller = new AbortController();
+		const baseline = bytesInUse();
+
+		const interrupted = queue.enqueue('p1', first.run, {
+			signal: controller.signal,
+		});
+		const done = queue.enqueue('p1', second.run, {}, render.prepare);
+		await settle();
+		controller.abort();
+		await expect(interrupted).rejects.toBeInstanceOf(PrintJobCancelledError);
+
+		// Rendered without ESC @, so the job starts over from its ops
+		expect(second.contexts).toHaveLength(1);
+		expect(second.contexts[0]).toMatchObject({
+			reset: true,
+			prepared: undefined,
+		});
+		render.resolve();
+		await settle();
+		expect(bytesInUse()).toBe(baseline);
+
+		second.finish();
+		await done;
+	});
+
+	it('hands a rendering that ends after its job started over', async () => {
+		const queue = new PrintQueue();
+		const first = blockingJob();
+		const second = blockingJob();
+		const render = pendingRender(100);
+		const baseline = bytesInUse();
+
+		const done = [
+			queue.enqueue('p1', first.run),
+			queue.enqueue('p1', second.run, {}, render.prepare),
+		];
+		await settle();
+		first.finish();
+		await settle();
+
+		expect(second.contexts).toHaveLength(1);
+		render.resolve();
+		const buffer = await second.contexts[0].prepared;
+		expect(buffer).toHaveLength(100);
+		// Owned by the runner now, not counted as held ahead
+		expect(queue.getPreparedBytes()).toBe(0);
+		jobBufferPool.release(buffer as Buffer);
+		expect(bytesInUse()).toBe(baseline);
+
+		second.finish();
+		await Promise.all(done);
+	});
+});
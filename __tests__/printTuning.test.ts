@@ -0,0 +1,61 @@
+import type { JobOp } from '../src/core/jobBuilder';
+import { loadNativeAddon } from '../src/core/nativeAddon';
+import { getPrinterProfile } from '../src/core/printerProfile';
+import { analyzeJob } from '../src/core/printTuning';
+import { layoutSymbol, rasterizeSymbol } from '../src/core/symbology';
+
+const addon = loadNativeAddon();
+const itNative = addon?.encodeDataMatrix ? it : it.skip;
+
+const profile = (id: string) => {
+	const found = getPrinterProfile(id);
+	if (!found) {
+		throw new Error(`No profile ${id}`);
+	}
+	return found;
+};
+
+const DATA_MATRIX: JobOp = {
+	type: 'symbol',
+	symbology: 'datamatrix',
+	data: '0104012345012345',
+	moduleSize: 4,
+};
+
+describe('analyzeJob', () => {
+	it('finds no raster in a text-only job', () => {
+		const analysis = analyzeJob([{ type: 'text', text: 'receipt\n' }]);
+
+		expect(analysis).toMatchObject({ textOnly: true, rasterDots: 0 });
+	});
+
+	itNative('counts the dots of a symbol the encoder rasterizes', () => {
+		const escpos = profile('escpos-80mm');
+		const bitmap = rasterizeSymbol(
+			layoutSymbol('datamatrix', '0104012345012345', DATA_MATRIX, escpos),
+		);
+
+		const analysis = analyzeJob([DATA_MATRIX], escpos);
+
+		expect(analysis.textOnly).toBe(false);
+		expect(analysis.rasterDots).toBe(bitmap.width * bitmap.height);
+		expect(analysis.blackDots).toBeGreaterThan(0);
+		expect(analysis.blackDots).toBeLessThan(analysis.rasterDots);
+	});
+
+	it('counts a symbol the printer draws by its area', () => {
+		const zpl = profile('zpl-203dpi');
+		const { width, height } = layoutSymbol(
+			'datamatrix',
+			'0104012345012345',
+			DATA_MATRIX,
+			zpl,
+		);
+
+		const analysis = analyzeJob([DATA_MATRIX], zpl);
+
+		expect(analysis.textOnly).toBe(false);
+		expect(analysis.rasterDots).toBe(width * height);
+		expect(analysis.peakBlackRatio).toBeCloseTo(0.5, 2);
+	});
+});
@@ -0,0 +1,209 @@
+import type {
+	WritableDevice,
+	WriteOptions,
+} from '../src/adaptor/deviceAdaptor';
+import { jobBufferPool } from '../src/core/bufferPool';
+import type { PrintData, TerminalDevice } from '../src/core/types';
+import type { DeviceManager } from '../src/managers/deviceManager';
+import { PrintJobCancelledError } from '../src/core/windows_printer';
+import { PrinterManager } from '../src/managers/printerManager';
+
+const printer = (id: string, group?: string): TerminalDevice => ({
+	id,
+	vid: '0416',
+	pid: '5011',
+	path: `/dev/usb/${id}`,
+	name: id,
+	serialNumber: '',
+	manufacturer: '',
+	meta: {
+		deviceType: 'printer',
+		brand: '',
+		model: '',
+		baudrate: 'not-supported',
+		setToDefault: false,
+		group,
+	},
+	capabilities: ['write'],
+});
+
+// PrinterManager looks printers up and subscribes to connects and
+// disconnects; nothing here is ever opened
+const fakeDeviceManager = (devices: TerminalDevice[]) =>
+	({
+		getDevice: (deviceId: string) =>
+			devices.find((device) => device.id === deviceId),
+		getDevicesByType: (deviceType: string) =>
+			devices.filter((device) => device.meta.deviceType === deviceType),
+		onDeviceConnect: () => {},
+		onDeviceDisconnect: () => {},
+		getEventEmitter: () => ({ emitDeviceError: () => {} }),
+	}) as unknown as DeviceManager;
+
+// An open adapter that renders every job to a pooled buffer and writes it
+// nowhere, handed to the manager as if it had opened the printer itself
+const fakeAdapter = (manager: PrinterManager, deviceId: string) => {
+	const adapter = {
+		open: jest.fn(async () => {}),
+		close: jest.fn(async () => {}),
+		onError: jest.fn(),
+		prepare: jest.fn(async (data: PrintData) =>
+			jobBufferPool.acquire(data.length),
+		),
+		write: jest.fn(
+			async (_data: PrintData, _isImage: boolean, options?: WriteOptions) => {
+				if (options?.prepared) {
+					jobBufferPool.release(options.prepared);
+				}
+			},
+		),
+	} satisfies WritableDevice;
+	(
+		manager as unknown as { printerAdapters: Map<string, WritableDevice> }
+	).printerAdapters.set(deviceId, adapter);
+	return adapter;
+};
+
+const HOLDER = 'the label trigger of scale s1';
+
+describe('PrinterManager.detachPrinter', () => {
+	let manager: PrinterManager;
+
+	beforeEach(() => {
+		manager = new PrinterManager(
+			fakeDeviceManager([printer('p1', 'front'), printer('p2', 'front')]),
+		);
+	});
+
+	it('refuses jobs and renderings for a detached printer', async () => {
+		await manager.detachPrinter('p1', HOLDER);
+
+		await expect(manager.printToDevice('p1', 'receipt\n')).rejects.toThrow(
+			`Printer p1 is in use by ${HOLDER}`,
+		);
+		await expect(manager.preparePrint('p1', 'receipt\n')).rejects.toThrow(
+			'in use',
+		);
+	});
+
+	it('leaves the printer out of its group while detached', async () => {
+		await manager.detachPrinter('p1', HOLDER);
+
+		const members = manager.getPrinterGroupStatus('front');
+		expect(members.map((member) => member.deviceId)).toEqual(['p2']);
+
+		manager.attachPrinter('p1');
+		expect(manager.getPrinterGroupStatus('front')).toHaveLength(2);
+	});
+
+	it('gives a printer to one holder at a time', async () => {
+		const other = 'the label trigger of scale s2';
+		await manager.detachPrinter('p1', HOLDER);
+
+		await expect(manager.detachPrinter('p1', other)).rejects.toThrow(
+			`Printer p1 is in use by ${HOLDER}`,
+		);
+		manager.attachPrinter('p1');
+		await expect(manager.detachPrinter('p1', other)).resolves.toBeUndefined();
+	});
+});
+
+describe('PrinterManager.commitPrint', () => {
+	it('writes the rendering held for a prepared job', async () => {
+		const manager = new PrinterManager(fakeDeviceManager([printer('p1')]));
+		const adapter = fakeAdapter(manager, 'p1');
+
+		const job = await manager.preparePrint('p1', 'receipt\n');
+		await manager.commitPrint(job);
+
+		expect(adapter.prepare).toHaveBeenCalledTimes(1);
+		expect(adapter.write.mock.calls[0][2]?.prepared).toHaveLength(8);
+	});
+
+	it('encodes a job again when its rendering was dropped', async () => {
+		const manager = new PrinterManager(fakeDeviceManager([printer('p1')]));
+		const adapter = fakeAdapter(manager, 'p1');
+
+		const job = await manager.preparePrint('p1', 'receipt\n');
+		expect(manager.trimPreparedJobs()).toBe(8);
+		await manager.commitPrint(job);
+
+		// Left to write() to encode, as for a job that was never prepared
+		expect(adapter.write).toHaveBeenCalledTimes(1);
+		expect(adapter.write.mock.calls[0][2]?.prepared).toBeUndefined();
+		await expect(manager.commitPrint(job)).rejects.toThrow(
+			'already committed',
+		);
+	});
+});
+
+describe('PrinterManager.printToGroup', () => {
+	let manager: PrinterManager;
+	let first: ReturnType<typeof fakeAdapter>;
+	let second: ReturnType<typeof fakeAdapter>;
+
+	beforeEach(() => {
+		manager = new PrinterManager(
+			fakeDeviceManager([printer('p1', 'front'), printer('p2', 'front')]),
+		);
+		first = fakeAdapter(manager, 'p1');
+		second = fakeAdapter(manager, 'p2');
+	});
+
+	it('fails over to the next printer when one fails the job', async () => {
+		first.write.mockImplementation(async () => {
+			throw new Error('Paper out');
+		});
+
+		await expect(manager.printToGroup('front', 'receipt\n')).resolves.toBe(
+			true,
+		);
+		expect(first.write).toHaveBeenCalledTimes(1);
+		expect(second.write).toHaveBeenCalledTimes(1);
+
+		// The failed printer cools down behind the one that printed
+		const ranked = manager.getPrinterGroupStatus('front');
+		expect(ranked.map((member) => member.deviceId)).toEqual(['p2', 'p1']);
+		expect(ranked[1].healthy).toBe(false);
+	});
+
+	it('reports the last error when every printer fails', async () => {
+		first.write.mockImplementation(async () => {
+			throw new Error('Paper out');
+		});
+		second.write.mockImplementation(async () => {
+			throw new Error('Cover open');
+		});
+
+		await expect(manager.printToGroup('front', 'receipt\n')).rejects.toThrow(
+			'Cover open',
+		);
+	});
+
+	it('does not fail over a job cancelled on its printer', async () => {
+		first.write.mockImplementation(() => new Promise<void>(() => {}));
+
+		const job = manager.printToGroup('front', 'receipt\n');
+		await new Promise((resolve) => setImmediate(resolve));
+		expect(manager.cancelPrintJobs('p1')).toBe(1);
+
+		await expect(job).rejects.toBeInstanceOf(PrintJobCancelledError);
+		expect(second.write).not.toHaveBeenCalled();
+		// Cancelling says nothing about the printer's health
+		expect(manager.getPrinterGroupStatus('front')[0].healthy).toBe(true);
+	});
+
+	it('does not fail over a job its caller aborted', async () => {
+		const controller = new AbortController();
+		first.write.mockImplementation(() => new Promise<void>(() => {}));
+
+		const job = manager.printToGroup('front', 'receipt\n', false, {
+			signal: controller.signal,
+		});
+		await new Promise((resolve) => setImmediate(resolve));
+		controller.abort();
+
+		await expect(job).rejects.toBeInstanceOf(PrintJobCancelledError);
+		expect(second.write).not.toHaveBeenCalled();
+	});
+});
@@ -0,0 +1,95 @@
+import { PrinterRouter } from '../src/core/printerRouter';
+
+const idle = () => 0;
+
+const order = (router: PrinterRouter, bytes = 1000, depth = idle) =>
+	router.rank(['a', 'b'], bytes, depth).map((member) => member.deviceId);
+
+describe('PrinterRouter', () => {
+	afterEach(() => {
+		jest.useRealTimers();
+	});
+
+	it('estimates a job from the queue depth and its bytes', () => {
+		const router = new PrinterRouter();
+
+		const ranked = router.rank(['a', 'b'], 100, (deviceId) =>
+			deviceId === 'a' ? 2 : 0,
+		);
+
+		// 300 ms per job in line, 0.5 ms per byte before any job completed
+		expect(ranked).toEqual([
+			{ deviceId: 'b', estimatedMs: 350, queueDepth: 0, healthy: true },
+			{ deviceId: 'a', estimatedMs: 950, queueDepth: 2, healthy: true },
+		]);
+	});
+
+	it('counts the bytes still queued for a printer', () => {
+		const router = new PrinterRouter();
+
+		router.begin('a', 2000);
+		expect(order(router)).toEqual(['b', 'a']);
+
+		// A failed or cancelled job leaves the queue without a rate sample
+		router.end('a', 2000);
+		expect(order(router)).toEqual(['a', 'b']);
+		expect(router.rank(['a'], 1000, idle)[0].estimatedMs).toBe(800);
+	});
+
+	it('learns the print rate from completed jobs', () => {
+		const router = new PrinterRouter();
+
+		// 2 ms per byte after overhead, averaged into the 0.5 ms prior
+		router.begin('a', 1000);
+		router.end('a', 1000, 300 + 2000);
+
+		const [b, a] = router.rank(['a', 'b'], 1000, idle);
+		expect(b).toMatchObject({ deviceId: 'b', estimatedMs: 800 });
+		expect(a.deviceId).toBe('a');
+		expect(a.estimatedMs).toBeCloseTo(1100);
+	});
+
+	it('ranks a failed printer last until its cooldown passes', () => {
+		jest.useFakeTimers();
+		const router = new PrinterRouter({ failureCooldownMs: 5000 });
+
+		// Five jobs behind on b still beat a printer that just failed
+		const busyB = (deviceId: string) => (deviceId === 'b' ? 5 : 0);
+
+		router.reportFailure('a');
+		expect(router.rank(['a', 'b'], 1000, busyB)).toMatchObject([
+			{ deviceId: 'b', healthy: true },
+			{ deviceId: 'a', healthy: false },
+		]);
+
+		jest.advanceTimersByTime(4999);
+		expect(order(router, 1000, busyB)).toEqual(['b', 'a']);
+		jest.advanceTimersByTime(1);
+		expect(order(router, 1000, busyB)).toEqual(['a', 'b']);
+	});
+
+	it('ends the cooldown when the printer completes a job', () => {
+		jest.useFakeTimers();
+		const router = new PrinterRouter();
+
+		router.reportFailure('a');
+		router.end('a', 0);
+		expect(router.rank(['a'], 0, idle)[0].healthy).toBe(false);
+
+		router.end('a', 0, 100);
+		expect(router.rank(['a'], 0, idle)[0].healthy).toBe(true);
+	});
+
+	it('forgets what it learned about a removed printer', () => {
+		const router = new PrinterRouter();
+		router.begin('a', 2000);
+		router.reportFailure('a');
+
+		router.remove('a');
+
+		expect(router.rank(['a'], 1000, idle)[0]).toMatchObject({
+			estimatedMs: 800,
+			healthy: true,
+		});
+	});
+});
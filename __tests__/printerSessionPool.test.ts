@@ -0,0 +1,333 @@
+import { execFileSync } from 'node:child_process';
+import {
+	closeSync,
+	constants,
+	mkdtempSync,
+	openSync,
+	readFileSync,
+	readSync,
+	rmSync,
+} from 'node:fs';
+import { tmpdir } from 'node:os';
+import { join } from 'node:path';
+import { TransportPrinterAdapter } from '../src/adaptor/transportPrinterAdapter';
+import { loadNativeAddon } from '../src/core/nativeAddon';
+import {
+	type PrinterSession,
+	PrinterSessionPool,
+} from '../src/core/printerSessionPool';
+import { PrintQueue } from '../src/core/printQueue';
+import { PrinterTransport } from '../src/core/transport';
+import type { TerminalDevice } from '../src/core/types';
+import {
+	PrintJobCancelledError,
+	PrintJobTimeoutError,
+} from '../src/core/windows_printer';
+
+const addon = loadNativeAddon();
+const describePosix =
+	addon?.Transport && process.platform !== 'win32' ? describe : describe.skip;
+
+class FakeSession implements PrinterSession {
+	closed = 0;
+	healthy = true;
+
+	isHealthy(): boolean {
+		return this.healthy;
+	}
+
+	close(): void {
+		this.closed++;
+	}
+}
+
+describe('PrinterSessionPool', () => {
+	it('reuses a healthy session across jobs', async () => {
+		const pool = new PrinterSessionPool<FakeSession>();
+		const open = jest.fn(async () => new FakeSession());
+
+		const first = await pool.use('lp0', open, async (session) => session);
+		const second = await pool.use('lp0', open, async (session) => session);
+
+		expect(second).toBe(first);
+		expect(open).toHaveBeenCalledTimes(1);
+		await pool.closeAll();
+		expect(first.closed).toBe(1);
+	});
+
+	it('reopens a session that fails its health check', async () => {
+		const pool = new PrinterSessionPool<FakeSession>();
+		const first = await pool.acquire('lp0', async () => new FakeSession());
+		pool.release('lp0', first);
+		first.healthy = false;
+
+		const second = await pool.acquire('lp0', async () => new FakeSession());
+
+		expect(second).not.toBe(first);
+		expect(first.closed).toBe(1);
+		await pool.closeAll();
+	});
+
+	it('waits for the job still holding a session', async () => {
+		const pool = new PrinterSessionPool<FakeSession>();
+		const open = jest.fn(async () => new FakeSession());
+		const first = await pool.acquire('lp0', open);
+
+		const waiting: FakeSession[] = [];
+		const next = pool.acquire('lp0', open).then((session) => {
+			waiting.push(session);
+		});
+		await new Promise((resolve) => setImmediate(resolve));
+		expect(waiting).toEqual([]);
+
+		pool.release('lp0', first);
+		await next;
+		expect(waiting).toEqual([first]);
+		expect(open).toHaveBeenCalledTimes(1);
+		await pool.closeAll();
+	});
+
+	it('opens a new session only once an interrupted one is closed', async () => {
+		const pool = new PrinterSessionPool<FakeSession>();
+		const open = jest.fn(async () => new FakeSession());
+		const interrupted = await pool.acquire('lp0', open);
+
+		const next = pool.acquire('lp0', open);
+		// The interrupted job unwinds and reports its session broken
+		pool.release('lp0', interrupted, { discard: true });
+
+		const reopened = await next;
+		expect(reopened).not.toBe(interrupted);
+		expect(interrupted.closed).toBe(1);
+		expect(open).toHaveBeenCalledTimes(2);
+		expect(pool.size).toBe(1);
+		await pool.closeAll();
+	});
+
+	it('discards the session when a job fails', async () => {
+		const pool = new PrinterSessionPool<FakeSession>();
+		const opened: FakeSession[] = [];
+
+		await expect(
+			pool.use(
+				'lp0',
+				async () => new FakeSession(),
+				async (session) => {
+					opened.push(session);
+					throw new Error('jammed');
+				},
+			),
+		).rejects.toThrow('jammed');
+
+		expect(pool.size).toBe(0);
+		expect(opened[0].closed).toBe(1);
+	});
+
+	it('closes sessions left idle', async () => {
+		jest.useFakeTimers();
+		try {
+			const pool = new PrinterSessionPool<FakeSession>({
+				idleTimeoutMs: 1000,
+			});
+			const session = await pool.acquire(
+				'lp0',
+				async () => new FakeSession(),
+			);
+			pool.release('lp0', session);
+
+			jest.advanceTimersByTime(1000);
+			for (let tick = 0; tick < 3; tick++) {
+				await Promise.resolve();
+			}
+
+			expect(pool.size).toBe(0);
+			expect(session.closed).toBe(1);
+		} finally {
+			jest.useRealTimers();
+		}
+	});
+});
+
+describePosix('pooled transport sessions', () => {
+	let dir: string;
+	let pool: PrinterSessionPool<PrinterTransport>;
+
+	beforeEach(() => {
+		dir = mkdtempSync(join(tmpdir(), 'escpos-session-'));
+		pool = new PrinterSessionPool<PrinterTransport>();
+	});
+
+	afterEach(async () => {
+		await pool.closeAll();
+		rmSync(dir, { recursive: true, force: true });
+	});
+
+	describe('file://', () => {
+		it('writes every job through one open session', async () => {
+			const path = join(dir, 'receipts.bin');
+			const uri = `file://${path}?create=1`;
+			const open = jest.fn(() => PrinterTransport.open(uri));
+
+			for (const job of ['first\n', 'second\n']) {
+				const written = await pool.use(uri, open, (transport) =>
+					transport.write(Buffer.from(job)),
+				);
+				expect(written).toBe(job.length);
+			}
+
+			expect(open).toHaveBeenCalledTimes(1);
+			expect(readFileSync(path, 'utf8')).toBe('first\nsecond\n');
+		});
+	});
+
+	describe('FIFO', () => {
+		let fifo: string;
+		let reader: number;
+
+		// The reader end is held open but never drained, so a job larger
+		// than the pipe buffer blocks like a printer out of paper
+		beforeEach(() => {
+			fifo = join(dir, 'printer.fifo');
+			execFileSync('mkfifo', [fifo]);
+			reader = openSync(fifo, constants.O_RDONLY | constants.O_NONBLOCK);
+		});
+
+		afterEach(() => {
+			closeSync(reader);
+		});
+
+		const stalledJob = () => Buffer.alloc(4 * 1024 * 1024, 0x1b);
+
+		// Everything waiting in the pipe
+		const drain = () => {
+			const chunks: Buffer[] = [];
+			const scratch = Buffer.alloc(64 * 1024);
+			let read = 0;
+			try {
+				do {
+					read = readSync(reader, scratch);
+					chunks.push(Buffer.from(scratch.subarray(0, read)));
+				} while (read > 0);
+			} catch {
+				// EAGAIN: the pipe is empty
+			}
+			return Buffer.concat(chunks);
+		};
+
+		it('times out a blocked write and discards the session', async () => {
+			const uri = `file://${fifo}`;
+			const opened: PrinterTransport[] = [];
+
+			await expect(
+				pool.use(
+					uri,
+					() => PrinterTransport.open(uri),
+					(transport) => {
+						opened.push(transport);
+						return transport.write(stalledJob(), { timeoutMs: 200 });
+					},
+				),
+			).rejects.toBeInstanceOf(PrintJobTimeoutError);
+
+			expect(pool.size).toBe(0);
+			const metrics = opened[0].getMetrics();
+			expect(metrics.timeouts).toBe(1);
+			expect(metrics.stalls).toBeGreaterThan(0);
+		});
+
+		it('cancels a blocked write when the signal aborts', async () => {
+			const uri = `file://${fifo}`;
+			const controller = new AbortController();
+			setTimeout(() => controller.abort(), 100);
+
+			const started = Date.now();
+			await expect(
+				pool.use(
+					uri,
+					() => PrinterTransport.open(uri),
+					(transport) =>
+						transport.write(stalledJob(), { signal: controller.signal }),
+				),
+			).rejects.toBeInstanceOf(PrintJobCancelledError);
+
+			expect(Date.now() - started).toBeLessThan(2000);
+			expect(pool.size).toBe(0);
+		});
+
+		it('reopens after a failed job', async () => {
+			const uri = `file://${fifo}`;
+			const open = jest.fn(() => PrinterTransport.open(uri));
+
+			await expect(
+				pool.use(uri, open, (transport) =>
+					transport.write(stalledJob(), { timeoutMs: 100 }),
+				),
+			).rejects.toBeInstanceOf(PrintJobTimeoutError);
+			drain();
+
+			const written = await pool.use(uri, open, (transport) =>
+				transport.write(Buffer.from([0x1b, 0x40])),
+			);
+
+			expect(written).toBe(2);
+			expect(open).toHaveBeenCalledTimes(2);
+		});
+
+		it('prints the job queued behind a cancelled one', async () => {
+			const printer: TerminalDevice = {
+				id: 'fifo-printer',
+				vid: '',
+				pid: '',
+				path: fifo,
+				name: 'FIFO',
+				serialNumber: '',
+				manufacturer: '',
+				meta: {
+					deviceType: 'printer',
+					brand: '',
+					model: '',
+					baudrate: 'not-supported',
+					setToDefault: false,
+					transport: `file://${fifo}`,
+				},
+				capabilities: ['write'],
+			};
+			const adapter = new TransportPrinterAdapter(printer);
+			const queue = new PrintQueue();
+			const controller = new AbortController();
+
+			const blocked = queue.enqueue(
+				printer.id,
+				({ signal, reset }) =>
+					adapter.write('', false, {
+						signal,
+						reset,
+						prepared: Buffer.alloc(4 * 1024 * 1024, '~'),
+					}),
+				{ signal: controller.signal },
+			);
+			const next = queue.enqueue(printer.id, ({ signal, reset }) =>
+				adapter.write('next\n', false, { signal, reset }),
+			);
+			setTimeout(() => controller.abort(), 100);
+			await expect(blocked).rejects.toBeInstanceOf(PrintJobCancelledError);
+
+			// The printer comes back and reads what the blocked job left behind
+			const received: Buffer[] = [];
+			const reading = setInterval(() => received.push(drain()), 10);
+			try {
+				await next;
+			} finally {
+				clearInterval(reading);
+				await adapter.close();
+			}
+			received.push(drain());
+
+			const output = Buffer.concat(received);
+			const nextJob = output.subarray(output.lastIndexOf('~') + 1);
+			// Re-initialised after the interrupted job
+			expect([...nextJob.subarray(0, 2)]).toEqual([0x1b, 0x40]);
+			expect(nextJob.includes('next\n')).toBe(true);
+		}, 10_000);
+	});
+});
@@ -0,0 +1,141 @@
+import { closeSync, constants, openSync } from 'node:fs';
+import { ReadStream } from 'node:tty';
+import type { SerialPort } from 'serialport';
+import { loadNativeAddon } from '../src/core/nativeAddon';
+import { tuneSerialLatency } from '../src/core/serialLatency';
+import { openPtyPair, type PtyPair } from './helpers/ptyPair';
+
+const addon = loadNativeAddon();
+const describePosix =
+	addon?.configureSerialLatency && process.platform !== 'win32'
+		? describe
+		: describe.skip;
+
+const openTty = (path: string) =>
+	openSync(path, constants.O_RDWR | constants.O_NOCTTY);
+
+const sleep = (ms: number) => new Promise((resolve) => setTimeout(resolve, ms));
+
+// Milliseconds from a frame's first bytes reaching the tty to the first
+// read returning anything. The frame's CR follows frameMs later, the way a
+// scanner sends a slow barcode. Closes fd.
+const firstReadDelay = async (pty: PtyPair, fd: number, frameMs: number) => {
+	const stream = new ReadStream(fd);
+	try {
+		const firstRead = new Promise<number>((resolve) =>
+			stream.once('data', () => resolve(performance.now())),
+		);
+		const started = performance.now();
+		await pty.type('0123456789');
+		const terminated = sleep(frameMs).then(() => pty.type('\r'));
+		const delay = (await firstRead) - started;
+		await terminated;
+		return delay;
+	} finally {
+		stream.destroy();
+	}
+};
+
+describePosix('configureSerialLatency on a pty', () => {
+	let pty: PtyPair | null;
+
+	beforeEach(async () => {
+		pty = await openPtyPair();
+	});
+
+	afterEach(() => {
+		pty?.close();
+	});
+
+	it('reports what a pty supports, step by step', () => {
+		if (!pty || !addon) {
+			return;
+		}
+		const fd = openTty(pty.path);
+		try {
+			const report = addon.configureSerialLatency(fd);
+
+			expect(report.raw).toEqual({ status: 'applied' });
+			// No serial_struct or usb-serial latency timer behind a pty
+			expect(report.lowLatency.status).toBe('unsupported');
+			expect(report.latencyTimer.status).toBe('unsupported');
+			expect(report.latencyTimerMs).toBe(-1);
+		} finally {
+			closeSync(fd);
+		}
+	});
+
+	it('skips the steps the options turn off', () => {
+		if (!pty || !addon) {
+			return;
+		}
+		const fd = openTty(pty.path);
+		try {
+			const report = addon.configureSerialLatency(fd, {
+				raw: false,
+				lowLatency: false,
+				latencyTimerMs: 0,
+			});
+
+			expect(report.raw.status).toBe('skipped');
+			expect(report.lowLatency.status).toBe('skipped');
+			expect(report.latencyTimer.status).toBe('skipped');
+		} finally {
+			closeSync(fd);
+		}
+	});
+
+	it('reports a descriptor that is not a tty', () => {
+		if (!addon) {
+			return;
+		}
+		const fd = openSync('/dev/null', 'r');
+		try {
+			const report = addon.configureSerialLatency(fd);
+
+			expect(report.raw.status).toBe('unsupported');
+			expect(report.raw.detail).toMatch(/^isatty/);
+			expect(report.lowLatency.status).toBe('skipped');
+		} finally {
+			closeSync(fd);
+		}
+	});
+
+	it('falls back or fails by mode when driver controls are missing', () => {
+		if (!pty) {
+			return;
+		}
+		const fd = openTty(pty.path);
+		try {
+			const port = { path: pty.path, port: { fd } } as unknown as SerialPort;
+
+			expect(tuneSerialLatency(port, 'prefer')?.raw.status).toBe('applied');
+			expect(() => tuneSerialLatency(port, 'require')).toThrow(
+				/could not be applied/,
+			);
+			expect(tuneSerialLatency(port, 'off')).toBeNull();
+		} finally {
+			closeSync(fd);
+		}
+	});
+
+	// The pty starts out the way serialport opens a port: raw, VMIN=1 and
+	// VTIME=0, so the first bytes of a frame are readable before its end
+	// either way and the raw step is a no-op. What low-latency mode is for,
+	// ASYNC_LOW_LATENCY and the usb-serial latency timer, needs a real
+	// driver and is not measured here.
+	it('does not change first reads on a port opened raw', async () => {
+		if (!pty || !addon) {
+			return;
+		}
+		const frameMs = 200;
+
+		const before = await firstReadDelay(pty, openTty(pty.path), frameMs);
+		const tuned = openTty(pty.path);
+		expect(addon.configureSerialLatency(tuned).raw.status).toBe('applied');
+		const after = await firstReadDelay(pty, tuned, frameMs);
+
+		expect(before).toBeLessThan(frameMs / 2);
+		expect(after).toBeLessThan(frameMs / 2);
+	});
+});
@@ -0,0 +1,102 @@
+import { loadNativeAddon } from '../src/core/nativeAddon';
+import { PrinterTransport, serialTransportUri } from '../src/core/transport';
+import {
+	PrintJobCancelledError,
+	PrintJobTimeoutError,
+} from '../src/core/windows_printer';
+import { openPtyPair, type PtyPair } from './helpers/ptyPair';
+
+const addon = loadNativeAddon();
+const describeNative = addon?.Transport ? describe : describe.skip;
+
+const waitForBytes = async (pty: PtyPair, expected: number) => {
+	const until = Date.now() + 2000;
+	let received = await pty.received();
+	while (received < expected && Date.now() < until) {
+		await new Promise((resolve) => setTimeout(resolve, 20));
+		received = await pty.received();
+	}
+	return received;
+};
+
+describeNative('serial transport over a pty pair', () => {
+	let pty: PtyPair | null;
+	let transport: PrinterTransport | undefined;
+
+	beforeEach(async () => {
+		pty = await openPtyPair();
+	});
+
+	afterEach(() => {
+		transport?.close();
+		transport = undefined;
+		pty?.close();
+	});
+
+	const open = async (query = '') => {
+		if (!pty) {
+			return undefined;
+		}
+		transport = await PrinterTransport.open(
+			`${serialTransportUri(pty.path, 115200)}${query}`,
+		);
+		return transport;
+	};
+
+	it('paces a job in window-sized writes', async () => {
+		const serial = await open('&window=64');
+		if (!pty || !serial) {
+			return;
+		}
+		await pty.read();
+
+		const written = await serial.write(Buffer.alloc(8192, 0x2a));
+
+		expect(written).toBe(8192);
+		// Linux ptys report an empty TIOCOUTQ, so every write is bounded by
+		// the window rather than by what the queue still holds
+		expect(serial.getMetrics().chunksWritten).toBeGreaterThanOrEqual(
+			8192 / 64,
+		);
+		expect(await waitForBytes(pty, 8192)).toBe(8192);
+	});
+
+	it('counts stalls and times out when the far end stops', async () => {
+		const serial = await open();
+		if (!pty || !serial) {
+			return;
+		}
+		await pty.hold();
+
+		const started = Date.now();
+		await expect(
+			serial.write(Buffer.alloc(256 * 1024), { timeoutMs: 300 }),
+		).rejects.toBeInstanceOf(PrintJobTimeoutError);
+		const elapsed = Date.now() - started;
+
+		const metrics = serial.getMetrics();
+		expect(metrics.stalls).toBeGreaterThan(0);
+		expect(metrics.timeouts).toBe(1);
+		expect(metrics.bytesWritten).toBeLessThan(256 * 1024);
+		expect(elapsed).toBeGreaterThanOrEqual(250);
+		expect(elapsed).toBeLessThan(2000);
+	});
+
+	it('cancels a stalled write and accepts the next job', async () => {
+		const serial = await open();
+		if (!pty || !serial) {
+			return;
+		}
+		await pty.hold();
+
+		const controller = new AbortController();
+		setTimeout(() => controller.abort(), 100);
+		await expect(
+			serial.write(Buffer.alloc(256 * 1024), { signal: controller.signal }),
+		).rejects.toBeInstanceOf(PrintJobCancelledError);
+		expect(serial.getMetrics().cancellations).toBe(1);
+
+		await pty.read();
+		await expect(serial.write(Buffer.from([0x1b, 0x40]))).resolves.toBe(2);
+	});
+});
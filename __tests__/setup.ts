@@ -0,0 +1,4 @@
+import { configureLogging } from '../src/core/logger';
+
+// Records stay in the ring buffer for getRecentLogs(); nothing is printed
+configureLogging({ sink: () => {} });
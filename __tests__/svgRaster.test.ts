@@ -0,0 +1,43 @@
+import { loadNativeAddon } from '../src/core/nativeAddon';
+
+const addon = loadNativeAddon();
+const describeNative = addon?.rasterizeSvg ? describe : describe.skip;
+
+const render = (svg: string, width = 576) => {
+	if (!addon) {
+		throw new Error('Native addon not loaded');
+	}
+	return addon.rasterizeSvg(Buffer.from(svg), width, 128, false);
+};
+
+describeNative('rasterizeSvg', () => {
+	it('renders width dots wide with the height of the viewBox', async () => {
+		const block = await render(
+			"<svg viewBox='0 0 10 5'><rect width='10' height='5'/></svg>",
+		);
+
+		// GS v 0, 72 bytes a row, 288 rows
+		expect([...block.subarray(0, 8)]).toEqual([
+			0x1d, 0x76, 0x30, 0x00, 72, 0, 0x20, 0x01,
+		]);
+		expect(block.length).toBe(8 + 72 * 288);
+	});
+
+	it('rejects a viewBox whose height overflows the canvas size', async () => {
+		// 576 * 4503599627370496 rows wraps a 64-bit dot count to zero
+		await expect(
+			render(
+				"<svg viewBox='0 0 1 4503599627370496'>" +
+					"<rect width='1' height='1'/></svg>",
+			),
+		).rejects.toMatchObject({ code: 'EINVAL' });
+	});
+
+	it('rejects a viewBox that scales to an infinite height', async () => {
+		await expect(
+			render(
+				"<svg viewBox='0 0 1e-300 1e300'><rect width='1' height='1'/></svg>",
+			),
+		).rejects.toThrow('out of range');
+	});
+});
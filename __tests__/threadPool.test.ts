@@ -0,0 +1,71 @@
+import { pbkdf2 } from 'node:crypto';
+import { performance } from 'node:perf_hooks';
+import {
+	configureThreadPool,
+	getThreadPoolStats,
+	loadNativeAddon,
+} from '../src/core/nativeAddon';
+
+const addon = loadNativeAddon();
+const describeNative = addon ? describe : describe.skip;
+
+// About 50-100 ms of CPU per call on a libuv pool thread
+const hashOnLibuvPool = () =>
+	new Promise<void>((resolve, reject) => {
+		pbkdf2('secret', 'salt', 200_000, 64, 'sha512', (error) =>
+			error ? reject(error) : resolve(),
+		);
+	});
+
+const rasterize = (width: number, height: number) => {
+	const rgba = Buffer.alloc(width * height * 4, 0x80);
+	const output = Buffer.alloc(8 + Math.ceil(width / 8) * height);
+	return addon?.rasterize(rgba, width, height, 128, true, output);
+};
+
+describeNative('native thread pool', () => {
+	afterEach(() => {
+		configureThreadPool(0);
+	});
+
+	it('is not queued behind a saturated libuv pool', async () => {
+		// Warm up so the pool exists and the first run is not timed
+		await rasterize(576, 64);
+
+		const started = performance.now();
+		let libuvMs = 0;
+		const backlog = Promise.all(
+			Array.from({ length: 16 }, hashOnLibuvPool),
+		).then(() => {
+			libuvMs = performance.now() - started;
+		});
+
+		await rasterize(576, 400);
+		const rasterMs = performance.now() - started;
+		await backlog;
+
+		// With a shared pool the raster would wait for the whole backlog
+		expect(rasterMs).toBeLessThan(libuvMs / 2);
+	});
+
+	it('resizes without waiting for running tasks', async () => {
+		const long = rasterize(2048, 2048);
+
+		const started = performance.now();
+		expect(configureThreadPool(2)).toBe(2);
+		const configureMs = performance.now() - started;
+
+		await long;
+		expect(configureMs).toBeLessThan(50);
+		expect(getThreadPoolStats().size).toBe(2);
+	});
+
+	it('runs every task submitted across a resize', async () => {
+		const jobs = Array.from({ length: 64 }, () => rasterize(384, 32));
+		configureThreadPool(3);
+		jobs.push(...Array.from({ length: 64 }, () => rasterize(384, 32)));
+
+		const lengths = await Promise.all(jobs);
+		expect(lengths.every((length) => length === 8 + 48 * 32)).toBe(true);
+	});
+});
@@ -0,0 +1,190 @@
+import {
+	UnixPrinterAdapter,
+	type UsbPrinterDevice,
+} from '../src/adaptor/unixPrinterAdapter';
+import { jobBufferPool } from '../src/core/bufferPool';
+import { PrintQueue } from '../src/core/printQueue';
+import type { TerminalDevice } from '../src/core/types';
+import {
+	PrintJobCancelledError,
+	PrintJobTimeoutError,
+} from '../src/core/windows_printer';
+
+// The real adapter claims a USB interface; every test injects a fake
+jest.mock('@node-escpos/usb-adapter', () => ({
+	__esModule: true,
+	default: jest.fn(),
+}));
+
+const ESC_INIT = Buffer.from([0x1b, 0x40]);
+
+class FakeUsbDevice implements UsbPrinterDevice {
+	/** When set, writes are accepted but never complete */
+	stalled = false;
+	closed = false;
+	private pending?: (error?: Error | null) => void;
+	private listeners: Record<string, ((error?: Error) => void)[]> = {};
+
+	constructor(private readonly log: Buffer[]) {}
+
+	write(data: Buffer, callback: (error?: Error | null) => void): void {
+		// Copied: the adapter hands the job back to the pool afterwards
+		this.log.push(Buffer.from(data));
+		if (this.stalled) {
+			this.pending = callback;
+		} else {
+			callback();
+		}
+	}
+
+	close(callback?: (error?: Error | null) => void): void {
+		this.closed = true;
+		this.pending?.(new Error('LIBUSB_ERROR_NO_DEVICE'));
+		this.pending = undefined;
+		for (const listener of this.listeners.close ?? []) {
+			listener();
+		}
+		callback?.();
+	}
+
+	on(event: 'error' | 'close', listener: (error?: Error) => void): void {
+		this.listeners[event] = [...(this.listeners[event] ?? []), listener];
+	}
+}
+
+let nextDevice = 0;
+
+const printerDevice = (): TerminalDevice => ({
+	id: `usb-printer-${nextDevice++}`,
+	vid: '0x0416',
+	pid: '0x5011',
+	path: '',
+	name: 'POS-80',
+	serialNumber: '',
+	manufacturer: '',
+	meta: {
+		deviceType: 'printer',
+		brand: '',
+		model: '',
+		baudrate: 'not-supported',
+		setToDefault: false,
+	},
+	capabilities: ['write'],
+});
+
+describe('UnixPrinterAdapter', () => {
+	let written: Buffer[];
+	let devices: FakeUsbDevice[];
+	let adapter: UnixPrinterAdapter;
+	let openDevice: jest.Mock<Promise<FakeUsbDevice>, [number]>;
+
+	beforeEach(() => {
+		written = [];
+		devices = [];
+		openDevice = jest.fn(async () => {
+			const device = new FakeUsbDevice(written);
+			devices.push(device);
+			return device;
+		});
+		adapter = new UnixPrinterAdapter(printerDevice(), { openDevice });
+	});
+
+	afterEach(async () => {
+		jest.restoreAllMocks();
+		await adapter.close();
+	});
+
+	it('keeps the interface claimed across jobs', async () => {
+		await adapter.write('first', false);
+		await adapter.write('second', false);
+
+		expect(openDevice).toHaveBeenCalledTimes(1);
+		expect(openDevice).toHaveBeenCalledWith(0x0416);
+		expect(written).toHaveLength(2);
+		expect(written[1].includes(Buffer.from('second'))).toBe(true);
+	});
+
+	it('closes the device to interrupt a stalled write', async () => {
+		await adapter.write('warm up', false);
+		devices[0].stalled = true;
+
+		const controller = new AbortController();
+		const job = adapter.write('stuck', false, { signal: controller.signal });
+		await new Promise((resolve) => setImmediate(resolve));
+		controller.abort();
+
+		await expect(job).rejects.toBeInstanceOf(PrintJobCancelledError);
+		expect(devices[0].closed).toBe(true);
+
+		// The broken session was discarded; the next job claims it afresh
+		await adapter.write('after', false, { reset: true });
+		expect(openDevice).toHaveBeenCalledTimes(2);
+	});
+
+	it('starts the job after an interrupted one with ESC @', async () => {
+		const queue = new PrintQueue({ lookahead: 0 });
+		const deviceId = adapter.terminalDevice.id;
+		const print = (data: string, timeoutMs?: number) =>
+			queue.enqueue(
+				deviceId,
+				({ signal, reset }) => adapter.write(data, false, { signal, reset }),
+				{ timeoutMs },
+			);
+
+		await print('first');
+		devices[0].stalled = true;
+		await expect(print('stuck', 50)).rejects.toBeInstanceOf(
+			PrintJobTimeoutError,
+		);
+		await print('recovered');
+
+		expect(written[0].subarray(0, 2).equals(ESC_INIT)).toBe(false);
+		const recovered = written[written.length - 1];
+		expect(recovered.subarray(0, 2).equals(ESC_INIT)).toBe(true);
+		expect(recovered.includes(Buffer.from('recovered'))).toBe(true);
+	});
+
+	it('returns prepared bytes to jobBufferPool after writing them', async () => {
+		const release = jest.spyOn(jobBufferPool, 'release');
+		const prepared = await adapter.prepare('ahead of time', false);
+		const expected = Buffer.from(prepared);
+
+		await adapter.write('ahead of time', false, { prepared });
+
+		expect(written[0].equals(expected)).toBe(true);
+		expect(release).toHaveBeenCalledWith(prepared);
+	});
+
+	it('returns prepared bytes when cancelled before writing', async () => {
+		const release = jest.spyOn(jobBufferPool, 'release');
+		const prepared = await adapter.prepare('never sent', false);
+		const controller = new AbortController();
+		controller.abort();
+
+		await expect(
+			adapter.write('never sent', false, {
+				prepared,
+				signal: controller.signal,
+			}),
+		).rejects.toBeInstanceOf(PrintJobCancelledError);
+
+		expect(release).toHaveBeenCalledWith(prepared);
+		expect(openDevice).not.toHaveBeenCalled();
+	});
+
+	it('returns prepared bytes when the device fails the write', async () => {
+		const release = jest.spyOn(jobBufferPool, 'release');
+		const prepared = await adapter.prepare('unlucky', false);
+		openDevice.mockImplementationOnce(async () => {
+			const device = new FakeUsbDevice(written);
+			device.write = (_data, callback) => callback(new Error('EPIPE'));
+			return device;
+		});
+
+		await expect(
+			adapter.write('unlucky', false, { prepared }),
+		).rejects.toThrow('EPIPE');
+
+		expect(release).toHaveBeenCalledWith(prepared);
+	});
+});
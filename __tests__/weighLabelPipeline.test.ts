@@ -0,0 +1,94 @@
+import { join } from 'node:path';
+import {
+	loadNativeAddon,
+	type WeighLabelEvent,
+	type WeighLabelTemplatePart,
+} from '../src/core/nativeAddon';
+
+const addon = loadNativeAddon();
+const describePosix =
+	addon?.WeighLabelPipeline && process.platform !== 'win32'
+		? describe
+		: describe.skip;
+
+// Continuous output of a CAS-style scale, CR LF terminated: an item of
+// 0.482 kg settling, the platter emptied, then 1.250 kg with an overload
+// line while it sits there. Replayed to its end without its timing.
+const SCALE_RECORDING = join(__dirname, 'fixtures', 'scale', 'continuous.txt');
+
+const TEMPLATE: WeighLabelTemplatePart[] = [
+	'SIZE 40 mm,30 mm\r\nCLS\r\nTEXT 10,10,"3",0,1,1,"',
+	{ field: 'weight', width: 6 },
+	' kg"\r\nTEXT 10,60,"4",0,1,1,"',
+	{ field: 'price', width: 7 },
+	'"\r\nPRINT 1\r\n',
+];
+
+const BITS_PER_SECOND = 9600;
+
+// Events of one pipeline run, resolved once the run has ended
+const runPipeline = (printer: string) => {
+	if (!addon) {
+		throw new Error('Native addon not loaded');
+	}
+	const pipeline = new addon.WeighLabelPipeline({
+		scalePath: SCALE_RECORDING,
+		printer,
+		template: TEMPLATE,
+		unitPrice: 12.5,
+		writeTimeoutMs: 2000,
+	});
+	const events: WeighLabelEvent[] = [];
+	const ended = new Promise<Error | null>((resolve) => {
+		pipeline.start((event) => {
+			events.push(event);
+		}, resolve);
+	});
+	return { pipeline, events, ended };
+};
+
+describePosix('WeighLabelPipeline', () => {
+	it('prints a label per settled item and times each one', async () => {
+		if (!addon) {
+			return;
+		}
+		const { pipeline, events, ended } = runPipeline(
+			`emu://?bps=${BITS_PER_SECOND}`,
+		);
+
+		expect(await ended).toBeNull();
+		const prints = events.filter((event) => event.type === 'print');
+		expect(prints.map((event) => [event.weight, event.price])).toEqual([
+			[0.482, 6.03],
+			[1.25, 15.63],
+		]);
+
+		const label = addon.renderWeighLabel(TEMPLATE, 0.482, 6.03);
+		// The emulator drains ten bits per byte at BITS_PER_SECOND
+		const drainMs = (label.length * 10_000) / BITS_PER_SECOND;
+		for (const event of prints) {
+			expect(event.error).toBeUndefined();
+			expect(event.bytes).toBe(label.length);
+			expect(event.weighToPrintMs).toBeGreaterThanOrEqual(drainMs - 5);
+			// The replay reads both items at once, so the second label also
+			// waits for the first
+			expect(event.weighToPrintMs).toBeLessThan(2 * drainMs + 500);
+		}
+
+		const stats = pipeline.getStats();
+		expect(stats).toMatchObject({ triggers: 2, printed: 2, failed: 0 });
+		expect(stats.lastMs).toBe(prints[1].weighToPrintMs);
+		expect(stats.maxMs).toBe(
+			Math.max(...prints.map((event) => event.weighToPrintMs ?? 0)),
+		);
+	});
+
+	it('ends the run when the printer cannot be opened', async () => {
+		// Opened on the pipeline's thread: start() itself does not fail
+		const { events, ended } = runPipeline('tcp://127.0.0.1:1');
+
+		const error = await ended;
+		expect(error).toMatchObject({ code: 'ECONNREFUSED' });
+		expect(events).toEqual([]);
+	});
+});
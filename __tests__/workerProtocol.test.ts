@@ -0,0 +1,99 @@
+import { MessageChannel, receiveMessageOnPort } from 'node:worker_threads';
+import { jobBufferPool } from '../src/core/bufferPool';
+import {
+	CallbackRegistry,
+	decodeWireValue,
+	encodeWireValue,
+	markTransferable,
+	TRANSFER_THRESHOLD,
+} from '../src/managers/workerProtocol';
+
+// Round trip through postMessage as the channel does it
+const send = (value: unknown) => {
+	const transfer: ArrayBuffer[] = [];
+	const encoded = encodeWireValue(value, transfer);
+	const { port1, port2 } = new MessageChannel();
+	port1.postMessage(encoded, transfer);
+	const received = receiveMessageOnPort(port2);
+	port1.close();
+	return decodeWireValue(received?.message);
+};
+
+describe('encodeWireValue', () => {
+	it('copies buffers by default, leaving the caller its bytes', () => {
+		const data = Buffer.from('receipt body');
+		expect(send(data)).toEqual(data);
+		expect(data.length).toBe(12);
+		expect(data.toString()).toBe('receipt body');
+	});
+
+	it('copies pooled blocks without detaching the pool memory', () => {
+		const block = jobBufferPool.acquire(4096);
+		block.fill(7);
+		const copy = send(block) as Buffer;
+		expect(copy[0]).toBe(7);
+		expect(block.buffer.byteLength).toBeGreaterThanOrEqual(4096);
+		jobBufferPool.release(block);
+	});
+
+	it('moves a buffer only when marked transferable', () => {
+		const owned = new Uint8Array(1024).fill(3);
+		const received = send(markTransferable(owned)) as Buffer;
+		expect(received.length).toBe(1024);
+		expect(received[1023]).toBe(3);
+		expect(owned.byteLength).toBe(0);
+	});
+
+	it('copies a marked slice instead of detaching its parent', () => {
+		const parent = new Uint8Array(64).fill(1);
+		const slice = markTransferable(parent.subarray(8, 16));
+		expect((send(slice) as Buffer).length).toBe(8);
+		expect(parent.byteLength).toBe(64);
+	});
+
+	it('sends long strings as bytes and decodes them back', () => {
+		const text = 'x'.repeat(TRANSFER_THRESHOLD + 1);
+		const transfer: ArrayBuffer[] = [];
+		const encoded = encodeWireValue(text, transfer);
+		expect(transfer).toHaveLength(1);
+		expect(decodeWireValue(encoded)).toBe(text);
+	});
+
+	it('refuses to return functions without a registry', () => {
+		expect(() => encodeWireValue(() => {}, [])).toThrow(/worker boundary/);
+	});
+});
+
+describe('CallbackRegistry', () => {
+	it('keeps one id per callback', () => {
+		const registry = new CallbackRegistry();
+		const callback = jest.fn();
+		const id = registry.register(callback, 1);
+		expect(registry.register(callback, 2)).toBe(id);
+		expect(registry.get(id)).toBe(callback);
+		expect(registry.size).toBe(1);
+	});
+
+	it('drops a callback the worker released', () => {
+		const registry = new CallbackRegistry();
+		const callback = jest.fn();
+		const id = registry.register(callback, 1);
+		registry.release(id, 1);
+		expect(registry.get(id)).toBeUndefined();
+		expect(registry.size).toBe(0);
+		// Registering again gets a fresh id
+		expect(registry.register(callback, 2)).not.toBe(id);
+	});
+
+	it('keeps a callback sent again after the worker released it', () => {
+		const registry = new CallbackRegistry();
+		const callback = jest.fn();
+		const id = registry.register(callback, 1);
+		registry.register(callback, 5);
+		// The worker had only seen call 1 when its forwarder was collected
+		registry.release(id, 1);
+		expect(registry.get(id)).toBe(callback);
+		registry.release(id, 5);
+		expect(registry.size).toBe(0);
+	});
+});
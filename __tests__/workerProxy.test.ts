@@ -0,0 +1,31 @@
+import { execFile } from 'node:child_process';
+import { join } from 'node:path';
+import { pathToFileURL } from 'node:url';
+import { promisify } from 'node:util';
+import { loadNativeAddon } from '../src/core/nativeAddon';
+
+const addon = loadNativeAddon();
+const describeNative = addon?.Transport ? describe : describe.skip;
+
+const CLIENT_SCRIPT = join(__dirname, 'helpers', 'workerAbortClient.ts');
+// Worker threads inherit the preload, so the device worker has the printer
+const PRELOAD = pathToFileURL(join(__dirname, 'helpers', 'virtualPrinter.ts'));
+
+describeNative('PrinterManagerProxy', () => {
+	it('cancels only the job whose signal was aborted', async () => {
+		const { stdout } = await promisify(execFile)(
+			process.execPath,
+			[require.resolve('tsx/cli'), '--import', PRELOAD.href, CLIENT_SCRIPT],
+			// Info lines would go to stdout along with the results
+			{ timeout: 30_000, env: { ...process.env, ESCPOS_LOG: 'warn' } },
+		);
+		const results = JSON.parse(stdout);
+
+		expect(results.first).toMatchObject({
+			ok: false,
+			name: 'PrintJobCancelledError',
+		});
+		// Queued behind the aborted job on the same printer
+		expect(results.second).toEqual({ ok: true });
+	}, 60_000);
+});
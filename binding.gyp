@@ -2,9 +2,32 @@
   "targets": [
     {
       "target_name": "escpos-lib",
+      "sources": [
+        "src/native/thread_pool.cpp",
+        "src/native/cancel_token.cpp",
+        "src/native/pool_task.cpp",
+        "src/native/transport.cpp",
+        "src/native/transport_binding.cpp",
+        "src/native/raster.cpp",
+        "src/native/raster_binding.cpp",
+        "src/native/jpeg.cpp",
+        "src/native/svg.cpp",
+        "src/native/datamatrix.cpp",
+        "src/native/mapped_file.cpp",
+        "src/native/serial_latency.cpp",
+        "src/native/evdev.cpp",
+        "src/native/evdev_binding.cpp",
+        "src/native/weigh_label.cpp",
+        "src/native/weigh_label_binding.cpp",
+        "src/native/handoff.cpp",
+        "src/native/handoff_binding.cpp"
+      ],
       "conditions": [
         ["OS=='win'", {
-          "sources": [ "src/native/printer.cpp" ],
+          "sources": [
+            "src/native/printer.cpp",
+            "src/native/transport_win.cpp"
+          ],
           "include_dirs": [
             "<!@(node -p \"require('node-addon-api').include\")"
           ],
@@ -22,10 +45,15 @@
           "libraries": [
             "advapi32.lib",
             "wbemuuid.lib",
-            "ole32.lib"
+            "ole32.lib",
+            "ws2_32.lib"
           ]
         }, {
-          "sources": [ "src/native/stub.cpp" ],
+          "sources": [
+            "src/native/stub.cpp",
+            "src/native/transport_posix.cpp",
+            "src/native/transport_serial.cpp"
+          ],
           "include_dirs": [
             "<!@(node -p \"require('node-addon-api').include\")"
           ],
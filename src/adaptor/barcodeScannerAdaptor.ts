@@ -1,15 +1,30 @@
 import assert from 'node:assert';
 import { SerialPort } from 'serialport';
+import { getLogger } from '../core/logger';
 import { type RetryOptions, withExponentialBackoff } from '../core/retryUtils';
+import {
+	ReadLatencyMeter,
+	type ReadLatencyStats,
+	tuneSerialLatency,
+} from '../core/serialLatency';
 import type { TerminalDevice } from '../core/types';
 import type { ReadableDevice } from './deviceAdaptor';
 
+const log = getLogger('scanner');
+
+// A scan without a CR/LF suffix ends when the line stays quiet this long
+const SCAN_IDLE_MS = 50;
+
 export class BarcodeScannerAdapter implements ReadableDevice {
 	private device: SerialPort;
 	private isOpen = false;
 	private dataCallbacks: Set<(data: Buffer | string) => void> = new Set();
 	private dataHandler?: (data: Buffer) => void;
 	private retryOptions: Partial<RetryOptions>;
+	private framed = false;
+	private pending = '';
+	private idleTimer?: NodeJS.Timeout;
+	private latency = new ReadLatencyMeter();
 
 	constructor(
 		public terminalDevice: TerminalDevice,
@@ -47,19 +62,18 @@ export class BarcodeScannerAdapter implements ReadableDevice {
 						return;
 					}
 
-					// Set up parser to handle scanned barcodes
-					this.dataHandler = (data: Buffer) => {
-						const barcode = data.toString().trim();
-						if (barcode && this.dataCallbacks.size > 0) {
-							for (const callback of this.dataCallbacks) {
-								try {
-									callback(barcode);
-								} catch (error) {
-									console.error('Error in barcode callback:', error);
-								}
-							}
-						}
-					};
+					const mode = this.terminalDevice.meta.lowLatency ?? 'off';
+					try {
+						this.latency.tuning = tuneSerialLatency(this.device, mode);
+					} catch (error) {
+						this.device.close(() => reject(error));
+						return;
+					}
+
+					// In low-latency mode a scan may arrive over several reads, so
+					// frame on CR/LF; otherwise every read is a whole scan
+					this.framed = mode !== 'off';
+					this.dataHandler = (data: Buffer) => this.receive(data);
 					this.device.on('data', this.dataHandler);
 
 					this.isOpen = true;
@@ -80,6 +94,8 @@ export class BarcodeScannerAdapter implements ReadableDevice {
 				this.device.removeAllListeners('data');
 				this.dataHandler = undefined;
 			}
+			clearTimeout(this.idleTimer);
+			this.pending = '';
 
 			this.device.close(() => {
 				this.isOpen = false;
@@ -106,4 +122,51 @@ export class BarcodeScannerAdapter implements ReadableDevice {
 	onError(callback: (error: Error | string) => void): void {
 		this.device.on('error', callback);
 	}
+
+	/**
+	 * Delay between a scan's first bytes arriving and its delivery, and the
+	 * low-latency setup in effect
+	 */
+	getReadLatency(): ReadLatencyStats {
+		return this.latency.stats();
+	}
+
+	private receive(data: Buffer): void {
+		this.latency.chunk();
+		if (!this.framed) {
+			this.emit(data.toString());
+			return;
+		}
+
+		clearTimeout(this.idleTimer);
+		this.pending += data.toString();
+
+		const lines = this.pending.split(/[\r\n]/);
+		this.pending = lines.pop() ?? '';
+		for (const line of lines) {
+			this.emit(line);
+		}
+		if (this.pending) {
+			this.idleTimer = setTimeout(() => {
+				const barcode = this.pending;
+				this.pending = '';
+				this.emit(barcode);
+			}, SCAN_IDLE_MS);
+		}
+	}
+
+	private emit(line: string): void {
+		const barcode = line.trim();
+		if (!barcode) {
+			return;
+		}
+		this.latency.frame();
+		for (const callback of this.dataCallbacks) {
+			try {
+				callback(barcode);
+			} catch (error) {
+				log.error('Barcode callback failed', { error });
+			}
+		}
+	}
 }
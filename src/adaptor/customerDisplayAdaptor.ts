@@ -0,0 +1,272 @@
+import assert from 'node:assert';
+import iconv from 'iconv-lite';
+import { SerialPort } from 'serialport';
+import {
+	DisplayFramebuffer,
+	type DisplayUpdate,
+} from '../core/displayFramebuffer';
+import { type RetryOptions, withExponentialBackoff } from '../core/retryUtils';
+import type { TerminalDevice } from '../core/types';
+
+// ESC @ initialise, US MD1 overwrite mode (no scrolling at line ends),
+// US C 0 cursor off, CLR; leaves the cursor home
+const DISPLAY_RESET = Buffer.from([
+	0x1b, 0x40, 0x1f, 0x01, 0x1f, 0x43, 0x00, 0x0c,
+]);
+
+export interface CustomerDisplayOptions {
+	/** Characters per line (default 20) */
+	columns?: number;
+	/** Lines (default 2) */
+	rows?: number;
+	/**
+	 * Writes per second the display keeps up with (default 20). Updates
+	 * arriving faster are merged, so only the latest content is sent.
+	 */
+	maxUpdatesPerSecond?: number;
+	/** Character table the display is set to, as an iconv name (default cp437) */
+	encoding?: string;
+}
+
+export interface CustomerDisplayStats {
+	/** show, setLine and clear calls */
+	updates: number;
+	/** Writes that reached the display after merging */
+	frames: number;
+	bytesSent: number;
+	/** What the same frames would have cost rewriting every line */
+	fullRewriteBytes: number;
+}
+
+interface Waiter {
+	resolve: () => void;
+	reject: (error: Error) => void;
+}
+
+/**
+ * Customer-facing pole display (VFD/LCD, ESC/POS display command set)
+ * on a serial port. Content is kept in a shadow framebuffer; each write
+ * carries only the changed character ranges, at most one write is in
+ * flight, and updates are paced to what the display can refresh.
+ */
+export class CustomerDisplayAdapter {
+	private device: SerialPort;
+	private isOpen = false;
+	private framebuffer: DisplayFramebuffer;
+	private encoding: string;
+	private minIntervalMs: number;
+	private retryOptions: Partial<RetryOptions>;
+	private errorCallbacks: Array<(error: Error | string) => void> = [];
+	private waiters: Waiter[] = [];
+	private timer: NodeJS.Timeout | undefined;
+	private writing = false;
+	private lastSendAt = 0;
+	// Display state unknown: reset and repaint everything on the next write
+	private repaint = true;
+	// Where the display's cursor is, null when not known
+	private cursor: { row: number; column: number } | null = null;
+	private stats: CustomerDisplayStats = {
+		updates: 0,
+		frames: 0,
+		bytesSent: 0,
+		fullRewriteBytes: 0,
+	};
+
+	constructor(
+		public terminalDevice: TerminalDevice,
+		retryOptions: Partial<RetryOptions> = {},
+		options: CustomerDisplayOptions = {},
+	) {
+		assert(
+			terminalDevice.meta.deviceType === 'display',
+			'Terminal device is not a customer display',
+		);
+		const baudRate = terminalDevice.meta.baudrate;
+		assert(
+			baudRate !== 'not-supported',
+			'Customer display does not support baudrate change',
+		);
+		this.encoding = options.encoding ?? 'cp437';
+		assert(
+			iconv.encodingExists(this.encoding),
+			`Unknown display encoding ${this.encoding}`,
+		);
+		this.framebuffer = new DisplayFramebuffer(
+			options.columns ?? 20,
+			options.rows ?? 2,
+		);
+		this.minIntervalMs = 1000 / Math.max(1, options.maxUpdatesPerSecond ?? 20);
+		this.device = new SerialPort({
+			path: terminalDevice.path,
+			baudRate,
+			autoOpen: false,
+		});
+		this.device.on('error', (error) => this.emitError(error));
+		this.retryOptions = retryOptions;
+	}
+
+	async open() {
+		if (this.isOpen) {
+			return;
+		}
+
+		await withExponentialBackoff(async () => {
+			return new Promise<void>((resolve, reject) => {
+				this.device.open((err) => (err ? reject(err) : resolve()));
+			});
+		}, this.retryOptions);
+		this.isOpen = true;
+		this.repaint = true;
+		this.schedule();
+	}
+
+	async close() {
+		if (!this.isOpen) {
+			return;
+		}
+
+		this.isOpen = false;
+		clearTimeout(this.timer);
+		this.timer = undefined;
+		this.settle(new Error('Customer display was closed'));
+		await new Promise<void>((resolve) => this.device.close(() => resolve()));
+	}
+
+	/**
+	 * Show lines, blanking the rest. Resolves once the display shows them
+	 * or content set after them.
+	 */
+	show(lines: ReadonlyArray<string>): Promise<void> {
+		this.framebuffer.setLines(lines);
+		return this.update();
+	}
+
+	setLine(row: number, text: string): Promise<void> {
+		this.framebuffer.setLine(row, text);
+		return this.update();
+	}
+
+	clear(): Promise<void> {
+		return this.show([]);
+	}
+
+	getLines(): string[] {
+		return this.framebuffer.getLines();
+	}
+
+	getStats(): CustomerDisplayStats {
+		return { ...this.stats };
+	}
+
+	onError(callback: (error: Error | string) => void): void {
+		this.errorCallbacks.push(callback);
+	}
+
+	private update(): Promise<void> {
+		this.stats.updates++;
+		const shown = new Promise<void>((resolve, reject) => {
+			this.waiters.push({ resolve, reject });
+		});
+		this.schedule();
+		return shown;
+	}
+
+	private schedule(): void {
+		if (!this.isOpen || this.writing || this.timer) {
+			return;
+		}
+		if (!this.repaint && !this.framebuffer.isDirty()) {
+			this.settle();
+			return;
+		}
+		// Also defers same-turn updates, which then go out as one write
+		const wait = Math.max(0, this.lastSendAt + this.minIntervalMs - Date.now());
+		this.timer = setTimeout(() => {
+			this.timer = undefined;
+			void this.send();
+		}, wait);
+	}
+
+	private async send(): Promise<void> {
+		const prefix = this.repaint ? DISPLAY_RESET : Buffer.alloc(0);
+		if (this.repaint) {
+			this.framebuffer.reset();
+			this.cursor = { row: 0, column: 0 };
+		}
+		const updates = this.framebuffer.diff();
+		const frame = Buffer.concat([prefix, this.encode(updates)]);
+
+		this.writing = true;
+		this.lastSendAt = Date.now();
+		try {
+			await this.write(frame);
+		} catch (error) {
+			this.writing = false;
+			this.repaint = true;
+			this.cursor = null;
+			const failure = error instanceof Error ? error : new Error(String(error));
+			this.settle(failure);
+			this.emitError(failure);
+			return;
+		}
+		this.writing = false;
+		this.repaint = false;
+		this.framebuffer.apply(updates);
+
+		const { columns, rows } = this.framebuffer;
+		this.stats.frames++;
+		this.stats.bytesSent += frame.length;
+		this.stats.fullRewriteBytes += prefix.length + rows * (4 + columns);
+		this.schedule();
+	}
+
+	// Cursor moves are skipped where the previous range left the cursor
+	private encode(updates: ReadonlyArray<DisplayUpdate>): Buffer {
+		const parts: Buffer[] = [];
+		for (const { row, column, text } of updates) {
+			if (this.cursor?.row !== row || this.cursor.column !== column) {
+				// US $ x y, 1-based
+				parts.push(Buffer.from([0x1f, 0x24, column + 1, row + 1]));
+			}
+			parts.push(iconv.encode(text, this.encoding));
+			const end = column + text.length;
+			// What a write into the last column does to the cursor varies
+			this.cursor =
+				end < this.framebuffer.columns ? { row, column: end } : null;
+		}
+		return Buffer.concat(parts);
+	}
+
+	private write(data: Buffer): Promise<void> {
+		return new Promise((resolve, reject) => {
+			this.device.write(data, (err) => {
+				if (err) {
+					reject(err);
+					return;
+				}
+				// Done once the bytes have left the port, so frames never queue up
+				this.device.drain((drainErr) =>
+					drainErr ? reject(drainErr) : resolve(),
+				);
+			});
+		});
+	}
+
+	private settle(error?: Error): void {
+		const waiters = this.waiters;
+		this.waiters = [];
+		for (const waiter of waiters) {
+			if (error) {
+				waiter.reject(error);
+			} else {
+				waiter.resolve();
+			}
+		}
+	}
+
+	private emitError(error: Error | string): void {
+		for (const callback of this.errorCallbacks) {
+			callback(error);
+		}
+	}
+}
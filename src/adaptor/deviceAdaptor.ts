@@ -1,3 +1,5 @@
+import type { PrintData, PrintJobOptions } from '../core/types';
+
 export interface DeviceAdapter {
 	open(): Promise<void>;
 
@@ -6,8 +8,27 @@ export interface DeviceAdapter {
 	onError(callback: (error: Error | string) => void): void;
 }
 
+export interface WriteOptions extends PrintJobOptions {
+	/** Send ESC @ first; the previous job was interrupted mid-write */
+	reset?: boolean;
+	/**
+	 * Bytes prepare() rendered for this data, sent instead of encoding it
+	 * again; write() returns them to jobBufferPool
+	 */
+	prepared?: Buffer;
+}
+
 export interface WritableDevice extends DeviceAdapter {
-	write(data: string, isImage: boolean): Promise<void>;
+	write(
+		data: PrintData,
+		isImage: boolean,
+		options?: WriteOptions,
+	): Promise<void>;
+	/**
+	 * Encode a job ahead of time (without a leading reset) so the print
+	 * queue can render it while an earlier job prints
+	 */
+	prepare?(data: PrintData, isImage: boolean): Promise<Buffer>;
 }
 
 export interface ReadableDevice extends DeviceAdapter {
@@ -0,0 +1,142 @@
+import assert from 'node:assert';
+import { getLogger } from '../core/logger';
+import {
+	type EvdevKeymap,
+	type EvdevReader,
+	loadNativeAddon,
+} from '../core/nativeAddon';
+import { type RetryOptions, withExponentialBackoff } from '../core/retryUtils';
+import type { TerminalDevice } from '../core/types';
+import type { ReadableDevice } from './deviceAdaptor';
+
+const log = getLogger('scanner');
+
+/**
+ * Keyboard-wedge (HID) scanners are addressed by their evdev node
+ */
+export const isHidScannerPath = (path: string): boolean =>
+	path.startsWith('/dev/input/');
+
+/**
+ * Scans contained in a recording of a scanner's event node, decoded
+ * exactly as the live reader would, e.g. from
+ * `cat /dev/input/event5 > scans.bin` on the same architecture
+ */
+export function decodeEvdevRecording(
+	events: Buffer,
+	keymap?: EvdevKeymap,
+): string[] {
+	const addon = loadNativeAddon();
+	if (!addon) {
+		throw new Error('Decoding evdev events needs the native addon');
+	}
+	return addon.decodeEvdevEvents(events, keymap);
+}
+
+export interface HidScannerOptions {
+	/** Take the scanner away from the focused window (default true) */
+	grab?: boolean;
+	/** Key codes to characters for scanners not set to a US layout */
+	keymap?: EvdevKeymap;
+}
+
+/**
+ * Reads a keyboard-wedge scanner through Linux evdev instead of as
+ * keystrokes. The native reader grabs the input node, decodes key events
+ * on its own thread and delivers whole scans, independent of UI focus and
+ * keyboard repeat settings.
+ */
+export class HidScannerAdapter implements ReadableDevice {
+	private reader: EvdevReader | undefined;
+	private dataCallbacks: Set<(data: Buffer | string) => void> = new Set();
+	private errorCallbacks: Array<(error: Error | string) => void> = [];
+	private retryOptions: Partial<RetryOptions>;
+
+	constructor(
+		public terminalDevice: TerminalDevice,
+		retryOptions: Partial<RetryOptions> = {},
+		private readonly options: HidScannerOptions = {},
+	) {
+		assert(
+			terminalDevice.meta.deviceType === 'scanner',
+			'Terminal device is not a barcode scanner',
+		);
+		assert(
+			isHidScannerPath(terminalDevice.path),
+			'Terminal device is not an input device',
+		);
+		this.retryOptions = retryOptions;
+	}
+
+	async open() {
+		if (this.reader) {
+			return;
+		}
+
+		const addon = loadNativeAddon();
+		if (!addon) {
+			throw new Error('HID scanners need the native addon');
+		}
+
+		await withExponentialBackoff(async () => {
+			const reader = new addon.EvdevReader(this.terminalDevice.path, {
+				grab: this.options.grab ?? true,
+				keymap: this.options.keymap,
+			});
+			reader.start(
+				(scan) => this.emit(scan),
+				(error) => {
+					if (this.reader === reader) {
+						this.reader = undefined;
+					}
+					if (error) {
+						for (const callback of this.errorCallbacks) {
+							callback(error);
+						}
+					}
+				},
+			);
+			this.reader = reader;
+		}, this.retryOptions);
+	}
+
+	async close() {
+		const reader = this.reader;
+		this.reader = undefined;
+		// Joins the reader thread, which wakes immediately
+		reader?.stop();
+	}
+
+	read(callback: (data: Buffer | string) => void) {
+		if (typeof callback !== 'function') {
+			throw new Error('Read callback must be a function');
+		}
+		this.dataCallbacks.add(callback);
+	}
+
+	removeReadCallback(callback: (data: Buffer | string) => void) {
+		this.dataCallbacks.delete(callback);
+	}
+
+	clearReadCallbacks() {
+		this.dataCallbacks.clear();
+	}
+
+	onError(callback: (error: Error | string) => void): void {
+		this.errorCallbacks.push(callback);
+	}
+
+	private emit(scan: string): void {
+		const barcode = scan.trim();
+		if (!barcode) {
+			return;
+		}
+		for (const callback of this.dataCallbacks) {
+			try {
+				callback(barcode);
+			} catch (error) {
+				log.error('Barcode callback failed', { error });
+			}
+		}
+	}
+}
@@ -1,12 +1,29 @@
+import { serialTransportUri } from '../core/transport';
 import type { TerminalDevice } from '../core/types';
 import type { WritableDevice } from './deviceAdaptor';
+import { TransportPrinterAdapter } from './transportPrinterAdapter';
 import { UnixPrinterAdapter } from './unixPrinterAdapter';
 import { WindowsPrinterAdapter } from './windowsPrinterAdapter';
 
 export function createPrinterAdapter(device: TerminalDevice): WritableDevice {
+	if (device.meta.transport) {
+		return new TransportPrinterAdapter(device);
+	}
+	// Serial ports configured as printers keep their numeric baud rate;
+	// only the POSIX transport layer can drive a serial line so far
+	if (
+		process.platform !== 'win32' &&
+		typeof device.meta.baudrate === 'number' &&
+		device.path
+	) {
+		return new TransportPrinterAdapter(
+			device,
+			serialTransportUri(device.path, device.meta.baudrate),
+		);
+	}
 	return process.platform === 'win32'
 		? new WindowsPrinterAdapter(device)
 		: new UnixPrinterAdapter(device);
 }
 
-export { WindowsPrinterAdapter, UnixPrinterAdapter };
+export { TransportPrinterAdapter, WindowsPrinterAdapter, UnixPrinterAdapter };
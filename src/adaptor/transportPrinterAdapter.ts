@@ -0,0 +1,106 @@
+import assert from 'node:assert';
+import { jobBufferPool } from '../core/bufferPool';
+import { resolvePrinterProfile } from '../core/printerProfile';
+import { PrinterSessionPool } from '../core/printerSessionPool';
+import { encodeReceipt } from '../core/receiptEncoder';
+import { getTransportScheme, PrinterTransport } from '../core/transport';
+import type { PrintData, TerminalDevice } from '../core/types';
+import {
+	PrintJobCancelledError,
+	PrintJobTimeoutError,
+} from '../core/windows_printer';
+import type { WritableDevice, WriteOptions } from './deviceAdaptor';
+
+// Connections stay open between receipts; keyed by transport URI
+const sessions = new PrinterSessionPool<PrinterTransport>();
+
+/**
+ * Drives any printer reachable through a native transport URI
+ * (meta.transport, or a serial URI derived from the port), independent
+ * of the host platform.
+ */
+export class TransportPrinterAdapter implements WritableDevice {
+	private readonly uri: string;
+
+	constructor(
+		public terminalDevice: TerminalDevice,
+		uri = terminalDevice.meta.transport,
+	) {
+		assert(
+			terminalDevice.meta.deviceType === 'printer',
+			'Terminal device is not a thermal printer',
+		);
+		assert(
+			uri && getTransportScheme(uri),
+			'Terminal device has no valid transport URI',
+		);
+		this.uri = uri;
+	}
+
+	async open(): Promise<void> {
+		// Stub implementation - the session is opened lazily by write()
+	}
+
+	async close(): Promise<void> {
+		await sessions.closeSession(this.uri);
+	}
+
+	async prepare(data: PrintData, isImage: boolean): Promise<Buffer> {
+		return encodeReceipt(data, isImage, {
+			profile: resolvePrinterProfile(this.terminalDevice.meta),
+		});
+	}
+
+	async write(
+		data: PrintData,
+		isImage: boolean,
+		options: WriteOptions = {},
+	): Promise<void> {
+		try {
+			const job =
+				options.prepared ??
+				(await encodeReceipt(data, isImage, {
+					reset: options.reset,
+					profile: resolvePrinterProfile(this.terminalDevice.meta),
+				}));
+			try {
+				await sessions.use(
+					this.uri,
+					() => PrinterTransport.open(this.uri),
+					(transport) =>
+						transport.write(job, {
+							timeoutMs: options.timeoutMs,
+							signal: options.signal,
+						}),
+				);
+			} finally {
+				// The native write has settled and no longer reads the job
+				jobBufferPool.release(job);
+			}
+		} catch (e) {
+			// Cancellation and timeouts keep their own error types
+			if (
+				e instanceof PrintJobCancelledError ||
+				e instanceof PrintJobTimeoutError
+			) {
+				throw e;
+			}
+			throw new Error(`Printer error: ${(e as Error).message}`);
+		}
+	}
+
+	/**
+	 * Bytes an `emu://` printer has received since the last call
+	 */
+	async takeOutput(): Promise<Buffer> {
+		return sessions.use(
+			this.uri,
+			() => PrinterTransport.open(this.uri),
+			async (transport) => transport.takeOutput(),
+		);
+	}
+
+	onError(_callback: (error: Error | string) => void): void {
+		// Transport errors surface from the write itself; there is no event stream
+	}
+}
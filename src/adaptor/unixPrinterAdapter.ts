@@ -1,67 +1,201 @@
 import assert from 'node:assert';
-import { Image, Printer } from '@node-escpos/core';
-import type USBAdapter from '@node-escpos/usb-adapter';
 import USB from '@node-escpos/usb-adapter';
-import type { TerminalDevice } from '../core/types';
-import type { WritableDevice } from './deviceAdaptor';
+import { jobBufferPool } from '../core/bufferPool';
+import { resolvePrinterProfile } from '../core/printerProfile';
+import {
+	type PrinterSession,
+	PrinterSessionPool,
+} from '../core/printerSessionPool';
+import { encodeReceipt } from '../core/receiptEncoder';
+import type { PrintData, TerminalDevice } from '../core/types';
+import { PrintJobCancelledError } from '../core/windows_printer';
+import type { WritableDevice, WriteOptions } from './deviceAdaptor';
+
+/**
+ * The part of a USB adapter the printer session drives. Tests can inject
+ * an in-memory implementation through UnixPrinterAdapterOptions.
+ */
+export interface UsbPrinterDevice {
+	write(data: Buffer, callback: (error?: Error | null) => void): unknown;
+	close(callback?: (error?: Error | null) => void): unknown;
+	on(event: 'error' | 'close', listener: (error?: Error) => void): unknown;
+}
+
+export interface UnixPrinterAdapterOptions {
+	/** Opens the device for a session; defaults to @node-escpos/usb-adapter */
+	openDevice?: (vid: number) => Promise<UsbPrinterDevice>;
+}
+
+async function openUsbDevice(vid: number): Promise<UsbPrinterDevice> {
+	const device = new USB(vid);
+	await new Promise<void>((resolve, reject) => {
+		device.open((err: Error | null) => {
+			if (err) {
+				reject(err);
+			} else {
+				resolve();
+			}
+		});
+	});
+	return device;
+}
+
+/**
+ * An opened USB interface. Jobs are written to it as raw ESC/POS bytes;
+ * only the pool closes it.
+ */
+class UsbPrinterSession implements PrinterSession {
+	private broken = false;
+
+	constructor(readonly device: UsbPrinterDevice) {
+		device.on('error', () => {
+			this.broken = true;
+		});
+		device.on('close', () => {
+			this.broken = true;
+		});
+	}
+
+	write(data: Buffer): Promise<void> {
+		return new Promise<void>((resolve, reject) => {
+			this.device.write(data, (error) => {
+				if (error) {
+					this.broken = true;
+					reject(error);
+				} else {
+					resolve();
+				}
+			});
+		});
+	}
+
+	isHealthy(): boolean {
+		return !this.broken;
+	}
+
+	markBroken(): void {
+		this.broken = true;
+	}
+
+	close(): Promise<void> {
+		return new Promise<void>((resolve) => {
+			this.device.close(() => resolve());
+		});
+	}
+}
+
+// USB interfaces stay claimed between receipts; keyed by device id
+const sessions = new PrinterSessionPool<UsbPrinterSession>();
 
 export class UnixPrinterAdapter implements WritableDevice {
-	private readonly device: USBAdapter;
-	private printer: Printer<[]>;
+	private readonly vid: number;
+	private readonly openDevice: (vid: number) => Promise<UsbPrinterDevice>;
+	private errorCallbacks: Array<(error: Error | string) => void> = [];
 
-	constructor(public terminalDevice: TerminalDevice) {
+	constructor(
+		public terminalDevice: TerminalDevice,
+		options: UnixPrinterAdapterOptions = {},
+	) {
 		assert(
 			terminalDevice.meta.deviceType === 'printer',
 			'Terminal device is not a thermal printer',
 		);
 		assert(
-			process.platform !== 'win32',
+			process.platform !== 'win32' || options.openDevice,
 			'UnixPrinterAdapter cannot be used on Windows',
 		);
 
-		this.device = new USB(
-			Number.parseInt(terminalDevice.vid.replace('0x', '')),
-		);
-		this.printer = new Printer(this.device, { encoding: 'GB18030' });
+		this.vid = Number.parseInt(terminalDevice.vid.replace('0x', ''));
+		this.openDevice = options.openDevice ?? openUsbDevice;
 	}
 
 	async open(): Promise<void> {
-		// Stub implementation - actual connection happens in write()
+		// Stub implementation - the session is opened lazily by write()
 	}
 
 	async close(): Promise<void> {
-		// Stub implementation - connection is closed after each write()
+		await sessions.closeSession(this.terminalDevice.id);
 	}
 
-	async write(data: string, isImage: boolean): Promise<void> {
-		// Open connection
-		await new Promise<void>((resolve, reject) => {
-			this.device.open((err: Error | null) => {
-				if (err) {
-					reject(err);
-				} else {
-					resolve();
-				}
-			});
+	async prepare(data: PrintData, isImage: boolean): Promise<Buffer> {
+		return encodeReceipt(data, isImage, {
+			profile: resolvePrinterProfile(this.terminalDevice.meta),
 		});
+	}
 
-		try {
-			if (!isImage) {
-				this.printer.text(data);
-				this.printer.text('\n');
-				this.printer.cut(true);
-			} else {
-				const image = await Image.load(data);
-				this.printer.align('ct').raster(image, 'normal');
-				this.printer.println('\n').cut(true);
+	async write(
+		data: PrintData,
+		isImage: boolean,
+		options: WriteOptions = {},
+	): Promise<void> {
+		const { signal } = options;
+		if (signal?.aborted) {
+			if (options.prepared) {
+				jobBufferPool.release(options.prepared);
 			}
+			throw new PrintJobCancelledError();
+		}
+
+		// Same encoder (and native raster path) as the other adapters
+		const job =
+			options.prepared ??
+			(await encodeReceipt(data, isImage, {
+				reset: options.reset,
+				profile: resolvePrinterProfile(this.terminalDevice.meta),
+			}));
+
+		try {
+			await sessions.use(
+				this.terminalDevice.id,
+				() => this.openSession(),
+				(session) => this.writeJob(session, job, signal),
+			);
 		} finally {
-			// Always close connection after write
-			await this.printer.close();
+			// The USB transfer has completed or failed by now
+			jobBufferPool.release(job);
 		}
 	}
 
 	onError(callback: (error: Error | string) => void): void {
-		this.device.on('error', callback);
+		this.errorCallbacks.push(callback);
+	}
+
+	private async writeJob(
+		session: UsbPrinterSession,
+		job: Buffer,
+		signal?: AbortSignal,
+	): Promise<void> {
+		// Closing the device fails the pending USB transfer, which is the
+		// only way to interrupt a write to a stalled printer from here.
+		// The broken session is then discarded.
+		const onAbort = () => {
+			session.markBroken();
+			session.device.close();
+		};
+		signal?.addEventListener('abort', onAbort, { once: true });
+
+		try {
+			await session.write(job);
+		} catch (error) {
+			if (!signal?.aborted) {
+				throw error;
+			}
+		} finally {
+			signal?.removeEventListener('abort', onAbort);
+		}
+
+		if (signal?.aborted) {
+			throw new PrintJobCancelledError();
+		}
+	}
+
+	private async openSession(): Promise<UsbPrinterSession> {
+		const session = new UsbPrinterSession(await this.openDevice(this.vid));
+		session.device.on('error', (error?: Error) => {
+			for (const callback of this.errorCallbacks) {
+				callback(error ?? 'Printer device error');
+			}
+		});
+		return session;
 	}
 }
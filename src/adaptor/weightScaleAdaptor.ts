@@ -1,9 +1,17 @@
 import assert from 'node:assert';
 import { ReadlineParser, SerialPort } from 'serialport';
+import { getLogger } from '../core/logger';
 import { type RetryOptions, withExponentialBackoff } from '../core/retryUtils';
+import {
+	ReadLatencyMeter,
+	type ReadLatencyStats,
+	tuneSerialLatency,
+} from '../core/serialLatency';
 import type { TerminalDevice } from '../core/types';
 import type { ReadableDevice } from './deviceAdaptor';
 
+const log = getLogger('scale');
+
 export class WeightScaleAdapter implements ReadableDevice {
 	private device: SerialPort;
 	private parser: ReadlineParser;
@@ -11,6 +19,8 @@ export class WeightScaleAdapter implements ReadableDevice {
 	private dataCallbacks: Set<(data: Buffer | string) => void> = new Set();
 	private dataHandler?: (data: string) => void;
 	private retryOptions: Partial<RetryOptions>;
+	private latency = new ReadLatencyMeter();
+	private chunkHandler = () => this.latency.chunk();
 
 	constructor(
 		public terminalDevice: TerminalDevice,
@@ -49,15 +59,31 @@ export class WeightScaleAdapter implements ReadableDevice {
 						return;
 					}
 
+					try {
+						this.latency.tuning = tuneSerialLatency(
+							this.device,
+							this.terminalDevice.meta.lowLatency ?? 'off',
+						);
+					} catch (error) {
+						this.device.close(() => reject(error));
+						return;
+					}
+
+					// Ahead of the parser, so a line's first read is seen first
+					this.device.prependListener('data', this.chunkHandler);
+
 					// Set up parser to handle weight data
 					this.dataHandler = (data: string) => {
 						const weight = data.trim();
+						if (weight) {
+							this.latency.frame();
+						}
 						if (weight && this.dataCallbacks.size > 0) {
 							for (const callback of this.dataCallbacks) {
 								try {
 									callback(weight);
 								} catch (error) {
-									console.error('Error in weight callback:', error);
+									log.error('Weight callback failed', { error });
 								}
 							}
 						}
@@ -82,6 +108,7 @@ export class WeightScaleAdapter implements ReadableDevice {
 				this.parser.removeAllListeners('data');
 				this.dataHandler = undefined;
 			}
+			this.device.off('data', this.chunkHandler);
 
 			this.device.close(() => {
 				this.isOpen = false;
@@ -112,4 +139,12 @@ export class WeightScaleAdapter implements ReadableDevice {
 	onError(callback: (error: Error | string) => void): void {
 		this.device.on('error', callback);
 	}
+
+	/**
+	 * Delay between a weight line's first bytes arriving and its delivery,
+	 * and the low-latency setup in effect
+	 */
+	getReadLatency(): ReadLatencyStats {
+		return this.latency.stats();
+	}
 }
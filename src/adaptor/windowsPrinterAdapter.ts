@@ -1,7 +1,18 @@
 import assert from 'node:assert';
-import type { TerminalDevice } from '../core/types';
-import { EscPosCommands, ThermalWindowPrinter } from '../core/windows_printer';
-import type { WritableDevice } from './deviceAdaptor';
+import { jobBufferPool } from '../core/bufferPool';
+import { resolvePrinterProfile } from '../core/printerProfile';
+import { PrinterSessionPool } from '../core/printerSessionPool';
+import { encodeReceipt } from '../core/receiptEncoder';
+import type { PrintData, TerminalDevice } from '../core/types';
+import {
+	PrintJobCancelledError,
+	PrintJobTimeoutError,
+	ThermalWindowPrinter,
+} from '../core/windows_printer';
+import type { WritableDevice, WriteOptions } from './deviceAdaptor';
+
+// Spooler handles stay open between receipts; keyed by printer name
+const sessions = new PrinterSessionPool<ThermalWindowPrinter>();
 
 export class WindowsPrinterAdapter implements WritableDevice {
 	constructor(public terminalDevice: TerminalDevice) {
@@ -16,43 +27,71 @@ export class WindowsPrinterAdapter implements WritableDevice {
 	}
 
 	async open(): Promise<void> {
-		// Stub implementation - actual connection happens in write()
+		// Stub implementation - the session is opened lazily by write()
 	}
 
 	async close(): Promise<void> {
-		// Stub implementation - connection is closed after each write()
+		await sessions.closeSession(this.terminalDevice.name);
 	}
 
-	async write(data: string, isImage: boolean): Promise<void> {
-		try {
-			const printer = new ThermalWindowPrinter(this.terminalDevice.name);
-
-			if (!isImage) {
-				printer.printText(data);
-				printer.print(EscPosCommands.ALIGN_CENTER);
-				printer.printText('\n');
-				printer.print(EscPosCommands.ALIGN_CENTER);
-				printer.print(EscPosCommands.CUT);
-			} else {
-				printer.print(EscPosCommands.ALIGN_CENTER);
-				await printer.printImageFromBase64(data, {
-					width: 576,
-					dither: true,
-					threshold: 180,
-				});
-				printer.print(EscPosCommands.ALIGN_CENTER);
-				printer.printText('\n');
-				printer.print(EscPosCommands.ALIGN_CENTER);
-				printer.print(EscPosCommands.CUT);
-			}
+	async prepare(data: PrintData, isImage: boolean): Promise<Buffer> {
+		return encodeReceipt(data, isImage, {
+			profile: resolvePrinterProfile(this.terminalDevice.meta),
+		});
+	}
+
+	async write(
+		data: PrintData,
+		isImage: boolean,
+		options: WriteOptions = {},
+	): Promise<void> {
+		const name = this.terminalDevice.name;
 
-			printer.close();
+		try {
+			// A failed or interrupted job discards the session
+			await sessions.use(
+				name,
+				async () => new ThermalWindowPrinter(name),
+				(printer) => this.writeJob(printer, data, isImage, options),
+			);
 		} catch (e) {
+			// Cancellation and timeouts keep their own error types
+			if (
+				e instanceof PrintJobCancelledError ||
+				e instanceof PrintJobTimeoutError
+			) {
+				throw e;
+			}
 			throw new Error(`Printer error: ${(e as Error).message}`);
 		}
 	}
 
+	private async writeJob(
+		printer: ThermalWindowPrinter,
+		data: PrintData,
+		isImage: boolean,
+		options: WriteOptions,
+	): Promise<void> {
+		// The whole job reaches the spooler as one document that can be
+		// cancelled or timed out as a unit
+		const job =
+			options.prepared ??
+			(await encodeReceipt(data, isImage, {
+				reset: options.reset,
+				profile: resolvePrinterProfile(this.terminalDevice.meta),
+			}));
+		try {
+			await printer.printAsync(job, {
+				timeoutMs: options.timeoutMs,
+				signal: options.signal,
+			});
+		} finally {
+			// printAsync settles only after the native write lets go of the job
+			jobBufferPool.release(job);
+		}
+	}
+
 	onError(_callback: (error: Error | string) => void): void {
-		// Windows printer doesn't have persistent error events since connections are per-operation
+		// Spooler errors surface from the write itself; there is no event stream
 	}
 }
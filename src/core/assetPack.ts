@@ -0,0 +1,393 @@
+import { createHash } from 'node:crypto';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import { getLogger } from './logger';
+import { loadNativeAddon } from './nativeAddon';
+
+const log = getLogger('assets');
+
+// Pack layout, little-endian:
+//   'EPAK', format version, generation, entry count   (4 x u32)
+//   entries sorted by key: sha256 key, offset, length (32 bytes + 2 x u32)
+//   blocks, 8-byte aligned, most recently added first
+const MAGIC = 0x4b415045;
+const FORMAT_VERSION = 1;
+const HEADER_BYTES = 16;
+const KEY_BYTES = 32;
+const ENTRY_BYTES = KEY_BYTES + 8;
+const PACK_FILE = /^rasters\.(\d+)\.pack$/;
+
+// How often a reader looks for a generation written by another process
+const RESCAN_INTERVAL_MS = 1000;
+// Content hashes remembered for offer()
+const SEEN_LIMIT = 1024;
+
+export interface RasterAssetPackOptions {
+	/** Default ~/.escpos-lib/assets, next to the config store */
+	directory?: string;
+	/** Oldest blocks are dropped beyond this (default 64 MiB) */
+	maxBytes?: number;
+	/** New blocks are batched into one write (default 1000 ms) */
+	flushDelayMs?: number;
+	/** Default on unless ESCPOS_ASSET_PACK=0 */
+	enabled?: boolean;
+}
+
+export interface RasterAssetPackStats {
+	generation: number;
+	entries: number;
+	bytes: number;
+	/** Shared with other processes; false when the pack was read instead */
+	mapped: boolean;
+	hits: number;
+	misses: number;
+	pending: number;
+	writes: number;
+}
+
+const keyOf = (contentHash: string, variant: string): Buffer =>
+	createHash('sha256').update(`${contentHash}:${variant}`).digest();
+
+const packFileName = (generation: number): string =>
+	`rasters.${generation}.pack`;
+
+/**
+ * Pre-rendered raster blocks on disk, keyed by the hash of the source
+ * content and the render variant (width, threshold, dither). The pack is
+ * memory-mapped read-only, so every process on the machine shares one
+ * copy in the page cache and the first receipt after a restart skips
+ * decoding and dithering.
+ *
+ * Each update writes a complete new generation next to the old one and
+ * renames it into place, so readers never see a partial pack. When two
+ * processes publish the same generation the last rename wins; the other's
+ * blocks are simply rendered and offered again later.
+ */
+export class RasterAssetPack {
+	private readonly directory: string;
+	private readonly maxBytes: number;
+	private readonly flushDelayMs: number;
+	private readonly enabled: boolean;
+	private pack: Buffer | undefined;
+	private mapped = false;
+	private generation = 0;
+	private lastScan = 0;
+	private readonly pending = new Map<string, Buffer>();
+	private readonly seen = new Set<string>();
+	private flushTimer: NodeJS.Timeout | undefined;
+	private writing: Promise<void> | undefined;
+	private exitHookInstalled = false;
+	private counters = { hits: 0, misses: 0, writes: 0 };
+
+	constructor(options: RasterAssetPackOptions = {}) {
+		this.directory =
+			options.directory ?? path.join(os.homedir(), '.escpos-lib', 'assets');
+		this.maxBytes = options.maxBytes ?? 64 * 1024 * 1024;
+		this.flushDelayMs = options.flushDelayMs ?? 1000;
+		this.enabled = options.enabled ?? process.env.ESCPOS_ASSET_PACK !== '0';
+	}
+
+	/**
+	 * The block stored for this content and variant. Blocks are views of
+	 * the read-only mapping: writing to one crashes the process, so copy it
+	 * (e.g. with jobBufferPool.concat) before patching any bits.
+	 */
+	get(contentHash: string, variant: string): Buffer | undefined {
+		if (!this.enabled) {
+			return undefined;
+		}
+		const key = keyOf(contentHash, variant);
+		const block =
+			this.pending.get(key.toString('hex')) ??
+			this.lookup(key) ??
+			(this.rescan() ? this.lookup(key) : undefined);
+		if (block) {
+			this.counters.hits++;
+		} else {
+			this.counters.misses++;
+		}
+		return block;
+	}
+
+	/**
+	 * Store a block; it is copied, so the caller keeps ownership
+	 */
+	put(contentHash: string, variant: string, block: Buffer): void {
+		if (!this.enabled) {
+			return;
+		}
+		const key = keyOf(contentHash, variant);
+		if (this.lookup(key)) {
+			return;
+		}
+		this.pending.set(key.toString('hex'), Buffer.from(block));
+		this.scheduleFlush();
+	}
+
+	/**
+	 * put() for content that may be one-off (a whole receipt rendered as an
+	 * image): it is only stored once the same content and variant has been
+	 * rendered twice, so logos get in and unique images do not churn the pack
+	 */
+	offer(contentHash: string, variant: string, block: Buffer): void {
+		const id = `${contentHash}:${variant}`;
+		if (!this.seen.delete(id)) {
+			this.seen.add(id);
+			if (this.seen.size > SEEN_LIMIT) {
+				this.seen.delete(this.seen.values().next().value as string);
+			}
+			return;
+		}
+		this.put(contentHash, variant, block);
+	}
+
+	/**
+	 * Write pending blocks now instead of after the batching delay
+	 */
+	async flush(): Promise<void> {
+		clearTimeout(this.flushTimer);
+		this.flushTimer = undefined;
+		while (this.writing) {
+			await this.writing;
+		}
+		if (this.pending.size === 0) {
+			return;
+		}
+		this.writing = this.write().finally(() => {
+			this.writing = undefined;
+		});
+		return this.writing;
+	}
+
+	stats(): RasterAssetPackStats {
+		return {
+			generation: this.generation,
+			entries: this.pack ? this.pack.readUInt32LE(12) : 0,
+			bytes: this.pack?.length ?? 0,
+			mapped: this.mapped,
+			...this.counters,
+			pending: this.pending.size,
+		};
+	}
+
+	private scheduleFlush(): void {
+		if (!this.exitHookInstalled) {
+			// The timer does not hold the process open; write before it exits
+			this.exitHookInstalled = true;
+			process.on('beforeExit', () => {
+				void this.flush().catch(() => {});
+			});
+		}
+		if (this.flushTimer) {
+			return;
+		}
+		this.flushTimer = setTimeout(() => {
+			this.flushTimer = undefined;
+			this.flush().catch((error) => {
+				log.warn('Failed to write raster asset pack', { error });
+			});
+		}, this.flushDelayMs);
+		this.flushTimer.unref();
+	}
+
+	private lookup(key: Buffer): Buffer | undefined {
+		if (!this.pack) {
+			this.rescan();
+		}
+		const pack = this.pack;
+		if (!pack) {
+			return undefined;
+		}
+		let low = 0;
+		let high = pack.readUInt32LE(12) - 1;
+		while (low <= high) {
+			const middle = (low + high) >> 1;
+			const entry = HEADER_BYTES + middle * ENTRY_BYTES;
+			const order = key.compare(pack, entry, entry + KEY_BYTES);
+			if (order === 0) {
+				const offset = pack.readUInt32LE(entry + KEY_BYTES);
+				const length = pack.readUInt32LE(entry + KEY_BYTES + 4);
+				return offset + length <= pack.length
+					? pack.subarray(offset, offset + length)
+					: undefined;
+			}
+			if (order < 0) {
+				high = middle - 1;
+			} else {
+				low = middle + 1;
+			}
+		}
+		return undefined;
+	}
+
+	/**
+	 * Switch to the newest generation on disk, at most once per interval
+	 * @returns Whether a newer pack was loaded
+	 */
+	private rescan(): boolean {
+		const now = Date.now();
+		if (now - this.lastScan < RESCAN_INTERVAL_MS) {
+			return false;
+		}
+		this.lastScan = now;
+
+		let names: string[];
+		try {
+			names = fs.readdirSync(this.directory);
+		} catch {
+			return false;
+		}
+		const generations = names
+			.map((name) => Number(PACK_FILE.exec(name)?.[1] ?? 0))
+			.filter((generation) => generation > this.generation)
+			.sort((a, b) => b - a);
+
+		for (const generation of generations) {
+			const file = path.join(this.directory, packFileName(generation));
+			const pack = this.open(file);
+			if (pack) {
+				this.pack = pack.data;
+				this.mapped = pack.mapped;
+				this.generation = generation;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	private open(file: string): { data: Buffer; mapped: boolean } | undefined {
+		let data: Buffer | null = null;
+		let mapped = false;
+		try {
+			const addon = loadNativeAddon();
+			data = addon?.mapFile ? addon.mapFile(file) : null;
+			mapped = data !== null;
+			data ??= fs.readFileSync(file);
+		} catch {
+			// Removed by a newer generation's writer since the scan
+			return undefined;
+		}
+		if (
+			data.length < HEADER_BYTES ||
+			data.readUInt32LE(0) !== MAGIC ||
+			data.readUInt32LE(4) !== FORMAT_VERSION ||
+			HEADER_BYTES + data.readUInt32LE(12) * ENTRY_BYTES > data.length
+		) {
+			return undefined;
+		}
+		return { data, mapped };
+	}
+
+	private async write(): Promise<void> {
+		// Merge into whatever another process may have published meanwhile
+		this.lastScan = 0;
+		this.rescan();
+
+		const added = [...this.pending];
+		const blocks: Array<[Buffer, Buffer]> = added
+			.map(([key, block]): [Buffer, Buffer] => [Buffer.from(key, 'hex'), block])
+			.reverse();
+		const pack = this.pack;
+		if (pack) {
+			const existing: Array<[Buffer, Buffer]> = [];
+			for (let i = 0; i < pack.readUInt32LE(12); i++) {
+				const entry = HEADER_BYTES + i * ENTRY_BYTES;
+				const offset = pack.readUInt32LE(entry + KEY_BYTES);
+				const length = pack.readUInt32LE(entry + KEY_BYTES + 4);
+				existing.push([
+					pack.subarray(entry, entry + KEY_BYTES),
+					pack.subarray(offset, offset + length),
+				]);
+			}
+			// Blocks are stored newest first; keep that order
+			existing.sort((a, b) => a[1].byteOffset - b[1].byteOffset);
+			const keys = new Set(added.map(([key]) => key));
+			for (const [key, block] of existing) {
+				if (!keys.has(key.toString('hex'))) {
+					blocks.push([key, block]);
+				}
+			}
+		}
+
+		// Drop the oldest blocks over the budget
+		let dataBytes = 0;
+		let count = 0;
+		for (const [, block] of blocks) {
+			const size = (block.length + 7) & ~7;
+			const total = HEADER_BYTES + (count + 1) * ENTRY_BYTES + dataBytes;
+			if (total + size > this.maxBytes) {
+				break;
+			}
+			dataBytes += size;
+			count++;
+		}
+		const kept = blocks.slice(0, count);
+
+		const generation = this.generation + 1;
+		const dataStart = HEADER_BYTES + count * ENTRY_BYTES;
+		const output = Buffer.alloc(dataStart + dataBytes);
+		output.writeUInt32LE(MAGIC, 0);
+		output.writeUInt32LE(FORMAT_VERSION, 4);
+		output.writeUInt32LE(generation, 8);
+		output.writeUInt32LE(count, 12);
+		const offsets = new Map<Buffer, number>();
+		let offset = dataStart;
+		for (const [key, block] of kept) {
+			block.copy(output, offset);
+			offsets.set(key, offset);
+			offset += (block.length + 7) & ~7;
+		}
+		kept
+			.sort((a, b) => a[0].compare(b[0]))
+			.forEach(([key, block], index) => {
+				const entry = HEADER_BYTES + index * ENTRY_BYTES;
+				key.copy(output, entry);
+				output.writeUInt32LE(offsets.get(key) as number, entry + KEY_BYTES);
+				output.writeUInt32LE(block.length, entry + KEY_BYTES + 4);
+			});
+
+		await fs.promises.mkdir(this.directory, { recursive: true });
+		const file = path.join(this.directory, packFileName(generation));
+		const temporary = `${file}.${process.pid}.tmp`;
+		const handle = await fs.promises.open(temporary, 'w');
+		try {
+			await handle.writeFile(output);
+			await handle.sync();
+		} finally {
+			await handle.close();
+		}
+		await fs.promises.rename(temporary, file);
+		this.counters.writes++;
+
+		for (const [key, block] of added) {
+			if (this.pending.get(key) === block) {
+				this.pending.delete(key);
+			}
+		}
+		this.lastScan = 0;
+		this.rescan();
+		await this.removeOldGenerations();
+	}
+
+	// Windows refuses to delete packs another process still maps; the next
+	// write tries again
+	private async removeOldGenerations(): Promise<void> {
+		const names = await fs.promises.readdir(this.directory);
+		await Promise.all(
+			names
+				.filter((name) => {
+					const generation = Number(PACK_FILE.exec(name)?.[1] ?? Number.NaN);
+					return generation < this.generation;
+				})
+				.map((name) =>
+					fs.promises.unlink(path.join(this.directory, name)).catch(() => {}),
+				),
+		);
+	}
+}
+
+/**
+ * Shared pack used by the image rasterizers
+ */
+export const rasterAssetPack = new RasterAssetPack();
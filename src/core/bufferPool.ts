@@ -0,0 +1,150 @@
+export interface BufferPoolOptions {
+	/** Most bytes kept on the free lists (default 16 MiB) */
+	maxRetainedBytes?: number;
+	/** Smallest size class (default 1 KiB) */
+	minClassBytes?: number;
+	/** Larger requests bypass the pool (default 8 MiB) */
+	maxClassBytes?: number;
+}
+
+export interface BufferPoolStats {
+	acquired: number;
+	hits: number;
+	misses: number;
+	/** hits / acquired, 0 before the first acquire */
+	hitRate: number;
+	released: number;
+	/** Releases dropped because the pool was full */
+	dropped: number;
+	bytesRetained: number;
+	bytesInUse: number;
+}
+
+/**
+ * Reusable job buffers in power-of-two size classes. acquire() hands out a
+ * view of exactly the requested length over a pooled backing store;
+ * release() returns it once the transport no longer needs it. Buffers the
+ * pool did not hand out are ignored by release(), so callers can release
+ * whatever they got without tracking where it came from.
+ */
+export class BufferPool {
+	private readonly free = new Map<number, ArrayBuffer[]>();
+	private readonly inUse = new WeakSet<ArrayBuffer>();
+	private readonly maxRetainedBytes: number;
+	private readonly minClassBytes: number;
+	private readonly maxClassBytes: number;
+	private counters = {
+		acquired: 0,
+		hits: 0,
+		misses: 0,
+		released: 0,
+		dropped: 0,
+		bytesRetained: 0,
+		bytesInUse: 0,
+	};
+
+	constructor(options: BufferPoolOptions = {}) {
+		this.maxRetainedBytes = options.maxRetainedBytes ?? 16 * 1024 * 1024;
+		this.minClassBytes = options.minClassBytes ?? 1024;
+		this.maxClassBytes = options.maxClassBytes ?? 8 * 1024 * 1024;
+	}
+
+	private sizeClass(size: number): number {
+		let bytes = this.minClassBytes;
+		while (bytes < size) {
+			bytes *= 2;
+		}
+		return bytes;
+	}
+
+	/**
+	 * A buffer of `size` bytes with unspecified contents
+	 */
+	acquire(size: number): Buffer {
+		this.counters.acquired++;
+		if (size > this.maxClassBytes) {
+			this.counters.misses++;
+			return Buffer.allocUnsafeSlow(size);
+		}
+
+		const bytes = this.sizeClass(size);
+		let store = this.free.get(bytes)?.pop();
+		if (store) {
+			this.counters.hits++;
+			this.counters.bytesRetained -= bytes;
+		} else {
+			this.counters.misses++;
+			store = new ArrayBuffer(bytes);
+		}
+		this.inUse.add(store);
+		this.counters.bytesInUse += bytes;
+		return Buffer.from(store, 0, size);
+	}
+
+	/**
+	 * Give a buffer from acquire() (or any view of it) back to the pool
+	 */
+	release(buffer: Buffer): void {
+		const store = buffer.buffer;
+		if (!(store instanceof ArrayBuffer) || !this.inUse.has(store)) {
+			return;
+		}
+		this.inUse.delete(store);
+		this.counters.released++;
+		this.counters.bytesInUse -= store.byteLength;
+
+		if (
+			this.counters.bytesRetained + store.byteLength >
+			this.maxRetainedBytes
+		) {
+			this.counters.dropped++;
+			return;
+		}
+		const list = this.free.get(store.byteLength) ?? [];
+		list.push(store);
+		this.free.set(store.byteLength, list);
+		this.counters.bytesRetained += store.byteLength;
+	}
+
+	/**
+	 * Buffer.concat into a pooled buffer
+	 */
+	concat(parts: readonly Uint8Array[]): Buffer {
+		let length = 0;
+		for (const part of parts) {
+			length += part.length;
+		}
+		const result = this.acquire(length);
+		let offset = 0;
+		for (const part of parts) {
+			result.set(part, offset);
+			offset += part.length;
+		}
+		return result;
+	}
+
+	/**
+	 * Drop every retained buffer, e.g. under memory pressure
+	 */
+	trim(): void {
+		this.free.clear();
+		this.counters.bytesRetained = 0;
+	}
+
+	stats(): BufferPoolStats {
+		const { acquired, hits } = this.counters;
+		return {
+			...this.counters,
+			hitRate: acquired > 0 ? hits / acquired : 0,
+		};
+	}
+}
+
+/**
+ * Shared pool for encoded jobs and raster blocks
+ */
+export const jobBufferPool = new BufferPool();
+
+export function getBufferPoolStats(): BufferPoolStats {
+	return jobBufferPool.stats();
+}
@@ -1,4 +1,6 @@
 import * as storage from './persistentStorage';
+import { getPrinterProfile } from './printerProfile';
+import { getTransportScheme } from './transport';
 import type { DeviceConfig } from './types';
 
 const createDeviceKey = (vid: string, pid: string): string => {
@@ -22,13 +24,20 @@ const validateConfig = (config: Partial<DeviceConfig>): boolean => {
 			case 'deviceType':
 				if (
 					typeof value !== 'string' ||
-					!['printer', 'scanner', 'scale', 'unassigned'].includes(value)
+					![
+						'printer',
+						'scanner',
+						'scale',
+						'display',
+						'unassigned',
+					].includes(value)
 				) {
 					return false;
 				}
 				break;
 			case 'brand':
 			case 'model':
+			case 'group':
 				if (typeof value !== 'string' || value.trim() === '') {
 					return false;
 				}
@@ -43,6 +52,24 @@ const validateConfig = (config: Partial<DeviceConfig>): boolean => {
 					return false;
 				}
 				break;
+			case 'transport':
+				if (typeof value !== 'string' || !getTransportScheme(value)) {
+					return false;
+				}
+				break;
+			case 'lowLatency':
+				if (
+					typeof value !== 'string' ||
+					!['off', 'prefer', 'require'].includes(value)
+				) {
+					return false;
+				}
+				break;
+			case 'profile':
+				if (typeof value !== 'string' || !getPrinterProfile(value)) {
+					return false;
+				}
+				break;
 			default:
 				return false;
 		}
@@ -136,6 +163,26 @@ export const clearAllDevices = (): boolean => {
 	}
 };
 
+/**
+ * Whether two configs differ in any field, including optional fields
+ * (group, transport, profile, lowLatency) only one of them sets
+ */
+export const deviceConfigChanged = (
+	previous: DeviceConfig,
+	next: DeviceConfig,
+): boolean => {
+	const fields = new Set([
+		...Object.keys(previous),
+		...Object.keys(next),
+	]) as Set<keyof DeviceConfig>;
+	for (const field of fields) {
+		if (previous[field] !== next[field]) {
+			return true;
+		}
+	}
+	return false;
+};
+
 export const hasDeviceConfig = (vid: string, pid: string): boolean => {
 	const key = createDeviceKey(vid, pid);
 	return storage.getValue<DeviceConfig>(key) !== undefined;
@@ -1,10 +1,15 @@
+import * as fs from 'node:fs';
+import * as path from 'node:path';
 import Serial from '@node-escpos/serialport-adapter';
 import USB from '@node-escpos/usb-adapter';
 import { type Device, usb } from 'usb';
 import { getDeviceConfig } from './deviceConfig';
+import { getLogger } from './logger';
 import type { TerminalDevice } from './types';
 import { type PrinterInfo, ThermalWindowPrinter } from './windows_printer';
 
+const log = getLogger('device');
+
 // Helper function to format ID as hexadecimal string
 const toHexString = (value: number | string): string => {
 	const num = typeof value === 'string' ? Number.parseInt(value, 16) : value;
@@ -41,7 +46,7 @@ function getWindowsPrinters(connectedDevices: Device[]): TerminalDevice[] {
 	const connectedPrintersOnWindows: PrinterInfo[] = [];
 	const devices: TerminalDevice[] = [];
 	const availablePrinters = ThermalWindowPrinter.getAvailablePrinters();
-	console.log('Available printers on windows:', availablePrinters);
+	log.debug('Windows printers', { printers: availablePrinters });
 	const pattern = /^USB\d+$/;
 	const windowsPrinter = connectedDevices.flatMap((_device) =>
 		availablePrinters.filter((printer) => pattern.test(printer.portName)),
@@ -171,11 +176,89 @@ async function getSerialDevices(
 	return devices;
 }
 
+const INPUT_CLASS_DIR = '/sys/class/input';
+const BUS_USB = 0x03;
+const KEY_ENTER = 28;
+
+const readSysfs = (file: string): string => {
+	try {
+		return fs.readFileSync(file, 'utf8').trim();
+	} catch {
+		return '';
+	}
+};
+
+// The key bitmap is hex words, most significant first; Enter is in the last
+const hasEnterKey = (keyBitmap: string): boolean => {
+	const lowest = keyBitmap.split(' ').pop()?.slice(-8) || '0';
+	return (Number.parseInt(lowest, 16) & (1 << KEY_ENTER)) !== 0;
+};
+
+// USB keyboards, which keyboard-wedge scanners present themselves as, by
+// their evdev node (Linux). They stay unassigned until configured as
+// scanners; one node per vid/pid, as a keyboard may expose several.
+function getHidInputDevices(): TerminalDevice[] {
+	if (process.platform !== 'linux') {
+		return [];
+	}
+
+	let entries: string[];
+	try {
+		entries = fs.readdirSync(INPUT_CLASS_DIR);
+	} catch {
+		return [];
+	}
+
+	const devices = new Map<string, TerminalDevice>();
+	for (const entry of entries.filter((name) => /^event\d+$/.test(name))) {
+		const info = path.join(INPUT_CLASS_DIR, entry, 'device');
+		const bus = Number.parseInt(readSysfs(path.join(info, 'id/bustype')), 16);
+		if (
+			bus !== BUS_USB ||
+			!hasEnterKey(readSysfs(path.join(info, 'capabilities/key')))
+		) {
+			continue;
+		}
+
+		const vid = toHexString(readSysfs(path.join(info, 'id/vendor')) || '0');
+		const pid = toHexString(readSysfs(path.join(info, 'id/product')) || '0');
+		const id = `device_${vid}_${pid}`;
+		if (devices.has(id)) {
+			continue;
+		}
+		devices.set(id, {
+			capabilities: ['read'],
+			id,
+			meta: {
+				deviceType: 'unassigned',
+				baudrate: 'not-supported',
+				setToDefault: false,
+				brand: '',
+				model: '',
+			},
+			path: `/dev/input/${entry}`,
+			name: readSysfs(path.join(info, 'name')),
+			pid,
+			vid,
+			manufacturer: '',
+			serialNumber: '',
+		});
+	}
+	return Array.from(devices.values());
+}
+
 export function devicesWithSavedConfig(devices: TerminalDevice[]) {
 	return devices.map((device) => {
 		const saved = getDeviceConfig(device.vid, device.pid);
 		if (saved) {
 			device.meta = saved;
+			// Serial ports configured as printers or displays are written to
+			if (
+				(saved.deviceType === 'printer' || saved.deviceType === 'display') &&
+				!device.capabilities.includes('write')
+			) {
+				device.capabilities = [...device.capabilities, 'write'];
+			}
 		} else {
 			// Reset to default metadata when no config exists (after deletion)
 			device.meta = {
@@ -210,5 +293,8 @@ export async function getConnectedDevices(): Promise<TerminalDevice[]> {
 	const serialDevices = await getSerialDevices(connectedDevices);
 	devices.push(...serialDevices);
 
+	// HID scanners are excluded from the USB list above (class 3)
+	devices.push(...getHidInputDevices());
+
 	return devices;
 }
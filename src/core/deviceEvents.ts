@@ -1,5 +1,8 @@
+import { getLogger } from './logger';
 import type { TerminalDevice } from './types';
 
+const log = getLogger('device');
+
 export type DeviceConnectCallback = (device: TerminalDevice) => void;
 export type DeviceDisconnectCallback = (deviceId: string) => void;
 export type DeviceDataCallback = (deviceId: string, data: string) => void;
@@ -39,7 +42,7 @@ export class DeviceEventEmitter {
 			try {
 				callback(device);
 			} catch (error) {
-				console.error('Error in device connect callback:', error);
+				log.error('Device connect callback failed', { error });
 			}
 		});
 	}
@@ -49,7 +52,7 @@ export class DeviceEventEmitter {
 			try {
 				callback(deviceId);
 			} catch (error) {
-				console.error('Error in device disconnect callback:', error);
+				log.error('Device disconnect callback failed', { error });
 			}
 		});
 		// Clean up data callbacks for disconnected device
@@ -62,7 +65,7 @@ export class DeviceEventEmitter {
 			try {
 				callback(deviceId, data);
 			} catch (error) {
-				console.error(`Error in device data callback for ${deviceId}:`, error);
+				log.error('Device data callback failed', { deviceId, error });
 			}
 		});
 	}
@@ -72,7 +75,7 @@ export class DeviceEventEmitter {
 			try {
 				callback(deviceId, error);
 			} catch (error) {
-				console.error('Error in device error callback:', error);
+				log.error('Device error callback failed', { error });
 			}
 		});
 	}
@@ -0,0 +1,115 @@
+/** Characters to write at a position, 0-based */
+export interface DisplayUpdate {
+	row: number;
+	column: number;
+	text: string;
+}
+
+// Bytes of a cursor move (US $ x y); gaps shorter than this are cheaper
+// to rewrite than to jump over
+const CURSOR_MOVE_BYTES = 4;
+
+/**
+ * Pad or cut text to exactly columns characters, with right beside it
+ * aligned to the end when given, e.g. formatDisplayLine('Milk 2L', '45.00')
+ */
+export function formatDisplayLine(
+	left: string,
+	right = '',
+	columns = 20,
+): string {
+	const room = Math.max(0, columns - right.length);
+	return (left.slice(0, room).padEnd(room) + right).slice(0, columns);
+}
+
+/**
+ * What a character display shows (the shadow) next to what it should
+ * show. diff() yields the changed ranges only, so an update costs bytes
+ * in proportion to what changed rather than to the display size.
+ */
+export class DisplayFramebuffer {
+	private shown: string[];
+	private wanted: string[];
+
+	constructor(
+		readonly columns = 20,
+		readonly rows = 2,
+	) {
+		this.shown = Array.from({ length: rows }, () => ' '.repeat(columns));
+		this.wanted = [...this.shown];
+	}
+
+	/**
+	 * Set the wanted content; rows not given are blanked
+	 */
+	setLines(lines: ReadonlyArray<string>): void {
+		for (let row = 0; row < this.rows; row++) {
+			this.setLine(row, lines[row] ?? '');
+		}
+	}
+
+	setLine(row: number, text: string): void {
+		if (row >= 0 && row < this.rows) {
+			this.wanted[row] = formatDisplayLine(text, '', this.columns);
+		}
+	}
+
+	getLines(): string[] {
+		return [...this.wanted];
+	}
+
+	isDirty(): boolean {
+		return this.wanted.some((line, row) => line !== this.shown[row]);
+	}
+
+	/**
+	 * Changed ranges between the shadow and the wanted content. Nearby
+	 * ranges on a row are merged when resending the characters between
+	 * them is cheaper than another cursor move.
+	 */
+	diff(): DisplayUpdate[] {
+		const updates: DisplayUpdate[] = [];
+		for (let row = 0; row < this.rows; row++) {
+			const shown = this.shown[row];
+			const wanted = this.wanted[row];
+			let start = -1;
+			let end = -1;
+			for (let column = 0; column < this.columns; column++) {
+				if (shown[column] === wanted[column]) {
+					continue;
+				}
+				if (start >= 0 && column - end > CURSOR_MOVE_BYTES) {
+					updates.push({ row, column: start, text: wanted.slice(start, end) });
+					start = -1;
+				}
+				if (start < 0) {
+					start = column;
+				}
+				end = column + 1;
+			}
+			if (start >= 0) {
+				updates.push({ row, column: start, text: wanted.slice(start, end) });
+			}
+		}
+		return updates;
+	}
+
+	/**
+	 * Record that updates have reached the display
+	 */
+	apply(updates: ReadonlyArray<DisplayUpdate>): void {
+		for (const { row, column, text } of updates) {
+			const line = this.shown[row];
+			this.shown[row] =
+				line.slice(0, column) + text + line.slice(column + text.length);
+		}
+	}
+
+	/**
+	 * Forget what the display shows, e.g. after it was cleared or power
+	 * cycled; the next diff repaints whatever differs from blank
+	 */
+	reset(): void {
+		this.shown = this.shown.map(() => ' '.repeat(this.columns));
+	}
+}
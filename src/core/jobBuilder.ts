@@ -0,0 +1,328 @@
+import { jobBufferPool } from './bufferPool';
+import { encodeTspl, encodeZpl } from './labelEncoder';
+import {
+	type LengthConstraints,
+	type LengthReport,
+	optimizeJobLength,
+} from './lengthOptimizer';
+import {
+	type PrinterProfile,
+	resolvePrinterProfile,
+} from './printerProfile';
+import {
+	analyzeJob,
+	chooseTuning,
+	encodeTuning,
+	type JobAnalysis,
+} from './printTuning';
+import {
+	encodeSymbolCommand,
+	layoutSymbol,
+	rasterizeSymbol,
+	rasterizesSymbol,
+	type SymbolOptions,
+	type Symbology,
+} from './symbology';
+import {
+	EscPosCommands,
+	type ImageProcessingOptions,
+	ImageProcessingError,
+	rasterizeBase64Image,
+	rasterizeImageBuffer,
+} from './windows_printer';
+
+/**
+ * 1-bpp image, rows of ceil(width / 8) bytes, most significant bit first,
+ * a set bit is a black dot
+ */
+export interface MonoBitmap {
+	width: number;
+	height: number;
+	data: Buffer;
+}
+
+export type JobAlign = 'left' | 'center' | 'right';
+
+export interface TextStyle {
+	align?: JobAlign;
+	bold?: boolean;
+	/** Character magnification, 1-8 */
+	scale?: number;
+	/** ESC/POS font: A is 12x24 dots, B is 9x17 */
+	font?: 'A' | 'B';
+	/** ESC/POS line pitch in dots (ESC 3); printer default otherwise */
+	lineSpacing?: number;
+}
+
+export type JobOp =
+	| { type: 'reset' }
+	| ({ type: 'text'; text: string } & TextStyle)
+	| { type: 'raster'; bitmap: MonoBitmap; align?: JobAlign }
+	| ({ type: 'symbol'; symbology: Symbology; data: string } & SymbolOptions)
+	| { type: 'feed'; lines: number }
+	| { type: 'cut' };
+
+export const bytesPerRow = (bitmap: Pick<MonoBitmap, 'width'>): number =>
+	Math.ceil(bitmap.width / 8);
+
+/**
+ * Unpack a GS v 0 raster block (as produced by rasterizeBase64Image)
+ */
+export function bitmapFromRaster(block: Buffer): MonoBitmap {
+	const header = EscPosCommands.IMAGE_HIGH_DENSITY;
+	if (block.length < 8 || !block.subarray(0, 4).equals(header)) {
+		throw new ImageProcessingError('Not a GS v 0 raster block');
+	}
+	const rowBytes = block.readUInt16LE(4);
+	const height = block.readUInt16LE(6);
+	return {
+		width: rowBytes * 8,
+		height,
+		data: block.subarray(8, 8 + rowBytes * height),
+	};
+}
+
+/**
+ * Decode a base64 image, or the image file in a Buffer, into a 1-bpp
+ * bitmap for PrintJobBuilder.raster()
+ */
+export async function loadMonoBitmap(
+	image: string | Buffer,
+	options: ImageProcessingOptions = {},
+): Promise<MonoBitmap> {
+	return bitmapFromRaster(
+		typeof image === 'string'
+			? await rasterizeBase64Image(image, options)
+			: await rasterizeImageBuffer(image, options),
+	);
+}
+
+const ALIGN_COMMANDS: Record<JobAlign, Buffer> = {
+	left: EscPosCommands.ALIGN_LEFT,
+	center: EscPosCommands.ALIGN_CENTER,
+	right: EscPosCommands.ALIGN_RIGHT,
+};
+
+// ESC 2
+const DEFAULT_LINE_SPACING = Buffer.from([0x1b, 0x32]);
+
+function rasterCommands(bitmap: MonoBitmap, align: JobAlign): Buffer[] {
+	const rowBytes = bytesPerRow(bitmap);
+	return [
+		ALIGN_COMMANDS[align],
+		EscPosCommands.IMAGE_HIGH_DENSITY,
+		Buffer.from([
+			rowBytes & 0xff,
+			(rowBytes >> 8) & 0xff,
+			bitmap.height & 0xff,
+			(bitmap.height >> 8) & 0xff,
+		]),
+		bitmap.data,
+	];
+}
+
+/**
+ * Encode builder ops as ESC/POS. 2D symbols the profile's firmware cannot
+ * draw (GS ( k) are rasterized natively.
+ */
+export function encodeEscPos(
+	ops: readonly JobOp[],
+	profile: PrinterProfile = resolvePrinterProfile(),
+): Buffer {
+	const parts: Buffer[] = [];
+	for (const op of ops) {
+		switch (op.type) {
+			case 'reset':
+				parts.push(EscPosCommands.INIT);
+				break;
+			case 'text': {
+				const scale = Math.max(1, Math.min(8, op.scale ?? 1));
+				if (op.align) {
+					parts.push(ALIGN_COMMANDS[op.align]);
+				}
+				if (op.bold) {
+					parts.push(EscPosCommands.BOLD_ON);
+				}
+				if (op.font === 'B') {
+					parts.push(EscPosCommands.FONT_COMPRESSED);
+				}
+				if (op.lineSpacing !== undefined) {
+					parts.push(
+						EscPosCommands.createLineSpacingCommand(op.lineSpacing),
+					);
+				}
+				if (scale > 1) {
+					parts.push(
+						EscPosCommands.createTextSizeCommand(scale - 1, scale - 1),
+					);
+				}
+				parts.push(EscPosCommands.ASCII_MODE, Buffer.from(op.text, 'utf8'));
+				if (!op.text.endsWith('\n')) {
+					parts.push(EscPosCommands.LINE_FEED);
+				}
+				// Styles are per op; do not let them leak into the next one
+				if (scale > 1) {
+					parts.push(EscPosCommands.createTextSizeCommand(0, 0));
+				}
+				if (op.lineSpacing !== undefined) {
+					parts.push(DEFAULT_LINE_SPACING);
+				}
+				if (op.font === 'B') {
+					parts.push(EscPosCommands.FONT_STANDARD);
+				}
+				if (op.bold) {
+					parts.push(EscPosCommands.BOLD_OFF);
+				}
+				break;
+			}
+			case 'raster':
+				parts.push(...rasterCommands(op.bitmap, op.align ?? 'center'));
+				break;
+			case 'symbol': {
+				const layout = layoutSymbol(op.symbology, op.data, op, profile);
+				const align = op.align ?? 'center';
+				if (rasterizesSymbol(op.symbology, profile)) {
+					parts.push(...rasterCommands(rasterizeSymbol(layout), align));
+				} else {
+					parts.push(
+						ALIGN_COMMANDS[align],
+						encodeSymbolCommand(layout),
+						EscPosCommands.LINE_FEED,
+					);
+				}
+				break;
+			}
+			case 'feed':
+				// ESC d n
+				parts.push(
+					Buffer.from([0x1b, 0x64, Math.max(0, Math.min(255, op.lines))]),
+				);
+				break;
+			case 'cut':
+				parts.push(EscPosCommands.CUT);
+				break;
+		}
+	}
+	return jobBufferPool.concat(parts);
+}
+
+export interface JobEncodeOptions {
+	/**
+	 * Prepend the speed/density that suits this job's content when the
+	 * profile has tuning ranges (default true)
+	 */
+	adaptiveTuning?: boolean;
+}
+
+function encodeOps(ops: readonly JobOp[], profile: PrinterProfile): Buffer {
+	switch (profile.language) {
+		case 'zpl':
+			return encodeZpl(ops, profile);
+		case 'tspl':
+			return encodeTspl(ops, profile);
+		default:
+			return encodeEscPos(ops, profile);
+	}
+}
+
+/**
+ * Describes a print job once as a list of ops and encodes it in whatever
+ * command language the target printer's profile speaks.
+ */
+export class PrintJobBuilder {
+	private readonly ops: JobOp[] = [];
+
+	/** ESC @ on receipt printers; label languages start each label clean */
+	reset(): this {
+		this.ops.push({ type: 'reset' });
+		return this;
+	}
+
+	text(text: string, style: TextStyle = {}): this {
+		this.ops.push({ type: 'text', text, ...style });
+		return this;
+	}
+
+	raster(bitmap: MonoBitmap, align?: JobAlign): this {
+		this.ops.push({ type: 'raster', bitmap, align });
+		return this;
+	}
+
+	/**
+	 * PDF417 or Data Matrix symbol; drawn by the printer when its profile
+	 * supports the symbology, rasterized otherwise
+	 */
+	symbol(
+		symbology: Symbology,
+		data: string,
+		options: SymbolOptions = {},
+	): this {
+		this.ops.push({ type: 'symbol', symbology, data, ...options });
+		return this;
+	}
+
+	feed(lines = 1): this {
+		this.ops.push({ type: 'feed', lines });
+		return this;
+	}
+
+	/** Cut the receipt, or end the current label */
+	cut(): this {
+		this.ops.push({ type: 'cut' });
+		return this;
+	}
+
+	getOps(): readonly JobOp[] {
+		return this.ops;
+	}
+
+	/**
+	 * Shorten the printed receipt within the given readability constraints
+	 * (tighter line pitch, font B for wide blocks, collapsed feeds)
+	 * @returns Estimated paper length before and after, in mm
+	 */
+	optimizeLength(
+		profile: PrinterProfile = resolvePrinterProfile(),
+		constraints: LengthConstraints = {},
+	): LengthReport {
+		const { ops, report } = optimizeJobLength(this.ops, profile, constraints);
+		this.ops.splice(0, this.ops.length, ...ops);
+		return report;
+	}
+
+	/**
+	 * Black-dot load of the job as encoded for profile; symbols count
+	 * whether the printer draws them or they are rasterized
+	 */
+	analyze(profile: PrinterProfile = resolvePrinterProfile()): JobAnalysis {
+		return analyzeJob(this.ops, profile);
+	}
+
+	/**
+	 * The job in the profile's language, in a buffer from jobBufferPool;
+	 * release it once the transport is done with it
+	 */
+	encode(
+		profile: PrinterProfile = resolvePrinterProfile(),
+		options: JobEncodeOptions = {},
+	): Buffer {
+		const { adaptiveTuning = true } = options;
+		if (!adaptiveTuning || !profile.tuning) {
+			return encodeOps(this.ops, profile);
+		}
+
+		const settings = chooseTuning(this.analyze(profile), profile.tuning);
+		// Settings go after a leading ESC @ in case it restores the defaults
+		const lead = this.ops[0]?.type === 'reset' ? 1 : 0;
+		const head = encodeOps(this.ops.slice(0, lead), profile);
+		const body = encodeOps(this.ops.slice(lead), profile);
+		const job = jobBufferPool.concat([
+			head,
+			encodeTuning(settings, profile),
+			body,
+		]);
+		jobBufferPool.release(head);
+		jobBufferPool.release(body);
+		return job;
+	}
+}
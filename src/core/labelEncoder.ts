@@ -0,0 +1,364 @@
+import { deflateSync } from 'node:zlib';
+import { jobBufferPool } from './bufferPool';
+import type { JobAlign, JobOp, MonoBitmap } from './jobBuilder';
+import type { PrinterProfile } from './printerProfile';
+import { layoutSymbol, type SymbolLayout } from './symbology';
+
+// A label is laid out top to bottom; `cut` ends one and starts the next
+interface LabelLayout {
+	heightDots: number;
+	commands: Buffer[];
+}
+
+interface LabelDialect {
+	/** Height of one line of unscaled text in dots */
+	lineDots(profile: PrinterProfile): number;
+	text(
+		lines: string[],
+		y: number,
+		scale: number,
+		align: JobAlign,
+		profile: PrinterProfile,
+	): Buffer;
+	raster(
+		bitmap: MonoBitmap,
+		x: number,
+		y: number,
+		profile: PrinterProfile,
+	): Buffer;
+	/** Both label languages draw PDF417 and Data Matrix natively */
+	symbol(symbol: SymbolLayout, x: number, y: number): Buffer;
+	label(layout: LabelLayout, profile: PrinterProfile): Buffer;
+}
+
+const rowBytesOf = (bitmap: MonoBitmap): number =>
+	Math.ceil(bitmap.width / 8);
+
+function alignedX(width: number, align: JobAlign, profile: PrinterProfile) {
+	const room = Math.max(0, profile.printWidthDots - width);
+	if (align === 'left') {
+		return 0;
+	}
+	return align === 'right' ? room : Math.floor(room / 2);
+}
+
+function layoutLabels(
+	ops: readonly JobOp[],
+	profile: PrinterProfile,
+	dialect: LabelDialect,
+): Buffer {
+	const margin = profile.dotsPerMm * 2;
+	const gap = profile.dotsPerMm;
+	const labels: Buffer[] = [];
+	let current: LabelLayout = { heightDots: margin, commands: [] };
+
+	const finish = () => {
+		if (current.commands.length > 0) {
+			current.heightDots += margin;
+			labels.push(dialect.label(current, profile));
+		}
+		current = { heightDots: margin, commands: [] };
+	};
+
+	for (const op of ops) {
+		switch (op.type) {
+			case 'text': {
+				const scale = Math.max(1, Math.min(8, op.scale ?? 1));
+				const lines = op.text.replace(/\n$/, '').split('\n');
+				current.commands.push(
+					dialect.text(
+						lines,
+						current.heightDots,
+						scale,
+						op.align ?? 'left',
+						profile,
+					),
+				);
+				current.heightDots +=
+					lines.length * (dialect.lineDots(profile) * scale + gap);
+				break;
+			}
+			case 'raster': {
+				const x = alignedX(op.bitmap.width, op.align ?? 'center', profile);
+				current.commands.push(
+					dialect.raster(op.bitmap, x, current.heightDots, profile),
+				);
+				current.heightDots += op.bitmap.height + gap;
+				break;
+			}
+			case 'symbol': {
+				const symbol = layoutSymbol(op.symbology, op.data, op, profile);
+				const x = alignedX(symbol.width, op.align ?? 'center', profile);
+				current.commands.push(dialect.symbol(symbol, x, current.heightDots));
+				current.heightDots += symbol.height + gap;
+				break;
+			}
+			case 'feed':
+				current.heightDots += op.lines * (dialect.lineDots(profile) + gap);
+				break;
+			case 'cut':
+				finish();
+				break;
+			case 'reset':
+				// Every label starts from a clean format already
+				break;
+		}
+	}
+	finish();
+	return jobBufferPool.concat(labels);
+}
+
+// CRC-16/XMODEM over the base64 text, as ZPL expects after :Z64:
+function crc16(text: string): number {
+	let crc = 0;
+	for (let i = 0; i < text.length; i++) {
+		crc ^= text.charCodeAt(i) << 8;
+		for (let bit = 0; bit < 8; bit++) {
+			crc =
+				crc & 0x8000 ? ((crc << 1) ^ 0x1021) & 0xffff : (crc << 1) & 0xffff;
+		}
+	}
+	return crc;
+}
+
+/**
+ * ^GF payload as :Z64: (zlib deflate, base64, CRC)
+ */
+export function encodeZ64(data: Buffer): string {
+	const encoded = deflateSync(data).toString('base64');
+	const crc = crc16(encoded).toString(16).toUpperCase().padStart(4, '0');
+	return `:Z64:${encoded}:${crc}`;
+}
+
+// ACS repeat counts: G-Y are 1-19, g-z are 20-400; counts add up
+function acsCount(count: number): string {
+	let out = '';
+	let left = count;
+	while (left >= 400) {
+		out += 'z';
+		left -= 400;
+	}
+	if (left >= 20) {
+		out += String.fromCharCode(0x67 + Math.floor(left / 20) - 1);
+		left %= 20;
+	}
+	if (left > 0) {
+		out += String.fromCharCode(0x47 + left - 1);
+	}
+	return out;
+}
+
+function acsRow(hex: string): string {
+	// A trailing run of 0 or F collapses to ',' or '!'
+	let end = hex.length;
+	let tail = '';
+	const last = hex[end - 1];
+	if (last === '0' || last === 'F') {
+		while (end > 0 && hex[end - 1] === last) {
+			end--;
+		}
+		tail = last === '0' ? ',' : '!';
+	}
+
+	let out = '';
+	for (let i = 0; i < end; ) {
+		let j = i;
+		while (j < end && hex[j] === hex[i]) {
+			j++;
+		}
+		out += j - i > 2 ? acsCount(j - i) + hex[i] : hex.slice(i, j);
+		i = j;
+	}
+	return out + tail;
+}
+
+/**
+ * ^GF payload in the ASCII compression scheme, for firmware without Z64.
+ * Rows repeating the previous one become ':'.
+ */
+export function encodeAcs(data: Buffer, rowBytes: number): string {
+	let out = '';
+	let previous: string | undefined;
+	for (let offset = 0; offset < data.length; offset += rowBytes) {
+		const hex = data
+			.subarray(offset, offset + rowBytes)
+			.toString('hex')
+			.toUpperCase();
+		out += hex === previous ? ':' : acsRow(hex);
+		previous = hex;
+	}
+	return out;
+}
+
+// ^FH lets the field carry ^ and ~
+const zplEscape = (text: string): string =>
+	text.replace(/_/g, '_5F').replace(/\^/g, '_5E').replace(/~/g, '_7E');
+
+// ^FB breaks lines on \&
+const zplField = (lines: string[]): string =>
+	lines.map((line) => zplEscape(line.replace(/\\/g, '\\\\'))).join('\\&');
+
+const ZPL_JUSTIFY: Record<JobAlign, string> = {
+	left: 'L',
+	center: 'C',
+	right: 'R',
+};
+
+const zpl: LabelDialect = {
+	lineDots: (profile) => profile.dotsPerMm * 3,
+
+	text(lines, y, scale, align, profile) {
+		const height = this.lineDots(profile) * scale;
+		const block = [
+			profile.printWidthDots,
+			lines.length,
+			profile.dotsPerMm,
+			ZPL_JUSTIFY[align],
+			0,
+		].join(',');
+		return Buffer.from(
+			`^FO0,${y}^FB${block}^A0N,${height},${height}` +
+				`^FH^FD${zplField(lines)}^FS\n`,
+			'utf8',
+		);
+	},
+
+	raster(bitmap, x, y, profile) {
+		const rowBytes = rowBytesOf(bitmap);
+		const total = rowBytes * bitmap.height;
+		const acs = encodeAcs(bitmap.data, rowBytes);
+		const z64 = profile.capabilities.zplZ64
+			? encodeZ64(bitmap.data)
+			: undefined;
+		const payload = z64 && z64.length < acs.length ? z64 : acs;
+		return Buffer.from(
+			`^FO${x},${y}^GFA,${total},${total},${rowBytes},${payload}^FS\n`,
+			'ascii',
+		);
+	},
+
+	symbol(symbol, x, y) {
+		const data = zplEscape(symbol.data.toString('utf8'));
+		const barcode =
+			symbol.symbology === 'datamatrix'
+				? `^BXN,${symbol.moduleSize},200`
+				: `^BY${symbol.moduleSize}^B7N,${symbol.rowHeight},` +
+					`${symbol.errorLevel},${symbol.columns}`;
+		return Buffer.from(`^FO${x},${y}${barcode}^FH^FD${data}^FS\n`, 'utf8');
+	},
+
+	label(layout, profile) {
+		return Buffer.concat([
+			Buffer.from(
+				`^XA\n^CI28\n^PW${profile.printWidthDots}\n` +
+					`^LL${layout.heightDots}\n^LH0,0\n`,
+				'ascii',
+			),
+			...layout.commands,
+			Buffer.from('^XZ\n', 'ascii'),
+		]);
+	},
+};
+
+// TSPL font "3" is 16 x 24 dots
+const TSPL_FONT = { width: 16, height: 24 };
+
+const tspl: LabelDialect = {
+	lineDots: () => TSPL_FONT.height,
+
+	text(lines, y, scale, align, profile) {
+		const lineHeight = TSPL_FONT.height * scale + profile.dotsPerMm;
+		const commands = lines.map((line, index) => {
+			const width = [...line].length * TSPL_FONT.width * scale;
+			const x = alignedX(width, align, profile);
+			const content = line.replace(/"/g, '\\["]');
+			const top = y + index * lineHeight;
+			return `TEXT ${x},${top},"3",0,${scale},${scale},"${content}"\r\n`;
+		});
+		return Buffer.from(commands.join(''), 'utf8');
+	},
+
+	raster(bitmap, x, y) {
+		// BITMAP has no portable compressed mode; blank bands are simply
+		// skipped since CLS already cleared them. A 0 bit prints black.
+		const rowBytes = rowBytesOf(bitmap);
+		const parts: Buffer[] = [];
+		const isBlank = (row: number) =>
+			bitmap.data
+				.subarray(row * rowBytes, (row + 1) * rowBytes)
+				.every((byte) => byte === 0);
+
+		for (let row = 0; row < bitmap.height; ) {
+			if (isBlank(row)) {
+				row++;
+				continue;
+			}
+			const start = row;
+			while (row < bitmap.height && !isBlank(row)) {
+				row++;
+			}
+			const band = Buffer.from(
+				bitmap.data.subarray(start * rowBytes, row * rowBytes),
+			);
+			for (let i = 0; i < band.length; i++) {
+				band[i] = ~band[i] & 0xff;
+			}
+			parts.push(
+				Buffer.from(
+					`BITMAP ${x},${y + start},${rowBytes},${row - start},0,`,
+					'ascii',
+				),
+				band,
+				Buffer.from('\r\n', 'ascii'),
+			);
+		}
+		return Buffer.concat(parts);
+	},
+
+	symbol(symbol, x, y) {
+		const data = symbol.data.toString('utf8').replace(/"/g, '\\["]');
+		const barcode =
+			symbol.symbology === 'datamatrix'
+				? `DMATRIX ${x},${y},${symbol.width},${symbol.height},` +
+					`x${symbol.moduleSize}`
+				: `PDF417 ${x},${y},${symbol.width},${symbol.height},0,` +
+					`E${symbol.errorLevel},W${symbol.moduleSize},` +
+					`H${symbol.rowHeight},C${symbol.columns}`;
+		return Buffer.from(`${barcode},"${data}"\r\n`, 'utf8');
+	},
+
+	label(layout, profile) {
+		const widthMm = Math.round(profile.printWidthDots / profile.dotsPerMm);
+		const heightMm = Math.ceil(layout.heightDots / profile.dotsPerMm);
+		return Buffer.concat([
+			Buffer.from(
+				`SIZE ${widthMm} mm,${heightMm} mm\r\nGAP 2 mm,0 mm\r\n` +
+					'CODEPAGE UTF-8\r\nCLS\r\n',
+				'ascii',
+			),
+			...layout.commands,
+			Buffer.from('PRINT 1,1\r\n', 'ascii'),
+		]);
+	},
+};
+
+/**
+ * Encode builder ops as ZPL II labels; rasters use Z64 when the profile
+ * allows it and it is smaller, ACS otherwise
+ */
+export function encodeZpl(
+	ops: readonly JobOp[],
+	profile: PrinterProfile,
+): Buffer {
+	return layoutLabels(ops, profile, zpl);
+}
+
+/**
+ * Encode builder ops as TSPL labels
+ */
+export function encodeTspl(
+	ops: readonly JobOp[],
+	profile: PrinterProfile,
+): Buffer {
+	return layoutLabels(ops, profile, tspl);
+}
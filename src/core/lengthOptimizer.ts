@@ -0,0 +1,183 @@
+import type { JobOp } from './jobBuilder';
+import type { PrinterProfile } from './printerProfile';
+import { layoutSymbol } from './symbology';
+
+/**
+ * Readability limits the length optimizer must respect
+ */
+export interface LengthConstraints {
+	/** Smallest gap between text lines in mm (default 0.5) */
+	minLineGapMm?: number;
+	/**
+	 * When text may switch to font B: only for blocks that would wrap in
+	 * font A (default), for every plain block, or never
+	 */
+	fontB?: 'wrapping' | 'always' | 'never';
+	/** Longest run of blank lines or feeds kept (default 1) */
+	maxBlankLines?: number;
+}
+
+export interface LengthReport {
+	beforeMm: number;
+	afterMm: number;
+	savedMm: number;
+}
+
+const FONTS = {
+	A: { width: 12, height: 24 },
+	B: { width: 9, height: 17 },
+} as const;
+
+// ESC 2 selects 1/6 inch line pitch
+const defaultPitch = (profile: PrinterProfile): number =>
+	Math.round((25.4 / 6) * profile.dotsPerMm);
+
+function wrappedLines(text: string, columns: number): number {
+	return text
+		.replace(/\n$/, '')
+		.split('\n')
+		.reduce(
+			(total, line) =>
+				total + Math.max(1, Math.ceil([...line].length / columns)),
+			0,
+		);
+}
+
+type TextOp = Extract<JobOp, { type: 'text' }>;
+
+const columns = (
+	font: { width: number },
+	profile: PrinterProfile,
+	scale = 1,
+): number =>
+	Math.max(1, Math.floor(profile.printWidthDots / (font.width * scale)));
+
+function textHeight(op: TextOp, profile: PrinterProfile): number {
+	const scale = Math.max(1, Math.min(8, op.scale ?? 1));
+	const font = FONTS[op.font ?? 'A'];
+	const pitch = Math.max(
+		op.lineSpacing ?? defaultPitch(profile),
+		font.height * scale,
+	);
+	return wrappedLines(op.text, columns(font, profile, scale)) * pitch;
+}
+
+/**
+ * Estimated paper length of a job in dots
+ */
+export function estimateJobLength(
+	ops: readonly JobOp[],
+	profile: PrinterProfile,
+): number {
+	let dots = 0;
+	for (const op of ops) {
+		switch (op.type) {
+			case 'text':
+				dots += textHeight(op, profile);
+				break;
+			case 'raster':
+				dots += op.bitmap.height;
+				break;
+			case 'symbol':
+				dots += layoutSymbol(op.symbology, op.data, op, profile).height;
+				break;
+			case 'feed':
+				dots += op.lines * defaultPitch(profile);
+				break;
+		}
+	}
+	return dots;
+}
+
+const collapseBlankLines = (text: string, maxBlankLines: number): string =>
+	text.replace(/\n{2,}/g, (run) =>
+		'\n'.repeat(Math.min(run.length, maxBlankLines + 1)),
+	);
+
+/**
+ * Rewrite text blocks with tighter line pitch and, where allowed, font B,
+ * and collapse runs of blank lines and feeds. Blocks that already set a
+ * font or line spacing, and scaled headings, keep their style.
+ */
+export function optimizeJobLength(
+	ops: readonly JobOp[],
+	profile: PrinterProfile,
+	constraints: LengthConstraints = {},
+): { ops: JobOp[]; report: LengthReport } {
+	const {
+		minLineGapMm = 0.5,
+		fontB = 'wrapping',
+		maxBlankLines = 1,
+	} = constraints;
+	const gap = Math.ceil(minLineGapMm * profile.dotsPerMm);
+	const optimized: JobOp[] = [];
+
+	// A single feed is kept as the tear-off margin
+	const maxFeedLines = Math.max(1, maxBlankLines);
+
+	for (const op of ops) {
+		if (op.type === 'feed') {
+			const previous = optimized[optimized.length - 1];
+			if (previous?.type === 'feed') {
+				previous.lines = Math.min(previous.lines + op.lines, maxFeedLines);
+			} else {
+				optimized.push({ ...op, lines: Math.min(op.lines, maxFeedLines) });
+			}
+			continue;
+		}
+
+		if (
+			op.type !== 'text' ||
+			op.font !== undefined ||
+			op.lineSpacing !== undefined ||
+			(op.scale ?? 1) > 1
+		) {
+			optimized.push(op);
+			continue;
+		}
+
+		const text = collapseBlankLines(op.text, maxBlankLines);
+		const fontA: TextOp = {
+			...op,
+			text,
+			font: 'A',
+			lineSpacing: FONTS.A.height + gap,
+		};
+		let best = fontA;
+		if (
+			fontB === 'always' ||
+			(fontB === 'wrapping' &&
+				wrappedLines(text, columns(FONTS.B, profile)) <
+					wrappedLines(text, columns(FONTS.A, profile)))
+		) {
+			const candidate: TextOp = {
+				...op,
+				text,
+				font: 'B',
+				lineSpacing: FONTS.B.height + gap,
+			};
+			if (textHeight(candidate, profile) < textHeight(fontA, profile)) {
+				best = candidate;
+			}
+		}
+		// Font A at the default pitch or looser needs no commands at all
+		optimized.push(
+			best === fontA && gap + FONTS.A.height >= defaultPitch(profile)
+				? { ...op, text }
+				: best,
+		);
+	}
+
+	const before = estimateJobLength(ops, profile);
+	const after = estimateJobLength(optimized, profile);
+	const toMm = (dots: number) =>
+		Math.round((dots / profile.dotsPerMm) * 10) / 10;
+	return {
+		ops: optimized,
+		report: {
+			beforeMm: toMm(before),
+			afterMm: toMm(after),
+			savedMm: toMm(before - after),
+		},
+	};
+}
@@ -0,0 +1,373 @@
+import * as fs from 'node:fs';
+import { inspect } from 'node:util';
+
+export type LogLevel = 'trace' | 'debug' | 'info' | 'warn' | 'error' | 'silent';
+export type LogFields = Record<string, unknown>;
+
+export interface LogRecord {
+	time: number;
+	level: Exclude<LogLevel, 'silent'>;
+	subsystem: string;
+	message: string;
+	fields: LogFields | undefined;
+}
+
+/**
+ * Receives batches of records after the logging call has returned. A
+ * returned promise holds back the next batch until it settles.
+ */
+export type LogSink = (records: LogRecord[]) => void | Promise<void>;
+
+export interface LoggingOptions {
+	/** Level for subsystems without their own (default info) */
+	level?: LogLevel;
+	/** Per-subsystem levels, e.g. { printer: 'debug', usb: 'warn' } */
+	subsystems?: Record<string, LogLevel>;
+	/** Where records go (default: formatted lines on stdout/stderr) */
+	sink?: LogSink;
+	/** Records kept in the ring buffer (default 1024) */
+	capacity?: number;
+}
+
+const LEVELS: Record<LogLevel, number> = {
+	trace: 10,
+	debug: 20,
+	info: 30,
+	warn: 40,
+	error: 50,
+	silent: 100,
+};
+
+const isLogLevel = (value: string): value is LogLevel => value in LEVELS;
+
+/**
+ * A subsystem's logger. Calls below the subsystem's level return after one
+ * comparison; enabled calls copy their arguments into a preallocated ring
+ * slot, and formatting and output happen later on the sink. Fields are
+ * formatted when flushed, so pass values rather than building strings.
+ */
+export class Logger {
+	/** Numeric level; updated in place by configureLogging */
+	threshold = LEVELS.info;
+
+	constructor(readonly subsystem: string) {}
+
+	isEnabled(level: Exclude<LogLevel, 'silent'>): boolean {
+		return LEVELS[level] >= this.threshold;
+	}
+
+	trace(message: string, fields?: LogFields): void {
+		if (this.threshold <= LEVELS.trace) {
+			ring.push('trace', this.subsystem, message, fields);
+		}
+	}
+
+	debug(message: string, fields?: LogFields): void {
+		if (this.threshold <= LEVELS.debug) {
+			ring.push('debug', this.subsystem, message, fields);
+		}
+	}
+
+	info(message: string, fields?: LogFields): void {
+		if (this.threshold <= LEVELS.info) {
+			ring.push('info', this.subsystem, message, fields);
+		}
+	}
+
+	warn(message: string, fields?: LogFields): void {
+		if (this.threshold <= LEVELS.warn) {
+			ring.push('warn', this.subsystem, message, fields);
+		}
+	}
+
+	error(message: string, fields?: LogFields): void {
+		if (this.threshold <= LEVELS.error) {
+			ring.push('error', this.subsystem, message, fields);
+		}
+	}
+}
+
+const formatValue = (value: unknown): string => {
+	if (value instanceof Error) {
+		return value.stack ?? `${value.name}: ${value.message}`;
+	}
+	if (typeof value === 'string') {
+		return /\s/.test(value) ? JSON.stringify(value) : value;
+	}
+	return inspect(value, { breakLength: Number.POSITIVE_INFINITY, depth: 4 });
+};
+
+/**
+ * `2026-01-01T10:00:00.000Z INFO  [printer] message key=value`
+ */
+export function formatLogRecord(record: LogRecord): string {
+	let line = `${new Date(record.time).toISOString()} ${record.level
+		.toUpperCase()
+		.padEnd(5)} [${record.subsystem}] ${record.message}`;
+	if (record.fields) {
+		for (const [key, value] of Object.entries(record.fields)) {
+			line += ` ${key}=${formatValue(value)}`;
+		}
+	}
+	return line;
+}
+
+const formatBatch = (records: LogRecord[]): { out: string; err: string } => {
+	let out = '';
+	let err = '';
+	for (const record of records) {
+		const line = `${formatLogRecord(record)}\n`;
+		if (LEVELS[record.level] >= LEVELS.warn) {
+			err += line;
+		} else {
+			out += line;
+		}
+	}
+	return { out, err };
+};
+
+/**
+ * Default sink: one write per batch to stdout (trace..info) and stderr
+ * (warn, error) instead of one per line
+ */
+export const consoleSink: LogSink = (records) => {
+	const { out, err } = formatBatch(records);
+	if (out) {
+		process.stdout.write(out);
+	}
+	if (err) {
+		process.stderr.write(err);
+	}
+};
+
+/**
+ * Sink appending formatted lines to a file through a write stream, so
+ * writes run on the libuv thread pool
+ */
+export function fileSink(file: string): LogSink {
+	const stream = fs.createWriteStream(file, { flags: 'a' });
+	stream.on('error', () => {});
+	return (records) =>
+		new Promise<void>((resolve) => {
+			const { out, err } = formatBatch(records);
+			stream.write(out + err, () => resolve());
+		});
+}
+
+/**
+ * Fixed-capacity ring of reusable record slots. Records are handed to the
+ * sink once per event-loop turn; if the sink falls a whole ring behind,
+ * the oldest unflushed records are dropped and counted.
+ */
+class LogRing {
+	private slots: LogRecord[] = [];
+	// Sequence numbers; slot = sequence % capacity
+	private written = 0;
+	private flushed = 0;
+	private dropped = 0;
+	private scheduled = false;
+	private sinking: Promise<void> | undefined;
+	sink: LogSink = consoleSink;
+
+	constructor(capacity: number) {
+		this.resize(capacity);
+	}
+
+	/**
+	 * Change the capacity, keeping the newest records and what is unflushed
+	 */
+	resize(capacity: number): void {
+		const kept = this.recent();
+		const unflushed = this.written - this.flushed;
+		const size = Math.max(16, Math.floor(capacity));
+		this.slots = Array.from({ length: size }, (_, index) => ({
+			time: 0,
+			level: 'info' as const,
+			subsystem: '',
+			message: '',
+			fields: undefined,
+			...kept[kept.length - Math.min(size, kept.length) + index],
+		}));
+		this.written = Math.min(size, kept.length);
+		this.flushed = Math.max(0, this.written - unflushed);
+	}
+
+	push(
+		level: LogRecord['level'],
+		subsystem: string,
+		message: string,
+		fields: LogFields | undefined,
+	): void {
+		const slot = this.slots[this.written % this.slots.length];
+		slot.time = Date.now();
+		slot.level = level;
+		slot.subsystem = subsystem;
+		slot.message = message;
+		slot.fields = fields;
+		this.written++;
+		if (this.written - this.flushed > this.slots.length) {
+			this.dropped += this.written - this.flushed - this.slots.length;
+			this.flushed = this.written - this.slots.length;
+		}
+		if (!this.scheduled) {
+			this.scheduled = true;
+			setImmediate(() => {
+				this.scheduled = false;
+				void this.flush();
+			});
+		}
+	}
+
+	/**
+	 * Copies of the records still in the ring, oldest first
+	 */
+	recent(): LogRecord[] {
+		const start = Math.max(0, this.written - this.slots.length);
+		return this.copy(start, this.written);
+	}
+
+	async flush(): Promise<void> {
+		while (this.sinking) {
+			await this.sinking;
+		}
+		const records = this.takeUnflushed();
+		if (records.length === 0) {
+			return;
+		}
+		try {
+			const result = this.sink(records);
+			if (result) {
+				this.sinking = result.finally(() => {
+					this.sinking = undefined;
+				});
+				await this.sinking;
+			}
+		} catch {
+			// A failing sink must not take the caller down with it
+		}
+	}
+
+	/**
+	 * Write what is left synchronously; used when the process exits
+	 */
+	flushSync(): void {
+		const { out, err } = formatBatch(this.takeUnflushed());
+		try {
+			if (out) {
+				fs.writeSync(1, out);
+			}
+			if (err) {
+				fs.writeSync(2, err);
+			}
+		} catch {
+			// stdout may already be closed
+		}
+	}
+
+	private takeUnflushed(): LogRecord[] {
+		const records = this.copy(this.flushed, this.written);
+		this.flushed = this.written;
+		if (this.dropped > 0) {
+			records.unshift({
+				time: Date.now(),
+				level: 'warn',
+				subsystem: 'logger',
+				message: 'Log records dropped; the sink fell behind',
+				fields: { dropped: this.dropped },
+			});
+			this.dropped = 0;
+		}
+		return records;
+	}
+
+	private copy(from: number, to: number): LogRecord[] {
+		const records: LogRecord[] = [];
+		for (let sequence = from; sequence < to; sequence++) {
+			records.push({ ...this.slots[sequence % this.slots.length] });
+		}
+		return records;
+	}
+}
+
+const ring = new LogRing(1024);
+const loggers = new Map<string, Logger>();
+let defaultLevel: LogLevel = 'info';
+let subsystemLevels: Record<string, LogLevel> = {};
+
+const levelOf = (subsystem: string): number =>
+	LEVELS[subsystemLevels[subsystem] ?? defaultLevel];
+
+/**
+ * The logger of a subsystem ('printer', 'device', 'scanner', ...)
+ */
+export function getLogger(subsystem: string): Logger {
+	let logger = loggers.get(subsystem);
+	if (!logger) {
+		logger = new Logger(subsystem);
+		logger.threshold = levelOf(subsystem);
+		loggers.set(subsystem, logger);
+	}
+	return logger;
+}
+
+/**
+ * Change levels, sink or ring size for every logger in this thread. The
+ * device worker reads ESCPOS_LOG instead, e.g. `warn,printer=debug`.
+ */
+export function configureLogging(options: LoggingOptions): void {
+	if (options.level) {
+		defaultLevel = options.level;
+	}
+	if (options.subsystems) {
+		subsystemLevels = { ...subsystemLevels, ...options.subsystems };
+	}
+	if (options.sink) {
+		ring.sink = options.sink;
+	}
+	if (options.capacity) {
+		ring.resize(options.capacity);
+	}
+	for (const logger of loggers.values()) {
+		logger.threshold = levelOf(logger.subsystem);
+	}
+}
+
+/**
+ * Hand every pending record to the sink
+ */
+export function flushLogs(): Promise<void> {
+	return ring.flush();
+}
+
+/**
+ * The most recent records, including ones already flushed
+ */
+export function getRecentLogs(): LogRecord[] {
+	return ring.recent();
+}
+
+// `level` or `level,subsystem=level,...`
+const parseLogEnv = (value: string): void => {
+	const subsystems: Record<string, LogLevel> = {};
+	let level: LogLevel | undefined;
+	for (const part of value.split(',')) {
+		const [name, setting] = part.trim().split('=');
+		if (setting === undefined && isLogLevel(name)) {
+			level = name;
+		} else if (setting !== undefined && isLogLevel(setting)) {
+			subsystems[name] = setting;
+		}
+	}
+	configureLogging({ level, subsystems });
+};
+
+if (process.env.ESCPOS_LOG) {
+	parseLogEnv(process.env.ESCPOS_LOG);
+}
+
+// Records of the last event-loop turn would otherwise be lost
+process.on('exit', () => {
+	if (ring.sink === consoleSink) {
+		ring.flushSync();
+	}
+});
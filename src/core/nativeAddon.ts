@@ -0,0 +1,332 @@
+export interface ThreadPoolStats {
+	size: number;
+	queuedHigh: number;
+	queuedNormal: number;
+	submitted: number;
+	executed: number;
+	steals: number;
+	workerQueueDepth: number[];
+	/** Threads of the lane that runs scanner and scale readers */
+	blockingThreads: number;
+	/** Of those, running a reader now */
+	blockingActive: number;
+}
+
+export interface JpegInfo {
+	width: number;
+	height: number;
+	components: number;
+	/** Baseline, 8-bit, grayscale or YCbCr: the native decoder handles it */
+	supported: boolean;
+	/** EXIF orientation, 1 when upright or absent */
+	orientation: number;
+}
+
+export interface SerialTuningStep {
+	status: 'applied' | 'skipped' | 'unsupported' | 'denied' | 'failed';
+	detail?: string;
+}
+
+export interface SerialLatencyReport {
+	/** Non-canonical termios, VMIN=1/VTIME=0 */
+	raw: SerialTuningStep;
+	/** ASYNC_LOW_LATENCY (Linux) or IOSSDATALAT (macOS) */
+	lowLatency: SerialTuningStep;
+	/** usb-serial latency timer in sysfs (FTDI and similar) */
+	latencyTimer: SerialTuningStep;
+	/** Latency timer in effect afterwards, -1 where the driver has none */
+	latencyTimerMs: number;
+}
+
+/** Characters of evdev key codes without and with shift, over the US map */
+export type EvdevKeymap = Record<number, [string, string?]>;
+
+export interface EvdevReader {
+	/**
+	 * Read on a native thread. onEnd gets null when stop() was called or a
+	 * recording ended, an error with code ENODEV when the scanner went away.
+	 */
+	start(
+		onScan: (scan: string) => void,
+		onEnd: (error: Error | null) => void,
+	): void;
+	stop(): void;
+}
+
+export interface DescriptorReceiver {
+	/**
+	 * Listen on a native thread. Each descriptor arrives mapped read-only,
+	 * or as the error mapping it failed with; onEnd gets null after stop().
+	 * On Linux only sealed memfds are mapped (EPERM otherwise); elsewhere
+	 * the contents are copied.
+	 */
+	start(
+		onPayload: (tag: string, payload: Buffer | Error) => void,
+		onEnd: (error: Error | null) => void,
+	): void;
+	/** Stop listening and remove the socket */
+	stop(): void;
+}
+
+/** Weight or price cut out of a compiled label, right-aligned to width */
+export interface WeighLabelField {
+	field: 'weight' | 'price';
+	/** Digits after the point (default 3 for weight, 2 for price) */
+	decimals?: number;
+	width?: number;
+	/** Fill for width (default a space); '0' goes after a minus sign */
+	pad?: string;
+	/** Leave out the decimal point, e.g. price digits for an EAN-13 */
+	minorUnits?: boolean;
+}
+
+export type WeighLabelTemplatePart = Uint8Array | string | WeighLabelField;
+
+export interface WeighLabelPipelineOptions {
+	scalePath: string;
+	baudRate?: number;
+	/** Printer transport URI, held open while the pipeline runs */
+	printer: string;
+	template: WeighLabelTemplatePart[];
+	/** Price per scale unit */
+	unitPrice?: number;
+	priceDecimals?: number;
+	/** Readings in a row within tolerance, for scales without a stable flag */
+	stableReadings?: number;
+	tolerance?: number;
+	/** At or below this the platter counts as empty and the trigger re-arms */
+	minWeight?: number;
+	writeTimeoutMs?: number;
+}
+
+export interface WeighLabelEvent {
+	type: 'weight' | 'print';
+	/** The scale's line as received */
+	line: string;
+	/** null when the line holds no weight (overload, error) */
+	weight: number | null;
+	unit: string;
+	stability: 'stable' | 'motion' | 'unknown';
+	/** Print events only */
+	price?: number;
+	bytes?: number;
+	/** From reading the weight line to the printer accepting the label */
+	weighToPrintMs?: number;
+	error?: Error;
+}
+
+export interface WeighLabelStats {
+	readings: number;
+	triggers: number;
+	printed: number;
+	failed: number;
+	lastMs: number;
+	meanMs: number;
+	maxMs: number;
+}
+
+export interface WeighLabelPipeline {
+	/**
+	 * Open the printer and read the scale on a native thread, and print a
+	 * label per settled item from that thread. Events arrive after the
+	 * label was written. onEnd gets null after stop(), an error with code
+	 * ENODEV when the scale went away, or the error the printer failed to
+	 * open with.
+	 */
+	start(
+		onEvent: (event: WeighLabelEvent) => void,
+		onEnd: (error: Error | null) => void,
+	): void;
+	stop(): void;
+	setUnitPrice(unitPrice: number): void;
+	getStats(): WeighLabelStats;
+}
+
+export interface NativeAddon {
+	Printer: unknown;
+	Transport: unknown;
+	/**
+	 * Keyboard-wedge scanner on a /dev/input/event node (Linux), grabbed so
+	 * it stops typing into the focused window; a recording of such a node
+	 * is replayed instead
+	 */
+	EvdevReader: new (
+		path: string,
+		options?: { grab?: boolean; keymap?: EvdevKeymap },
+	) => EvdevReader;
+	/**
+	 * Scans in raw struct input_event records, e.g. a recording made with
+	 * `cat /dev/input/eventN > scans.bin`
+	 */
+	decodeEvdevEvents(events: Buffer, keymap?: EvdevKeymap): string[];
+	/**
+	 * Serial scale bound to a label printer (POSIX); see
+	 * ScaleManager.startLabelTrigger
+	 */
+	WeighLabelPipeline: new (
+		options: WeighLabelPipelineOptions,
+	) => WeighLabelPipeline;
+	/**
+	 * The bytes a pipeline would print for weight and price
+	 */
+	renderWeighLabel(
+		template: WeighLabelTemplatePart[],
+		weight: number,
+		price: number,
+	): Buffer;
+	/**
+	 * Dither and pack an RGBA bitmap into a GS v 0 block written to output
+	 * on the pool
+	 * @returns Bytes written
+	 */
+	rasterize(
+		rgba: Buffer,
+		width: number,
+		height: number,
+		threshold: number,
+		dither: boolean,
+		output: Buffer,
+	): Promise<number>;
+	/**
+	 * Frame header of a JPEG without decoding it
+	 * @returns null when the buffer is not a JPEG
+	 */
+	readJpegInfo(jpeg: Buffer): JpegInfo | null;
+	/**
+	 * Decode a baseline JPEG's luma at a reduced DCT scale, resize it to
+	 * width x height and dither it into a GS v 0 block written to output on
+	 * the pool
+	 * @returns Bytes written
+	 */
+	rasterizeJpeg(
+		jpeg: Buffer,
+		width: number,
+		height: number,
+		threshold: number,
+		dither: boolean,
+		output: Buffer,
+	): Promise<number>;
+	/**
+	 * Render an SVG exactly width dots wide and dither it on the pool
+	 * @returns A new GS v 0 block
+	 */
+	rasterizeSvg(
+		svg: Buffer,
+		width: number,
+		threshold: number,
+		dither: boolean,
+	): Promise<Buffer>;
+	/**
+	 * Encode an ECC 200 Data Matrix and rasterize it at moduleSize dots per
+	 * module with a one-module quiet zone
+	 * @returns A new GS v 0 block
+	 */
+	encodeDataMatrix(data: Buffer, moduleSize: number): Buffer;
+	/**
+	 * Map a whole file read-only; pages are shared with other processes
+	 * mapping it. Writing to the buffer crashes the process.
+	 * @returns null where external buffers are not allowed (Electron)
+	 */
+	mapFile(path: string): Buffer | null;
+	/**
+	 * Writable anonymous shared memory of size bytes (POSIX): a memfd on
+	 * Linux. Only fd gives access to it; fill the buffer, seal it with
+	 * sealSharedMemory, hand fd to another process with sendDescriptor,
+	 * then close it.
+	 * @returns null where external buffers are not allowed (Electron)
+	 */
+	createSharedMemory(
+		name: string,
+		size: number,
+	): { fd: number; buffer: Buffer } | null;
+	/**
+	 * Make the buffer of createSharedMemory read-only before its descriptor
+	 * is sent: on Linux the memfd is sealed against writes and resizing, so
+	 * no process can change it any more. Writing to the buffer afterwards
+	 * crashes the process. A no-op where memfds do not exist.
+	 */
+	sealSharedMemory(buffer: Buffer): void;
+	/**
+	 * Pass an open descriptor to the DescriptorReceiver listening on
+	 * socketPath (SCM_RIGHTS, POSIX). fd stays open in this process.
+	 */
+	sendDescriptor(socketPath: string, tag: string, fd: number): Promise<void>;
+	/**
+	 * Receives descriptors from processes of the same user on a Unix
+	 * domain socket (POSIX); the counterpart of sendDescriptor
+	 */
+	DescriptorReceiver: new (socketPath: string) => DescriptorReceiver;
+	/**
+	 * Tune an open tty for low read latency; unsupported steps are
+	 * reported, not thrown
+	 */
+	configureSerialLatency(
+		fd: number,
+		options?: { raw?: boolean; lowLatency?: boolean; latencyTimerMs?: number },
+	): SerialLatencyReport;
+	configureThreadPool(size: number): number;
+	getThreadPoolStats(): ThreadPoolStats;
+}
+
+let nativeAddon: NativeAddon | null | undefined;
+let loadError: unknown;
+
+/**
+ * Loads the compiled addon once and shares it between every native feature
+ * @returns The addon exports, or null when the module could not be loaded
+ */
+export function loadNativeAddon(): NativeAddon | null {
+	if (nativeAddon !== undefined) {
+		return nativeAddon;
+	}
+
+	try {
+		nativeAddon = require('bindings')('escpos-lib') as NativeAddon;
+	} catch (error) {
+		loadError = error;
+		nativeAddon = null;
+	}
+	return nativeAddon;
+}
+
+/**
+ * Error raised by the last failed load attempt, if any
+ */
+export function getNativeAddonLoadError(): unknown {
+	return loadError;
+}
+
+/**
+ * Resize the native worker pool shared by image processing, encoding,
+ * transport I/O and serial readers. Pass 0 to restore the default size
+ * (ESCPOS_THREADPOOL_SIZE, or the core count clamped to 2..8).
+ * @returns The effective pool size, or 0 without the native addon
+ */
+export function configureThreadPool(size: number): number {
+	const addon = loadNativeAddon();
+	if (!addon) {
+		return 0;
+	}
+	return addon.configureThreadPool(size);
+}
+
+/**
+ * Queue depth and work-stealing counters of the native worker pool
+ */
+export function getThreadPoolStats(): ThreadPoolStats {
+	const addon = loadNativeAddon();
+	if (!addon) {
+		return {
+			size: 0,
+			queuedHigh: 0,
+			queuedNormal: 0,
+			submitted: 0,
+			executed: 0,
+			steals: 0,
+			workerQueueDepth: [],
+			blockingThreads: 0,
+			blockingActive: 0,
+		};
+	}
+	return addon.getThreadPoolStats();
+}
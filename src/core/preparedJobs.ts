@@ -0,0 +1,158 @@
+import { randomUUID } from 'node:crypto';
+import { jobBufferPool } from './bufferPool';
+import { PrintJobError } from './windows_printer';
+
+/**
+ * Handle to a job rendered ahead of time by PrinterManager.preparePrint.
+ * Plain data, so it can cross the worker boundary.
+ */
+export interface PreparedPrintJob {
+	readonly id: string;
+	readonly deviceId: string;
+	readonly data: string;
+	readonly isImage: boolean;
+	/** Rendered bytes held for the job; 0 when it is encoded at commit */
+	readonly bytes: number;
+	/** Epoch ms after which the bytes are dropped */
+	readonly expiresAt: number;
+}
+
+export interface PreparedJobStoreOptions {
+	/** Rendered bytes held across all prepared jobs (default 32 MiB) */
+	maxBytes?: number;
+	/** Default lifetime of a prepared job (default 2 minutes) */
+	ttlMs?: number;
+}
+
+export interface PreparedJobStoreStats {
+	jobs: number;
+	bytes: number;
+	/** Jobs whose bytes were dropped by the budget, trim() or their TTL */
+	evicted: number;
+}
+
+interface HeldJob {
+	buffer: Buffer;
+	timer: NodeJS.Timeout;
+}
+
+// Committed and discarded ids remembered to reject a second commit
+const SETTLED_LIMIT = 1024;
+
+/**
+ * Rendered bytes of prepared jobs, oldest first. When the budget is
+ * exceeded, a TTL passes or trim() is called, the bytes are dropped but
+ * the handle stays valid: committing it encodes the job again, so memory
+ * pressure costs time, never a receipt.
+ */
+export class PreparedJobStore {
+	private readonly held = new Map<string, HeldJob>();
+	private readonly settled = new Set<string>();
+	private readonly maxBytes: number;
+	private readonly ttlMs: number;
+	private bytes = 0;
+	private evicted = 0;
+
+	constructor(options: PreparedJobStoreOptions = {}) {
+		this.maxBytes = options.maxBytes ?? 32 * 1024 * 1024;
+		this.ttlMs = options.ttlMs ?? 120_000;
+	}
+
+	/**
+	 * Hold a rendered job (from jobBufferPool) and hand out its handle
+	 */
+	add(
+		deviceId: string,
+		data: string,
+		isImage: boolean,
+		buffer: Buffer | undefined,
+		ttlMs = this.ttlMs,
+	): PreparedPrintJob {
+		const id = randomUUID();
+		const expiresAt = Date.now() + ttlMs;
+		if (!buffer || buffer.length > this.maxBytes) {
+			if (buffer) {
+				jobBufferPool.release(buffer);
+			}
+			return { id, deviceId, data, isImage, bytes: 0, expiresAt };
+		}
+
+		while (this.bytes + buffer.length > this.maxBytes) {
+			const oldest = this.held.keys().next().value as string;
+			this.drop(oldest);
+			this.evicted++;
+		}
+		const timer = setTimeout(() => {
+			this.drop(id);
+			this.evicted++;
+		}, ttlMs);
+		timer.unref();
+		this.held.set(id, { buffer, timer });
+		this.bytes += buffer.length;
+		return { id, deviceId, data, isImage, bytes: buffer.length, expiresAt };
+	}
+
+	/**
+	 * Claim a job for printing
+	 * @returns Its rendered bytes, or undefined when they were dropped
+	 */
+	take(job: PreparedPrintJob): Buffer | undefined {
+		if (this.settled.has(job.id)) {
+			throw new PrintJobError(
+				'Prepared job was already committed or discarded',
+			);
+		}
+		this.settle(job.id);
+		const held = this.held.get(job.id);
+		if (!held) {
+			return undefined;
+		}
+		clearTimeout(held.timer);
+		this.held.delete(job.id);
+		this.bytes -= held.buffer.length;
+		return held.buffer;
+	}
+
+	/**
+	 * Drop a job that will not be printed (e.g. the payment failed)
+	 */
+	discard(job: PreparedPrintJob): void {
+		this.settle(job.id);
+		this.drop(job.id);
+	}
+
+	/**
+	 * Drop every held rendering, e.g. under memory pressure
+	 * @returns Bytes freed
+	 */
+	trim(): number {
+		const freed = this.bytes;
+		for (const id of [...this.held.keys()]) {
+			this.drop(id);
+			this.evicted++;
+		}
+		return freed;
+	}
+
+	stats(): PreparedJobStoreStats {
+		return { jobs: this.held.size, bytes: this.bytes, evicted: this.evicted };
+	}
+
+	private drop(id: string): void {
+		const held = this.held.get(id);
+		if (!held) {
+			return;
+		}
+		clearTimeout(held.timer);
+		this.held.delete(id);
+		this.bytes -= held.buffer.length;
+		jobBufferPool.release(held.buffer);
+	}
+
+	private settle(id: string): void {
+		this.settled.add(id);
+		if (this.settled.size > SETTLED_LIMIT) {
+			this.settled.delete(this.settled.values().next().value as string);
+		}
+	}
+}
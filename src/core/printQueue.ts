@@ -0,0 +1,319 @@
+import { jobBufferPool } from './bufferPool';
+import type { PrintJobOptions } from './types';
+import {
+	PrintJobCancelledError,
+	PrintJobTimeoutError,
+} from './windows_printer';
+
+export interface PrintJobContext {
+	/** Aborted when the job is cancelled or its deadline passes */
+	signal: AbortSignal;
+	timeoutMs?: number;
+	/** The previous job on this device was interrupted; start with ESC @ */
+	reset: boolean;
+	/**
+	 * The job's bytes rendered ahead by its preparer (never with reset).
+	 * The runner owns the buffer and returns it to jobBufferPool.
+	 */
+	prepared?: Promise<Buffer | undefined>;
+}
+
+export type PrintJobRunner = (context: PrintJobContext) => Promise<void>;
+
+/**
+ * Renders a job's bytes (from jobBufferPool) while earlier jobs print;
+ * undefined when there is nothing to render ahead
+ */
+export type PrintJobPreparer = () => Promise<Buffer | undefined>;
+
+export interface PrintQueueOptions {
+	/** Queued jobs per device rendered ahead of time (default 2, 0 disables) */
+	lookahead?: number;
+	/**
+	 * Rendered, unsent bytes across all devices (default 32 MiB). A job's
+	 * size is known only once it is rendered, so one job at a time is
+	 * rendered ahead and the last one may go over the budget.
+	 */
+	lookaheadBytes?: number;
+}
+
+interface QueuedJob {
+	run: PrintJobRunner;
+	timeoutMs?: number;
+	signal?: AbortSignal;
+	controller: AbortController;
+	timer?: NodeJS.Timeout;
+	resolve: () => void;
+	reject: (error: Error) => void;
+	detach: () => void;
+	prepare?: PrintJobPreparer;
+	prepared?: Promise<Buffer | undefined>;
+	/** Counted against the lookahead budget until the job starts or drops */
+	preparedBytes: number;
+	preparing: boolean;
+}
+
+/**
+ * Serialises jobs per device while letting different devices print
+ * concurrently. A job that is cancelled or misses its deadline is rejected
+ * immediately and the device moves on to its next job without waiting for
+ * the interrupted write to unwind; the adapters' session pools hold that
+ * job's write back until the device's session is free again.
+ *
+ * While a device prints, the next queued jobs that have a preparer are
+ * rendered ahead within a memory budget, so the device finds its next job
+ * ready as soon as the current one ends.
+ */
+export class PrintQueue {
+	private queues = new Map<string, QueuedJob[]>();
+	private active = new Map<string, QueuedJob>();
+	private needsReset = new Set<string>();
+	private readonly lookahead: number;
+	private readonly lookaheadBytes: number;
+	private preparedBytes = 0;
+	/** A job being rendered ahead; its bytes are not counted yet */
+	private rendering = false;
+
+	constructor(options: PrintQueueOptions = {}) {
+		this.lookahead = Math.max(0, options.lookahead ?? 2);
+		this.lookaheadBytes = options.lookaheadBytes ?? 32 * 1024 * 1024;
+	}
+
+	enqueue(
+		deviceId: string,
+		run: PrintJobRunner,
+		options: PrintJobOptions = {},
+		/** Renders the job ahead, or the bytes themselves if already rendered */
+		prepare?: PrintJobPreparer | Buffer,
+	): Promise<void> {
+		const { timeoutMs, signal } = options;
+		if (signal?.aborted) {
+			if (Buffer.isBuffer(prepare)) {
+				jobBufferPool.release(prepare);
+			}
+			return Promise.reject(new PrintJobCancelledError());
+		}
+
+		return new Promise<void>((resolve, reject) => {
+			const job: QueuedJob = {
+				run,
+				timeoutMs,
+				signal,
+				controller: new AbortController(),
+				resolve,
+				reject,
+				detach: () => {},
+				prepare: Buffer.isBuffer(prepare) ? undefined : prepare,
+				preparedBytes: 0,
+				preparing: false,
+			};
+			if (Buffer.isBuffer(prepare)) {
+				job.prepared = Promise.resolve(prepare);
+				job.preparing = true;
+				job.preparedBytes = prepare.length;
+				this.preparedBytes += prepare.length;
+			}
+
+			if (signal) {
+				const onAbort = () => this.abortJob(deviceId, job);
+				signal.addEventListener('abort', onAbort, { once: true });
+				job.detach = () => signal.removeEventListener('abort', onAbort);
+			}
+
+			const queue = this.queues.get(deviceId) ?? [];
+			queue.push(job);
+			this.queues.set(deviceId, queue);
+			this.pump(deviceId);
+			this.prefetch(deviceId);
+		});
+	}
+
+	/**
+	 * Cancel every queued and in-flight job for a device
+	 * @returns Number of jobs cancelled
+	 */
+	cancelDevice(deviceId: string): number {
+		// Drop waiting jobs first so none of them starts once the active one ends
+		const jobs = [...(this.queues.get(deviceId) ?? [])];
+		const activeJob = this.active.get(deviceId);
+		if (activeJob) {
+			jobs.push(activeJob);
+		}
+
+		for (const job of jobs) {
+			this.abortJob(deviceId, job);
+		}
+		return jobs.length;
+	}
+
+	/**
+	 * Bytes rendered ahead for queued jobs and not yet sent
+	 */
+	getPreparedBytes(): number {
+		return this.preparedBytes;
+	}
+
+	/**
+	 * Jobs waiting or writing for a device
+	 */
+	getQueueDepth(deviceId: string): number {
+		return (
+			(this.queues.get(deviceId)?.length ?? 0) +
+			(this.active.has(deviceId) ? 1 : 0)
+		);
+	}
+
+	private abortJob(deviceId: string, job: QueuedJob): void {
+		const queue = this.queues.get(deviceId);
+		const index = queue?.indexOf(job) ?? -1;
+		if (queue && index > -1) {
+			queue.splice(index, 1);
+			job.detach();
+			this.discardPrepared(job);
+			job.reject(new PrintJobCancelledError());
+			return;
+		}
+
+		if (this.active.get(deviceId) === job) {
+			this.finish(deviceId, job, new PrintJobCancelledError());
+		}
+	}
+
+	private pump(deviceId: string): void {
+		if (this.active.has(deviceId)) {
+			return;
+		}
+
+		const job = this.queues.get(deviceId)?.shift();
+		if (!job) {
+			this.queues.delete(deviceId);
+			return;
+		}
+
+		this.active.set(deviceId, job);
+		const reset = this.needsReset.has(deviceId);
+		// Rendered without ESC @; an interrupted predecessor needs a fresh one
+		const prepared = reset ? undefined : this.claimPrepared(job);
+		if (reset) {
+			this.discardPrepared(job);
+		}
+
+		if (job.timeoutMs && job.timeoutMs > 0) {
+			const timeoutMs = job.timeoutMs;
+			job.timer = setTimeout(() => {
+				this.finish(deviceId, job, new PrintJobTimeoutError(timeoutMs));
+			}, timeoutMs);
+		}
+
+		job
+			.run({
+				signal: job.controller.signal,
+				timeoutMs: job.timeoutMs,
+				reset,
+				prepared,
+			})
+			.then(
+				() => {
+					if (this.active.get(deviceId) === job) {
+						this.needsReset.delete(deviceId);
+					}
+					this.finish(deviceId, job);
+				},
+				(error) =>
+					this.finish(
+						deviceId,
+						job,
+						error instanceof Error ? error : new Error(String(error)),
+					),
+			);
+		this.prefetch(deviceId);
+	}
+
+	/**
+	 * Start rendering the next queued jobs of a busy device, oldest first,
+	 * until the lookahead depth or the byte budget is reached
+	 */
+	private prefetch(deviceId: string): void {
+		if (!this.active.has(deviceId)) {
+			return;
+		}
+		const queue = this.queues.get(deviceId) ?? [];
+		for (const job of queue.slice(0, this.lookahead)) {
+			if (this.rendering || this.preparedBytes >= this.lookaheadBytes) {
+				return;
+			}
+			if (!job.prepare || job.prepared) {
+				continue;
+			}
+			job.preparing = true;
+			this.rendering = true;
+			job.prepared = job.prepare();
+			job.prepared.then(
+				(buffer) => {
+					// Jobs that started or dropped meanwhile are not held any more
+					if (job.preparing && buffer) {
+						job.preparedBytes = buffer.length;
+						this.preparedBytes += buffer.length;
+					}
+					this.rendered();
+				},
+				// Reported to the runner when the job starts
+				() => this.rendered(),
+			);
+		}
+	}
+
+	/**
+	 * Move on to the next job to render ahead, on any busy device
+	 */
+	private rendered(): void {
+		this.rendering = false;
+		for (const deviceId of this.active.keys()) {
+			this.prefetch(deviceId);
+		}
+	}
+
+	private claimPrepared(
+		job: QueuedJob,
+	): Promise<Buffer | undefined> | undefined {
+		job.preparing = false;
+		this.preparedBytes -= job.preparedBytes;
+		job.preparedBytes = 0;
+		return job.prepared;
+	}
+
+	private discardPrepared(job: QueuedJob): void {
+		this.claimPrepared(job)?.then(
+			(buffer) => buffer && jobBufferPool.release(buffer),
+			() => {},
+		);
+	}
+
+	private finish(deviceId: string, job: QueuedJob, error?: Error): void {
+		// Late completions of an interrupted job have already been reported
+		if (this.active.get(deviceId) !== job) {
+			return;
+		}
+
+		this.active.delete(deviceId);
+		clearTimeout(job.timer);
+		job.detach();
+
+		if (
+			error instanceof PrintJobCancelledError ||
+			error instanceof PrintJobTimeoutError
+		) {
+			// Printer state is unknown mid-job; the next job re-initialises it
+			this.needsReset.add(deviceId);
+			job.controller.abort();
+		}
+
+		if (error) {
+			job.reject(error);
+		} else {
+			job.resolve();
+		}
+
+		this.pump(deviceId);
+	}
+}
@@ -0,0 +1,155 @@
+import type { JobOp, MonoBitmap } from './jobBuilder';
+import {
+	type PrinterProfile,
+	type PrintTuning,
+	resolvePrinterProfile,
+} from './printerProfile';
+import { layoutSymbol, rasterizeSymbol, rasterizesSymbol } from './symbology';
+
+export interface JobAnalysis {
+	textOnly: boolean;
+	rasterDots: number;
+	blackDots: number;
+	/** Black dots over all raster dots */
+	blackRatio: number;
+	/** Black-dot ratio of the densest raster; dense rasters fade first */
+	peakBlackRatio: number;
+}
+
+export interface TuningSettings {
+	speed: number;
+	density: number;
+}
+
+// Rasters lighter than this print fine at full speed; at the heavy end
+// the slowest speed and darkest density are used
+const LIGHT_RASTER_RATIO = 0.08;
+const HEAVY_RASTER_RATIO = 0.4;
+
+// PDF417 and Data Matrix modules are close to half black by design; used
+// for symbols the printer draws itself, whose dots are never seen here
+const SYMBOL_BLACK_RATIO = 0.5;
+
+const POPCOUNT = new Uint8Array(256).map((_, byte) => {
+	let bits = 0;
+	for (let value = byte; value; value >>= 1) {
+		bits += value & 1;
+	}
+	return bits;
+});
+
+/**
+ * Count the black dots of every raster in a finished job, including the
+ * PDF417 and Data Matrix symbols it has. Symbols that encoding for profile
+ * rasterizes are counted dot for dot; those the printer draws are counted
+ * by their area.
+ */
+export function analyzeJob(
+	ops: readonly JobOp[],
+	profile: PrinterProfile = resolvePrinterProfile(),
+): JobAnalysis {
+	let rasterDots = 0;
+	let blackDots = 0;
+	let peakBlackRatio = 0;
+
+	const add = (dots: number, black: number) => {
+		rasterDots += dots;
+		blackDots += black;
+		if (dots > 0) {
+			peakBlackRatio = Math.max(peakBlackRatio, black / dots);
+		}
+	};
+	const addBitmap = (bitmap: MonoBitmap) => {
+		let black = 0;
+		for (const byte of bitmap.data) {
+			black += POPCOUNT[byte];
+		}
+		add(Math.ceil(bitmap.width / 8) * 8 * bitmap.height, black);
+	};
+
+	for (const op of ops) {
+		if (op.type === 'raster') {
+			addBitmap(op.bitmap);
+		} else if (op.type === 'symbol') {
+			const layout = layoutSymbol(op.symbology, op.data, op, profile);
+			if (rasterizesSymbol(op.symbology, profile)) {
+				// Cached, so encoding the job reuses this bitmap
+				addBitmap(rasterizeSymbol(layout));
+			} else {
+				const dots = layout.width * layout.height;
+				add(dots, Math.round(dots * SYMBOL_BLACK_RATIO));
+			}
+		}
+	}
+
+	return {
+		textOnly: rasterDots === 0,
+		rasterDots,
+		blackDots,
+		blackRatio: rasterDots > 0 ? blackDots / rasterDots : 0,
+		peakBlackRatio,
+	};
+}
+
+/**
+ * Fastest speed (and lightest density) that keeps the job legible:
+ * text-only and light jobs run flat out, dense rasters slow down and
+ * darken proportionally.
+ */
+export function chooseTuning(
+	analysis: JobAnalysis,
+	tuning: PrintTuning,
+): TuningSettings {
+	const heaviness = Math.max(
+		0,
+		Math.min(
+			1,
+			(analysis.peakBlackRatio - LIGHT_RASTER_RATIO) /
+				(HEAVY_RASTER_RATIO - LIGHT_RASTER_RATIO),
+		),
+	);
+	const { speed, density } = tuning;
+	return {
+		speed: Math.round(
+			speed.fastest - heaviness * (speed.fastest - speed.slowest),
+		),
+		density: Math.round(
+			density.normal + heaviness * (density.darkest - density.normal),
+		),
+	};
+}
+
+/**
+ * Speed and density commands in the profile's language
+ */
+export function encodeTuning(
+	settings: TuningSettings,
+	profile: PrinterProfile,
+): Buffer {
+	const { speed, density } = settings;
+	switch (profile.language) {
+		case 'zpl':
+			// ^PR and ^MD persist until changed, so a format of their own works
+			return Buffer.from(`^XA^PR${speed}^MD${density}^XZ\n`, 'ascii');
+		case 'tspl':
+			return Buffer.from(`SPEED ${speed}\r\nDENSITY ${density}\r\n`, 'ascii');
+		default:
+			// GS ( K fn 50 (speed) and fn 49 (density, signed)
+			return Buffer.from([
+				0x1d,
+				0x28,
+				0x4b,
+				0x02,
+				0x00,
+				0x32,
+				speed & 0xff,
+				0x1d,
+				0x28,
+				0x4b,
+				0x02,
+				0x00,
+				0x31,
+				density & 0xff,
+			]);
+	}
+}
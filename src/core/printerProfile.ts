@@ -0,0 +1,139 @@
+import type { Symbology } from './symbology';
+import type { DeviceConfig } from './types';
+
+export type PrinterLanguage = 'escpos' | 'zpl' | 'tspl';
+
+export interface PrinterCapabilities {
+	/** ZPL firmware accepts :Z64: (deflate) ^GF data; ACS hex otherwise */
+	zplZ64?: boolean;
+	/**
+	 * 2D symbols the ESC/POS firmware draws itself (GS ( k); others are
+	 * rasterized. ZPL and TSPL printers draw both natively.
+	 */
+	escposSymbols?: readonly Symbology[];
+}
+
+/**
+ * Print speed and density ranges in the model's own units. Speed levels
+ * grow faster, density levels grow darker.
+ */
+export interface PrintTuning {
+	speed: { slowest: number; fastest: number };
+	density: { normal: number; darkest: number };
+}
+
+/**
+ * What the encoder needs to know about a printer model: the command
+ * language it speaks and the geometry of its print head.
+ */
+export interface PrinterProfile {
+	id: string;
+	language: PrinterLanguage;
+	/** Print head resolution: 8 for 203 dpi, 12 for 300 dpi */
+	dotsPerMm: number;
+	/** Printable width in dots */
+	printWidthDots: number;
+	capabilities: PrinterCapabilities;
+	/**
+	 * Models that accept speed/density commands (GS ( K on ESC/POS, ^PR/^MD
+	 * on ZPL, SPEED/DENSITY on TSPL). Omitted for generic profiles, since
+	 * printers without the command may print it as text.
+	 */
+	tuning?: PrintTuning;
+}
+
+const profiles = new Map<string, PrinterProfile>();
+
+/**
+ * Add or replace a profile that DeviceConfig.profile can refer to
+ */
+export function registerPrinterProfile(profile: PrinterProfile): void {
+	profiles.set(profile.id, profile);
+}
+
+const BUILT_IN_PROFILES: PrinterProfile[] = [
+	{
+		id: 'escpos-80mm',
+		language: 'escpos',
+		dotsPerMm: 8,
+		printWidthDots: 576,
+		capabilities: {},
+	},
+	{
+		id: 'escpos-58mm',
+		language: 'escpos',
+		dotsPerMm: 8,
+		printWidthDots: 384,
+		capabilities: {},
+	},
+	{
+		id: 'escpos-epson-80mm',
+		language: 'escpos',
+		dotsPerMm: 8,
+		printWidthDots: 576,
+		capabilities: { escposSymbols: ['pdf417', 'datamatrix'] },
+		tuning: {
+			speed: { slowest: 1, fastest: 9 },
+			density: { normal: 0, darkest: 6 },
+		},
+	},
+	{
+		id: 'zpl-203dpi',
+		language: 'zpl',
+		dotsPerMm: 8,
+		printWidthDots: 832,
+		capabilities: { zplZ64: true },
+		tuning: {
+			speed: { slowest: 2, fastest: 6 },
+			density: { normal: 0, darkest: 10 },
+		},
+	},
+	{
+		id: 'zpl-300dpi',
+		language: 'zpl',
+		dotsPerMm: 12,
+		printWidthDots: 1248,
+		capabilities: { zplZ64: true },
+		tuning: {
+			speed: { slowest: 2, fastest: 6 },
+			density: { normal: 0, darkest: 10 },
+		},
+	},
+	{
+		id: 'tspl-203dpi',
+		language: 'tspl',
+		dotsPerMm: 8,
+		printWidthDots: 832,
+		capabilities: {},
+		tuning: {
+			speed: { slowest: 2, fastest: 6 },
+			density: { normal: 8, darkest: 12 },
+		},
+	},
+];
+
+for (const profile of BUILT_IN_PROFILES) {
+	registerPrinterProfile(profile);
+}
+
+export const DEFAULT_PRINTER_PROFILE_ID = 'escpos-80mm';
+
+export function getPrinterProfile(id: string): PrinterProfile | undefined {
+	return profiles.get(id);
+}
+
+export function getPrinterProfiles(): PrinterProfile[] {
+	return [...profiles.values()];
+}
+
+/**
+ * Profile for a configured device, falling back to an 80mm ESC/POS printer
+ */
+export function resolvePrinterProfile(
+	config?: Pick<DeviceConfig, 'profile'>,
+): PrinterProfile {
+	return (
+		(config?.profile && profiles.get(config.profile)) ||
+		(profiles.get(DEFAULT_PRINTER_PROFILE_ID) as PrinterProfile)
+	);
+}
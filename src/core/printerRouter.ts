@@ -0,0 +1,123 @@
+// Feed, cut and command overhead of one job, on top of its bytes
+const JOB_OVERHEAD_MS = 300;
+// Prior for a printer that has not completed a job yet (~250 mm/s text)
+const DEFAULT_MS_PER_BYTE = 0.5;
+// Weight of the newest job in the learned rate
+const RATE_SMOOTHING = 0.2;
+
+export interface PrinterRouterOptions {
+	/** How long a printer that reported an error is passed over (default 30 s) */
+	failureCooldownMs?: number;
+}
+
+export interface PrinterRouteEstimate {
+	deviceId: string;
+	/** Estimated time until a job sent now would finish */
+	estimatedMs: number;
+	queueDepth: number;
+	/** False while the printer is cooling down after an error */
+	healthy: boolean;
+}
+
+interface PrinterLoad {
+	msPerByte: number;
+	pendingBytes: number;
+	failedUntil: number;
+}
+
+/**
+ * Estimates when each printer of a group would finish a new job, from its
+ * queue depth, the bytes still queued for it and a print rate learned from
+ * the jobs it has completed. Printers that fail are ranked last until
+ * their cooldown passes.
+ */
+export class PrinterRouter {
+	private readonly loads = new Map<string, PrinterLoad>();
+	private readonly failureCooldownMs: number;
+
+	constructor(options: PrinterRouterOptions = {}) {
+		this.failureCooldownMs = options.failureCooldownMs ?? 30_000;
+	}
+
+	/**
+	 * Printers ordered best first: healthy before failed, then by estimated
+	 * completion time, then by queue depth
+	 */
+	rank(
+		deviceIds: readonly string[],
+		bytes: number,
+		queueDepth: (deviceId: string) => number,
+	): PrinterRouteEstimate[] {
+		const now = Date.now();
+		return deviceIds
+			.map((deviceId) => {
+				const load = this.load(deviceId);
+				const depth = queueDepth(deviceId);
+				return {
+					deviceId,
+					estimatedMs:
+						(depth + 1) * JOB_OVERHEAD_MS +
+						(load.pendingBytes + bytes) * load.msPerByte,
+					queueDepth: depth,
+					healthy: load.failedUntil <= now,
+				};
+			})
+			.sort(
+				(a, b) =>
+					Number(b.healthy) - Number(a.healthy) ||
+					a.estimatedMs - b.estimatedMs ||
+					a.queueDepth - b.queueDepth,
+			);
+	}
+
+	/**
+	 * A job of this size was queued for the printer
+	 */
+	begin(deviceId: string, bytes: number): void {
+		this.load(deviceId).pendingBytes += bytes;
+	}
+
+	/**
+	 * A job left the queue
+	 * @param writeMs Time the write took when it succeeded; learns the rate
+	 */
+	end(deviceId: string, bytes: number, writeMs?: number): void {
+		const load = this.load(deviceId);
+		load.pendingBytes = Math.max(0, load.pendingBytes - bytes);
+		if (writeMs === undefined) {
+			return;
+		}
+		load.failedUntil = 0;
+		if (bytes > 0) {
+			const sample = Math.max(0, writeMs - JOB_OVERHEAD_MS) / bytes;
+			load.msPerByte += (sample - load.msPerByte) * RATE_SMOOTHING;
+		}
+	}
+
+	/**
+	 * The printer failed a job or its adapter reported an error
+	 */
+	reportFailure(deviceId: string): void {
+		this.load(deviceId).failedUntil = Date.now() + this.failureCooldownMs;
+	}
+
+	/**
+	 * Forget a printer, e.g. once it disconnects
+	 */
+	remove(deviceId: string): void {
+		this.loads.delete(deviceId);
+	}
+
+	private load(deviceId: string): PrinterLoad {
+		let load = this.loads.get(deviceId);
+		if (!load) {
+			load = {
+				msPerByte: DEFAULT_MS_PER_BYTE,
+				pendingBytes: 0,
+				failedUntil: 0,
+			};
+			this.loads.set(deviceId, load);
+		}
+		return load;
+	}
+}
@@ -0,0 +1,192 @@
+import { getLogger } from './logger';
+
+const log = getLogger('printer');
+
+export interface PrinterSession {
+	/** Cheap probe run before an idle session is handed out again */
+	isHealthy(): boolean | Promise<boolean>;
+	/** Return value is ignored; a promise is awaited */
+	close(): unknown;
+}
+
+export interface PrinterSessionPoolOptions {
+	/** Close sessions nobody has used for this long (default 30s) */
+	idleTimeoutMs?: number;
+}
+
+export interface ReleaseOptions {
+	/** Close the session instead of keeping it, e.g. after a failed write */
+	discard?: boolean;
+}
+
+interface PoolEntry<T extends PrinterSession> {
+	session: Promise<T>;
+	/** The opened session, once session has resolved */
+	opened?: T;
+	idleTimer?: NodeJS.Timeout;
+}
+
+/** Held by the one job using a device's session */
+interface Holder<T> {
+	session?: T;
+	released: Promise<void>;
+	release: () => void;
+}
+
+/**
+ * Keeps one open session per device across print jobs so the spooler handle
+ * or USB interface is opened once rather than per receipt. Sessions are
+ * health-checked before reuse, closed after sitting idle, and dropped when a
+ * job reports them broken.
+ *
+ * A device's session has one user at a time. A job the print queue gave up
+ * on may still be unwinding its interrupted write; the next job waits for
+ * it to let go instead of writing to a busy session or opening a second
+ * connection to the same device.
+ */
+export class PrinterSessionPool<T extends PrinterSession> {
+	private entries = new Map<string, PoolEntry<T>>();
+	private holders = new Map<string, Holder<T>>();
+	private readonly idleTimeoutMs: number;
+
+	constructor(options: PrinterSessionPoolOptions = {}) {
+		this.idleTimeoutMs = options.idleTimeoutMs ?? 30_000;
+	}
+
+	/**
+	 * Hand out the open session for key, or open one with open(), once the
+	 * previous user has released it
+	 */
+	async acquire(key: string, open: () => Promise<T>): Promise<T> {
+		let holder = this.holders.get(key);
+		while (holder) {
+			await holder.released;
+			holder = this.holders.get(key);
+		}
+		const held = {} as Holder<T>;
+		held.released = new Promise((resolve) => {
+			held.release = () => {
+				if (this.holders.get(key) === held) {
+					this.holders.delete(key);
+				}
+				resolve();
+			};
+		});
+		this.holders.set(key, held);
+
+		try {
+			held.session = await this.checkOut(key, open);
+			return held.session;
+		} catch (error) {
+			held.release();
+			throw error;
+		}
+	}
+
+	release(key: string, session: T, options: ReleaseOptions = {}): void {
+		const holder = this.holders.get(key);
+		const handBack = holder?.session === session ? holder.release : () => {};
+		const entry = this.entries.get(key);
+		if (!entry || entry.opened !== session) {
+			// Already evicted; make sure the handle does not outlive the job
+			Promise.resolve(session.close()).then(handBack, handBack);
+			return;
+		}
+
+		if (options.discard) {
+			this.entries.delete(key);
+			// The next user opens a new session only once this one is closed
+			this.closeEntry(entry).then(handBack);
+			return;
+		}
+
+		entry.idleTimer = setTimeout(() => {
+			if (this.entries.get(key) === entry && !this.holders.has(key)) {
+				this.entries.delete(key);
+				this.closeEntry(entry);
+			}
+		}, this.idleTimeoutMs);
+		entry.idleTimer.unref();
+		handBack();
+	}
+
+	/**
+	 * Run fn with the device's session, releasing it afterwards.
+	 * A failing fn discards the session so the next job reopens it.
+	 */
+	async use<R>(
+		key: string,
+		open: () => Promise<T>,
+		fn: (session: T) => Promise<R>,
+	): Promise<R> {
+		const session = await this.acquire(key, open);
+		try {
+			const result = await fn(session);
+			this.release(key, session);
+			return result;
+		} catch (error) {
+			this.release(key, session, { discard: true });
+			throw error;
+		}
+	}
+
+	async closeSession(key: string): Promise<void> {
+		const entry = this.entries.get(key);
+		if (entry) {
+			this.entries.delete(key);
+			await this.closeEntry(entry);
+		}
+	}
+
+	async closeAll(): Promise<void> {
+		const keys = Array.from(this.entries.keys());
+		await Promise.all(keys.map((key) => this.closeSession(key)));
+	}
+
+	get size(): number {
+		return this.entries.size;
+	}
+
+	private async checkOut(key: string, open: () => Promise<T>): Promise<T> {
+		const entry = this.entries.get(key);
+		if (entry) {
+			clearTimeout(entry.idleTimer);
+			try {
+				const session = await entry.session;
+				if (await session.isHealthy()) {
+					entry.opened = session;
+					return session;
+				}
+			} catch {
+				// Opening failed earlier; fall through and open again
+			}
+
+			if (this.entries.get(key) === entry) {
+				this.entries.delete(key);
+				await this.closeEntry(entry);
+			}
+		}
+
+		const created: PoolEntry<T> = { session: open() };
+		this.entries.set(key, created);
+		try {
+			created.opened = await created.session;
+			return created.opened;
+		} catch (error) {
+			if (this.entries.get(key) === created) {
+				this.entries.delete(key);
+			}
+			throw error;
+		}
+	}
+
+	private async closeEntry(entry: PoolEntry<T>): Promise<void> {
+		clearTimeout(entry.idleTimer);
+		try {
+			const session = await entry.session;
+			await session.close();
+		} catch (error) {
+			log.error('Failed to close printer session', { error });
+		}
+	}
+}
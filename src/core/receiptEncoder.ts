@@ -0,0 +1,61 @@
+import { jobBufferPool } from './bufferPool';
+import { loadMonoBitmap, PrintJobBuilder } from './jobBuilder';
+import { type PrinterProfile, resolvePrinterProfile } from './printerProfile';
+import type { PrintData } from './types';
+
+export interface ReceiptEncodeOptions {
+	/** Prefix ESC @ to clear state left by an interrupted job */
+	reset?: boolean;
+	/** Target printer; decides the command language and raster width */
+	profile?: PrinterProfile;
+}
+
+/**
+ * Build the text or image payload accepted by
+ * PrinterManager.printToDevice as a job: the image centered, followed by
+ * a blank line and a full cut (or the end of the label).
+ */
+export async function buildReceipt(
+	data: PrintData,
+	isImage: boolean,
+	options: ReceiptEncodeOptions = {},
+): Promise<PrintJobBuilder> {
+	const profile = options.profile ?? resolvePrinterProfile();
+	const builder = new PrintJobBuilder();
+	if (options.reset) {
+		builder.reset();
+	}
+
+	if (!isImage) {
+		builder.text(typeof data === 'string' ? data : data.toString('utf8'));
+	} else {
+		const bitmap = await loadMonoBitmap(data, {
+			width: profile.printWidthDots,
+			dither: true,
+			threshold: 180,
+		});
+		builder.raster(bitmap, 'center');
+	}
+
+	return builder.feed(1).cut();
+}
+
+/**
+ * Encode a printToDevice payload into one raw job in the profile's
+ * command language. The job comes from jobBufferPool.
+ */
+export async function encodeReceipt(
+	data: PrintData,
+	isImage: boolean,
+	options: ReceiptEncodeOptions = {},
+): Promise<Buffer> {
+	const builder = await buildReceipt(data, isImage, options);
+	const job = builder.encode(options.profile);
+	// The raster blocks have been copied into the job
+	for (const op of builder.getOps()) {
+		if (op.type === 'raster') {
+			jobBufferPool.release(op.bitmap.data);
+		}
+	}
+	return job;
+}
@@ -1,3 +1,7 @@
+import { getLogger } from './logger';
+
+const log = getLogger('retry');
+
 export interface RetryOptions {
 	maxAttempts: number;
 	baseDelayMs: number;
@@ -53,9 +57,12 @@ export async function withExponentialBackoff<T>(
 			}
 
 			// Log retry attempt (but don't log the final failure here)
-			console.log(
-				`Port opening attempt ${attempt}/${config.maxAttempts} failed: ${lastError.message}. Retrying in ${delay}ms...`,
-			);
+			log.info('Port opening attempt failed, retrying', {
+				attempt,
+				maxAttempts: config.maxAttempts,
+				delayMs: delay,
+				error: lastError.message,
+			});
 
 			// Wait before retrying
 			await new Promise((resolve) => setTimeout(resolve, delay));
@@ -0,0 +1,114 @@
+import type { SerialPort } from 'serialport';
+import { getLogger } from './logger';
+import { loadNativeAddon, type SerialLatencyReport } from './nativeAddon';
+import type { SerialLatencyMode } from './types';
+
+const log = getLogger('device');
+
+export interface ReadLatencyStats {
+	/** Scans or weight lines delivered */
+	frames: number;
+	/** Reads that assembled them; one per frame suggests driver batching */
+	chunks: number;
+	/** From the first byte of a frame reaching Node to its delivery */
+	lastMs: number;
+	meanMs: number;
+	maxMs: number;
+	/** What the low-latency setup managed, null when it was off or failed */
+	tuning: SerialLatencyReport | null;
+}
+
+/**
+ * Put an open port into low-latency mode as far as mode asks for
+ * @returns The native report, or null when mode is off
+ */
+export function tuneSerialLatency(
+	port: SerialPort,
+	mode: SerialLatencyMode,
+	latencyTimerMs = 1,
+): SerialLatencyReport | null {
+	if (mode === 'off') {
+		return null;
+	}
+
+	// The unix bindings keep the descriptor on the binding port
+	const fd = (port.port as { fd?: unknown } | undefined)?.fd;
+	const addon = loadNativeAddon();
+	if (process.platform === 'win32' || typeof fd !== 'number' || !addon) {
+		if (mode === 'require') {
+			throw new Error(
+				`Low-latency serial mode is not available for ${port.path}`,
+			);
+		}
+		log.info('Low-latency serial mode not available', { path: port.path });
+		return null;
+	}
+
+	const report = addon.configureSerialLatency(fd, { latencyTimerMs });
+	const applied =
+		report.raw.status === 'applied' &&
+		(report.lowLatency.status === 'applied' ||
+			report.latencyTimer.status === 'applied');
+	if (mode === 'require' && !applied) {
+		throw new Error(
+			`Low-latency serial mode could not be applied to ${port.path}: ${
+				report.raw.detail ??
+				report.lowLatency.detail ??
+				report.latencyTimer.detail
+			}`,
+		);
+	}
+	log.debug('Serial latency tuned', {
+		path: port.path,
+		raw: report.raw.status,
+		lowLatency: report.lowLatency.status,
+		latencyTimer: report.latencyTimer.status,
+		latencyTimerMs: report.latencyTimerMs,
+	});
+	return report;
+}
+
+/**
+ * Tracks how long frames take from their first chunk to delivery. Driver
+ * batching shows up as fewer, larger chunks and late first chunks; idle
+ * timeouts for unterminated frames show up directly in the delay.
+ */
+export class ReadLatencyMeter {
+	tuning: SerialLatencyReport | null = null;
+	private frameStart = 0;
+	private frameChunks = 0;
+	private frames = 0;
+	private chunks = 0;
+	private totalMs = 0;
+	private lastMs = 0;
+	private maxMs = 0;
+
+	chunk(): void {
+		if (this.frameChunks === 0) {
+			this.frameStart = performance.now();
+		}
+		this.frameChunks++;
+	}
+
+	frame(): void {
+		const elapsed =
+			this.frameChunks > 0 ? performance.now() - this.frameStart : 0;
+		this.frames++;
+		this.chunks += this.frameChunks;
+		this.frameChunks = 0;
+		this.totalMs += elapsed;
+		this.lastMs = elapsed;
+		this.maxMs = Math.max(this.maxMs, elapsed);
+	}
+
+	stats(): ReadLatencyStats {
+		return {
+			frames: this.frames,
+			chunks: this.chunks,
+			lastMs: this.lastMs,
+			meanMs: this.frames > 0 ? this.totalMs / this.frames : 0,
+			maxMs: this.maxMs,
+			tuning: this.tuning,
+		};
+	}
+}
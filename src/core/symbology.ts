@@ -0,0 +1,266 @@
+import type { JobAlign, MonoBitmap } from './jobBuilder';
+import { getNativeAddonLoadError, loadNativeAddon } from './nativeAddon';
+import type { PrinterProfile } from './printerProfile';
+import { ImageProcessingError, PrinterError } from './windows_printer';
+
+export type Symbology = 'pdf417' | 'datamatrix';
+
+export interface SymbolOptions {
+	/**
+	 * Dots per module (the narrowest bar for PDF417). Defaults to about
+	 * 0.5 mm for Data Matrix and 0.25 mm for PDF417.
+	 */
+	moduleSize?: number;
+	/** PDF417 error correction level 0-8; chosen from the payload otherwise */
+	errorLevel?: number;
+	align?: JobAlign;
+}
+
+/**
+ * Geometry of a symbol as the encoders lay it out. Label printers and
+ * GS ( k pick their own encodation, so sizes are an upper bound there.
+ */
+export interface SymbolLayout {
+	symbology: Symbology;
+	data: Buffer;
+	moduleSize: number;
+	/** Dots, including the quiet zone of a rasterized Data Matrix */
+	width: number;
+	height: number;
+	/** Data columns and rows for PDF417, modules per side for Data Matrix */
+	columns: number;
+	rows: number;
+	rowHeight: number;
+	errorLevel: number;
+}
+
+// Square ECC 200 sizes and their data capacity in ASCII codewords
+const DATA_MATRIX_SIZES: ReadonlyArray<readonly [number, number]> = [
+	[10, 3],
+	[12, 5],
+	[14, 8],
+	[16, 12],
+	[18, 18],
+	[20, 22],
+	[22, 30],
+	[24, 36],
+	[26, 44],
+	[32, 62],
+	[36, 86],
+	[40, 114],
+	[44, 144],
+	[48, 174],
+	[52, 204],
+	[64, 280],
+	[72, 368],
+	[80, 456],
+	[88, 576],
+	[96, 696],
+	[104, 816],
+	[120, 1050],
+	[132, 1304],
+	[144, 1558],
+];
+
+// Same encodation as the native encoder: digit pairs share a codeword,
+// bytes above 127 take two
+function dataMatrixCodewords(data: Buffer): number {
+	const isDigit = (byte: number) => byte >= 0x30 && byte <= 0x39;
+	let count = 0;
+	for (let i = 0; i < data.length; i++) {
+		if (isDigit(data[i]) && i + 1 < data.length && isDigit(data[i + 1])) {
+			i++;
+		}
+		count += data[i] > 127 ? 2 : 1;
+	}
+	return count;
+}
+
+// Start, stop and both row indicators take 69 modules; each data column 17
+const PDF417_OVERHEAD_MODULES = 69;
+const PDF417_MAX_ROWS = 90;
+const PDF417_MAX_COLUMNS = 30;
+
+// Recommended minimum error correction for the data size (ISO 15438)
+function pdf417ErrorLevel(dataCodewords: number): number {
+	if (dataCodewords <= 40) {
+		return 2;
+	}
+	if (dataCodewords <= 160) {
+		return 3;
+	}
+	return dataCodewords <= 320 ? 4 : 5;
+}
+
+/**
+ * Size and parameters of a symbol on this profile
+ */
+export function layoutSymbol(
+	symbology: Symbology,
+	data: string | Buffer,
+	options: SymbolOptions,
+	profile: PrinterProfile,
+): SymbolLayout {
+	const bytes = typeof data === 'string' ? Buffer.from(data, 'utf8') : data;
+	if (bytes.length === 0) {
+		throw new PrinterError('Symbol data cannot be empty');
+	}
+
+	if (symbology === 'datamatrix') {
+		const moduleSize = Math.max(
+			1,
+			Math.round(options.moduleSize ?? profile.dotsPerMm / 2),
+		);
+		const codewords = dataMatrixCodewords(bytes);
+		const size = DATA_MATRIX_SIZES.find(
+			([, capacity]) => capacity >= codewords,
+		);
+		if (!size) {
+			throw new PrinterError('Data is too long for a Data Matrix symbol');
+		}
+		const dots = (size[0] + 2) * moduleSize;
+		return {
+			symbology,
+			data: bytes,
+			moduleSize,
+			width: dots,
+			height: dots,
+			columns: size[0],
+			rows: size[0],
+			rowHeight: moduleSize,
+			errorLevel: 0,
+		};
+	}
+
+	const moduleSize = Math.max(
+		2,
+		Math.min(8, Math.round(options.moduleSize ?? profile.dotsPerMm / 4)),
+	);
+	// Byte compaction: a latch, then five codewords per six bytes
+	const dataCodewords = 2 + Math.ceil((bytes.length * 5) / 6);
+	const level = options.errorLevel ?? pdf417ErrorLevel(dataCodewords);
+	const errorLevel = Math.max(0, Math.min(8, Math.round(level)));
+	const total = dataCodewords + 2 ** (errorLevel + 1);
+	const fit = Math.floor(
+		(profile.printWidthDots / moduleSize - PDF417_OVERHEAD_MODULES) / 17,
+	);
+	const maxColumns = Math.max(1, Math.min(PDF417_MAX_COLUMNS, fit));
+	// Roughly square, then as wide as it takes to stay within 90 rows
+	let columns = Math.min(
+		maxColumns,
+		Math.max(1, Math.ceil(Math.sqrt(total / 6))),
+	);
+	while (
+		columns < maxColumns &&
+		Math.ceil(total / columns) > PDF417_MAX_ROWS
+	) {
+		columns++;
+	}
+	const rows = Math.max(3, Math.ceil(total / columns));
+	if (rows > PDF417_MAX_ROWS || total > 928) {
+		throw new PrinterError('Data is too long for a PDF417 symbol');
+	}
+	const rowHeight = moduleSize * 3;
+	return {
+		symbology,
+		data: bytes,
+		moduleSize,
+		width: (columns * 17 + PDF417_OVERHEAD_MODULES) * moduleSize,
+		height: rows * rowHeight,
+		columns,
+		rows,
+		rowHeight,
+		errorLevel,
+	};
+}
+
+// GS ( k pL pH cn fn [params]
+const gsParenK = (cn: number, fn: number, params: Buffer | number[]) => {
+	const length = params.length + 2;
+	return Buffer.concat([
+		Buffer.from([0x1d, 0x28, 0x6b, length & 0xff, length >> 8, cn, fn]),
+		Buffer.from(params),
+	]);
+};
+
+/**
+ * The printer's own GS ( k symbol commands for a laid out symbol
+ */
+export function encodeSymbolCommand(layout: SymbolLayout): Buffer {
+	if (layout.data.length > 0xfff0) {
+		throw new PrinterError('Symbol data is too long for GS ( k');
+	}
+	const store = Buffer.concat([Buffer.from([0x30]), layout.data]);
+	if (layout.symbology === 'datamatrix') {
+		return Buffer.concat([
+			// Square, size chosen by the printer
+			gsParenK(0x36, 0x42, [0x00, 0x00, 0x00]),
+			gsParenK(0x36, 0x43, [Math.max(2, Math.min(16, layout.moduleSize))]),
+			gsParenK(0x36, 0x50, store),
+			gsParenK(0x36, 0x51, [0x30]),
+		]);
+	}
+	return Buffer.concat([
+		gsParenK(0x30, 0x41, [layout.columns]),
+		gsParenK(0x30, 0x43, [layout.moduleSize]),
+		gsParenK(0x30, 0x44, [3]),
+		gsParenK(0x30, 0x45, [0x30, 0x30 + layout.errorLevel]),
+		gsParenK(0x30, 0x50, store),
+		gsParenK(0x30, 0x51, [0x30]),
+	]);
+}
+
+/**
+ * Whether the job encoder draws the symbol as a raster image for profile
+ * instead of leaving it to the printer (GS ( k, ZPL or TSPL)
+ */
+export const rasterizesSymbol = (
+	symbology: Symbology,
+	profile: PrinterProfile,
+): boolean =>
+	profile.language === 'escpos' &&
+	!profile.capabilities.escposSymbols?.includes(symbology);
+
+const SYMBOL_CACHE_LIMIT = 64;
+const symbolCache = new Map<string, MonoBitmap>();
+
+/**
+ * Encode a Data Matrix natively and rasterize it at the layout's module
+ * size with a one-module quiet zone. Results are cached per payload and
+ * module size; the bitmap is shared, so treat it as read-only.
+ */
+export function rasterizeSymbol(layout: SymbolLayout): MonoBitmap {
+	if (layout.symbology !== 'datamatrix') {
+		throw new PrinterError(
+			'PDF417 needs a printer that supports it natively (GS ( k, ZPL or TSPL)',
+		);
+	}
+
+	const key = `${layout.moduleSize}:${layout.data.toString('base64')}`;
+	let bitmap = symbolCache.get(key);
+	if (bitmap) {
+		// Refresh its position in the LRU order
+		symbolCache.delete(key);
+	} else {
+		const addon = loadNativeAddon();
+		if (!addon?.encodeDataMatrix) {
+			const loadError = getNativeAddonLoadError();
+			throw new ImageProcessingError(
+				'Data Matrix rasterizing needs the native module',
+				loadError instanceof Error ? loadError : undefined,
+			);
+		}
+		const block = addon.encodeDataMatrix(layout.data, layout.moduleSize);
+		const rowBytes = block.readUInt16LE(4);
+		bitmap = {
+			width: rowBytes * 8,
+			height: block.readUInt16LE(6),
+			data: block.subarray(8),
+		};
+	}
+	symbolCache.set(key, bitmap);
+	if (symbolCache.size > SYMBOL_CACHE_LIMIT) {
+		symbolCache.delete(symbolCache.keys().next().value as string);
+	}
+	return bitmap;
+}
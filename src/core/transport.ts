@@ -0,0 +1,185 @@
+import { type BufferPoolStats, jobBufferPool } from './bufferPool';
+import { loadNativeAddon } from './nativeAddon';
+import type { PrinterSession } from './printerSessionPool';
+import type { PrintJobOptions } from './types';
+import {
+	PrinterError,
+	PrintJobCancelledError,
+	PrintJobError,
+	PrintJobTimeoutError,
+} from './windows_printer';
+
+export type TransportScheme = 'spool' | 'file' | 'tcp' | 'serial' | 'emu';
+
+const TRANSPORT_SCHEMES: readonly TransportScheme[] = [
+	'spool',
+	'file',
+	'tcp',
+	'serial',
+	'emu',
+];
+
+export interface TransportMetrics {
+	scheme: TransportScheme;
+	jobs: number;
+	bytesWritten: number;
+	chunksWritten: number;
+	/** Times a write had to wait for the device to accept more data */
+	stalls: number;
+	timeouts: number;
+	cancellations: number;
+	errors: number;
+	busyMs: number;
+	/** The shared job buffer pool the written jobs come from */
+	bufferPool: BufferPoolStats;
+}
+
+export interface TransportOpenOptions {
+	/** Give up connecting after this many ms (default 5000) */
+	timeoutMs?: number;
+}
+
+interface NativeTransport {
+	open(timeoutMs?: number): Promise<void>;
+	write(data: Buffer, timeoutMs?: number): Promise<number>;
+	cancel(): void;
+	close(): void;
+	isOpen(): boolean;
+	getMetrics(): Omit<TransportMetrics, 'bufferPool'>;
+	takeOutput(): Buffer;
+}
+
+type NativeTransportConstructor = new (uri: string) => NativeTransport;
+
+export class TransportError extends PrinterError {
+	constructor(uri: string, message: string, code?: string) {
+		super(`Transport ${uri}: ${message}`, code);
+		this.name = 'TransportError';
+	}
+}
+
+/**
+ * Scheme of a printer transport URI, or undefined if it is not one
+ */
+export function getTransportScheme(uri: string): TransportScheme | undefined {
+	const match = /^([a-z]+):\/\//i.exec(uri);
+	const scheme = match?.[1].toLowerCase();
+	return TRANSPORT_SCHEMES.find((candidate) => candidate === scheme);
+}
+
+export type SerialFlowControl = 'none' | 'rtscts' | 'xonxoff';
+
+/**
+ * Transport URI for a printer on a serial port
+ * @param path Port path, e.g. /dev/ttyUSB0
+ */
+export function serialTransportUri(
+	path: string,
+	baudrate: number,
+	flow: SerialFlowControl = 'none',
+): string {
+	const query = `baud=${baudrate}${flow === 'none' ? '' : `&flow=${flow}`}`;
+	return `serial://${path.startsWith('/') ? '' : '/'}${path}?${query}`;
+}
+
+const errorCode = (error: unknown): string | undefined =>
+	error && typeof error === 'object' && 'code' in error
+		? String(error.code)
+		: undefined;
+
+/**
+ * A native printer connection addressed by URI:
+ * `spool://POS-80`, `file:///dev/usb/lp0`, `tcp://10.0.0.5:9100`,
+ * `serial:///dev/ttyUSB0?baud=115200` or `emu://` for an in-memory sink.
+ * Every backend shares the native chunking, deadline, cancellation and
+ * metrics path, and completes on the shared thread pool.
+ */
+export class PrinterTransport implements PrinterSession {
+	private constructor(
+		readonly uri: string,
+		private readonly native: NativeTransport,
+	) {}
+
+	static async open(
+		uri: string,
+		options: TransportOpenOptions = {},
+	): Promise<PrinterTransport> {
+		const addon = loadNativeAddon();
+		if (!addon?.Transport) {
+			throw new TransportError(uri, 'native addon is not available');
+		}
+
+		const NativeTransportClass = addon.Transport as NativeTransportConstructor;
+		let native: NativeTransport;
+		try {
+			native = new NativeTransportClass(uri);
+			await native.open(options.timeoutMs ?? 5000);
+		} catch (error) {
+			throw new TransportError(
+				uri,
+				error instanceof Error ? error.message : String(error),
+				errorCode(error),
+			);
+		}
+		return new PrinterTransport(uri, native);
+	}
+
+	get scheme(): TransportScheme {
+		return getTransportScheme(this.uri) as TransportScheme;
+	}
+
+	/**
+	 * Write a complete job. The returned promise settles once the device has
+	 * accepted every byte, the signal aborts or timeoutMs passes.
+	 * @returns Bytes written
+	 */
+	async write(data: Buffer, options: PrintJobOptions = {}): Promise<number> {
+		const { timeoutMs = 0, signal } = options;
+		if (signal?.aborted) {
+			throw new PrintJobCancelledError();
+		}
+
+		const onAbort = () => this.native.cancel();
+		signal?.addEventListener('abort', onAbort, { once: true });
+		try {
+			return await this.native.write(data, timeoutMs);
+		} catch (error) {
+			const code = errorCode(error);
+			if (code === 'ETIMEDOUT') {
+				throw new PrintJobTimeoutError(timeoutMs);
+			}
+			if (code === 'ECANCELED') {
+				throw new PrintJobCancelledError();
+			}
+			throw new PrintJobError(
+				`Failed to write to ${this.uri}`,
+				error instanceof Error ? error : undefined,
+			);
+		} finally {
+			signal?.removeEventListener('abort', onAbort);
+		}
+	}
+
+	cancel(): void {
+		this.native.cancel();
+	}
+
+	isHealthy(): boolean {
+		return this.native.isOpen();
+	}
+
+	close(): void {
+		this.native.close();
+	}
+
+	getMetrics(): TransportMetrics {
+		return { ...this.native.getMetrics(), bufferPool: jobBufferPool.stats() };
+	}
+
+	/**
+	 * Bytes captured by an `emu://` transport since the last call
+	 */
+	takeOutput(): Buffer {
+		return this.native.takeOutput();
+	}
+}
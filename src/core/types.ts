@@ -14,7 +14,20 @@ export type BaudRate =
 	| 128000
 	| 256000;
 
-export type DeviceType = 'printer' | 'scanner' | 'scale' | 'unassigned';
+export type DeviceType =
+	| 'printer'
+	| 'scanner'
+	| 'scale'
+	| 'display'
+	| 'unassigned';
+
+/**
+ * off: leave the port as the serialport binding configured it.
+ * prefer: apply what the driver supports and carry on without the rest.
+ * require: fail the open unless raw termios and at least one driver
+ * latency control (low-latency flag or latency timer) took effect.
+ */
+export type SerialLatencyMode = 'off' | 'prefer' | 'require';
 
 export interface DeviceConfig {
 	deviceType: DeviceType;
@@ -22,6 +35,27 @@ export interface DeviceConfig {
 	model: string;
 	baudrate: BaudRate | 'not-supported';
 	setToDefault: boolean;
+	/**
+	 * Native transport URI for printers, e.g. `tcp://10.0.0.5:9100`,
+	 * `file:///dev/usb/lp0` or `spool://POS-80`. Overrides the
+	 * platform default adapter when set.
+	 */
+	transport?: string;
+	/**
+	 * Printer profile id (see getPrinterProfiles), which selects the command
+	 * language and print head geometry. Defaults to `escpos-80mm`.
+	 */
+	profile?: string;
+	/**
+	 * Printer group name. Jobs sent to the group (or to its default
+	 * printer) go to whichever member is expected to finish first.
+	 */
+	group?: string;
+	/**
+	 * Scanners and scales: low-latency tty setup (VMIN=1/VTIME=0, driver
+	 * low-latency flag, 1 ms usb-serial latency timer). Defaults to off.
+	 */
+	lowLatency?: SerialLatencyMode;
 }
 
 export interface TerminalDevice {
@@ -35,3 +69,16 @@ export interface TerminalDevice {
 	meta: DeviceConfig;
 	capabilities: Array<'read' | 'write'>;
 }
+
+/**
+ * Job payload: text, or an image as base64 or a data: URL. A Buffer holds
+ * the UTF-8 text or the image file itself.
+ */
+export type PrintData = string | Buffer;
+
+export interface PrintJobOptions {
+	/** Abandon the job if it has not finished writing within this many ms */
+	timeoutMs?: number;
+	/** Cancel the job, whether still queued or already writing */
+	signal?: AbortSignal;
+}
@@ -0,0 +1,65 @@
+import {
+	loadNativeAddon,
+	type WeighLabelField,
+	type WeighLabelTemplatePart,
+} from './nativeAddon';
+
+/**
+ * Cut {{name}} placeholders out of a finished label so a weigh-label
+ * pipeline only has to fill them in. The label is built once with the
+ * usual encoders (encodeTspl, encodeZpl, PrintJobBuilder text...) using
+ * the placeholders as text, e.g.
+ *
+ *   compileWeighLabel(encodeTspl(label), {
+ *     weight: { field: 'weight', decimals: 3 },
+ *     price: { field: 'price', width: 7 },
+ *     barcode: { field: 'price', width: 5, pad: '0', minorUnits: true },
+ *   })
+ *
+ * Placeholders must reach the output as plain text, so not inside
+ * rasterised text or images.
+ */
+export function compileWeighLabel(
+	label: Buffer | string,
+	fields: Record<string, WeighLabelField>,
+): WeighLabelTemplatePart[] {
+	const bytes = typeof label === 'string' ? Buffer.from(label) : label;
+	const parts: WeighLabelTemplatePart[] = [];
+	let position = 0;
+
+	while (position < bytes.length) {
+		const start = bytes.indexOf('{{', position);
+		const end = start < 0 ? -1 : bytes.indexOf('}}', start + 2);
+		if (end < 0) {
+			break;
+		}
+		const name = bytes.toString('latin1', start + 2, end).trim();
+		const field = fields[name];
+		if (!field) {
+			throw new Error(`Label placeholder {{${name}}} has no field`);
+		}
+		parts.push(bytes.subarray(position, start), field);
+		position = end + 2;
+	}
+
+	if (position < bytes.length) {
+		parts.push(bytes.subarray(position));
+	}
+	return parts;
+}
+
+/**
+ * The exact bytes a pipeline prints for weight and price, for previews
+ * and test prints
+ */
+export function renderWeighLabel(
+	template: WeighLabelTemplatePart[],
+	weight: number,
+	price: number,
+): Buffer {
+	const addon = loadNativeAddon();
+	if (!addon) {
+		throw new Error('Rendering weigh labels needs the native addon');
+	}
+	return addon.renderWeighLabel(template, weight, price);
+}
@@ -1,5 +1,15 @@
+import { createHash } from 'node:crypto';
+import { readFile } from 'node:fs/promises';
+import { Writable } from 'node:stream';
 import iconv from 'iconv-lite';
 import Jimp from 'jimp';
+import { rasterAssetPack } from './assetPack';
+import { jobBufferPool } from './bufferPool';
+import { getLogger } from './logger';
+import { getNativeAddonLoadError, loadNativeAddon } from './nativeAddon';
+import type { PrintJobOptions } from './types';
+
+const log = getLogger('printer');
 
 // Types and Interfaces
 export interface PrinterInfo {
@@ -41,9 +51,20 @@ export type BarcodeType =
 	| 'CODABAR';
 export type CharacterSet = 'ASCII' | 'GBK';
 
+export interface PrintStreamOptions {
+	/** Bytes buffered before write() starts returning false (default 64 KiB) */
+	highWaterMark?: number;
+}
+
 interface NativePrinter {
 	print(data: Buffer): boolean;
+	printAsync(data: Buffer, timeoutMs?: number): Promise<number>;
+	cancel(): void;
+	startDocument(): boolean;
+	writeAsync(data: Buffer, timeoutMs?: number): Promise<number>;
+	endDocument(): void;
 	close(): void;
+	isHealthy(): boolean;
 }
 
 interface NativePrinterConstructor {
@@ -92,6 +113,22 @@ export class PrintJobError extends PrinterError {
 	}
 }
 
+export class PrintJobCancelledError extends PrintJobError {
+	constructor() {
+		super('job was cancelled');
+		this.name = 'PrintJobCancelledError';
+		this.code = 'PRINT_JOB_CANCELLED';
+	}
+}
+
+export class PrintJobTimeoutError extends PrintJobError {
+	constructor(timeoutMs: number) {
+		super(`job did not finish within ${timeoutMs}ms`);
+		this.name = 'PrintJobTimeoutError';
+		this.code = 'PRINT_JOB_TIMEOUT';
+	}
+}
+
 // ESC/POS Commands
 export const EscPosCommands = {
 	// Printer control commands
@@ -209,6 +246,258 @@ export const EscPosCommands = {
 } as const;
 
 // Main Printer Class
+// Scale, dither and pack an image into a pooled GS v 0 raster block
+// (native when the addon is loaded, Jimp otherwise)
+async function rasterizeImage(
+	image: Jimp,
+	options: ImageProcessingOptions,
+): Promise<Buffer> {
+	const { width = 384, threshold = 128, dither = true } = options;
+
+	try {
+		image.scaleToFit(width, Jimp.AUTO);
+
+		const imgWidth = image.getWidth();
+		const imgHeight = image.getHeight();
+		const bytesPerLine = Math.ceil(imgWidth / 8);
+		const block = jobBufferPool.acquire(8 + bytesPerLine * imgHeight);
+
+		// Error diffusion and bit packing run natively off the event loop
+		const addon = loadNativeAddon();
+		if (addon?.rasterize) {
+			try {
+				const length = await addon.rasterize(
+					image.bitmap.data,
+					imgWidth,
+					imgHeight,
+					threshold,
+					dither,
+					block,
+				);
+				return block.subarray(0, length);
+			} catch (error) {
+				jobBufferPool.release(block);
+				throw error;
+			}
+		}
+
+		image.grayscale();
+
+		if (dither) {
+			image.dither16();
+		} else {
+			image.threshold({ max: threshold });
+		}
+
+		EscPosCommands.IMAGE_HIGH_DENSITY.copy(block, 0);
+		block.writeUInt16LE(bytesPerLine, 4);
+		block.writeUInt16LE(imgHeight, 6);
+		block.fill(0, 8);
+
+		const { data } = image.bitmap;
+		for (let y = 0; y < imgHeight; y++) {
+			const row = 8 + y * bytesPerLine;
+			for (let x = 0; x < imgWidth; x++) {
+				// Red channel of the RGBA pixel; the image is grayscale by now
+				const isBlack = data[(y * imgWidth + x) * 4] < threshold;
+				if (isBlack) {
+					block[row + (x >> 3)] |= 0x80 >> (x & 7);
+				}
+			}
+		}
+
+		return block;
+	} catch (error) {
+		throw new ImageProcessingError(
+			'Failed to process image buffer',
+			error instanceof Error ? error : undefined,
+		);
+	}
+}
+
+// Baseline JPEGs skip Jimp: the addon decodes only their luma, at the 1/2,
+// 1/4 or 1/8 DCT scale nearest the print width, and dithers it directly.
+// Returns undefined when the file or platform needs the Jimp path.
+async function rasterizeJpeg(
+	jpeg: Buffer,
+	options: Required<ImageProcessingOptions>,
+): Promise<Buffer | undefined> {
+	const addon = loadNativeAddon();
+	const info = addon?.readJpegInfo ? addon.readJpegInfo(jpeg) : null;
+	// Jimp applies EXIF rotation; rotated photos stay on that path
+	if (!addon || !info?.supported || info.orientation !== 1) {
+		return undefined;
+	}
+
+	const { width, threshold, dither } = options;
+	const height = Math.max(1, Math.round((info.height * width) / info.width));
+	const block = jobBufferPool.acquire(8 + Math.ceil(width / 8) * height);
+	try {
+		const length = await addon.rasterizeJpeg(
+			jpeg,
+			width,
+			height,
+			threshold,
+			dither,
+			block,
+		);
+		return block.subarray(0, length);
+	} catch (error) {
+		jobBufferPool.release(block);
+		throw error;
+	}
+}
+
+// Rendered SVGs per (asset hash, width, threshold, dither), oldest first
+const SVG_CACHE_LIMIT = 32;
+const svgCache = new Map<string, Promise<Buffer>>();
+
+const looksLikeSvg = (data: Buffer): boolean => {
+	const head = data.subarray(0, 1024).toString('utf8').trimStart();
+	return head.startsWith('<') && /<svg[\s>]/.test(head);
+};
+
+/**
+ * Render a vector logo natively at exactly the requested dot width into a
+ * GS v 0 raster block. Results are cached per asset and width, in memory
+ * and in the on-disk asset pack; the block is shared between callers, so
+ * treat it as read-only.
+ */
+export async function rasterizeSvg(
+	svg: string | Buffer,
+	options: ImageProcessingOptions = {},
+): Promise<Buffer> {
+	const { width = 384, threshold = 128, dither = true } = options;
+	const data = typeof svg === 'string' ? Buffer.from(svg, 'utf8') : svg;
+	const hash = createHash('sha256').update(data).digest('hex');
+	const variant = `${width}:${threshold}:${dither}`;
+	const key = `${hash}:${variant}`;
+	let block = svgCache.get(key);
+	if (block) {
+		// Refresh its position in the LRU order
+		svgCache.delete(key);
+	} else {
+		const packed = rasterAssetPack.get(hash, variant);
+		const addon = loadNativeAddon();
+		if (packed) {
+			block = Promise.resolve(packed);
+		} else if (!addon?.rasterizeSvg) {
+			const loadError = getNativeAddonLoadError();
+			throw new ImageProcessingError(
+				'SVG rendering needs the native module',
+				loadError instanceof Error ? loadError : undefined,
+			);
+		} else {
+			block = addon.rasterizeSvg(data, width, threshold, dither);
+			// Vector logos are static assets; keep them across restarts
+			block.then(
+				(rendered) => rasterAssetPack.put(hash, variant, rendered),
+				() => svgCache.delete(key),
+			);
+		}
+	}
+	svgCache.set(key, block);
+	if (svgCache.size > SVG_CACHE_LIMIT) {
+		svgCache.delete(svgCache.keys().next().value as string);
+	}
+
+	try {
+		return await block;
+	} catch (error) {
+		throw new ImageProcessingError(
+			'Failed to render SVG image',
+			error instanceof Error ? error : undefined,
+		);
+	}
+}
+
+/**
+ * Image file bytes of a base64 string or data: URL
+ */
+export function decodeBase64Image(base64Data: string): Buffer {
+	let cleanBase64 = base64Data;
+	if (base64Data.startsWith('data:')) {
+		const commaIndex = base64Data.indexOf(',');
+		if (commaIndex !== -1) {
+			cleanBase64 = base64Data.substring(commaIndex + 1);
+		}
+	}
+	return Buffer.from(cleanBase64, 'base64');
+}
+
+/**
+ * Decode a base64 (or data: URL) image into a GS v 0 raster block from
+ * jobBufferPool, owned by the caller. Images rendered repeatedly (logos)
+ * are kept in the on-disk asset pack and copied out of its read-only
+ * mapping instead of being decoded again.
+ */
+export async function rasterizeBase64Image(
+	base64Data: string,
+	options: ImageProcessingOptions = {},
+): Promise<Buffer> {
+	if (!base64Data) {
+		throw new ImageProcessingError('Base64 data cannot be empty');
+	}
+	return rasterizeImageFile(
+		decodeBase64Image(base64Data),
+		options,
+		'Failed to process base64 image data',
+	);
+}
+
+/**
+ * Same as rasterizeBase64Image for the image file itself (PNG, JPEG, SVG,
+ * ...), e.g. a read-only mapping received from another process
+ */
+export async function rasterizeImageBuffer(
+	imageBuffer: Buffer,
+	options: ImageProcessingOptions = {},
+): Promise<Buffer> {
+	if (imageBuffer.length === 0) {
+		throw new ImageProcessingError('Image data cannot be empty');
+	}
+	return rasterizeImageFile(
+		imageBuffer,
+		options,
+		'Failed to process image data',
+	);
+}
+
+async function rasterizeImageFile(
+	imageBuffer: Buffer,
+	options: ImageProcessingOptions,
+	failure: string,
+): Promise<Buffer> {
+	const { width = 384, threshold = 128, dither = true } = options;
+
+	try {
+		if (looksLikeSvg(imageBuffer)) {
+			return rasterizeSvg(imageBuffer, { width, threshold, dither });
+		}
+
+		const hash = createHash('sha256').update(imageBuffer).digest('hex');
+		const variant = `${width}:${threshold}:${dither}`;
+		const packed = rasterAssetPack.get(hash, variant);
+		if (packed) {
+			return jobBufferPool.concat([packed]);
+		}
+		const block =
+			(await rasterizeJpeg(imageBuffer, { width, threshold, dither })) ??
+			(await rasterizeImage(await Jimp.read(imageBuffer), {
+				width,
+				threshold,
+				dither,
+			}));
+		rasterAssetPack.offer(hash, variant, block);
+		return block;
+	} catch (error) {
+		throw new ImageProcessingError(
+			failure,
+			error instanceof Error ? error : undefined,
+		);
+	}
+}
+
 export class ThermalWindowPrinter {
 	private readonly nativePrinter: NativePrinter | null = null;
 	private readonly printerName: string;
@@ -218,30 +507,23 @@ export class ThermalWindowPrinter {
 	private static nativePrinterClass: NativePrinterConstructor | null = null;
 
 	static {
-		console.log('ThermalWindowPrinter: Initializing native printer module...');
-		console.log(
-			`ThermalWindowPrinter: Platform: ${process.platform}, Architecture: ${process.arch}`,
-		);
+		log.debug('Loading native printer module', {
+			platform: process.platform,
+			arch: process.arch,
+		});
 
 		try {
-			console.log(
-				'ThermalWindowPrinter: Attempting to load native module "escpos-lib"...',
-			);
-			const nativeModule = require('bindings')('escpos-lib');
-			console.log(
-				'ThermalWindowPrinter: Native module loaded, available exports:',
-				Object.keys(nativeModule),
-			);
-
-			ThermalWindowPrinter.nativePrinterClass = nativeModule.Printer;
-			console.log(
-				'ThermalWindowPrinter: Native printer class initialized successfully',
-			);
+			const nativeModule = loadNativeAddon();
+			if (!nativeModule) {
+				throw getNativeAddonLoadError();
+			}
+			ThermalWindowPrinter.nativePrinterClass =
+				nativeModule.Printer as NativePrinterConstructor;
+			log.debug('Native printer module loaded', {
+				exports: Object.keys(nativeModule),
+			});
 		} catch (error) {
-			console.error(
-				'ThermalWindowPrinter: Failed to load native printer module',
-			);
-			console.error('ThermalWindowPrinter: Error:', {
+			log.error('Failed to load native printer module', {
 				message: error instanceof Error ? error.message : String(error),
 				code:
 					error && typeof error === 'object' && 'code' in error
@@ -257,8 +539,8 @@ export class ThermalWindowPrinter {
 				error instanceof Error &&
 				error.message.includes('MODULE_NOT_FOUND')
 			) {
-				console.error(
-					'ThermalWindowPrinter: Native module not found - may need to rebuild with "npm run build"',
+				log.error(
+					'Native module not found - may need to rebuild with "npm run build"',
 				);
 			}
 
@@ -277,9 +559,9 @@ export class ThermalWindowPrinter {
 				);
 
 				if (process.platform !== 'win32') {
-					console.log(
-						`ThermalPrinter: Running in compatibility mode on ${process.platform}. Printing operations will be simulated.`,
-					);
+					log.info('Compatibility mode: printing will be simulated', {
+						platform: process.platform,
+					});
 				}
 			} catch (error) {
 				throw new PrinterConnectionError(
@@ -288,8 +570,8 @@ export class ThermalWindowPrinter {
 				);
 			}
 		} else {
-			console.warn(
-				`ThermalPrinter: Native printer functionality not available. Running in compatibility mode.`,
+			log.warn(
+				'Native printer functionality not available; compatibility mode',
 			);
 		}
 	}
@@ -297,9 +579,9 @@ export class ThermalWindowPrinter {
 	// Static methods
 	static getAvailablePrinters(): PrinterInfo[] {
 		if (!ThermalWindowPrinter.nativePrinterClass) {
-			console.warn(
-				'getAvailablePrinters: Native printer functionality not available. Returning empty list.',
-			);
+			log.warn('Native printer functionality not available; no printers', {
+				method: 'getAvailablePrinters',
+			});
 			return [];
 		}
 
@@ -322,9 +604,10 @@ export class ThermalWindowPrinter {
 		const buffer = data instanceof Buffer ? data : Buffer.from(data);
 
 		if (!this.isNativeSupported || !this.nativePrinter) {
-			console.log(
-				`ThermalPrinter: Would print ${buffer.length} bytes to printer '${this.printerName}' (compatibility mode)`,
-			);
+			log.debug('Would print (compatibility mode)', {
+				printer: this.printerName,
+				bytes: buffer.length,
+			});
 			return true;
 		}
 
@@ -338,11 +621,98 @@ export class ThermalWindowPrinter {
 		}
 	}
 
+	/**
+	 * Send a complete job as one spooler document off the main thread.
+	 * Aborting the signal or exceeding timeoutMs interrupts a blocked write
+	 * and deletes the partially spooled job.
+	 */
+	async printAsync(
+		data: Buffer,
+		options: PrintJobOptions = {},
+	): Promise<boolean> {
+		if (!data || data.length === 0) {
+			throw new PrinterError('Print data cannot be empty');
+		}
+
+		const { timeoutMs = 0, signal } = options;
+		if (signal?.aborted) {
+			throw new PrintJobCancelledError();
+		}
+
+		const nativePrinter = this.nativePrinter;
+		if (!this.isNativeSupported || !nativePrinter) {
+			log.debug('Would print (compatibility mode)', {
+				printer: this.printerName,
+				bytes: data.length,
+			});
+			return true;
+		}
+
+		let timedOut = false;
+		const onAbort = () => nativePrinter.cancel();
+		signal?.addEventListener('abort', onAbort, { once: true });
+		// The native deadline is checked between slices; the timer also
+		// interrupts a slice blocked on a jammed printer
+		const timer =
+			timeoutMs > 0
+				? setTimeout(() => {
+						timedOut = true;
+						nativePrinter.cancel();
+					}, timeoutMs)
+				: undefined;
+
+		try {
+			await nativePrinter.printAsync(data, timeoutMs);
+			return true;
+		} catch (error) {
+			const code =
+				error && typeof error === 'object' && 'code' in error
+					? error.code
+					: undefined;
+			if (timedOut || code === 'ETIMEDOUT') {
+				throw new PrintJobTimeoutError(timeoutMs);
+			}
+			if (code === 'ECANCELED') {
+				throw new PrintJobCancelledError();
+			}
+			throw new PrintJobError(
+				'Failed to send data to printer',
+				error instanceof Error ? error : undefined,
+			);
+		} finally {
+			clearTimeout(timer);
+			signal?.removeEventListener('abort', onAbort);
+		}
+	}
+
+	/**
+	 * Whether the spooler handle is still open and the queue is not offline
+	 * or in an error state. Used to decide if a pooled session can be reused.
+	 */
+	isHealthy(): boolean {
+		if (!this.isNativeSupported || !this.nativePrinter) {
+			return true;
+		}
+
+		try {
+			return this.nativePrinter.isHealthy();
+		} catch {
+			return false;
+		}
+	}
+
+	/**
+	 * Interrupt the job currently being written by printAsync()
+	 */
+	cancel(): void {
+		this.nativePrinter?.cancel();
+	}
+
 	close(): boolean {
 		if (!this.isNativeSupported || !this.nativePrinter) {
-			console.log(
-				`ThermalPrinter: Would close printer '${this.printerName}' (compatibility mode)`,
-			);
+			log.debug('Would close (compatibility mode)', {
+				printer: this.printerName,
+			});
 			return true;
 		}
 
@@ -357,6 +727,97 @@ export class ThermalWindowPrinter {
 		}
 	}
 
+	/**
+	 * Open a spooler document and return a Writable feeding it chunk by chunk.
+	 * Chunks are raw ESC/POS bytes; memory is bounded by highWaterMark rather
+	 * than by document size, and write() returns false while the printer drains.
+	 * Do not mix print() calls with an open stream on the same printer.
+	 */
+	createWriteStream(options: PrintStreamOptions = {}): Writable {
+		const { highWaterMark = 64 * 1024 } = options;
+		const nativePrinter = this.nativePrinter;
+		const printerName = this.printerName;
+		let documentOpen = false;
+		let bytesWritten = 0;
+
+		const writeChunk = (chunk: Buffer, callback: (error?: Error) => void) => {
+			if (!nativePrinter) {
+				bytesWritten += chunk.length;
+				callback();
+				return;
+			}
+			nativePrinter.writeAsync(chunk).then(
+				(written) => {
+					bytesWritten += written;
+					callback();
+				},
+				(error) =>
+					callback(
+						new PrintJobError(
+							'Failed to stream data to printer',
+							error instanceof Error ? error : undefined,
+						),
+					),
+			);
+		};
+
+		const endDocument = () => {
+			if (documentOpen && nativePrinter) {
+				nativePrinter.endDocument();
+			}
+			documentOpen = false;
+		};
+
+		return new Writable({
+			highWaterMark,
+			construct(callback) {
+				if (!nativePrinter) {
+					log.debug('Would stream (compatibility mode)', {
+						printer: printerName,
+					});
+					callback();
+					return;
+				}
+				try {
+					documentOpen = nativePrinter.startDocument();
+					callback(
+						documentOpen
+							? undefined
+							: new PrintJobError('Failed to start print document'),
+					);
+				} catch (error) {
+					callback(
+						new PrintJobError(
+							'Failed to start print document',
+							error instanceof Error ? error : undefined,
+						),
+					);
+				}
+			},
+			write(chunk: Buffer, _encoding, callback) {
+				writeChunk(chunk, callback);
+			},
+			// Coalesce chunks queued while the previous write was in flight
+			writev(chunks, callback) {
+				writeChunk(Buffer.concat(chunks.map(({ chunk }) => chunk)), callback);
+			},
+			final(callback) {
+				endDocument();
+				if (!nativePrinter) {
+					log.debug('Would print streamed bytes (compatibility mode)', {
+						printer: printerName,
+						bytes: bytesWritten,
+					});
+				}
+				callback();
+			},
+			destroy(error, callback) {
+				endDocument();
+				callback(error);
+			},
+		});
+	}
+
 	// Text encoding methods
 	private encodeText(text: string, charset: CharacterSet = 'ASCII'): Buffer {
 		if (!text) {
@@ -531,8 +992,15 @@ export class ThermalWindowPrinter {
 		const { width = 384, threshold = 128, dither = true } = options;
 
 		try {
+			if (imagePath.toLowerCase().endsWith('.svg')) {
+				return rasterizeSvg(await readFile(imagePath), {
+					width,
+					threshold,
+					dither,
+				});
+			}
 			const image = await Jimp.read(imagePath);
-			return this.processImageBuffer(image, { width, threshold, dither });
+			return rasterizeImage(image, { width, threshold, dither });
 		} catch (error) {
 			throw new ImageProcessingError(
 				`Failed to read image from path: ${imagePath}`,
@@ -545,81 +1013,7 @@ export class ThermalWindowPrinter {
 		base64Data: string,
 		options: ImageProcessingOptions = {},
 	): Promise<Buffer> {
-		if (!base64Data) {
-			throw new ImageProcessingError('Base64 data cannot be empty');
-		}
-
-		const { width = 384, threshold = 128, dither = true } = options;
-
-		try {
-			let cleanBase64 = base64Data;
-			if (base64Data.startsWith('data:')) {
-				const commaIndex = base64Data.indexOf(',');
-				if (commaIndex !== -1) {
-					cleanBase64 = base64Data.substring(commaIndex + 1);
-				}
-			}
-
-			const imageBuffer = Buffer.from(cleanBase64, 'base64');
-			const image = await Jimp.read(imageBuffer);
-			return this.processImageBuffer(image, { width, threshold, dither });
-		} catch (error) {
-			throw new ImageProcessingError(
-				'Failed to process base64 image data',
-				error instanceof Error ? error : undefined,
-			);
-		}
-	}
-
-	private async processImageBuffer(
-		image: Jimp,
-		options: ImageProcessingOptions,
-	): Promise<Buffer> {
-		const { width = 384, threshold = 128, dither = true } = options;
-
-		try {
-			image.scaleToFit(width, Jimp.AUTO);
-			image.grayscale();
-
-			if (dither) {
-				image.dither16();
-			} else {
-				image.threshold({ max: threshold });
-			}
-
-			const imgWidth = image.getWidth();
-			const imgHeight = image.getHeight();
-			const bytesPerLine = Math.ceil(imgWidth / 8);
-
-			const printData: Buffer[] = [];
-			const header = Buffer.concat([
-				EscPosCommands.IMAGE_HIGH_DENSITY,
-				Buffer.from([bytesPerLine & 0xff, (bytesPerLine >> 8) & 0xff]),
-				Buffer.from([imgHeight & 0xff, (imgHeight >> 8) & 0xff]),
-			]);
-			printData.push(header);
-
-			for (let y = 0; y < imgHeight; y++) {
-				const row = new Uint8Array(bytesPerLine);
-				for (let x = 0; x < imgWidth; x++) {
-					const pixel = Jimp.intToRGBA(image.getPixelColor(x, y));
-					const isBlack = pixel.r < threshold;
-					if (isBlack) {
-						const byteIndex = Math.floor(x / 8);
-						const bitIndex = 7 - (x % 8);
-						row[byteIndex] |= 1 << bitIndex;
-					}
-				}
-				printData.push(Buffer.from(row));
-			}
-
-			return Buffer.concat(printData);
-		} catch (error) {
-			throw new ImageProcessingError(
-				'Failed to process image buffer',
-				error instanceof Error ? error : undefined,
-			);
-		}
+		return rasterizeBase64Image(base64Data, options);
 	}
 
 	async printImageFromFile(
@@ -1,58 +1,296 @@
 // Core managers
 
+import type { CustomerDisplayOptions } from './adaptor/customerDisplayAdaptor';
 import type { RetryOptions } from './core/retryUtils';
 import { DeviceManager } from './managers/deviceManager';
+import { DisplayManager } from './managers/displayManager';
 import { PrinterManager } from './managers/printerManager';
 import { ScaleManager } from './managers/scaleManager';
 import { ScannerManager } from './managers/scannerManager';
+import {
+	createWorkerDeviceManagers,
+	type WorkerDeviceManagers,
+} from './managers/workerProxy';
 
 export { BarcodeScannerAdapter } from './adaptor/barcodeScannerAdaptor';
+export {
+	CustomerDisplayAdapter,
+	type CustomerDisplayOptions,
+	type CustomerDisplayStats,
+} from './adaptor/customerDisplayAdaptor';
 export {
 	DeviceAdapter,
 	ReadableDevice,
 	WritableDevice,
+	WriteOptions,
 } from './adaptor/deviceAdaptor';
-export { UnixPrinterAdapter } from './adaptor/unixPrinterAdapter';
+export {
+	decodeEvdevRecording,
+	HidScannerAdapter,
+	type HidScannerOptions,
+	isHidScannerPath,
+} from './adaptor/hidScannerAdaptor';
+export { TransportPrinterAdapter } from './adaptor/transportPrinterAdapter';
+export {
+	UnixPrinterAdapter,
+	type UnixPrinterAdapterOptions,
+	type UsbPrinterDevice,
+} from './adaptor/unixPrinterAdapter';
 export { WeightScaleAdapter } from './adaptor/weightScaleAdaptor';
 export { WindowsPrinterAdapter } from './adaptor/windowsPrinterAdapter';
 // Core utilities
+export {
+	RasterAssetPack,
+	type RasterAssetPackOptions,
+	type RasterAssetPackStats,
+	rasterAssetPack,
+} from './core/assetPack';
+export {
+	BufferPool,
+	type BufferPoolOptions,
+	type BufferPoolStats,
+	getBufferPoolStats,
+	jobBufferPool,
+} from './core/bufferPool';
 export * from './core/deviceConfig';
 export {
 	devicesWithSavedConfig,
 	getConnectedDevices,
 } from './core/deviceDetector';
 export { DeviceEventEmitter } from './core/deviceEvents';
+export {
+	DisplayFramebuffer,
+	type DisplayUpdate,
+	formatDisplayLine,
+} from './core/displayFramebuffer';
+export {
+	bitmapFromRaster,
+	encodeEscPos,
+	type JobAlign,
+	type JobEncodeOptions,
+	type JobOp,
+	loadMonoBitmap,
+	type MonoBitmap,
+	PrintJobBuilder,
+	type TextStyle,
+} from './core/jobBuilder';
+export {
+	encodeAcs,
+	encodeTspl,
+	encodeZ64,
+	encodeZpl,
+} from './core/labelEncoder';
+export {
+	configureLogging,
+	consoleSink,
+	fileSink,
+	flushLogs,
+	formatLogRecord,
+	getLogger,
+	getRecentLogs,
+	Logger,
+	type LogFields,
+	type LoggingOptions,
+	type LogLevel,
+	type LogRecord,
+	type LogSink,
+} from './core/logger';
+export {
+	configureThreadPool,
+	type EvdevKeymap,
+	getThreadPoolStats,
+	type SerialLatencyReport,
+	type SerialTuningStep,
+	type ThreadPoolStats,
+	type WeighLabelEvent,
+	type WeighLabelField,
+	type WeighLabelStats,
+	type WeighLabelTemplatePart,
+} from './core/nativeAddon';
+export {
+	estimateJobLength,
+	type LengthConstraints,
+	type LengthReport,
+	optimizeJobLength,
+} from './core/lengthOptimizer';
 export { PersistentStorage } from './core/persistentStorage';
+export {
+	DEFAULT_PRINTER_PROFILE_ID,
+	getPrinterProfile,
+	getPrinterProfiles,
+	type PrinterCapabilities,
+	type PrinterLanguage,
+	type PrinterProfile,
+	type PrintTuning,
+	registerPrinterProfile,
+	resolvePrinterProfile,
+} from './core/printerProfile';
+export {
+	PreparedJobStore,
+	type PreparedJobStoreOptions,
+	type PreparedJobStoreStats,
+	type PreparedPrintJob,
+} from './core/preparedJobs';
+export {
+	type PrinterRouteEstimate,
+	PrinterRouter,
+	type PrinterRouterOptions,
+} from './core/printerRouter';
+export {
+	type PrinterSession,
+	PrinterSessionPool,
+	type PrinterSessionPoolOptions,
+} from './core/printerSessionPool';
+export {
+	type PrintJobContext,
+	type PrintJobPreparer,
+	type PrintJobRunner,
+	PrintQueue,
+	type PrintQueueOptions,
+} from './core/printQueue';
+export {
+	analyzeJob,
+	chooseTuning,
+	encodeTuning,
+	type JobAnalysis,
+	type TuningSettings,
+} from './core/printTuning';
 export {
 	RetryError,
 	type RetryOptions,
 	withExponentialBackoff,
 } from './core/retryUtils';
+export {
+	buildReceipt,
+	encodeReceipt,
+	type ReceiptEncodeOptions,
+} from './core/receiptEncoder';
+export {
+	ReadLatencyMeter,
+	type ReadLatencyStats,
+	tuneSerialLatency,
+} from './core/serialLatency';
+export {
+	encodeSymbolCommand,
+	layoutSymbol,
+	rasterizeSymbol,
+	type SymbolLayout,
+	type SymbolOptions,
+	type Symbology,
+} from './core/symbology';
+export {
+	getTransportScheme,
+	PrinterTransport,
+	type SerialFlowControl,
+	serialTransportUri,
+	TransportError,
+	type TransportMetrics,
+	type TransportOpenOptions,
+	type TransportScheme,
+} from './core/transport';
 // Types
 export * from './core/types';
+export { compileWeighLabel, renderWeighLabel } from './core/weighLabel';
+export {
+	EscPosCommands,
+	PrinterError,
+	PrintJobCancelledError,
+	PrintJobError,
+	PrintJobTimeoutError,
+	type PrintStreamOptions,
+	rasterizeBase64Image,
+	rasterizeImageBuffer,
+	rasterizeSvg,
+	ThermalWindowPrinter,
+} from './core/windows_printer';
 // Adaptors
+export {
+	type BrokerMetrics,
+	type BrokerPrintTarget,
+	type BrokerStatusEvent,
+	defaultBrokerSocketPath,
+	SHARED_PAYLOAD_THRESHOLD,
+} from './managers/brokerProtocol';
 export { DeviceManager } from './managers/deviceManager';
+export { DisplayManager } from './managers/displayManager';
+export { PrintBroker, type PrintBrokerOptions } from './managers/printBroker';
+export { PrintBrokerClient } from './managers/printBrokerClient';
 export { PrinterManager } from './managers/printerManager';
-export { ScaleManager } from './managers/scaleManager';
+export {
+	type LabelPrintCallback,
+	type LabelTriggerOptions,
+	ScaleManager,
+} from './managers/scaleManager';
 export { ScannerManager } from './managers/scannerManager';
+export { markTransferable } from './managers/workerProtocol';
+export {
+	DeviceManagerProxy,
+	DisplayManagerProxy,
+	PrinterManagerProxy,
+	ScaleManagerProxy,
+	ScannerManagerProxy,
+	type WorkerDeviceManagers,
+} from './managers/workerProxy';
 
 // Services
 export { DeviceConfigService } from './services/deviceConfigService';
 
-// Factory function for easy initialization
-export function createDeviceManagers(retryOptions?: {
+export interface DeviceManagersOptions {
 	scannerRetry?: Partial<RetryOptions>;
 	scaleRetry?: Partial<RetryOptions>;
-}) {
+	displayRetry?: Partial<RetryOptions>;
+	/** Geometry, refresh rate and encoding of customer displays */
+	display?: CustomerDisplayOptions;
+	/**
+	 * 'worker' hosts the whole device stack in a worker thread and returns
+	 * main-thread proxies. Device getters stay synchronous; these return
+	 * promises instead:
+	 * - deviceManager: getDeviceConfig, getAllDeviceConfigs,
+	 *   hasDeviceConfig, getConfiguredDeviceCount
+	 * - printerManager: discardPrint, trimPreparedJobs, getPreparedJobStats,
+	 *   getPrinterGroupStatus, cancelPrintJobs, getPrintQueueDepth
+	 * - scannerManager: isScanning, getActiveScanners, getReadLatency
+	 * - scaleManager: isReading, getActiveScales, getReadLatency,
+	 *   getLabelTriggerStats
+	 * - displayManager: getLines, getDisplayStats
+	 * getConfigService() and getEventEmitter() are not available; use
+	 * deviceManager.onDeviceError() for device errors. Buffers are copied
+	 * unless passed through markTransferable().
+	 */
+	isolate?: 'main' | 'worker';
+}
+
+// Factory function for easy initialization
+export function createDeviceManagers(
+	options: DeviceManagersOptions & { isolate: 'worker' },
+): WorkerDeviceManagers;
+export function createDeviceManagers(options?: DeviceManagersOptions): {
+	deviceManager: DeviceManager;
+	printerManager: PrinterManager;
+	scannerManager: ScannerManager;
+	scaleManager: ScaleManager;
+	displayManager: DisplayManager;
+};
+export function createDeviceManagers(options?: DeviceManagersOptions) {
+	if (options?.isolate === 'worker') {
+		return createWorkerDeviceManagers(options);
+	}
+
 	const deviceManager = new DeviceManager();
 	const printerManager = new PrinterManager(deviceManager);
 	const scannerManager = new ScannerManager(
 		deviceManager,
-		retryOptions?.scannerRetry,
+		options?.scannerRetry,
 	);
 	const scaleManager = new ScaleManager(
 		deviceManager,
-		retryOptions?.scaleRetry,
+		options?.scaleRetry,
+		printerManager,
+	);
+	const displayManager = new DisplayManager(
+		deviceManager,
+		options?.displayRetry,
+		options?.display,
 	);
 
 	return {
@@ -60,5 +298,6 @@ export function createDeviceManagers(retryOptions?: {
 		printerManager,
 		scannerManager,
 		scaleManager,
+		displayManager,
 	};
 }
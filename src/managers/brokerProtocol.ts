@@ -0,0 +1,310 @@
+import { randomUUID } from 'node:crypto';
+import * as fs from 'node:fs';
+import type { Socket } from 'node:net';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import { getLogger } from '../core/logger';
+import { type DescriptorReceiver, loadNativeAddon } from '../core/nativeAddon';
+import type { PrintData } from '../core/types';
+import { decodeBase64Image } from '../core/windows_printer';
+
+const log = getLogger('broker');
+
+// Payloads at least this large travel as shared-memory descriptors
+export const SHARED_PAYLOAD_THRESHOLD = 64 * 1024;
+
+export type BrokerPrintTarget =
+	| { device: string }
+	| { group: string }
+	| { default: true }
+	/** A transport URI the broker drives itself, e.g. `emu://counter` */
+	| { transport: string; profile?: string };
+
+export type BrokerPayload =
+	/** binary: a Buffer's bytes in base64 */
+	| { inline: string; binary?: boolean }
+	/** Tag of a descriptor sent to the handoff socket, and its size */
+	| { handle: string; length: number };
+
+export interface BrokerMetrics {
+	clients: number;
+	submitted: number;
+	completed: number;
+	failed: number;
+	/** Jobs whose payload arrived as a shared-memory descriptor */
+	sharedPayloads: number;
+	sharedBytes: number;
+	inlineBytes: number;
+	printers: Array<{ deviceId: string; queueDepth: number }>;
+	transports: Array<{ uri: string; queueDepth: number }>;
+}
+
+export type BrokerStatusEvent =
+	| { event: 'connect'; deviceId: string }
+	| { event: 'disconnect'; deviceId: string }
+	| { event: 'error'; deviceId: string; message: string };
+
+export type ClientToBrokerMessage =
+	| {
+			type: 'print';
+			id: number;
+			target: BrokerPrintTarget;
+			isImage: boolean;
+			timeoutMs?: number;
+			payload: BrokerPayload;
+	  }
+	| { type: 'cancel'; id: number }
+	| { type: 'takeOutput'; id: number; transport: string }
+	| { type: 'subscribe'; intervalMs: number };
+
+export type BrokerToClientMessage =
+	/** The payload was read */
+	| { type: 'accepted'; id: number }
+	| { type: 'done'; id: number }
+	| { type: 'failed'; id: number; name: string; message: string }
+	| { type: 'output'; id: number; data: string }
+	| { type: 'metrics'; metrics: BrokerMetrics }
+	| ({ type: 'status' } & BrokerStatusEvent);
+
+/**
+ * Socket the broker listens on by default: a named pipe on Windows, a
+ * Unix domain socket next to the config store elsewhere
+ */
+export function defaultBrokerSocketPath(): string {
+	if (process.platform === 'win32') {
+		return '\\\\.\\pipe\\escpos-lib-broker';
+	}
+	return path.join(os.homedir(), '.escpos-lib', 'broker.sock');
+}
+
+/**
+ * Send one newline-delimited JSON message
+ */
+export function sendMessage(
+	socket: Socket,
+	message: ClientToBrokerMessage | BrokerToClientMessage,
+): void {
+	if (!socket.destroyed) {
+		socket.write(`${JSON.stringify(message)}\n`);
+	}
+}
+
+/**
+ * Parse newline-delimited JSON messages as they arrive on a socket
+ */
+export function onMessages<T>(
+	socket: Socket,
+	handler: (message: T) => void,
+): void {
+	let pending = '';
+	socket.setEncoding('utf8');
+	socket.on('data', (chunk: string) => {
+		pending += chunk;
+		let newline = pending.indexOf('\n');
+		while (newline !== -1) {
+			const line = pending.slice(0, newline);
+			pending = pending.slice(newline + 1);
+			if (line) {
+				try {
+					handler(JSON.parse(line) as T);
+				} catch (error) {
+					log.error('Malformed print broker message', { error });
+				}
+			}
+			newline = pending.indexOf('\n');
+		}
+	});
+}
+
+const SHARED_MEMORY_NAME = 'escpos-payload';
+
+// How long a print message waits for its descriptor, and a received
+// descriptor for its print message
+const HANDOFF_TIMEOUT_MS = 5000;
+
+/**
+ * Socket on which the broker receives shared-memory descriptors, next to
+ * the one it listens on for messages (POSIX)
+ */
+export function handoffSocketPath(socketPath: string): string {
+	return `${socketPath}.handoff`;
+}
+
+const inlinePayload = (data: PrintData): BrokerPayload =>
+	typeof data === 'string'
+		? { inline: data }
+		: { inline: data.toString('base64'), binary: true };
+
+/**
+ * Wrap job data for sending: inline when small, otherwise copied into
+ * anonymous shared memory whose descriptor goes to the broker over the
+ * handoff socket (SCM_RIGHTS). The memory has no file name, is sealed
+ * read-only before it is sent and the descriptor is closed once sent.
+ * Base64 images are shared decoded. Where descriptors cannot be passed
+ * (Windows, no addon) large payloads go inline too.
+ */
+export async function createPayload(
+	data: PrintData,
+	isImage: boolean,
+	handoffPath: string,
+): Promise<BrokerPayload> {
+	const length =
+		typeof data === 'string' ? Buffer.byteLength(data) : data.length;
+	const addon = loadNativeAddon();
+	if (length < SHARED_PAYLOAD_THRESHOLD || !addon?.sendDescriptor) {
+		return inlinePayload(data);
+	}
+
+	const bytes =
+		typeof data !== 'string'
+			? data
+			: isImage
+				? decodeBase64Image(data)
+				: Buffer.from(data, 'utf8');
+	let memory: { fd: number; buffer: Buffer } | null = null;
+	try {
+		memory = addon.createSharedMemory(SHARED_MEMORY_NAME, bytes.length);
+	} catch (error) {
+		log.debug('Shared memory unavailable; sending inline', { error });
+	}
+	if (!memory) {
+		return inlinePayload(bytes);
+	}
+
+	const handle = randomUUID();
+	try {
+		bytes.copy(memory.buffer);
+		// The broker refuses memory the client could still change
+		addon.sealSharedMemory(memory.buffer);
+		await addon.sendDescriptor(handoffPath, handle, memory.fd);
+	} catch (error) {
+		log.debug('Descriptor handoff failed; sending inline', { error });
+		return inlinePayload(bytes);
+	} finally {
+		// The broker holds its own descriptor now
+		fs.closeSync(memory.fd);
+	}
+	return { handle, length: bytes.length };
+}
+
+/**
+ * Job data of an inline payload
+ */
+export function readInlinePayload(
+	payload: Extract<BrokerPayload, { inline: string }>,
+): PrintData {
+	return payload.binary
+		? Buffer.from(payload.inline, 'base64')
+		: payload.inline;
+}
+
+/**
+ * Broker side of the descriptor handoff: maps each shared-memory
+ * descriptor as it arrives and hands it to the print message naming its
+ * tag. Either may come first.
+ */
+export class SharedPayloadReceiver {
+	private receiver: DescriptorReceiver | undefined;
+	private readonly received = new Map<
+		string,
+		{ payload: Buffer | Error; timer: NodeJS.Timeout }
+	>();
+	private readonly waiting = new Map<
+		string,
+		(payload: Buffer | Error) => void
+	>();
+
+	/**
+	 * Listen on socketPath; a no-op where descriptors cannot be passed
+	 */
+	start(socketPath: string): void {
+		const addon = loadNativeAddon();
+		if (!addon?.DescriptorReceiver || this.receiver) {
+			return;
+		}
+		const receiver = new addon.DescriptorReceiver(socketPath);
+		receiver.start(
+			(tag, payload) => this.deliver(tag, payload),
+			(error) => {
+				if (error) {
+					log.error('Payload handoff stopped', { error });
+				}
+			},
+		);
+		this.receiver = receiver;
+	}
+
+	stop(): void {
+		this.receiver?.stop();
+		this.receiver = undefined;
+		for (const { timer } of this.received.values()) {
+			clearTimeout(timer);
+		}
+		this.received.clear();
+		const closed = new Error('Print broker stopped');
+		for (const resolve of this.waiting.values()) {
+			resolve(closed);
+		}
+		this.waiting.clear();
+	}
+
+	/**
+	 * The mapped payload sent under handle, cut to length
+	 */
+	async take(handle: string, length: number): Promise<Buffer> {
+		const payload = await this.claim(handle);
+		if (payload instanceof Error) {
+			throw payload;
+		}
+		if (payload.length < length) {
+			throw new Error(
+				`Shared payload holds ${payload.length} of ${length} bytes`,
+			);
+		}
+		return payload.subarray(0, length);
+	}
+
+	private claim(handle: string): Promise<Buffer | Error> {
+		const ready = this.received.get(handle);
+		if (ready) {
+			clearTimeout(ready.timer);
+			this.received.delete(handle);
+			return Promise.resolve(ready.payload);
+		}
+		if (!this.receiver || this.waiting.has(handle)) {
+			return Promise.resolve(
+				new Error(`Shared payload ${handle} is not available`),
+			);
+		}
+		return new Promise((resolve) => {
+			const timer = setTimeout(() => {
+				this.waiting.delete(handle);
+				resolve(new Error(`Shared payload ${handle} did not arrive`));
+			}, HANDOFF_TIMEOUT_MS);
+			this.waiting.set(handle, (payload) => {
+				clearTimeout(timer);
+				resolve(payload);
+			});
+		});
+	}
+
+	private deliver(tag: string, payload: Buffer | Error): void {
+		const waiter = this.waiting.get(tag);
+		if (waiter) {
+			this.waiting.delete(tag);
+			waiter(payload);
+			return;
+		}
+		const earlier = this.received.get(tag);
+		if (earlier) {
+			clearTimeout(earlier.timer);
+		}
+		// Dropped if its sender never follows up with the print message
+		const timer = setTimeout(
+			() => this.received.delete(tag),
+			HANDOFF_TIMEOUT_MS,
+		);
+		timer.unref();
+		this.received.set(tag, { payload, timer });
+	}
+}
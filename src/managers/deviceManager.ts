@@ -1,4 +1,5 @@
 import { usb } from 'usb';
+import { deviceConfigChanged } from '../core/deviceConfig';
 import {
 	devicesWithSavedConfig,
 	getConnectedDevices,
@@ -8,9 +9,12 @@ import {
 	type DeviceDisconnectCallback,
 	DeviceEventEmitter,
 } from '../core/deviceEvents';
+import { getLogger } from '../core/logger';
 import type { DeviceConfig, DeviceType, TerminalDevice } from '../core/types';
 import { DeviceConfigService } from '../services/deviceConfigService';
 
+const log = getLogger('device');
+
 export class DeviceManager {
 	private devices = new Map<string, TerminalDevice>();
 	private events = new DeviceEventEmitter();
@@ -127,10 +131,10 @@ export class DeviceManager {
 					// Update existing device metadata
 					const existingDevice = this.devices.get(device.id);
 					if (!existingDevice) continue;
-					const hasChanges =
-						existingDevice.meta.deviceType !== device.meta.deviceType ||
-						existingDevice.meta.setToDefault !== device.meta.setToDefault ||
-						existingDevice.meta.baudrate !== device.meta.baudrate;
+					const hasChanges = deviceConfigChanged(
+						existingDevice.meta,
+						device.meta,
+					);
 
 					if (hasChanges) {
 						this.devices.set(device.id, device);
@@ -150,7 +154,7 @@ export class DeviceManager {
 				}
 			}
 		} catch (error) {
-			console.error('Error refreshing devices:', error);
+			log.error('Failed to refresh devices', { error });
 		} finally {
 			this.refreshInProgress = false;
 			// If another refresh was requested while this one was running, do it once more
@@ -190,25 +194,25 @@ export class DeviceManager {
 				if (!this.devices.has(device.id)) {
 					this.devices.set(device.id, device);
 					this.events.emitDeviceConnect(device);
-					console.log(`Added device via targeted refresh: ${device.id}`);
+					log.info('Added device', { deviceId: device.id });
 				} else {
 					// Update existing device metadata
 					const existingDevice = this.devices.get(device.id);
 					if (!existingDevice) continue;
-					const hasChanges =
-						existingDevice.meta.deviceType !== device.meta.deviceType ||
-						existingDevice.meta.setToDefault !== device.meta.setToDefault ||
-						existingDevice.meta.baudrate !== device.meta.baudrate;
+					const hasChanges = deviceConfigChanged(
+						existingDevice.meta,
+						device.meta,
+					);
 
 					if (hasChanges) {
 						this.devices.set(device.id, device);
 						this.events.emitDeviceConnect(device);
-						console.log(`Updated device via targeted refresh: ${device.id}`);
+						log.info('Updated device', { deviceId: device.id });
 					}
 				}
 			}
 		} catch (error) {
-			console.error(`Error in targeted refresh for ${vid}:${pid}:`, error);
+			log.error('Targeted refresh failed', { vid, pid, error });
 		}
 	}
 
@@ -234,11 +238,11 @@ export class DeviceManager {
 				if (!currentDeviceIds.has(deviceId)) {
 					this.devices.delete(deviceId);
 					this.events.emitDeviceDisconnect(deviceId);
-					console.log(`Removed disconnected device: ${deviceId}`);
+					log.info('Removed disconnected device', { deviceId });
 				}
 			}
 		} catch (error) {
-			console.error('Error checking for disconnected devices:', error);
+			log.error('Failed to check for disconnected devices', { error });
 		}
 	}
 
@@ -267,22 +271,20 @@ export class DeviceManager {
 				if (this.devices.has(device.id)) {
 					const existingDevice = this.devices.get(device.id);
 					if (!existingDevice) continue;
-					const hasChanges =
-						existingDevice.meta.deviceType !== device.meta.deviceType ||
-						existingDevice.meta.setToDefault !== device.meta.setToDefault ||
-						existingDevice.meta.baudrate !== device.meta.baudrate ||
-						existingDevice.meta.brand !== device.meta.brand ||
-						existingDevice.meta.model !== device.meta.model;
+					const hasChanges = deviceConfigChanged(
+						existingDevice.meta,
+						device.meta,
+					);
 
 					if (hasChanges) {
 						this.devices.set(device.id, device);
 						this.events.emitDeviceConnect(device);
-						console.log(`Updated device config: ${device.id}`);
+						log.info('Updated device config', { deviceId: device.id });
 					}
 				}
 			}
 		} catch (error) {
-			console.error(`Error refreshing config for ${vid}:${pid}:`, error);
+			log.error('Failed to refresh device config', { vid, pid, error });
 		}
 	}
 
@@ -291,7 +293,7 @@ export class DeviceManager {
 			// Targeted refresh for the specific attached device
 			const vid = device.deviceDescriptor.idVendor;
 			const pid = device.deviceDescriptor.idProduct;
-			console.log(`USB device attached: ${vid}:${pid}`);
+			log.debug('USB device attached', { vid, pid });
 			this.refreshDeviceByVidPid(vid, pid);
 		});
 
@@ -299,7 +301,7 @@ export class DeviceManager {
 			// Check for disconnected devices
 			const vid = device.deviceDescriptor.idVendor;
 			const pid = device.deviceDescriptor.idProduct;
-			console.log(`USB device detached: ${vid}:${pid}`);
+			log.debug('USB device detached', { vid, pid });
 			this.checkForDisconnectedDevices();
 		});
 	}
@@ -359,12 +361,12 @@ export class DeviceManager {
 	async setDeviceAsDefault(deviceId: string): Promise<boolean> {
 		const device = this.getDevice(deviceId);
 		if (!device) {
-			console.error(`Device ${deviceId} not found`);
+			log.error('Device not found', { deviceId });
 			return false;
 		}
 
 		if (device.meta.deviceType === 'unassigned') {
-			console.error(`Cannot set unassigned device ${deviceId} as default`);
+			log.error('Cannot set unassigned device as default', { deviceId });
 			return false;
 		}
 
@@ -382,7 +384,7 @@ export class DeviceManager {
 	async unsetDeviceAsDefault(deviceId: string): Promise<boolean> {
 		const device = this.getDevice(deviceId);
 		if (!device) {
-			console.error(`Device ${deviceId} not found`);
+			log.error('Device not found', { deviceId });
 			return false;
 		}
 
@@ -0,0 +1,241 @@
+import { finished, type Writable } from 'node:stream';
+import { parentPort, workerData } from 'node:worker_threads';
+import type { CustomerDisplayOptions } from '../adaptor/customerDisplayAdaptor';
+import type { RetryOptions } from '../core/retryUtils';
+import { DeviceManager } from './deviceManager';
+import { DisplayManager } from './displayManager';
+import { PrinterManager } from './printerManager';
+import { ScaleManager } from './scaleManager';
+import { ScannerManager } from './scannerManager';
+import {
+	type CallMessage,
+	decodeWireValue,
+	encodeWireValue,
+	type MainToWorkerMessage,
+	type ManagerTarget,
+	type StreamMessage,
+	type WorkerToMainMessage,
+} from './workerProtocol';
+
+// Worker-thread host for the device stack. The main thread talks to it
+// through the proxies in workerProxy.ts.
+
+if (!parentPort) {
+	throw new Error('deviceWorker must be started as a worker thread');
+}
+
+const port = parentPort;
+const options = (workerData ?? {}) as {
+	scannerRetry?: Partial<RetryOptions>;
+	scaleRetry?: Partial<RetryOptions>;
+	displayRetry?: Partial<RetryOptions>;
+	display?: CustomerDisplayOptions;
+};
+
+const deviceManager = new DeviceManager();
+const printerManager = new PrinterManager(deviceManager);
+const targets: Record<ManagerTarget, object> = {
+	deviceManager,
+	printerManager,
+	scannerManager: new ScannerManager(deviceManager, options.scannerRetry),
+	scaleManager: new ScaleManager(
+		deviceManager,
+		options.scaleRetry,
+		printerManager,
+	),
+	displayManager: new DisplayManager(
+		deviceManager,
+		options.displayRetry,
+		options.display,
+	),
+};
+
+type Forwarder = (...args: unknown[]) => void;
+
+// One forwarder per main-thread callback, so remove* calls see the same
+// function. They are held weakly: once the managers drop one, the main
+// thread is told to drop its callback too.
+const forwarders = new Map<number, WeakRef<Forwarder>>();
+const lastCallIds = new Map<number, number>();
+
+const post = (message: WorkerToMainMessage, transfer: ArrayBuffer[] = []) => {
+	port.postMessage(message, transfer);
+};
+
+const collected = new FinalizationRegistry<number>((callbackId) => {
+	if (forwarders.get(callbackId)?.deref()) {
+		return; // A later call made a new forwarder for the id
+	}
+	forwarders.delete(callbackId);
+	post({
+		type: 'releaseCallback',
+		callbackId,
+		lastCallId: lastCallIds.get(callbackId) ?? 0,
+	});
+	lastCallIds.delete(callbackId);
+});
+
+const getForwarder = (callbackId: number, callId: number) => {
+	lastCallIds.set(callbackId, callId);
+	let forwarder = forwarders.get(callbackId)?.deref();
+	if (!forwarder) {
+		forwarder = (...args: unknown[]) => {
+			const transfer: ArrayBuffer[] = [];
+			const encoded = args.map((arg) => encodeWireValue(arg, transfer));
+			post({ type: 'callback', callbackId, args: encoded }, transfer);
+		};
+		forwarders.set(callbackId, new WeakRef(forwarder));
+		collected.register(forwarder, callbackId);
+	}
+	return forwarder;
+};
+
+const forwardDeviceEvents = () => {
+	deviceManager.onDeviceConnect((device) => {
+		post({ type: 'connect', device, devices: deviceManager.getDevices() });
+	});
+	deviceManager.onDeviceDisconnect((deviceId) => {
+		post({ type: 'disconnect', deviceId, devices: deviceManager.getDevices() });
+	});
+	deviceManager.getEventEmitter().onDeviceError((deviceId, error) => {
+		post({
+			type: 'deviceError',
+			deviceId,
+			name: error.name,
+			message: error.message,
+		});
+	});
+};
+
+// Signals of the calls in flight that the main thread may abort
+const callAborts = new Map<number, AbortController>();
+
+const handleCall = async (message: CallMessage) => {
+	const target = targets[message.target] as Record<string, unknown>;
+	const method = target[message.method];
+	if (typeof method !== 'function') {
+		throw new Error(`${message.target}.${message.method} is not a function`);
+	}
+
+	const args = message.args.map((arg) =>
+		decodeWireValue(arg, (callbackId) => getForwarder(callbackId, message.id)),
+	);
+	const { signalArg } = message;
+	if (signalArg !== undefined) {
+		const controller = new AbortController();
+		callAborts.set(message.id, controller);
+		args[signalArg] = {
+			...(args[signalArg] as object),
+			signal: controller.signal,
+		};
+	}
+	let result: unknown;
+	try {
+		result = await method.apply(target, args);
+	} finally {
+		callAborts.delete(message.id);
+	}
+
+	// DeviceManager.stop() clears every listener, including ours
+	if (message.target === 'deviceManager' && message.method === 'stop') {
+		forwardDeviceEvents();
+	}
+	return result;
+};
+
+// Streams opened through PrinterManagerProxy.createWriteStream
+const streams = new Map<number, { stream: Writable; error?: Error }>();
+
+const ackStream = (streamId: number, error?: Error) => {
+	post({
+		type: 'streamAck',
+		streamId,
+		name: error?.name,
+		message: error?.message,
+	});
+};
+
+const handleStream = (message: StreamMessage) => {
+	const { streamId } = message;
+	if (message.op === 'open') {
+		try {
+			const hosted: { stream: Writable; error?: Error } = {
+				stream: printerManager.createWriteStream(
+					message.printerName ?? '',
+					message.options,
+				),
+			};
+			hosted.stream.on('error', (error) => {
+				hosted.error = error;
+			});
+			streams.set(streamId, hosted);
+			ackStream(streamId);
+		} catch (error) {
+			const err = error instanceof Error ? error : new Error(String(error));
+			ackStream(streamId, err);
+		}
+		return;
+	}
+
+	const hosted = streams.get(streamId);
+	if (!hosted) {
+		if (message.op !== 'destroy') {
+			ackStream(streamId, new Error(`Stream ${streamId} is not open`));
+		}
+		return;
+	}
+
+	switch (message.op) {
+		case 'write':
+			if (hosted.error) {
+				ackStream(streamId, hosted.error);
+				return;
+			}
+			hosted.stream.write(decodeWireValue(message.chunk), (error) =>
+				ackStream(streamId, error ?? undefined),
+			);
+			break;
+		case 'end':
+			streams.delete(streamId);
+			finished(hosted.stream, (error) =>
+				ackStream(streamId, error ?? undefined),
+			);
+			hosted.stream.end();
+			break;
+		case 'destroy':
+			streams.delete(streamId);
+			hosted.stream.destroy();
+			break;
+	}
+};
+
+port.on('message', (message: MainToWorkerMessage) => {
+	if (message.type === 'stream') {
+		handleStream(message);
+		return;
+	}
+	if (message.type === 'abort') {
+		callAborts.get(message.id)?.abort();
+		return;
+	}
+
+	handleCall(message).then(
+		(result) => {
+			const transfer: ArrayBuffer[] = [];
+			const value = encodeWireValue(result, transfer);
+			post({ type: 'result', id: message.id, value }, transfer);
+		},
+		(error) => {
+			const err = error instanceof Error ? error : new Error(String(error));
+			post({
+				type: 'error',
+				id: message.id,
+				name: err.name,
+				message: err.message,
+			});
+		},
+	);
+});
+
+forwardDeviceEvents();
+post({ type: 'ready' });
@@ -0,0 +1,203 @@
+import {
+	CustomerDisplayAdapter,
+	type CustomerDisplayOptions,
+	type CustomerDisplayStats,
+} from '../adaptor/customerDisplayAdaptor';
+import { getLogger } from '../core/logger';
+import type { RetryOptions } from '../core/retryUtils';
+import type { TerminalDevice } from '../core/types';
+import type { DeviceManager } from './deviceManager';
+
+const log = getLogger('display');
+
+export class DisplayManager {
+	private deviceManager: DeviceManager;
+	private displayAdapters = new Map<string, CustomerDisplayAdapter>();
+	// Shared by updates that race a display's first open
+	private openingAdapters = new Map<string, Promise<CustomerDisplayAdapter>>();
+	private contents = new Map<string, string[]>(); // Last lines per display, repainted on reconnect
+	private pendingDefaultLines: string[] | undefined; // Shown when a default display connects
+	private retryOptions: Partial<RetryOptions>;
+
+	constructor(
+		deviceManager: DeviceManager,
+		retryOptions: Partial<RetryOptions> = {},
+		private readonly options: CustomerDisplayOptions = {},
+	) {
+		this.deviceManager = deviceManager;
+		this.retryOptions = retryOptions;
+		this.setupEventListeners();
+	}
+
+	/**
+	 * Show lines on a display; only the characters that changed are sent.
+	 * Calls faster than the display refreshes are merged, and a display
+	 * that is not connected shows the latest lines once it is.
+	 */
+	async show(deviceId: string, lines: string[]): Promise<void> {
+		this.contents.set(deviceId, [...lines]);
+
+		const device = this.deviceManager.getDevice(deviceId);
+		if (!device) {
+			log.info('Device not found; lines kept until it connects', {
+				deviceId,
+			});
+			return;
+		}
+
+		if (device.meta.deviceType !== 'display') {
+			throw new Error(`Device ${deviceId} is not a customer display`);
+		}
+
+		const adapter = await this.getDisplayAdapter(device);
+		await adapter.show(lines);
+	}
+
+	async showOnDefault(lines: string[]): Promise<void> {
+		const defaultDisplayId = this.deviceManager.getDefaultDeviceId('display');
+		if (!defaultDisplayId) {
+			log.info('No default display; lines kept until one connects');
+			this.pendingDefaultLines = [...lines];
+			return;
+		}
+
+		await this.show(defaultDisplayId, lines);
+	}
+
+	clear(deviceId: string): Promise<void> {
+		return this.show(deviceId, []);
+	}
+
+	clearDefault(): Promise<void> {
+		return this.showOnDefault([]);
+	}
+
+	async ensureDisplayAdapter(device: TerminalDevice): Promise<void> {
+		await this.getDisplayAdapter(device);
+	}
+
+	private async getDisplayAdapter(
+		device: TerminalDevice,
+	): Promise<CustomerDisplayAdapter> {
+		const existing =
+			this.displayAdapters.get(device.id) ??
+			this.openingAdapters.get(device.id);
+		if (existing) {
+			return existing;
+		}
+
+		const opening = this.openDisplayAdapter(device);
+		this.openingAdapters.set(device.id, opening);
+		try {
+			return await opening;
+		} finally {
+			this.openingAdapters.delete(device.id);
+		}
+	}
+
+	private async openDisplayAdapter(
+		device: TerminalDevice,
+	): Promise<CustomerDisplayAdapter> {
+		if (device.meta.deviceType !== 'display') {
+			throw new Error(
+				`Device ${device.id} must be configured as a customer display`,
+			);
+		}
+
+		try {
+			const adapter = new CustomerDisplayAdapter(
+				device,
+				this.retryOptions,
+				this.options,
+			);
+
+			adapter.onError((error) => {
+				log.error('Display adapter error', { deviceId: device.id, error });
+				this.deviceManager
+					.getEventEmitter()
+					.emitDeviceError(device.id, new Error(String(error)));
+				this.closeDisplayAdapter(device.id);
+			});
+
+			await adapter.open();
+			this.displayAdapters.set(device.id, adapter);
+			log.info('Display adapter created', { deviceId: device.id });
+			return adapter;
+		} catch (error) {
+			log.error('Failed to create display adapter', {
+				deviceId: device.id,
+				error,
+			});
+			throw error;
+		}
+	}
+
+	async closeDisplayAdapter(deviceId: string): Promise<void> {
+		const adapter = this.displayAdapters.get(deviceId);
+		if (adapter) {
+			this.displayAdapters.delete(deviceId);
+			try {
+				await adapter.close();
+			} catch (error) {
+				log.error('Failed to close display adapter', { deviceId, error });
+			}
+		}
+	}
+
+	async closeAllDisplayAdapters(): Promise<void> {
+		const adapters = Array.from(this.displayAdapters.keys());
+		for (const deviceId of adapters) {
+			await this.closeDisplayAdapter(deviceId);
+		}
+	}
+
+	getDisplayDevices(): TerminalDevice[] {
+		return this.deviceManager.getDevicesByType('display');
+	}
+
+	getDefaultDisplay(): TerminalDevice | undefined {
+		return this.deviceManager.getDefaultDevice('display');
+	}
+
+	/**
+	 * Lines last given for a display, whether or not it is connected
+	 */
+	getLines(deviceId: string): string[] | null {
+		return this.contents.get(deviceId) ?? null;
+	}
+
+	/**
+	 * Update, write and byte counts of an open display, null when it has
+	 * no adapter
+	 */
+	getDisplayStats(deviceId: string): CustomerDisplayStats | null {
+		return this.displayAdapters.get(deviceId)?.getStats() ?? null;
+	}
+
+	private setupEventListeners(): void {
+		// Repaint displays that come back, and take pending default lines
+		this.deviceManager.onDeviceConnect(async (device) => {
+			if (device.meta.deviceType !== 'display') {
+				return;
+			}
+			try {
+				if (device.meta.setToDefault && this.pendingDefaultLines) {
+					this.contents.set(device.id, this.pendingDefaultLines);
+					this.pendingDefaultLines = undefined;
+				}
+				const lines = this.contents.get(device.id);
+				if (lines) {
+					await this.show(device.id, lines);
+					log.info('Restored display content', { deviceId: device.id });
+				}
+			} catch (error) {
+				log.error('Failed to process device', { deviceId: device.id, error });
+			}
+		});
+
+		// Close adapters when displays disconnect (but keep their content)
+		this.deviceManager.onDeviceDisconnect(async (deviceId) => {
+			await this.closeDisplayAdapter(deviceId);
+		});
+	}
+}
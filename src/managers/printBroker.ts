@@ -0,0 +1,440 @@
+import * as fs from 'node:fs';
+import * as net from 'node:net';
+import * as path from 'node:path';
+import { TransportPrinterAdapter } from '../adaptor/transportPrinterAdapter';
+import { getLogger } from '../core/logger';
+import { PrintQueue } from '../core/printQueue';
+import type { PrintData, TerminalDevice } from '../core/types';
+import {
+	type BrokerMetrics,
+	type BrokerPayload,
+	type BrokerPrintTarget,
+	type BrokerToClientMessage,
+	type ClientToBrokerMessage,
+	defaultBrokerSocketPath,
+	handoffSocketPath,
+	onMessages,
+	readInlinePayload,
+	SharedPayloadReceiver,
+	sendMessage,
+} from './brokerProtocol';
+import type { DeviceManager } from './deviceManager';
+import type { PrinterManager } from './printerManager';
+
+const log = getLogger('broker');
+
+const DEFAULT_PRINT_TIMEOUT_MS = 60_000;
+const MIN_METRICS_INTERVAL_MS = 100;
+
+// Sockets are created owner-only from the start: a chmod after listen()
+// would leave a window in which other users could connect
+const ownerOnly = <T>(create: () => T): T => {
+	if (process.platform === 'win32') {
+		return create();
+	}
+	const umask = process.umask(0o177);
+	try {
+		return create();
+	} finally {
+		process.umask(umask);
+	}
+};
+
+export interface PrintBrokerOptions {
+	/** Unix domain socket path or Windows pipe name */
+	socketPath?: string;
+	/**
+	 * Transport URIs clients may print to and take output from: exact URIs,
+	 * or patterns such as /^emu:\/\//. None by default.
+	 */
+	transports?: Array<string | RegExp>;
+}
+
+interface BrokerClient {
+	socket: net.Socket;
+	jobs: Map<number, AbortController>;
+	metricsTimer?: NodeJS.Timeout;
+}
+
+// Transport targets are not detected devices; describe them as one
+const transportDevice = (uri: string, profile?: string): TerminalDevice => ({
+	id: uri,
+	vid: '',
+	pid: '',
+	path: uri,
+	name: uri,
+	serialNumber: '',
+	manufacturer: '',
+	meta: {
+		deviceType: 'printer',
+		brand: '',
+		model: '',
+		baudrate: 'not-supported',
+		setToDefault: false,
+		transport: uri,
+		profile,
+	},
+	capabilities: ['write'],
+});
+
+/**
+ * Lets several local processes share the same printers. The process
+ * running the broker owns every printer adapter and transport; others
+ * submit jobs with PrintBrokerClient over a Unix domain socket (a named
+ * pipe on Windows). Large payloads arrive as shared-memory descriptors and
+ * are mapped rather than copied through the socket. Job outcomes, printer
+ * status and metrics stream back to the clients.
+ */
+export class PrintBroker {
+	private readonly socketPath: string;
+	private readonly allowedTransports: Array<string | RegExp>;
+	private server: net.Server | undefined;
+	private readonly sharedPayloads = new SharedPayloadReceiver();
+	private readonly clients = new Set<BrokerClient>();
+	private readonly transportQueue = new PrintQueue();
+	private readonly transports = new Map<string, TransportPrinterAdapter>();
+	private counters = {
+		submitted: 0,
+		completed: 0,
+		failed: 0,
+		sharedPayloads: 0,
+		sharedBytes: 0,
+		inlineBytes: 0,
+	};
+
+	constructor(
+		private readonly deviceManager: DeviceManager,
+		private readonly printerManager: PrinterManager,
+		options: PrintBrokerOptions = {},
+	) {
+		this.socketPath = options.socketPath ?? defaultBrokerSocketPath();
+		this.allowedTransports = options.transports ?? [];
+
+		this.deviceManager.onDeviceConnect((device) => {
+			if (device.meta.deviceType === 'printer') {
+				this.broadcast({
+					type: 'status',
+					event: 'connect',
+					deviceId: device.id,
+				});
+			}
+		});
+		this.deviceManager.onDeviceDisconnect((deviceId) => {
+			this.broadcast({ type: 'status', event: 'disconnect', deviceId });
+		});
+		this.deviceManager.getEventEmitter().onDeviceError((deviceId, error) => {
+			this.broadcast({
+				type: 'status',
+				event: 'error',
+				deviceId,
+				message: error.message,
+			});
+		});
+	}
+
+	/**
+	 * Listen for clients. A socket file left behind by a broker that died
+	 * is replaced; one that still answers means another broker is running.
+	 */
+	async start(): Promise<void> {
+		if (this.server) {
+			return;
+		}
+		const handoffPath = handoffSocketPath(this.socketPath);
+		if (process.platform !== 'win32') {
+			await fs.promises.mkdir(path.dirname(this.socketPath), {
+				recursive: true,
+			});
+			if (fs.existsSync(this.socketPath)) {
+				if (await this.isBrokerRunning()) {
+					throw new Error(
+						`A print broker is already listening on ${this.socketPath}`,
+					);
+				}
+				fs.rmSync(this.socketPath, { force: true });
+			}
+			fs.rmSync(handoffPath, { force: true });
+		}
+
+		const server = net.createServer((socket) => this.accept(socket));
+		await new Promise<void>((resolve, reject) => {
+			server.once('error', reject);
+			ownerOnly(() =>
+				server.listen(this.socketPath, () => {
+					server.off('error', reject);
+					resolve();
+				}),
+			);
+		});
+		try {
+			ownerOnly(() => this.sharedPayloads.start(handoffPath));
+		} catch (error) {
+			server.close();
+			throw error;
+		}
+		this.server = server;
+		log.info('Print broker listening', { socketPath: this.socketPath });
+	}
+
+	/**
+	 * Stop accepting jobs, disconnect clients and close broker transports.
+	 * Jobs already queued on printers still print.
+	 */
+	async stop(): Promise<void> {
+		const server = this.server;
+		if (!server) {
+			return;
+		}
+		this.server = undefined;
+		for (const client of this.clients) {
+			client.socket.destroy();
+		}
+		await new Promise<void>((resolve) => server.close(() => resolve()));
+		this.sharedPayloads.stop();
+		for (const adapter of this.transports.values()) {
+			await adapter.close();
+		}
+		this.transports.clear();
+	}
+
+	getMetrics(): BrokerMetrics {
+		return {
+			clients: this.clients.size,
+			...this.counters,
+			printers: this.printerManager.getPrinterDevices().map((device) => ({
+				deviceId: device.id,
+				queueDepth: this.printerManager.getPrintQueueDepth(device.id),
+			})),
+			transports: Array.from(this.transports.keys(), (uri) => ({
+				uri,
+				queueDepth: this.transportQueue.getQueueDepth(uri),
+			})),
+		};
+	}
+
+	private accept(socket: net.Socket): void {
+		const client: BrokerClient = { socket, jobs: new Map() };
+		this.clients.add(client);
+		onMessages<ClientToBrokerMessage>(socket, (message) =>
+			this.handleMessage(client, message),
+		);
+		socket.on('error', () => {});
+		socket.on('close', () => {
+			// Jobs of a client that went away still print
+			clearInterval(client.metricsTimer);
+			this.clients.delete(client);
+		});
+	}
+
+	private handleMessage(
+		client: BrokerClient,
+		message: ClientToBrokerMessage,
+	): void {
+		switch (message.type) {
+			case 'print':
+				this.print(client, message);
+				break;
+			case 'cancel':
+				client.jobs.get(message.id)?.abort();
+				break;
+			case 'takeOutput':
+				this.takeOutput(client, message.id, message.transport);
+				break;
+			case 'subscribe':
+				clearInterval(client.metricsTimer);
+				client.metricsTimer = setInterval(
+					() =>
+						sendMessage(client.socket, {
+							type: 'metrics',
+							metrics: this.getMetrics(),
+						}),
+					Math.max(MIN_METRICS_INTERVAL_MS, message.intervalMs),
+				);
+				break;
+		}
+	}
+
+	private async print(
+		client: BrokerClient,
+		message: Extract<ClientToBrokerMessage, { type: 'print' }>,
+	): Promise<void> {
+		const { id, target, isImage, timeoutMs, payload } = message;
+		this.counters.submitted++;
+
+		// Registered first: a cancel may come while the payload is in transit
+		const controller = new AbortController();
+		client.jobs.set(id, controller);
+		let data: PrintData;
+		try {
+			this.checkTarget(target);
+			data = await this.readPayload(payload);
+		} catch (error) {
+			client.jobs.delete(id);
+			this.counters.failed++;
+			this.reply(client, { type: 'accepted', id });
+			this.replyError(client, id, error);
+			return;
+		}
+		this.reply(client, { type: 'accepted', id });
+
+		try {
+			await this.route(target, data, isImage, {
+				timeoutMs,
+				signal: controller.signal,
+			});
+			this.counters.completed++;
+			this.reply(client, { type: 'done', id });
+		} catch (error) {
+			this.counters.failed++;
+			this.replyError(client, id, error);
+		} finally {
+			client.jobs.delete(id);
+		}
+	}
+
+	// Shared payloads stay in their read-only mapping all the way to the
+	// adapter
+	private async readPayload(payload: BrokerPayload): Promise<PrintData> {
+		if ('inline' in payload) {
+			const data = readInlinePayload(payload);
+			this.counters.inlineBytes += Buffer.byteLength(data);
+			return data;
+		}
+		const data = await this.sharedPayloads.take(
+			payload.handle,
+			payload.length,
+		);
+		this.counters.sharedPayloads++;
+		this.counters.sharedBytes += data.length;
+		return data;
+	}
+
+	private route(
+		target: BrokerPrintTarget,
+		data: PrintData,
+		isImage: boolean,
+		options: { timeoutMs?: number; signal: AbortSignal },
+	): Promise<unknown> {
+		if ('device' in target) {
+			return this.printerManager.printToDevice(
+				target.device,
+				data,
+				isImage,
+				options,
+			);
+		}
+		if ('group' in target) {
+			return this.printerManager.printToGroup(
+				target.group,
+				data,
+				isImage,
+				options,
+			);
+		}
+		if ('transport' in target) {
+			return this.printToTransport(target, data, isImage, options);
+		}
+		return this.printerManager.printToDefault(data, isImage, options);
+	}
+
+	// Broker-owned transports get their own per-URI queue, like printers do
+	private async printToTransport(
+		target: { transport: string; profile?: string },
+		data: PrintData,
+		isImage: boolean,
+		options: { timeoutMs?: number; signal: AbortSignal },
+	): Promise<void> {
+		const uri = target.transport;
+		const adapter = this.transportAdapter(uri, target.profile);
+		await this.transportQueue.enqueue(
+			uri,
+			async ({ signal, timeoutMs, reset, prepared }) => {
+				const job = await prepared;
+				await adapter.write(data, isImage, {
+					signal,
+					timeoutMs,
+					reset,
+					prepared: job,
+				});
+			},
+			{
+				timeoutMs: options.timeoutMs ?? DEFAULT_PRINT_TIMEOUT_MS,
+				signal: options.signal,
+			},
+			() => adapter.prepare(data, isImage),
+		);
+	}
+
+	private async takeOutput(
+		client: BrokerClient,
+		id: number,
+		uri: string,
+	): Promise<void> {
+		try {
+			this.checkTarget({ transport: uri });
+			const output = await this.transportAdapter(uri).takeOutput();
+			this.reply(client, {
+				type: 'output',
+				id,
+				data: output.toString('base64'),
+			});
+		} catch (error) {
+			this.replyError(client, id, error);
+		}
+	}
+
+	// Transport URIs let a client open files and connections as the broker's
+	// user, so only those the broker was configured with are accepted
+	private checkTarget(target: BrokerPrintTarget): void {
+		if (!('transport' in target)) {
+			return;
+		}
+		const uri = target.transport;
+		const allowed = this.allowedTransports.some((entry) =>
+			typeof entry === 'string' ? entry === uri : entry.test(uri),
+		);
+		if (!allowed) {
+			throw new Error(`Transport ${uri} is not allowed by the print broker`);
+		}
+	}
+
+	private transportAdapter(
+		uri: string,
+		profile?: string,
+	): TransportPrinterAdapter {
+		let adapter = this.transports.get(uri);
+		if (!adapter) {
+			// Throws for anything but a transport URI
+			adapter = new TransportPrinterAdapter(transportDevice(uri, profile));
+			this.transports.set(uri, adapter);
+		}
+		return adapter;
+	}
+
+	private reply(client: BrokerClient, message: BrokerToClientMessage): void {
+		sendMessage(client.socket, message);
+	}
+
+	private replyError(client: BrokerClient, id: number, error: unknown): void {
+		const { name, message } =
+			error instanceof Error ? error : new Error(String(error));
+		this.reply(client, { type: 'failed', id, name, message });
+	}
+
+	private broadcast(message: BrokerToClientMessage): void {
+		for (const client of this.clients) {
+			sendMessage(client.socket, message);
+		}
+	}
+
+	private isBrokerRunning(): Promise<boolean> {
+		return new Promise((resolve) => {
+			const probe = net.connect(this.socketPath);
+			probe.once('connect', () => {
+				probe.destroy();
+				resolve(true);
+			});
+			probe.once('error', () => resolve(false));
+		});
+	}
+}
@@ -0,0 +1,226 @@
+import * as net from 'node:net';
+import type { PrintData, PrintJobOptions } from '../core/types';
+import {
+	type BrokerMetrics,
+	type BrokerPrintTarget,
+	type BrokerStatusEvent,
+	type BrokerToClientMessage,
+	type ClientToBrokerMessage,
+	createPayload,
+	defaultBrokerSocketPath,
+	handoffSocketPath,
+	onMessages,
+	sendMessage,
+} from './brokerProtocol';
+
+interface PendingRequest {
+	resolve: (value: BrokerToClientMessage) => void;
+	reject: (error: Error) => void;
+}
+
+const toError = (name: string, message: string): Error => {
+	const error = new Error(message);
+	error.name = name;
+	return error;
+};
+
+/**
+ * Submits print jobs to a PrintBroker in another local process. Errors
+ * keep the name they had in the broker (PrintJobCancelledError,
+ * PrintJobTimeoutError, ...).
+ */
+export class PrintBrokerClient {
+	private nextId = 1;
+	private readonly pending = new Map<number, PendingRequest>();
+	private readonly metricsCallbacks: Array<(metrics: BrokerMetrics) => void> =
+		[];
+	private readonly statusCallbacks: Array<(status: BrokerStatusEvent) => void> =
+		[];
+
+	private constructor(
+		private readonly socket: net.Socket,
+		private readonly socketPath: string,
+	) {
+		onMessages<BrokerToClientMessage>(socket, (message) =>
+			this.handleMessage(message),
+		);
+		socket.on('error', () => {});
+		socket.on('close', () => {
+			const error = new Error('Print broker connection closed');
+			for (const request of this.pending.values()) {
+				request.reject(error);
+			}
+			this.pending.clear();
+		});
+	}
+
+	static connect(
+		socketPath = defaultBrokerSocketPath(),
+	): Promise<PrintBrokerClient> {
+		return new Promise((resolve, reject) => {
+			const socket = net.connect(socketPath);
+			socket.once('error', reject);
+			socket.once('connect', () => {
+				socket.off('error', reject);
+				resolve(new PrintBrokerClient(socket, socketPath));
+			});
+		});
+	}
+
+	printToDevice(
+		deviceId: string,
+		data: PrintData,
+		isImage = false,
+		options: PrintJobOptions = {},
+	): Promise<boolean> {
+		return this.print({ device: deviceId }, data, isImage, options);
+	}
+
+	printToDefault(
+		data: PrintData,
+		isImage = false,
+		options: PrintJobOptions = {},
+	): Promise<boolean> {
+		return this.print({ default: true }, data, isImage, options);
+	}
+
+	printToGroup(
+		group: string,
+		data: PrintData,
+		isImage = false,
+		options: PrintJobOptions = {},
+	): Promise<boolean> {
+		return this.print({ group }, data, isImage, options);
+	}
+
+	/**
+	 * Print through a transport URI the broker opens itself, e.g.
+	 * `emu://counter` or `tcp://10.0.0.5:9100`
+	 */
+	printToTransport(
+		uri: string,
+		data: PrintData,
+		isImage = false,
+		options: PrintJobOptions & { profile?: string } = {},
+	): Promise<boolean> {
+		return this.print(
+			{ transport: uri, profile: options.profile },
+			data,
+			isImage,
+			options,
+		);
+	}
+
+	/**
+	 * Bytes an `emu://` transport in the broker has received since the
+	 * last call
+	 */
+	async takeOutput(uri: string): Promise<Buffer> {
+		const id = this.nextId++;
+		const reply = await this.request(id, {
+			type: 'takeOutput',
+			id,
+			transport: uri,
+		});
+		return Buffer.from(reply.type === 'output' ? reply.data : '', 'base64');
+	}
+
+	/**
+	 * Receive broker metrics every intervalMs
+	 */
+	onMetrics(
+		callback: (metrics: BrokerMetrics) => void,
+		intervalMs = 1000,
+	): void {
+		this.metricsCallbacks.push(callback);
+		sendMessage(this.socket, { type: 'subscribe', intervalMs });
+	}
+
+	/**
+	 * Printer connects, disconnects and errors seen by the broker
+	 */
+	onStatus(callback: (status: BrokerStatusEvent) => void): void {
+		this.statusCallbacks.push(callback);
+	}
+
+	close(): void {
+		this.socket.end();
+	}
+
+	private async print(
+		target: BrokerPrintTarget,
+		data: PrintData,
+		isImage: boolean,
+		options: PrintJobOptions,
+	): Promise<boolean> {
+		const id = this.nextId++;
+		const payload = await createPayload(
+			data,
+			isImage,
+			handoffSocketPath(this.socketPath),
+		);
+		// Checked after the handoff, which may have taken a moment; a shared
+		// payload the broker received is dropped there unclaimed
+		if (options.signal?.aborted) {
+			throw toError('PrintJobCancelledError', 'job was cancelled');
+		}
+		const onAbort = () => sendMessage(this.socket, { type: 'cancel', id });
+		options.signal?.addEventListener('abort', onAbort, { once: true });
+		try {
+			await this.request(id, {
+				type: 'print',
+				id,
+				target,
+				isImage,
+				timeoutMs: options.timeoutMs,
+				payload,
+			});
+			return true;
+		} finally {
+			options.signal?.removeEventListener('abort', onAbort);
+		}
+	}
+
+	private request(
+		id: number,
+		message: ClientToBrokerMessage,
+	): Promise<BrokerToClientMessage> {
+		return new Promise((resolve, reject) => {
+			if (this.socket.destroyed) {
+				reject(new Error('Print broker connection closed'));
+				return;
+			}
+			this.pending.set(id, { resolve, reject });
+			sendMessage(this.socket, message);
+		});
+	}
+
+	private handleMessage(message: BrokerToClientMessage): void {
+		switch (message.type) {
+			case 'metrics':
+				for (const callback of this.metricsCallbacks) {
+					callback(message.metrics);
+				}
+				return;
+			case 'status':
+				for (const callback of this.statusCallbacks) {
+					callback(message);
+				}
+				return;
+		}
+
+		const request = this.pending.get(message.id);
+		if (!request) {
+			return;
+		}
+		if (message.type === 'accepted') {
+			return;
+		}
+		this.pending.delete(message.id);
+		if (message.type === 'failed') {
+			request.reject(toError(message.name, message.message));
+		} else {
+			request.resolve(message);
+		}
+	}
+}
@@ -1,12 +1,43 @@
+import type { Writable } from 'node:stream';
 import type { WritableDevice } from '../adaptor/deviceAdaptor';
 import { createPrinterAdapter } from '../adaptor/printerAdapterFactory';
+import { jobBufferPool } from '../core/bufferPool';
 import { saveDeviceConfig, updateDeviceConfig } from '../core/deviceConfig';
-import type { TerminalDevice } from '../core/types';
+import { getLogger } from '../core/logger';
+import {
+	PreparedJobStore,
+	type PreparedJobStoreStats,
+	type PreparedPrintJob,
+} from '../core/preparedJobs';
+import {
+	type PrinterRouteEstimate,
+	PrinterRouter,
+} from '../core/printerRouter';
+import { PrintQueue } from '../core/printQueue';
+import type {
+	PrintData,
+	PrintJobOptions,
+	TerminalDevice,
+} from '../core/types';
+import {
+	PrintJobCancelledError,
+	type PrintStreamOptions,
+	ThermalWindowPrinter,
+} from '../core/windows_printer';
 import type { DeviceManager } from './deviceManager';
 
+const log = getLogger('printer');
+
+/** Deadline applied to print jobs that don't set their own timeoutMs */
+const DEFAULT_PRINT_TIMEOUT_MS = 60_000;
+
 export class PrinterManager {
 	private deviceManager: DeviceManager;
 	private printerAdapters = new Map<string, WritableDevice>();
+	private printQueue = new PrintQueue();
+	private preparedJobs = new PreparedJobStore();
+	private printerRouter = new PrinterRouter();
+	private detachedPrinters = new Map<string, string>(); // deviceId -> holder
 
 	constructor(deviceManager: DeviceManager) {
 		this.deviceManager = deviceManager;
@@ -14,43 +45,294 @@ export class PrinterManager {
 	}
 
 	async printToDevice(
+		deviceId: string,
+		data: PrintData,
+		isImage = false,
+		options: PrintJobOptions = {},
+	): Promise<boolean> {
+		return this.enqueuePrint(deviceId, data, isImage, options);
+	}
+
+	/**
+	 * Render a job now and hold its bytes, so commitPrint only has to queue
+	 * and write them (e.g. render while the payment is authorised)
+	 * @param options.ttlMs How long the rendering is held (default 2 minutes)
+	 */
+	async preparePrint(
 		deviceId: string,
 		data: string,
 		isImage = false,
+		options: { ttlMs?: number } = {},
+	): Promise<PreparedPrintJob> {
+		const device = this.getPrinterDevice(deviceId);
+		await this.ensurePrinterAdapter(device);
+		const rendered = await this.printerAdapters
+			.get(deviceId)
+			?.prepare?.(data, isImage);
+		return this.preparedJobs.add(
+			deviceId,
+			data,
+			isImage,
+			rendered,
+			options.ttlMs,
+		);
+	}
+
+	/**
+	 * Queue a prepared job. If its rendering was dropped (TTL, memory
+	 * budget or trimPreparedJobs) the job is encoded again here.
+	 */
+	async commitPrint(
+		job: PreparedPrintJob,
+		options: PrintJobOptions = {},
 	): Promise<boolean> {
+		const rendered = this.preparedJobs.take(job);
+		return this.enqueuePrint(
+			job.deviceId,
+			job.data,
+			job.isImage,
+			options,
+			rendered,
+		);
+	}
+
+	/**
+	 * Release a prepared job that will not be printed
+	 */
+	discardPrint(job: PreparedPrintJob): void {
+		this.preparedJobs.discard(job);
+	}
+
+	/**
+	 * Drop every held rendering; prepared jobs stay valid
+	 * @returns Bytes freed
+	 */
+	trimPreparedJobs(): number {
+		return this.preparedJobs.trim();
+	}
+
+	getPreparedJobStats(): PreparedJobStoreStats {
+		return this.preparedJobs.stats();
+	}
+
+	/**
+	 * Leave a printer to a writer that opens it itself, such as a scale's
+	 * label trigger, until attachPrinter: its queued and in-flight jobs are
+	 * cancelled, its connection is closed and new jobs fail, so the two
+	 * never hold the device at once. Group routing skips it meanwhile.
+	 * @param holder Who drives the printer instead, for error messages
+	 */
+	async detachPrinter(deviceId: string, holder: string): Promise<void> {
+		const current = this.detachedPrinters.get(deviceId);
+		if (current) {
+			throw new Error(`Printer ${deviceId} is in use by ${current}`);
+		}
+		this.detachedPrinters.set(deviceId, holder);
+		this.printQueue.cancelDevice(deviceId);
+		await this.closePrinterAdapter(deviceId);
+		log.info('Printer detached', { deviceId, holder });
+	}
+
+	/**
+	 * Take back a printer left to another writer; its next job opens it
+	 */
+	attachPrinter(deviceId: string): void {
+		if (this.detachedPrinters.delete(deviceId)) {
+			log.info('Printer attached', { deviceId });
+		}
+	}
+
+	private getPrinterDevice(deviceId: string): TerminalDevice {
 		const device = this.deviceManager.getDevice(deviceId);
 		if (!device || device.meta.deviceType !== 'printer') {
 			throw new Error(`Device ${deviceId} is not a printer or not found`);
 		}
+		this.assertAttached(deviceId);
+		return device;
+	}
 
+	private assertAttached(deviceId: string): void {
+		const holder = this.detachedPrinters.get(deviceId);
+		if (holder) {
+			throw new Error(`Printer ${deviceId} is in use by ${holder}`);
+		}
+	}
+
+	private async enqueuePrint(
+		deviceId: string,
+		data: PrintData,
+		isImage: boolean,
+		options: PrintJobOptions,
+		rendered?: Buffer,
+	): Promise<boolean> {
+		let device: TerminalDevice;
 		try {
-			await this.ensurePrinterAdapter(device);
-			const adapter = this.printerAdapters.get(deviceId);
-			if (!adapter) {
-				throw new Error(`Failed to create printer adapter for ${deviceId}`);
+			device = this.getPrinterDevice(deviceId);
+		} catch (error) {
+			if (rendered) {
+				jobBufferPool.release(rendered);
 			}
+			throw error;
+		}
+
+		let writeMs: number | undefined;
+		this.printerRouter.begin(deviceId, data.length);
+		try {
+			await this.printQueue.enqueue(
+				deviceId,
+				async ({ signal, timeoutMs, reset, prepared }) => {
+					const job = await prepared;
+					try {
+						await this.ensurePrinterAdapter(device);
+					} catch (error) {
+						if (job) {
+							jobBufferPool.release(job);
+						}
+						throw error;
+					}
+					const adapter = this.printerAdapters.get(deviceId);
+					if (!adapter) {
+						throw new Error(`Failed to create printer adapter for ${deviceId}`);
+					}
 
-			await adapter.write(data, isImage);
+					const started = Date.now();
+					await adapter.write(data, isImage, {
+						signal,
+						timeoutMs,
+						reset,
+						prepared: job,
+					});
+					writeMs = Date.now() - started;
+				},
+				{
+					timeoutMs: options.timeoutMs ?? DEFAULT_PRINT_TIMEOUT_MS,
+					signal: options.signal,
+				},
+				// Rendered while earlier jobs on this printer are still printing;
+				// the adapter exists by then, created by the first job
+				rendered ??
+					(async () =>
+						this.printerAdapters.get(deviceId)?.prepare?.(data, isImage)),
+			);
 			return true;
 		} catch (error) {
-			console.error(`Print failed for device ${deviceId}:`, error);
+			log.error('Print failed', { deviceId, error });
+			if (!(error instanceof PrintJobCancelledError)) {
+				this.printerRouter.reportFailure(deviceId);
+			}
 			throw error;
+		} finally {
+			this.printerRouter.end(deviceId, data.length, writeMs);
 		}
 	}
 
-	async printToDefault(data: string, isImage = false): Promise<boolean> {
+	async printToDefault(
+		data: PrintData,
+		isImage = false,
+		options: PrintJobOptions = {},
+	): Promise<boolean> {
 		const defaultPrinter = this.deviceManager.getDefaultDevice('printer');
 		if (!defaultPrinter) {
 			throw new Error('No default printer found');
 		}
 
-		return this.printToDevice(defaultPrinter.id, data, isImage);
+		// A default printer in a group shares the load with its group
+		if (defaultPrinter.meta.group) {
+			return this.printToGroup(
+				defaultPrinter.meta.group,
+				data,
+				isImage,
+				options,
+			);
+		}
+		return this.printToDevice(defaultPrinter.id, data, isImage, options);
+	}
+
+	/**
+	 * Print on the connected member of a printer group (DeviceConfig.group)
+	 * expected to finish the job first. If that member fails the job, the
+	 * next best member prints it; each attempt gets the full timeoutMs.
+	 */
+	async printToGroup(
+		group: string,
+		data: PrintData,
+		isImage = false,
+		options: PrintJobOptions = {},
+	): Promise<boolean> {
+		const tried = new Set<string>();
+		let lastError: unknown;
+		for (;;) {
+			const [best] = this.getPrinterGroupStatus(group, data.length).filter(
+				(member) => !tried.has(member.deviceId),
+			);
+			if (!best) {
+				throw (
+					lastError ??
+					new Error(`Printer group ${group} has no connected printers`)
+				);
+			}
+
+			tried.add(best.deviceId);
+			try {
+				return await this.printToDevice(
+					best.deviceId,
+					data,
+					isImage,
+					options,
+				);
+			} catch (error) {
+				if (
+					error instanceof PrintJobCancelledError ||
+					options.signal?.aborted
+				) {
+					throw error;
+				}
+				lastError = error;
+				log.warn('Printer failed, failing over within group', {
+					deviceId: best.deviceId,
+					group,
+				});
+			}
+		}
+	}
+
+	/**
+	 * Connected members of a printer group, best first
+	 * @param bytes Size of the job being routed; only shifts the estimates
+	 */
+	getPrinterGroupStatus(group: string, bytes = 0): PrinterRouteEstimate[] {
+		const members = this.getPrinterDevices()
+			.filter(
+				(device) =>
+					device.meta.group === group &&
+					!this.detachedPrinters.has(device.id),
+			)
+			.map((device) => device.id);
+		return this.printerRouter.rank(members, bytes, (deviceId) =>
+			this.printQueue.getQueueDepth(deviceId),
+		);
+	}
+
+	/**
+	 * Cancel queued and in-flight jobs for a printer
+	 * @returns Number of jobs cancelled
+	 */
+	cancelPrintJobs(deviceId: string): number {
+		return this.printQueue.cancelDevice(deviceId);
+	}
+
+	/**
+	 * Jobs waiting or writing for a printer
+	 */
+	getPrintQueueDepth(deviceId: string): number {
+		return this.printQueue.getQueueDepth(deviceId);
 	}
 
 	async ensurePrinterAdapter(device: TerminalDevice): Promise<void> {
 		if (this.printerAdapters.has(device.id)) {
 			return; // Adapter already exists
 		}
+		this.assertAttached(device.id);
 
 		// Auto-configure device as printer if not already configured
 		if (device.meta.deviceType !== 'printer') {
@@ -83,7 +365,8 @@ export class PrinterManager {
 			const adapter = createPrinterAdapter(device);
 
 			adapter.onError((error) => {
-				console.error(`Printer adapter error for ${device.id}:`, error);
+				log.error('Printer adapter error', { deviceId: device.id, error });
+				this.printerRouter.reportFailure(device.id);
 				this.deviceManager
 					.getEventEmitter()
 					.emitDeviceError(device.id, new Error(String(error)));
@@ -92,12 +375,12 @@ export class PrinterManager {
 
 			await adapter.open();
 			this.printerAdapters.set(device.id, adapter);
-			console.log(`Printer adapter created for ${device.id}`);
+			log.info('Printer adapter created', { deviceId: device.id });
 		} catch (error) {
-			console.error(
-				`Failed to create printer adapter for ${device.id}:`,
+			log.error('Failed to create printer adapter', {
+				deviceId: device.id,
 				error,
-			);
+			});
 			throw error;
 		}
 	}
@@ -108,7 +391,7 @@ export class PrinterManager {
 			try {
 				await adapter.close();
 			} catch (error) {
-				console.error(`Error closing printer adapter for ${deviceId}:`, error);
+				log.error('Failed to close printer adapter', { deviceId, error });
 			}
 			this.printerAdapters.delete(deviceId);
 		}
@@ -121,6 +404,27 @@ export class PrinterManager {
 		}
 	}
 
+	/**
+	 * Stream a long document to a spooler printer chunk by chunk (see
+	 * ThermalWindowPrinter.createWriteStream). The printer connection is
+	 * closed once the stream finishes or is destroyed.
+	 */
+	createWriteStream(
+		printerName: string,
+		options: PrintStreamOptions = {},
+	): Writable {
+		const printer = new ThermalWindowPrinter(printerName);
+		const stream = printer.createWriteStream(options);
+		stream.once('close', () => {
+			try {
+				printer.close();
+			} catch (error) {
+				log.error('Failed to close streamed printer', { printerName, error });
+			}
+		});
+		return stream;
+	}
+
 	getPrinterDevices(): TerminalDevice[] {
 		return this.deviceManager.getDevicesByType('printer');
 	}
@@ -138,7 +442,7 @@ export class PrinterManager {
 				throw new Error('No default scanner found');
 			}
 
-			console.log(`Starting test print on device: ${printerDevice.id}`);
+			log.info('Starting test print', { deviceId: printerDevice.id });
 
 			// Create test receipt content
 			const testContent = `
@@ -162,12 +466,10 @@ Thank you!
 			// Use existing printToDevice method
 			await this.printToDevice(printerDevice.id, testContent, false);
 
-			console.log(
-				`Test print completed successfully on device: ${printerDevice.id}`,
-			);
+			log.info('Test print completed', { deviceId: printerDevice.id });
 			return { success: true };
 		} catch (error) {
-			console.error(`Error in testPrint: ${error}`);
+			log.error('Test print failed', { error });
 			return { success: false, error: `Test print failed: ${error}` };
 		}
 	}
@@ -175,20 +477,26 @@ Thank you!
 	private setupEventListeners(): void {
 		// Auto-create printer adapters for devices with printer type and default flag
 		this.deviceManager.onDeviceConnect(async (device) => {
-			if (device.meta.deviceType === 'printer' && device.meta.setToDefault) {
+			if (
+				device.meta.deviceType === 'printer' &&
+				device.meta.setToDefault &&
+				!this.detachedPrinters.has(device.id)
+			) {
 				try {
 					await this.ensurePrinterAdapter(device);
 				} catch (error) {
-					console.error(
-						`Failed to auto-create printer adapter for ${device.id}:`,
+					log.error('Failed to auto-create printer adapter', {
+						deviceId: device.id,
 						error,
-					);
+					});
 				}
 			}
 		});
 
 		// Clean up adapters when devices disconnect
 		this.deviceManager.onDeviceDisconnect(async (deviceId) => {
+			this.printQueue.cancelDevice(deviceId);
+			this.printerRouter.remove(deviceId);
 			await this.closePrinterAdapter(deviceId);
 		});
 	}
@@ -1,12 +1,56 @@
 import type { ReadableDevice } from '../adaptor/deviceAdaptor';
 import { WeightScaleAdapter } from '../adaptor/weightScaleAdaptor';
 import { updateDeviceConfig } from '../core/deviceConfig';
+import { getLogger } from '../core/logger';
+import {
+	loadNativeAddon,
+	type WeighLabelEvent,
+	type WeighLabelPipeline,
+	type WeighLabelPipelineOptions,
+	type WeighLabelStats,
+	type WeighLabelTemplatePart,
+} from '../core/nativeAddon';
 import type { RetryOptions } from '../core/retryUtils';
+import type { ReadLatencyStats } from '../core/serialLatency';
 import type { BaudRate, TerminalDevice } from '../core/types';
 import type { DeviceManager } from './deviceManager';
+import type { PrinterManager } from './printerManager';
+
+const log = getLogger('scale');
 
 export type WeightDataCallback = (data: string) => void;
 
+export type LabelPrintCallback = (event: WeighLabelEvent) => void;
+
+export interface LabelTriggerOptions {
+	/**
+	 * Printer device with a native transport (default: the default
+	 * printer). PrinterManager leaves it alone while the trigger runs.
+	 */
+	printerId?: string;
+	/** Printer transport URI, instead of printerId */
+	transport?: string;
+	/** From compileWeighLabel */
+	template: WeighLabelTemplatePart[];
+	/** Price per scale unit */
+	unitPrice?: number;
+	priceDecimals?: number;
+	/** Readings in a row within tolerance, for scales without a stable flag */
+	stableReadings?: number;
+	tolerance?: number;
+	/** At or below this the platter counts as empty and the trigger re-arms */
+	minWeight?: number;
+	writeTimeoutMs?: number;
+}
+
+interface LabelTrigger {
+	options: WeighLabelPipelineOptions;
+	/** Printer device detached from PrinterManager for the trigger */
+	printerId?: string;
+	onPrint?: LabelPrintCallback;
+	pipeline?: WeighLabelPipeline;
+}
+
 export class ScaleManager {
 	private deviceManager: DeviceManager;
 	private scaleAdapters = new Map<string, ReadableDevice>();
@@ -15,14 +59,22 @@ export class ScaleManager {
 	private globalWeightCallbacks: WeightDataCallback[] = []; // Global weight callbacks
 	private pendingDefaultCallbacks: WeightDataCallback[] = []; // Callbacks waiting for default scale
 	private previousDefaultStates = new Map<string, boolean>(); // Track previous default states
+	private labelTriggers = new Map<string, LabelTrigger>(); // Kept on disconnect
 	private retryOptions: Partial<RetryOptions>;
+	private printerManager?: PrinterManager;
 
+	/**
+	 * @param printerManager Stops driving the printer of a label trigger
+	 * while the trigger writes to it
+	 */
 	constructor(
 		deviceManager: DeviceManager,
 		retryOptions: Partial<RetryOptions> = {},
+		printerManager?: PrinterManager,
 	) {
 		this.deviceManager = deviceManager;
 		this.retryOptions = retryOptions;
+		this.printerManager = printerManager;
 		this.setupEventListeners();
 	}
 
@@ -38,9 +90,9 @@ export class ScaleManager {
 
 		const device = this.deviceManager.getDevice(deviceId);
 		if (!device) {
-			console.log(
-				`Device ${deviceId} not found, callback queued for when device connects`,
-			);
+			log.info('Device not found; callback queued until it connects', {
+				deviceId,
+			});
 			return; // Don't throw error, just queue the callback
 		}
 
@@ -54,9 +106,7 @@ export class ScaleManager {
 	async readFromDefault(callback: WeightDataCallback): Promise<void> {
 		const defaultScaleId = this.deviceManager.getDefaultDeviceId('scale');
 		if (!defaultScaleId) {
-			console.log(
-				'No default scale found, callback queued for when default scale connects',
-			);
+			log.info('No default scale; callback queued until one connects');
 			// Store callback with a special key for "default scale when it becomes available"
 			this.storeCallbackForWhenDefaultConnects('scale', callback);
 			return;
@@ -134,10 +184,10 @@ export class ScaleManager {
 					});
 
 				this.activeScales.add(device.id);
-				console.log(`Started reading from scale: ${device.id}`);
+				log.info('Started reading', { deviceId: device.id });
 			}
 		} catch (error) {
-			console.error(`Failed to start reading from ${device.id}:`, error);
+			log.error('Failed to start reading', { deviceId: device.id, error });
 			throw error;
 		}
 	}
@@ -149,7 +199,7 @@ export class ScaleManager {
 			try {
 				callback(data);
 			} catch (error) {
-				console.error(`Error in weight callback for ${deviceId}:`, error);
+				log.error('Weight callback failed', { deviceId, error });
 			}
 		});
 
@@ -158,7 +208,7 @@ export class ScaleManager {
 			try {
 				callback(data);
 			} catch (error) {
-				console.error(`Error in global weight callback:`, error);
+				log.error('Global weight callback failed', { error });
 			}
 		});
 	}
@@ -170,6 +220,9 @@ export class ScaleManager {
 		if (this.scaleAdapters.has(device.id)) {
 			return; // Adapter already exists
 		}
+		if (this.labelTriggers.has(device.id)) {
+			return; // The label pipeline owns the port and forwards its weights
+		}
 
 		// Auto-configure device if not already configured
 		if (device.meta.deviceType !== 'scale') {
@@ -186,7 +239,7 @@ export class ScaleManager {
 			const adapter = new WeightScaleAdapter(device, this.retryOptions);
 
 			adapter.onError((error) => {
-				console.error(`Scale adapter error for ${device.id}:`, error);
+				log.error('Scale adapter error', { deviceId: device.id, error });
 				this.deviceManager
 					.getEventEmitter()
 					.emitDeviceError(device.id, new Error(String(error)));
@@ -201,9 +254,12 @@ export class ScaleManager {
 
 			await adapter.open();
 			this.scaleAdapters.set(device.id, adapter);
-			console.log(`Scale adapter created for ${device.id}`);
+			log.info('Scale adapter created', { deviceId: device.id });
 		} catch (error) {
-			console.error(`Failed to create scale adapter for ${device.id}:`, error);
+			log.error('Failed to create scale adapter', {
+				deviceId: device.id,
+				error,
+			});
 			throw error;
 		}
 	}
@@ -214,13 +270,16 @@ export class ScaleManager {
 			try {
 				await adapter.close();
 			} catch (error) {
-				console.error(`Error closing scale adapter for ${deviceId}:`, error);
+				log.error('Failed to close scale adapter', { deviceId, error });
 			}
 			this.scaleAdapters.delete(deviceId);
 		}
 	}
 
 	async closeAllScaleAdapters(): Promise<void> {
+		for (const deviceId of Array.from(this.labelTriggers.keys())) {
+			await this.stopLabelTrigger(deviceId);
+		}
 		const adapters = Array.from(this.scaleAdapters.keys());
 		for (const deviceId of adapters) {
 			await this.closeScaleAdapter(deviceId);
@@ -228,6 +287,192 @@ export class ScaleManager {
 		this.activeScales.clear();
 	}
 
+	/**
+	 * Print a label each time an item settles on a scale. A native thread
+	 * reads the scale, detects the stable weight, fills in the template and
+	 * writes it to the printer's transport, which it opens and keeps open;
+	 * onPrint and read callbacks hear of it afterwards. A printer that
+	 * cannot be opened is reported as a device error of the scale. Survives
+	 * reconnects until stopLabelTrigger. POSIX only, like serial://
+	 * transports.
+	 *
+	 * Until then the printer belongs to the trigger: PrinterManager cancels
+	 * its jobs, closes its connection and refuses new jobs for it (see
+	 * PrinterManager.detachPrinter), so receipts are not written to it
+	 * over a second connection.
+	 */
+	async startLabelTrigger(
+		deviceId: string,
+		options: LabelTriggerOptions,
+		onPrint?: LabelPrintCallback,
+	): Promise<void> {
+		const device = this.deviceManager.getDevice(deviceId);
+		if (!device) {
+			throw new Error(`Device ${deviceId} not found`);
+		}
+		if (device.meta.deviceType !== 'scale') {
+			throw new Error(`Device ${deviceId} is not a scale`);
+		}
+		const baudRate = device.meta.baudrate;
+		if (baudRate === 'not-supported') {
+			throw new Error(`Scale ${deviceId} is not a serial device`);
+		}
+
+		const { printerId, transport, ...pipelineOptions } = options;
+		const printer = this.labelPrinter(printerId, transport);
+		const trigger: LabelTrigger = {
+			options: {
+				...pipelineOptions,
+				scalePath: device.path,
+				baudRate,
+				printer: printer.transport,
+			},
+			printerId: printer.deviceId,
+			onPrint,
+		};
+
+		await this.stopLabelTrigger(deviceId);
+		if (trigger.printerId) {
+			await this.printerManager?.detachPrinter(
+				trigger.printerId,
+				`the label trigger of scale ${deviceId}`,
+			);
+		}
+		this.labelTriggers.set(deviceId, trigger);
+		// The pipeline reads the port itself
+		await this.closeScaleAdapter(deviceId);
+		try {
+			this.startLabelPipeline(deviceId, trigger);
+		} catch (error) {
+			this.labelTriggers.delete(deviceId);
+			if (trigger.printerId) {
+				this.printerManager?.attachPrinter(trigger.printerId);
+			}
+			if (this.activeScales.has(deviceId)) {
+				await this.ensureScaleAdapter(device);
+			}
+			throw error;
+		}
+	}
+
+	async stopLabelTrigger(deviceId: string): Promise<void> {
+		const trigger = this.labelTriggers.get(deviceId);
+		if (!trigger) {
+			return;
+		}
+		this.labelTriggers.delete(deviceId);
+		// Joins the pipeline thread, which wakes immediately
+		trigger.pipeline?.stop();
+		trigger.pipeline = undefined;
+		if (trigger.printerId) {
+			this.printerManager?.attachPrinter(trigger.printerId);
+		}
+		log.info('Label trigger stopped', { deviceId });
+
+		// Hand the port back to the regular reader
+		const device = this.deviceManager.getDevice(deviceId);
+		if (device && this.activeScales.has(deviceId)) {
+			await this.ensureScaleAdapter(device);
+		}
+	}
+
+	/**
+	 * Price per scale unit for the next labels, e.g. when the product changes
+	 */
+	setLabelUnitPrice(deviceId: string, unitPrice: number): void {
+		const trigger = this.labelTriggers.get(deviceId);
+		if (!trigger) {
+			throw new Error(`Scale ${deviceId} has no label trigger`);
+		}
+		trigger.options.unitPrice = unitPrice;
+		trigger.pipeline?.setUnitPrice(unitPrice);
+	}
+
+	/**
+	 * Labels printed and weigh-to-print latency of a running trigger, null
+	 * when it is not running
+	 */
+	getLabelTriggerStats(deviceId: string): WeighLabelStats | null {
+		return this.labelTriggers.get(deviceId)?.pipeline?.getStats() ?? null;
+	}
+
+	/**
+	 * Transport of a trigger's printer, and the printer device behind it if
+	 * there is one, also when the transport URI was given directly
+	 */
+	private labelPrinter(printerId?: string, transport?: string) {
+		if (transport) {
+			const known = this.deviceManager
+				.getDevicesByType('printer')
+				.find((printer) => printer.meta.transport === transport);
+			return { transport, deviceId: known?.id };
+		}
+		const printer = printerId
+			? this.deviceManager.getDevice(printerId)
+			: this.deviceManager.getDefaultDevice('printer');
+		if (!printer?.meta.transport) {
+			throw new Error('Label triggers need a printer with a native transport');
+		}
+		return { transport: printer.meta.transport, deviceId: printer.id };
+	}
+
+	private startLabelPipeline(deviceId: string, trigger: LabelTrigger): void {
+		const addon = loadNativeAddon();
+		if (!addon) {
+			throw new Error('Label triggers need the native addon');
+		}
+
+		const pipeline = new addon.WeighLabelPipeline(trigger.options);
+		pipeline.start(
+			(event) => this.handleLabelEvent(deviceId, trigger, event),
+			(error) => {
+				if (trigger.pipeline === pipeline) {
+					trigger.pipeline = undefined;
+				}
+				if (error) {
+					log.error('Label trigger ended', { deviceId, error });
+					this.deviceManager.getEventEmitter().emitDeviceError(deviceId, error);
+				}
+			},
+		);
+		trigger.pipeline = pipeline;
+		log.info('Label trigger started', {
+			deviceId,
+			printer: trigger.options.printer,
+		});
+	}
+
+	private handleLabelEvent(
+		deviceId: string,
+		trigger: LabelTrigger,
+		event: WeighLabelEvent,
+	): void {
+		if (event.type === 'weight') {
+			// Read callbacks keep working while the pipeline owns the port
+			const weight = event.line.trim();
+			if (weight) {
+				this.deviceManager.getEventEmitter().emitDeviceData(deviceId, weight);
+			}
+			return;
+		}
+
+		if (event.error) {
+			log.error('Label print failed', { deviceId, error: event.error });
+		} else {
+			log.debug('Label printed', {
+				deviceId,
+				weight: event.weight,
+				price: event.price,
+				weighToPrintMs: event.weighToPrintMs,
+			});
+		}
+		try {
+			trigger.onPrint?.(event);
+		} catch (error) {
+			log.error('Label print callback failed', { deviceId, error });
+		}
+	}
+
 	getScaleDevices(): TerminalDevice[] {
 		return this.deviceManager.getDevicesByType('scale');
 	}
@@ -244,6 +489,16 @@ export class ScaleManager {
 		return Array.from(this.activeScales);
 	}
 
+	/**
+	 * Read latency of an open scale, null when it has no adapter
+	 */
+	getReadLatency(deviceId: string): ReadLatencyStats | null {
+		const adapter = this.scaleAdapters.get(deviceId);
+		return adapter instanceof WeightScaleAdapter
+			? adapter.getReadLatency()
+			: null;
+	}
+
 	// Get current weight from default scale (one-time read with timeout)
 	async getCurrentWeight(timeoutMs = 5000): Promise<string> {
 		const defaultScale = this.getDefaultScale();
@@ -297,10 +552,10 @@ export class ScaleManager {
 			try {
 				await this.startReadingDevice(scale);
 			} catch (error) {
-				console.error(
-					`Failed to start reading from existing scale ${scale.id}:`,
+				log.error('Failed to start reading from existing scale', {
+					deviceId: scale.id,
 					error,
-				);
+				});
 			}
 		});
 	}
@@ -318,15 +573,22 @@ export class ScaleManager {
 
 				// Auto-stop reading if THIS SPECIFIC DEVICE lost default status (regardless of current deviceType)
 				if (wasDefault && !isDefault) {
-					console.log(
-						`Auto-stopping reading from device that lost default status: ${device.id}`,
-					);
+					log.info('Stopping reading; device is no longer the default', {
+						deviceId: device.id,
+					});
 					await this.stopReading(device.id);
 					return; // Exit early, no need to check start conditions
 				}
 
 				// Only process auto-start logic for scale devices
 				if (device.meta.deviceType === 'scale') {
+					// Resume a label trigger on a reconnected scale
+					const trigger = this.labelTriggers.get(device.id);
+					if (trigger && !trigger.pipeline) {
+						trigger.options.scalePath = device.path;
+						this.startLabelPipeline(device.id, trigger);
+					}
+
 					// Check if this device has persistent callbacks waiting
 					const hasCallbacks =
 						this.persistentCallbacks.has(device.id) &&
@@ -348,9 +610,10 @@ export class ScaleManager {
 							.get(device.id)
 							?.push(...this.pendingDefaultCallbacks);
 						this.pendingDefaultCallbacks = []; // Clear pending callbacks
-						console.log(
-							`Moved ${this.persistentCallbacks.get(device.id)?.length} pending callbacks to default scale: ${device.id}`,
-						);
+						log.info('Moved pending callbacks to default scale', {
+							deviceId: device.id,
+							callbacks: this.persistentCallbacks.get(device.id)?.length,
+						});
 					}
 
 					// Start reading if device has callbacks waiting or is default with setToDefault=true
@@ -363,28 +626,33 @@ export class ScaleManager {
 						await this.startReadingDevice(device);
 
 						if (isDefaultWithPendingCallbacks) {
-							console.log(
-								`Auto-started reading from new default scale: ${device.id}`,
-							);
+							log.info('Started reading from new default scale', {
+								deviceId: device.id,
+							});
 						} else if (hasCallbacks) {
-							console.log(
-								`Auto-resumed reading from reconnected scale: ${device.id}`,
-							);
+							log.info('Resumed reading from reconnected scale', {
+								deviceId: device.id,
+							});
 						} else if (isDefault) {
-							console.log(
-								`Auto-started reading from default scale: ${device.id}`,
-							);
+							log.info('Started reading from default scale', {
+								deviceId: device.id,
+							});
 						}
 					}
 				}
 			} catch (error) {
-				console.error(`Failed to process device ${device.id}:`, error);
+				log.error('Failed to process device', { deviceId: device.id, error });
 			}
 		});
 
 		// Clean up adapters when devices disconnect (but keep callbacks for reconnection)
 		this.deviceManager.onDeviceDisconnect(async (deviceId) => {
 			this.activeScales.delete(deviceId);
+			const trigger = this.labelTriggers.get(deviceId);
+			if (trigger) {
+				trigger.pipeline?.stop();
+				trigger.pipeline = undefined;
+			}
 			await this.closeScaleAdapter(deviceId);
 		});
 	}
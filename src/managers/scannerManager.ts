@@ -1,10 +1,18 @@
 import { BarcodeScannerAdapter } from '../adaptor/barcodeScannerAdaptor';
 import type { ReadableDevice } from '../adaptor/deviceAdaptor';
+import {
+	HidScannerAdapter,
+	isHidScannerPath,
+} from '../adaptor/hidScannerAdaptor';
 import { updateDeviceConfig } from '../core/deviceConfig';
+import { getLogger } from '../core/logger';
 import type { RetryOptions } from '../core/retryUtils';
+import type { ReadLatencyStats } from '../core/serialLatency';
 import type { BaudRate, TerminalDevice } from '../core/types';
 import type { DeviceManager } from './deviceManager';
 
+const log = getLogger('scanner');
+
 export type ScanDataCallback = (data: string) => void;
 
 export class ScannerManager {
@@ -38,9 +46,9 @@ export class ScannerManager {
 
 		const device = this.deviceManager.getDevice(deviceId);
 		if (!device) {
-			console.log(
-				`Device ${deviceId} not found, callback queued for when device connects`,
-			);
+			log.info('Device not found; callback queued until it connects', {
+				deviceId,
+			});
 			return; // Don't throw error, just queue the callback
 		}
 
@@ -54,9 +62,7 @@ export class ScannerManager {
 	async scanFromDefault(callback: ScanDataCallback): Promise<void> {
 		const defaultScannerId = this.deviceManager.getDefaultDeviceId('scanner');
 		if (!defaultScannerId) {
-			console.log(
-				'No default scanner found, callback queued for when default scanner connects',
-			);
+			log.info('No default scanner; callback queued until one connects');
 			// Store callback with a special key for "default scanner when it becomes available"
 			this.storeCallbackForWhenDefaultConnects('scanner', callback);
 			return;
@@ -134,10 +140,10 @@ export class ScannerManager {
 					});
 
 				this.activeScanners.add(device.id);
-				console.log(`Started scanning from device: ${device.id}`);
+				log.info('Started scanning', { deviceId: device.id });
 			}
 		} catch (error) {
-			console.error(`Failed to start scanning from ${device.id}:`, error);
+			log.error('Failed to start scanning', { deviceId: device.id, error });
 			throw error;
 		}
 	}
@@ -149,7 +155,7 @@ export class ScannerManager {
 			try {
 				callback(data);
 			} catch (error) {
-				console.error(`Error in scan callback for ${deviceId}:`, error);
+				log.error('Scan callback failed', { deviceId, error });
 			}
 		});
 
@@ -158,7 +164,7 @@ export class ScannerManager {
 			try {
 				callback(data);
 			} catch (error) {
-				console.error(`Error in global scan callback:`, error);
+				log.error('Global scan callback failed', { error });
 			}
 		});
 	}
@@ -183,10 +189,13 @@ export class ScannerManager {
 				device.meta.baudrate = baudRate;
 			}
 
-			const adapter = new BarcodeScannerAdapter(device, this.retryOptions);
+			// Keyboard-wedge scanners are read through evdev, others as serial ports
+			const adapter = isHidScannerPath(device.path)
+				? new HidScannerAdapter(device, this.retryOptions)
+				: new BarcodeScannerAdapter(device, this.retryOptions);
 
 			adapter.onError((error) => {
-				console.error(`Scanner adapter error for ${device.id}:`, error);
+				log.error('Scanner adapter error', { deviceId: device.id, error });
 				this.deviceManager
 					.getEventEmitter()
 					.emitDeviceError(device.id, new Error(String(error)));
@@ -201,12 +210,12 @@ export class ScannerManager {
 
 			await adapter.open();
 			this.scannerAdapters.set(device.id, adapter);
-			console.log(`Scanner adapter created for ${device.id}`);
+			log.info('Scanner adapter created', { deviceId: device.id });
 		} catch (error) {
-			console.error(
-				`Failed to create scanner adapter for ${device.id}:`,
+			log.error('Failed to create scanner adapter', {
+				deviceId: device.id,
 				error,
-			);
+			});
 			throw error;
 		}
 	}
@@ -217,7 +226,7 @@ export class ScannerManager {
 			try {
 				await adapter.close();
 			} catch (error) {
-				console.error(`Error closing scanner adapter for ${deviceId}:`, error);
+				log.error('Failed to close scanner adapter', { deviceId, error });
 			}
 			this.scannerAdapters.delete(deviceId);
 		}
@@ -247,6 +256,16 @@ export class ScannerManager {
 		return Array.from(this.activeScanners);
 	}
 
+	/**
+	 * Read latency of an open scanner, null when it has no adapter
+	 */
+	getReadLatency(deviceId: string): ReadLatencyStats | null {
+		const adapter = this.scannerAdapters.get(deviceId);
+		return adapter instanceof BarcodeScannerAdapter
+			? adapter.getReadLatency()
+			: null;
+	}
+
 	// Get next scan from default scanner (one-time read with timeout)
 	async getNextScan(timeoutMs = 10000): Promise<string> {
 		const defaultScanner = this.getDefaultScanner();
@@ -300,10 +319,10 @@ export class ScannerManager {
 			try {
 				await this.startScanningDevice(scanner);
 			} catch (error) {
-				console.error(
-					`Failed to start scanning from existing scanner ${scanner.id}:`,
+				log.error('Failed to start scanning from existing scanner', {
+					deviceId: scanner.id,
 					error,
-				);
+				});
 			}
 		});
 	}
@@ -321,9 +340,9 @@ export class ScannerManager {
 
 				// Auto-stop scanning if THIS SPECIFIC DEVICE lost default status (regardless of current deviceType)
 				if (wasDefault && !isDefault) {
-					console.log(
-						`Auto-stopping scanning from device that lost default status: ${device.id}`,
-					);
+					log.info('Stopping scanning; device is no longer the default', {
+						deviceId: device.id,
+					});
 					await this.stopScanning(device.id);
 					return; // Exit early, no need to check start conditions
 				}
@@ -351,9 +370,10 @@ export class ScannerManager {
 							.get(device.id)
 							?.push(...this.pendingDefaultCallbacks);
 						this.pendingDefaultCallbacks = []; // Clear pending callbacks
-						console.log(
-							`Moved ${this.persistentCallbacks.get(device.id)?.length} pending callbacks to default scanner: ${device.id}`,
-						);
+						log.info('Moved pending callbacks to default scanner', {
+							deviceId: device.id,
+							callbacks: this.persistentCallbacks.get(device.id)?.length,
+						});
 					}
 
 					// Start scanning if device has callbacks waiting or is default with setToDefault=true
@@ -366,22 +386,22 @@ export class ScannerManager {
 						await this.startScanningDevice(device);
 
 						if (isDefaultWithPendingCallbacks) {
-							console.log(
-								`Auto-started scanning from new default scanner: ${device.id}`,
-							);
+							log.info('Started scanning from new default scanner', {
+								deviceId: device.id,
+							});
 						} else if (hasCallbacks) {
-							console.log(
-								`Auto-resumed scanning from reconnected scanner: ${device.id}`,
-							);
+							log.info('Resumed scanning from reconnected scanner', {
+								deviceId: device.id,
+							});
 						} else if (isDefault) {
-							console.log(
-								`Auto-started scanning from default scanner: ${device.id}`,
-							);
+							log.info('Started scanning from default scanner', {
+								deviceId: device.id,
+							});
 						}
 					}
 				}
 			} catch (error) {
-				console.error(`Failed to process device ${device.id}:`, error);
+				log.error('Failed to process device', { deviceId: device.id, error });
 			}
 		});
 
@@ -0,0 +1,208 @@
+import type { TerminalDevice } from '../core/types';
+import type { PrintStreamOptions } from '../core/windows_printer';
+
+export type ManagerTarget =
+	| 'deviceManager'
+	| 'printerManager'
+	| 'scannerManager'
+	| 'scaleManager'
+	| 'displayManager';
+
+// Strings at least this long (base64 images, long receipts) are encoded
+// once and their backing ArrayBuffer transferred instead of cloned
+export const TRANSFER_THRESHOLD = 16 * 1024;
+
+interface CallbackRef {
+	__cb: number;
+}
+
+interface TransferredString {
+	__str: Uint8Array;
+}
+
+interface TransferredBytes {
+	__bytes: Uint8Array;
+}
+
+export type WireValue =
+	| CallbackRef
+	| TransferredString
+	| TransferredBytes
+	| unknown;
+
+export interface CallMessage {
+	type: 'call';
+	id: number;
+	target: ManagerTarget;
+	method: string;
+	args: WireValue[];
+	/**
+	 * Index of the options argument that gets a signal in the worker,
+	 * aborted by an AbortMessage for this call
+	 */
+	signalArg?: number;
+}
+
+// AbortSignals can't be posted; the caller's abort travels as a message
+export interface AbortMessage {
+	type: 'abort';
+	id: number;
+}
+
+// Writable streams are hosted in the worker; one op is in flight per stream
+export interface StreamMessage {
+	type: 'stream';
+	op: 'open' | 'write' | 'end' | 'destroy';
+	streamId: number;
+	printerName?: string;
+	options?: PrintStreamOptions;
+	chunk?: WireValue;
+}
+
+export type MainToWorkerMessage = CallMessage | StreamMessage | AbortMessage;
+
+export type WorkerToMainMessage =
+	| { type: 'ready' }
+	| { type: 'result'; id: number; value: WireValue }
+	| { type: 'error'; id: number; name: string; message: string }
+	| { type: 'callback'; callbackId: number; args: WireValue[] }
+	| { type: 'connect'; device: TerminalDevice; devices: TerminalDevice[] }
+	| { type: 'disconnect'; deviceId: string; devices: TerminalDevice[] }
+	| { type: 'deviceError'; deviceId: string; name: string; message: string }
+	// The worker's forwarder was collected after handling call lastCallId
+	| { type: 'releaseCallback'; callbackId: number; lastCallId: number }
+	| { type: 'streamAck'; streamId: number; name?: string; message?: string };
+
+const textEncoder = new TextEncoder();
+const textDecoder = new TextDecoder();
+
+const transferable = new WeakSet<Uint8Array>();
+
+/**
+ * Let a buffer be moved to the other thread instead of copied. It is
+ * detached (length 0) once sent, so mark only buffers nothing else reads
+ * afterwards, and never jobBufferPool blocks.
+ */
+export function markTransferable<T extends Uint8Array>(bytes: T): T {
+	transferable.add(bytes);
+	return bytes;
+}
+
+// Only a marked buffer that owns its whole ArrayBuffer is moved; anything
+// else (caller buffers, pool blocks, slices) is copied into a fresh one
+const ownedBytes = (bytes: Uint8Array): Uint8Array =>
+	transferable.has(bytes) &&
+	bytes.byteOffset === 0 &&
+	bytes.byteLength === bytes.buffer.byteLength
+		? bytes
+		: new Uint8Array(bytes);
+
+/**
+ * Encode a value for postMessage, collecting transferable buffers
+ * @param value - Argument or result to send
+ * @param transfer - Transfer list to append to
+ * @param registerCallback - Maps functions to callback ids (caller side only)
+ */
+export function encodeWireValue(
+	value: unknown,
+	transfer: ArrayBuffer[],
+	registerCallback?: (callback: (...args: unknown[]) => void) => number,
+): WireValue {
+	if (typeof value === 'function') {
+		if (!registerCallback) {
+			throw new Error(
+				'Functions cannot be returned across the worker boundary',
+			);
+		}
+		return { __cb: registerCallback(value as (...args: unknown[]) => void) };
+	}
+
+	if (typeof value === 'string' && value.length >= TRANSFER_THRESHOLD) {
+		const bytes = textEncoder.encode(value);
+		transfer.push(bytes.buffer as ArrayBuffer);
+		return { __str: bytes };
+	}
+
+	// Copies are ours, so they are transferred rather than cloned once more
+	if (value instanceof Uint8Array) {
+		const bytes = ownedBytes(value);
+		transfer.push(bytes.buffer as ArrayBuffer);
+		return { __bytes: bytes };
+	}
+
+	return value;
+}
+
+/**
+ * Reverse of encodeWireValue
+ * @param value - Received wire value
+ * @param resolveCallback - Maps callback ids back to functions (callee side only)
+ */
+export function decodeWireValue(
+	value: WireValue,
+	resolveCallback?: (callbackId: number) => (...args: unknown[]) => void,
+): unknown {
+	if (value === null || typeof value !== 'object') {
+		return value;
+	}
+
+	if ('__cb' in value && resolveCallback) {
+		return resolveCallback((value as CallbackRef).__cb);
+	}
+	if ('__str' in value) {
+		return textDecoder.decode((value as TransferredString).__str);
+	}
+	if ('__bytes' in value) {
+		const bytes = (value as TransferredBytes).__bytes;
+		return Buffer.from(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+	}
+
+	return value;
+}
+
+type AnyCallback = (...args: unknown[]) => void;
+
+/**
+ * Main-thread side of callbacks passed to the worker. A callback keeps its
+ * id while the worker holds a forwarder for it; once the worker reports
+ * the forwarder collected, and no later call sent the id again, it is
+ * dropped.
+ */
+export class CallbackRegistry {
+	private nextId = 1;
+	private ids = new WeakMap<AnyCallback, number>();
+	private callbacks = new Map<number, AnyCallback>();
+	private lastSent = new Map<number, number>();
+
+	register(callback: AnyCallback, callId: number): number {
+		let id = this.ids.get(callback);
+		if (id === undefined) {
+			id = this.nextId++;
+			this.ids.set(callback, id);
+			this.callbacks.set(id, callback);
+		}
+		this.lastSent.set(id, callId);
+		return id;
+	}
+
+	get(id: number): AnyCallback | undefined {
+		return this.callbacks.get(id);
+	}
+
+	release(id: number, lastCallId: number): void {
+		// A call still on its way to the worker carries the id again
+		if ((this.lastSent.get(id) ?? 0) > lastCallId) {
+			return;
+		}
+		const callback = this.callbacks.get(id);
+		if (callback) {
+			this.ids.delete(callback);
+		}
+		this.callbacks.delete(id);
+		this.lastSent.delete(id);
+	}
+
+	get size(): number {
+		return this.callbacks.size;
+	}
+}
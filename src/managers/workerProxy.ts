@@ -0,0 +1,926 @@
+import * as path from 'node:path';
+import { Writable } from 'node:stream';
+import { Worker } from 'node:worker_threads';
+import type {
+	CustomerDisplayOptions,
+	CustomerDisplayStats,
+} from '../adaptor/customerDisplayAdaptor';
+import type {
+	DeviceConnectCallback,
+	DeviceDisconnectCallback,
+	DeviceErrorCallback,
+} from '../core/deviceEvents';
+import { getLogger } from '../core/logger';
+import type { WeighLabelStats } from '../core/nativeAddon';
+import type {
+	PreparedJobStoreStats,
+	PreparedPrintJob,
+} from '../core/preparedJobs';
+import type { PrinterRouteEstimate } from '../core/printerRouter';
+import type { RetryOptions } from '../core/retryUtils';
+import type { ReadLatencyStats } from '../core/serialLatency';
+import type {
+	BaudRate,
+	DeviceConfig,
+	DeviceType,
+	PrintJobOptions,
+	TerminalDevice,
+} from '../core/types';
+import type { PrintStreamOptions } from '../core/windows_printer';
+import type {
+	LabelPrintCallback,
+	LabelTriggerOptions,
+	WeightDataCallback,
+} from './scaleManager';
+import type { ScanDataCallback } from './scannerManager';
+import {
+	CallbackRegistry,
+	decodeWireValue,
+	encodeWireValue,
+	type ManagerTarget,
+	type StreamMessage,
+	type WorkerToMainMessage,
+} from './workerProtocol';
+
+const log = getLogger('worker');
+
+interface PendingCall {
+	resolve: (value: unknown) => void;
+	reject: (error: Error) => void;
+}
+
+interface CallAbort {
+	signal: AbortSignal;
+	/** Index of the options argument that takes the worker-side signal */
+	optionsArg: number;
+}
+
+const toError = (name: string, message: string): Error => {
+	const error = new Error(message);
+	error.name = name;
+	return error;
+};
+
+/**
+ * Main-thread end of the device worker. Owns the request/response
+ * bookkeeping, the callback registry and a mirror of the device list so
+ * synchronous getters keep working without a round trip.
+ */
+export class DeviceWorkerChannel {
+	private readonly worker: Worker;
+	private nextCallId = 1;
+	private nextStreamId = 1;
+	private pending = new Map<number, PendingCall>();
+	private streamAcks = new Map<number, PendingCall>();
+	private callbacks = new CallbackRegistry();
+	private connectCallbacks: DeviceConnectCallback[] = [];
+	private disconnectCallbacks: DeviceDisconnectCallback[] = [];
+	private errorCallbacks: DeviceErrorCallback[] = [];
+	private devices: TerminalDevice[] = [];
+	readonly ready: Promise<void>;
+
+	constructor(options: {
+		scannerRetry?: Partial<RetryOptions>;
+		scaleRetry?: Partial<RetryOptions>;
+		displayRetry?: Partial<RetryOptions>;
+		display?: CustomerDisplayOptions;
+	}) {
+		const workerFile = path.join(
+			__dirname,
+			`deviceWorker${path.extname(__filename)}`,
+		);
+		this.worker = new Worker(workerFile, {
+			workerData: {
+				scannerRetry: options.scannerRetry,
+				scaleRetry: options.scaleRetry,
+				displayRetry: options.displayRetry,
+				display: options.display,
+			},
+		});
+
+		this.ready = new Promise((resolve, reject) => {
+			const onMessage = (message: WorkerToMainMessage) => {
+				if (message.type === 'ready') {
+					this.worker.off('error', reject);
+					resolve();
+				}
+			};
+			this.worker.on('message', onMessage);
+			this.worker.once('error', reject);
+		});
+		// Startup failures surface through start(); avoid an unhandled rejection
+		this.ready.catch(() => {});
+
+		this.worker.on('message', (message: WorkerToMainMessage) =>
+			this.handleMessage(message),
+		);
+		this.worker.on('exit', (code) => {
+			const error = new Error(`Device worker exited with code ${code}`);
+			const calls = [...this.pending.values(), ...this.streamAcks.values()];
+			for (const call of calls) {
+				call.reject(error);
+			}
+			this.pending.clear();
+			this.streamAcks.clear();
+		});
+	}
+
+	/**
+	 * Call a manager method in the worker. With abort, the options argument
+	 * gets a signal of its own there, aborted only when abort.signal is.
+	 */
+	call<T>(
+		target: ManagerTarget,
+		method: string,
+		args: unknown[] = [],
+		abort?: CallAbort,
+	): Promise<T> {
+		const id = this.nextCallId++;
+		const transfer: ArrayBuffer[] = [];
+		const encoded = args.map((arg) =>
+			encodeWireValue(arg, transfer, (callback) =>
+				this.callbacks.register(callback, id),
+			),
+		);
+
+		return new Promise<T>((resolve, reject) => {
+			const onAbort = () => {
+				this.worker.postMessage({ type: 'abort', id });
+			};
+			const settled = () => {
+				abort?.signal.removeEventListener('abort', onAbort);
+			};
+			this.pending.set(id, {
+				resolve: (value) => {
+					settled();
+					resolve(value as T);
+				},
+				reject: (error) => {
+					settled();
+					reject(error);
+				},
+			});
+			this.worker.postMessage(
+				{
+					type: 'call',
+					id,
+					target,
+					method,
+					args: encoded,
+					signalArg: abort?.optionsArg,
+				},
+				transfer,
+			);
+			abort?.signal.addEventListener('abort', onAbort, { once: true });
+		});
+	}
+
+	// Fire-and-forget variant for methods that are synchronous on the real managers
+	send(target: ManagerTarget, method: string, args: unknown[] = []): void {
+		this.call(target, method, args).catch((error) => {
+			log.error('Device worker call failed', { target, method, error });
+		});
+	}
+
+	onDeviceConnect(callback: DeviceConnectCallback): void {
+		this.connectCallbacks.push(callback);
+	}
+
+	onDeviceDisconnect(callback: DeviceDisconnectCallback): void {
+		this.disconnectCallbacks.push(callback);
+	}
+
+	onDeviceError(callback: DeviceErrorCallback): void {
+		this.errorCallbacks.push(callback);
+	}
+
+	getDevices(): TerminalDevice[] {
+		return this.devices.slice();
+	}
+
+	async terminate(): Promise<void> {
+		await this.worker.terminate();
+	}
+
+	/**
+	 * Writable whose chunks are copied to a stream hosted in the worker.
+	 * Each write completes once the worker's stream has taken the chunk,
+	 * so highWaterMark bounds memory on both threads.
+	 */
+	openStream(printerName: string, options: PrintStreamOptions): Writable {
+		const streamId = this.nextStreamId++;
+		const request = (
+			op: StreamMessage['op'],
+			fields: Partial<StreamMessage> = {},
+			transfer: ArrayBuffer[] = [],
+		) =>
+			new Promise<void>((resolve, reject) => {
+				this.streamAcks.set(streamId, {
+					resolve: () => resolve(),
+					reject,
+				});
+				this.worker.postMessage(
+					{ type: 'stream', op, streamId, ...fields },
+					transfer,
+				);
+			});
+		const writeChunk = (chunk: Buffer, callback: (error?: Error) => void) => {
+			const transfer: ArrayBuffer[] = [];
+			const encoded = encodeWireValue(chunk, transfer);
+			request('write', { chunk: encoded }, transfer).then(
+				() => callback(),
+				callback,
+			);
+		};
+
+		return new Writable({
+			highWaterMark: options.highWaterMark ?? 64 * 1024,
+			construct: (callback) => {
+				request('open', { printerName, options }).then(
+					() => callback(),
+					callback,
+				);
+			},
+			write: (chunk: Buffer, _encoding, callback) => {
+				writeChunk(chunk, callback);
+			},
+			writev: (chunks, callback) => {
+				writeChunk(Buffer.concat(chunks.map(({ chunk }) => chunk)), callback);
+			},
+			final: (callback) => {
+				request('end').then(() => callback(), callback);
+			},
+			destroy: (error, callback) => {
+				// Ends the worker's stream too; an ack still pending is dropped
+				this.streamAcks.delete(streamId);
+				this.worker.postMessage({ type: 'stream', op: 'destroy', streamId });
+				callback(error);
+			},
+		});
+	}
+
+	private handleMessage(message: WorkerToMainMessage): void {
+		switch (message.type) {
+			case 'result': {
+				const call = this.pending.get(message.id);
+				this.pending.delete(message.id);
+				call?.resolve(decodeWireValue(message.value));
+				break;
+			}
+			case 'error': {
+				const call = this.pending.get(message.id);
+				this.pending.delete(message.id);
+				call?.reject(toError(message.name, message.message));
+				break;
+			}
+			case 'releaseCallback':
+				this.callbacks.release(message.callbackId, message.lastCallId);
+				break;
+			case 'streamAck': {
+				const ack = this.streamAcks.get(message.streamId);
+				this.streamAcks.delete(message.streamId);
+				if (message.message !== undefined) {
+					ack?.reject(toError(message.name ?? 'Error', message.message));
+				} else {
+					ack?.resolve(undefined);
+				}
+				break;
+			}
+			case 'callback': {
+				const callback = this.callbacks.get(message.callbackId);
+				if (!callback) break;
+				try {
+					callback(...message.args.map((arg) => decodeWireValue(arg)));
+				} catch (error) {
+					log.error('Device worker callback failed', { error });
+				}
+				break;
+			}
+			case 'connect':
+				this.devices = message.devices;
+				for (const callback of this.connectCallbacks) {
+					try {
+						callback(message.device);
+					} catch (error) {
+						log.error('Device connect callback failed', { error });
+					}
+				}
+				break;
+			case 'disconnect':
+				this.devices = message.devices;
+				for (const callback of this.disconnectCallbacks) {
+					try {
+						callback(message.deviceId);
+					} catch (error) {
+						log.error('Device disconnect callback failed', { error });
+					}
+				}
+				break;
+			case 'deviceError':
+				for (const callback of this.errorCallbacks) {
+					try {
+						callback(message.deviceId, toError(message.name, message.message));
+					} catch (error) {
+						log.error('Device error callback failed', { error });
+					}
+				}
+				break;
+		}
+	}
+}
+
+/**
+ * DeviceManager API served from a worker thread. Device getters read the
+ * mirrored snapshot; config reads become async because the config store
+ * lives in the worker.
+ */
+export class DeviceManagerProxy {
+	constructor(private readonly channel: DeviceWorkerChannel) {}
+
+	async start(): Promise<void> {
+		await this.channel.ready;
+		return this.channel.call('deviceManager', 'start');
+	}
+
+	stop(): Promise<void> {
+		return this.channel.call('deviceManager', 'stop');
+	}
+
+	onDeviceConnect(callback: DeviceConnectCallback): void {
+		this.channel.onDeviceConnect(callback);
+	}
+
+	onDeviceDisconnect(callback: DeviceDisconnectCallback): void {
+		this.channel.onDeviceDisconnect(callback);
+	}
+
+	onDeviceError(callback: DeviceErrorCallback): void {
+		this.channel.onDeviceError(callback);
+	}
+
+	getDevices(): TerminalDevice[] {
+		return this.channel.getDevices();
+	}
+
+	getDevice(deviceId: string): TerminalDevice | undefined {
+		return this.channel.getDevices().find((device) => device.id === deviceId);
+	}
+
+	getDefaultDevice(deviceType: DeviceType): TerminalDevice | undefined {
+		return this.channel
+			.getDevices()
+			.find(
+				(device) =>
+					device.meta.deviceType === deviceType && device.meta.setToDefault,
+			);
+	}
+
+	getDefaultDeviceId(deviceType: DeviceType): string | null {
+		const defaultDevice = this.getDefaultDevice(deviceType);
+		return defaultDevice ? defaultDevice.id : null;
+	}
+
+	getDevicesByType(deviceType: DeviceType): TerminalDevice[] {
+		return this.channel
+			.getDevices()
+			.filter((device) => device.meta.deviceType === deviceType);
+	}
+
+	refreshDevices(): Promise<void> {
+		return this.channel.call('deviceManager', 'refreshDevices');
+	}
+
+	refreshDeviceConfig(vid: string, pid: string): Promise<void> {
+		return this.channel.call('deviceManager', 'refreshDeviceConfig', [
+			vid,
+			pid,
+		]);
+	}
+
+	setDeviceConfig(
+		vid: string,
+		pid: string,
+		config: DeviceConfig,
+	): Promise<boolean> {
+		return this.channel.call('deviceManager', 'setDeviceConfig', [
+			vid,
+			pid,
+			config,
+		]);
+	}
+
+	updateDeviceConfig(
+		vid: string,
+		pid: string,
+		config: Partial<DeviceConfig>,
+	): Promise<DeviceConfig | null> {
+		return this.channel.call('deviceManager', 'updateDeviceConfig', [
+			vid,
+			pid,
+			config,
+		]);
+	}
+
+	deleteDeviceConfig(vid: string, pid: string): Promise<boolean> {
+		return this.channel.call('deviceManager', 'deleteDeviceConfig', [vid, pid]);
+	}
+
+	deleteAllDeviceConfigs(): Promise<boolean> {
+		return this.channel.call('deviceManager', 'deleteAllDeviceConfigs');
+	}
+
+	setDeviceAsDefault(deviceId: string): Promise<boolean> {
+		return this.channel.call('deviceManager', 'setDeviceAsDefault', [deviceId]);
+	}
+
+	unsetDeviceAsDefault(deviceId: string): Promise<boolean> {
+		return this.channel.call('deviceManager', 'unsetDeviceAsDefault', [
+			deviceId,
+		]);
+	}
+
+	getDeviceConfig(vid: string, pid: string): Promise<DeviceConfig | null> {
+		return this.channel.call('deviceManager', 'getDeviceConfig', [vid, pid]);
+	}
+
+	getAllDeviceConfigs(): Promise<Record<string, DeviceConfig>> {
+		return this.channel.call('deviceManager', 'getAllDeviceConfigs');
+	}
+
+	hasDeviceConfig(vid: string, pid: string): Promise<boolean> {
+		return this.channel.call('deviceManager', 'hasDeviceConfig', [vid, pid]);
+	}
+
+	getConfiguredDeviceCount(): Promise<number> {
+		return this.channel.call('deviceManager', 'getConfiguredDeviceCount');
+	}
+
+	/**
+	 * Stop the worker thread hosting the device stack
+	 */
+	terminate(): Promise<void> {
+		return this.channel.terminate();
+	}
+}
+
+export class PrinterManagerProxy {
+	constructor(
+		private readonly channel: DeviceWorkerChannel,
+		private readonly deviceManager: DeviceManagerProxy,
+	) {}
+
+	// Large payloads (base64 images, long reports) are transferred, not cloned
+	printToDevice(
+		deviceId: string,
+		data: string,
+		isImage = false,
+		options: PrintJobOptions = {},
+	): Promise<boolean> {
+		return this.callWithSignal(options.signal, 'printToDevice', [
+			deviceId,
+			data,
+			isImage,
+			{ timeoutMs: options.timeoutMs },
+		]);
+	}
+
+	printToDefault(
+		data: string,
+		isImage = false,
+		options: PrintJobOptions = {},
+	): Promise<boolean> {
+		return this.callWithSignal(options.signal, 'printToDefault', [
+			data,
+			isImage,
+			{ timeoutMs: options.timeoutMs },
+		]);
+	}
+
+	printToGroup(
+		group: string,
+		data: string,
+		isImage = false,
+		options: PrintJobOptions = {},
+	): Promise<boolean> {
+		return this.callWithSignal(options.signal, 'printToGroup', [
+			group,
+			data,
+			isImage,
+			{ timeoutMs: options.timeoutMs },
+		]);
+	}
+
+	getPrinterGroupStatus(
+		group: string,
+		bytes = 0,
+	): Promise<PrinterRouteEstimate[]> {
+		return this.channel.call('printerManager', 'getPrinterGroupStatus', [
+			group,
+			bytes,
+		]);
+	}
+
+	preparePrint(
+		deviceId: string,
+		data: string,
+		isImage = false,
+		options: { ttlMs?: number } = {},
+	): Promise<PreparedPrintJob> {
+		return this.channel.call('printerManager', 'preparePrint', [
+			deviceId,
+			data,
+			isImage,
+			options,
+		]);
+	}
+
+	// The rendered bytes stay in the worker; only the handle crosses
+	commitPrint(
+		job: PreparedPrintJob,
+		options: PrintJobOptions = {},
+	): Promise<boolean> {
+		return this.callWithSignal(options.signal, 'commitPrint', [
+			job,
+			{ timeoutMs: options.timeoutMs },
+		]);
+	}
+
+	discardPrint(job: PreparedPrintJob): Promise<void> {
+		return this.channel.call('printerManager', 'discardPrint', [job]);
+	}
+
+	trimPreparedJobs(): Promise<number> {
+		return this.channel.call('printerManager', 'trimPreparedJobs');
+	}
+
+	getPreparedJobStats(): Promise<PreparedJobStoreStats> {
+		return this.channel.call('printerManager', 'getPreparedJobStats');
+	}
+
+	cancelPrintJobs(deviceId: string): Promise<number> {
+		return this.channel.call('printerManager', 'cancelPrintJobs', [deviceId]);
+	}
+
+	getPrintQueueDepth(deviceId: string): Promise<number> {
+		return this.channel.call('printerManager', 'getPrintQueueDepth', [
+			deviceId,
+		]);
+	}
+
+	ensurePrinterAdapter(device: TerminalDevice): Promise<void> {
+		return this.channel.call('printerManager', 'ensurePrinterAdapter', [
+			device,
+		]);
+	}
+
+	closePrinterAdapter(deviceId: string): Promise<void> {
+		return this.channel.call('printerManager', 'closePrinterAdapter', [
+			deviceId,
+		]);
+	}
+
+	closeAllPrinterAdapters(): Promise<void> {
+		return this.channel.call('printerManager', 'closeAllPrinterAdapters');
+	}
+
+	// Chunks are copied to a stream in the worker; see PrintStreamOptions
+	createWriteStream(
+		printerName: string,
+		options: PrintStreamOptions = {},
+	): Writable {
+		return this.channel.openStream(printerName, options);
+	}
+
+	getPrinterDevices(): TerminalDevice[] {
+		return this.deviceManager.getDevicesByType('printer');
+	}
+
+	getDefaultPrinter(): TerminalDevice | undefined {
+		return this.deviceManager.getDefaultDevice('printer');
+	}
+
+	testPrint(): Promise<{ success: boolean; error?: string }> {
+		return this.channel.call('printerManager', 'testPrint');
+	}
+
+	// AbortSignals can't cross the worker boundary; the job gets a signal of
+	// its own in the worker (the last argument's), aborted only with this one
+	private async callWithSignal<T>(
+		signal: AbortSignal | undefined,
+		method: string,
+		args: unknown[],
+	): Promise<T> {
+		if (signal?.aborted) {
+			throw toError('PrintJobCancelledError', 'job was cancelled');
+		}
+		return this.channel.call(
+			'printerManager',
+			method,
+			args,
+			signal && { signal, optionsArg: args.length - 1 },
+		);
+	}
+}
+
+export class ScannerManagerProxy {
+	constructor(
+		private readonly channel: DeviceWorkerChannel,
+		private readonly deviceManager: DeviceManagerProxy,
+	) {}
+
+	scanFromDevice(deviceId: string, callback: ScanDataCallback): Promise<void> {
+		return this.channel.call('scannerManager', 'scanFromDevice', [
+			deviceId,
+			callback,
+		]);
+	}
+
+	scanFromDefault(callback: ScanDataCallback): Promise<void> {
+		return this.channel.call('scannerManager', 'scanFromDefault', [callback]);
+	}
+
+	stopScanning(deviceId: string): Promise<void> {
+		return this.channel.call('scannerManager', 'stopScanning', [deviceId]);
+	}
+
+	stopScanningFromDefault(): Promise<void> {
+		return this.channel.call('scannerManager', 'stopScanningFromDefault');
+	}
+
+	removeCallback(deviceId: string, callback: ScanDataCallback): void {
+		this.channel.send('scannerManager', 'removeCallback', [deviceId, callback]);
+	}
+
+	removeDefaultCallback(callback: ScanDataCallback): void {
+		this.channel.send('scannerManager', 'removeDefaultCallback', [callback]);
+	}
+
+	stopAllScanning(): Promise<void> {
+		return this.channel.call('scannerManager', 'stopAllScanning');
+	}
+
+	ensureScannerAdapter(
+		device: TerminalDevice,
+		baudRate?: BaudRate,
+	): Promise<void> {
+		return this.channel.call('scannerManager', 'ensureScannerAdapter', [
+			device,
+			baudRate,
+		]);
+	}
+
+	closeScannerAdapter(deviceId: string): Promise<void> {
+		return this.channel.call('scannerManager', 'closeScannerAdapter', [
+			deviceId,
+		]);
+	}
+
+	closeAllScannerAdapters(): Promise<void> {
+		return this.channel.call('scannerManager', 'closeAllScannerAdapters');
+	}
+
+	getScannerDevices(): TerminalDevice[] {
+		return this.deviceManager.getDevicesByType('scanner');
+	}
+
+	getDefaultScanner(): TerminalDevice | undefined {
+		return this.deviceManager.getDefaultDevice('scanner');
+	}
+
+	isScanning(deviceId: string): Promise<boolean> {
+		return this.channel.call('scannerManager', 'isScanning', [deviceId]);
+	}
+
+	getActiveScanners(): Promise<string[]> {
+		return this.channel.call('scannerManager', 'getActiveScanners');
+	}
+
+	getReadLatency(deviceId: string): Promise<ReadLatencyStats | null> {
+		return this.channel.call('scannerManager', 'getReadLatency', [deviceId]);
+	}
+
+	getNextScan(timeoutMs = 10000): Promise<string> {
+		return this.channel.call('scannerManager', 'getNextScan', [timeoutMs]);
+	}
+
+	getNextScanFromDevice(deviceId: string, timeoutMs = 10000): Promise<string> {
+		return this.channel.call('scannerManager', 'getNextScanFromDevice', [
+			deviceId,
+			timeoutMs,
+		]);
+	}
+
+	onScanData(callback: ScanDataCallback): void {
+		this.channel.send('scannerManager', 'onScanData', [callback]);
+	}
+}
+
+export class ScaleManagerProxy {
+	constructor(
+		private readonly channel: DeviceWorkerChannel,
+		private readonly deviceManager: DeviceManagerProxy,
+	) {}
+
+	readFromDevice(
+		deviceId: string,
+		callback: WeightDataCallback,
+	): Promise<void> {
+		return this.channel.call('scaleManager', 'readFromDevice', [
+			deviceId,
+			callback,
+		]);
+	}
+
+	readFromDefault(callback: WeightDataCallback): Promise<void> {
+		return this.channel.call('scaleManager', 'readFromDefault', [callback]);
+	}
+
+	stopReading(deviceId: string): Promise<void> {
+		return this.channel.call('scaleManager', 'stopReading', [deviceId]);
+	}
+
+	stopReadingFromDefault(): Promise<void> {
+		return this.channel.call('scaleManager', 'stopReadingFromDefault');
+	}
+
+	removeCallback(deviceId: string, callback: WeightDataCallback): void {
+		this.channel.send('scaleManager', 'removeCallback', [deviceId, callback]);
+	}
+
+	removeDefaultCallback(callback: WeightDataCallback): void {
+		this.channel.send('scaleManager', 'removeDefaultCallback', [callback]);
+	}
+
+	stopAllReading(): Promise<void> {
+		return this.channel.call('scaleManager', 'stopAllReading');
+	}
+
+	ensureScaleAdapter(
+		device: TerminalDevice,
+		baudRate?: BaudRate,
+	): Promise<void> {
+		return this.channel.call('scaleManager', 'ensureScaleAdapter', [
+			device,
+			baudRate,
+		]);
+	}
+
+	closeScaleAdapter(deviceId: string): Promise<void> {
+		return this.channel.call('scaleManager', 'closeScaleAdapter', [deviceId]);
+	}
+
+	closeAllScaleAdapters(): Promise<void> {
+		return this.channel.call('scaleManager', 'closeAllScaleAdapters');
+	}
+
+	getScaleDevices(): TerminalDevice[] {
+		return this.deviceManager.getDevicesByType('scale');
+	}
+
+	getDefaultScale(): TerminalDevice | undefined {
+		return this.deviceManager.getDefaultDevice('scale');
+	}
+
+	isReading(deviceId: string): Promise<boolean> {
+		return this.channel.call('scaleManager', 'isReading', [deviceId]);
+	}
+
+	getActiveScales(): Promise<string[]> {
+		return this.channel.call('scaleManager', 'getActiveScales');
+	}
+
+	getReadLatency(deviceId: string): Promise<ReadLatencyStats | null> {
+		return this.channel.call('scaleManager', 'getReadLatency', [deviceId]);
+	}
+
+	getCurrentWeight(timeoutMs = 5000): Promise<string> {
+		return this.channel.call('scaleManager', 'getCurrentWeight', [timeoutMs]);
+	}
+
+	getCurrentWeightFromDevice(
+		deviceId: string,
+		timeoutMs = 5000,
+	): Promise<string> {
+		return this.channel.call('scaleManager', 'getCurrentWeightFromDevice', [
+			deviceId,
+			timeoutMs,
+		]);
+	}
+
+	onWeightData(callback: WeightDataCallback): void {
+		this.channel.send('scaleManager', 'onWeightData', [callback]);
+	}
+
+	startLabelTrigger(
+		deviceId: string,
+		options: LabelTriggerOptions,
+		onPrint?: LabelPrintCallback,
+	): Promise<void> {
+		return this.channel.call('scaleManager', 'startLabelTrigger', [
+			deviceId,
+			options,
+			onPrint,
+		]);
+	}
+
+	stopLabelTrigger(deviceId: string): Promise<void> {
+		return this.channel.call('scaleManager', 'stopLabelTrigger', [deviceId]);
+	}
+
+	setLabelUnitPrice(deviceId: string, unitPrice: number): void {
+		this.channel.send('scaleManager', 'setLabelUnitPrice', [
+			deviceId,
+			unitPrice,
+		]);
+	}
+
+	getLabelTriggerStats(deviceId: string): Promise<WeighLabelStats | null> {
+		return this.channel.call('scaleManager', 'getLabelTriggerStats', [
+			deviceId,
+		]);
+	}
+}
+
+export class DisplayManagerProxy {
+	constructor(
+		private readonly channel: DeviceWorkerChannel,
+		private readonly deviceManager: DeviceManagerProxy,
+	) {}
+
+	show(deviceId: string, lines: string[]): Promise<void> {
+		return this.channel.call('displayManager', 'show', [deviceId, lines]);
+	}
+
+	showOnDefault(lines: string[]): Promise<void> {
+		return this.channel.call('displayManager', 'showOnDefault', [lines]);
+	}
+
+	clear(deviceId: string): Promise<void> {
+		return this.channel.call('displayManager', 'clear', [deviceId]);
+	}
+
+	clearDefault(): Promise<void> {
+		return this.channel.call('displayManager', 'clearDefault');
+	}
+
+	ensureDisplayAdapter(device: TerminalDevice): Promise<void> {
+		return this.channel.call('displayManager', 'ensureDisplayAdapter', [
+			device,
+		]);
+	}
+
+	closeDisplayAdapter(deviceId: string): Promise<void> {
+		return this.channel.call('displayManager', 'closeDisplayAdapter', [
+			deviceId,
+		]);
+	}
+
+	closeAllDisplayAdapters(): Promise<void> {
+		return this.channel.call('displayManager', 'closeAllDisplayAdapters');
+	}
+
+	getDisplayDevices(): TerminalDevice[] {
+		return this.deviceManager.getDevicesByType('display');
+	}
+
+	getDefaultDisplay(): TerminalDevice | undefined {
+		return this.deviceManager.getDefaultDevice('display');
+	}
+
+	getLines(deviceId: string): Promise<string[] | null> {
+		return this.channel.call('displayManager', 'getLines', [deviceId]);
+	}
+
+	getDisplayStats(deviceId: string): Promise<CustomerDisplayStats | null> {
+		return this.channel.call('displayManager', 'getDisplayStats', [deviceId]);
+	}
+}
+
+export interface WorkerDeviceManagers {
+	deviceManager: DeviceManagerProxy;
+	printerManager: PrinterManagerProxy;
+	scannerManager: ScannerManagerProxy;
+	scaleManager: ScaleManagerProxy;
+	displayManager: DisplayManagerProxy;
+}
+
+/**
+ * Start the device stack in a worker thread and return main-thread proxies
+ */
+export function createWorkerDeviceManagers(options: {
+	scannerRetry?: Partial<RetryOptions>;
+	scaleRetry?: Partial<RetryOptions>;
+	displayRetry?: Partial<RetryOptions>;
+	display?: CustomerDisplayOptions;
+}): WorkerDeviceManagers {
+	const channel = new DeviceWorkerChannel(options);
+	const deviceManager = new DeviceManagerProxy(channel);
+
+	return {
+		deviceManager,
+		printerManager: new PrinterManagerProxy(channel, deviceManager),
+		scannerManager: new ScannerManagerProxy(channel, deviceManager),
+		scaleManager: new ScaleManagerProxy(channel, deviceManager),
+		displayManager: new DisplayManagerProxy(channel, deviceManager),
+	};
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <napi.h>
+
+// Platform-neutral subsystems registered by the platform entry points
+// (printer.cpp on Windows, stub.cpp elsewhere)
+namespace escpos {
+
+void InitThreadPool(Napi::Env env, Napi::Object exports);
+void InitTransport(Napi::Env env, Napi::Object exports);
+void InitRaster(Napi::Env env, Napi::Object exports);
+void InitEvdev(Napi::Env env, Napi::Object exports);
+void InitWeighLabel(Napi::Env env, Napi::Object exports);
+void InitHandoff(Napi::Env env, Napi::Object exports);
+
+}  // namespace escpos
@@ -0,0 +1,126 @@
+#include "cancel_token.h"
+
+#include <algorithm>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace escpos {
+
+Deadline Deadline::After(int64_t timeoutMs) {
+    Deadline deadline;
+    if (timeoutMs > 0) {
+        deadline.set = true;
+        deadline.at = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    }
+    return deadline;
+}
+
+bool Deadline::Expired() const {
+    return this->set && Clock::now() >= this->at;
+}
+
+int Deadline::RemainingMs(int cap) const {
+    if (!this->set) {
+        return cap;
+    }
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(this->at - Clock::now()).count();
+    return static_cast<int>(std::max<int64_t>(0, std::min<int64_t>(left, cap)));
+}
+
+#ifdef _WIN32
+
+CancelToken::CancelToken() {
+    this->event = CreateEventW(NULL, TRUE, FALSE, NULL);
+}
+
+CancelToken::~CancelToken() {
+    if (this->event) {
+        CloseHandle(this->event);
+    }
+}
+
+void CancelToken::Cancel() {
+    this->cancelled.store(true, std::memory_order_release);
+    if (this->event) {
+        SetEvent(this->event);
+    }
+}
+
+void CancelToken::Reset() {
+    this->cancelled.store(false, std::memory_order_release);
+    if (this->event) {
+        ResetEvent(this->event);
+    }
+}
+
+bool CancelToken::WaitFor(int ms) const {
+    if (this->IsCancelled()) {
+        return true;
+    }
+    if (this->event) {
+        WaitForSingleObject(this->event, static_cast<DWORD>(std::max(0, ms)));
+    } else {
+        Sleep(static_cast<DWORD>(std::max(0, ms)));
+    }
+    return this->IsCancelled();
+}
+
+#else
+
+CancelToken::CancelToken() {
+    if (pipe(this->pipeFds) == 0) {
+        for (int fd : this->pipeFds) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+    }
+}
+
+CancelToken::~CancelToken() {
+    for (int fd : this->pipeFds) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+void CancelToken::Cancel() {
+    if (this->cancelled.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    if (this->pipeFds[1] >= 0) {
+        const char wake = 1;
+        ssize_t ignored = write(this->pipeFds[1], &wake, 1);
+        (void)ignored;
+    }
+}
+
+void CancelToken::Reset() {
+    char drain[16];
+    if (this->pipeFds[0] >= 0) {
+        while (read(this->pipeFds[0], drain, sizeof(drain)) > 0) {
+        }
+    }
+    this->cancelled.store(false, std::memory_order_release);
+}
+
+bool CancelToken::WaitFor(int ms) const {
+    if (this->IsCancelled()) {
+        return true;
+    }
+    struct pollfd pfd = {this->pipeFds[0], POLLIN, 0};
+    if (pfd.fd >= 0) {
+        poll(&pfd, 1, std::max(0, ms));
+    } else {
+        usleep(static_cast<useconds_t>(std::max(0, ms)) * 1000);
+    }
+    return this->IsCancelled();
+}
+
+#endif
+
+}  // namespace escpos
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace escpos {
+
+using Clock = std::chrono::steady_clock;
+
+// Absolute point in time after which an I/O operation gives up.
+// A default-constructed deadline never expires.
+class Deadline {
+public:
+    Deadline() = default;
+
+    static Deadline After(int64_t timeoutMs);
+
+    bool IsSet() const { return this->set; }
+    bool Expired() const;
+    // Milliseconds left, clamped to [0, cap]; cap when no deadline is set
+    int RemainingMs(int cap) const;
+
+private:
+    bool set = false;
+    Clock::time_point at;
+};
+
+// One-shot cancellation flag that can also wake blocking waits:
+// a self-pipe readable end for poll() on POSIX, a manual-reset event on Windows.
+class CancelToken {
+public:
+    CancelToken();
+    ~CancelToken();
+
+    CancelToken(const CancelToken&) = delete;
+    CancelToken& operator=(const CancelToken&) = delete;
+
+    void Cancel();
+    void Reset();
+    bool IsCancelled() const { return this->cancelled.load(std::memory_order_acquire); }
+    // Sleeps up to ms, waking early on Cancel(); returns true if cancelled
+    bool WaitFor(int ms) const;
+
+#ifdef _WIN32
+    HANDLE Event() const { return this->event; }
+#else
+    // Becomes readable once Cancel() has been called
+    int PollFd() const { return this->pipeFds[0]; }
+#endif
+
+private:
+    std::atomic<bool> cancelled{false};
+#ifdef _WIN32
+    HANDLE event = NULL;
+#else
+    int pipeFds[2] = {-1, -1};
+#endif
+};
+
+}  // namespace escpos
@@ -0,0 +1,343 @@
+#include "datamatrix.h"
+
+#include <algorithm>
+
+#include "raster.h"
+
+namespace escpos {
+
+namespace {
+
+struct SymbolSize {
+    int size;
+    int regionSize;
+    int regionsPerSide;
+    int dataCodewords;
+    int ecCodewords;
+    int blocks;
+};
+
+// Square ECC 200 symbols (ISO/IEC 16022 table 7)
+const SymbolSize kSymbolSizes[] = {
+    {10, 8, 1, 3, 5, 1},         {12, 10, 1, 5, 7, 1},        {14, 12, 1, 8, 10, 1},       {16, 14, 1, 12, 12, 1},
+    {18, 16, 1, 18, 14, 1},      {20, 18, 1, 22, 18, 1},      {22, 20, 1, 30, 20, 1},      {24, 22, 1, 36, 24, 1},
+    {26, 24, 1, 44, 28, 1},      {32, 14, 2, 62, 36, 1},      {36, 16, 2, 86, 42, 1},      {40, 18, 2, 114, 48, 1},
+    {44, 20, 2, 144, 56, 1},     {48, 22, 2, 174, 68, 1},     {52, 24, 2, 204, 84, 2},     {64, 14, 4, 280, 112, 2},
+    {72, 16, 4, 368, 144, 4},    {80, 18, 4, 456, 192, 4},    {88, 20, 4, 576, 224, 4},    {96, 22, 4, 696, 272, 4},
+    {104, 24, 4, 816, 336, 6},   {120, 18, 6, 1050, 408, 6},  {132, 20, 6, 1304, 496, 8},  {144, 22, 6, 1558, 620, 10},
+};
+
+// GF(256) over x^8 + x^5 + x^3 + x^2 + 1
+class GaloisField {
+public:
+    GaloisField() {
+        int value = 1;
+        for (int i = 0; i < 255; i++) {
+            this->exp[i] = static_cast<uint8_t>(value);
+            this->log[value] = static_cast<uint8_t>(i);
+            value <<= 1;
+            if (value & 0x100) {
+                value ^= 0x12d;
+            }
+        }
+    }
+
+    uint8_t Multiply(uint8_t a, uint8_t b) const {
+        if (a == 0 || b == 0) {
+            return 0;
+        }
+        return this->exp[(this->log[a] + this->log[b]) % 255];
+    }
+
+    uint8_t Power(int n) const { return this->exp[n % 255]; }
+
+private:
+    uint8_t exp[255] = {};
+    uint8_t log[256] = {};
+};
+
+const GaloisField& Field() {
+    static const GaloisField field;
+    return field;
+}
+
+// Reed-Solomon check codewords over the generator with roots a^1 .. a^count
+std::vector<uint8_t> ReedSolomon(const std::vector<uint8_t>& data, int count) {
+    const GaloisField& field = Field();
+    std::vector<uint8_t> generator(count + 1, 0);
+    generator[0] = 1;
+    for (int i = 1; i <= count; i++) {
+        for (int j = i; j > 0; j--) {
+            generator[j] = generator[j - 1] ^ field.Multiply(generator[j], field.Power(i));
+        }
+        generator[0] = field.Multiply(generator[0], field.Power(i));
+    }
+
+    // generator[k] is the coefficient of x^k; divide data * x^count by it
+    std::vector<uint8_t> remainder(count, 0);
+    for (uint8_t codeword : data) {
+        uint8_t factor = codeword ^ remainder[count - 1];
+        for (int k = count - 1; k > 0; k--) {
+            remainder[k] = remainder[k - 1] ^ field.Multiply(factor, generator[k]);
+        }
+        remainder[0] = field.Multiply(factor, generator[0]);
+    }
+    return std::vector<uint8_t>(remainder.rbegin(), remainder.rend());
+}
+
+std::vector<uint8_t> EncodeAscii(const uint8_t* data, size_t length) {
+    std::vector<uint8_t> codewords;
+    for (size_t i = 0; i < length; i++) {
+        uint8_t byte = data[i];
+        if (byte >= '0' && byte <= '9' && i + 1 < length && data[i + 1] >= '0' && data[i + 1] <= '9') {
+            codewords.push_back(static_cast<uint8_t>(130 + (byte - '0') * 10 + (data[i + 1] - '0')));
+            i++;
+        } else if (byte < 128) {
+            codewords.push_back(static_cast<uint8_t>(byte + 1));
+        } else {
+            // Upper shift
+            codewords.push_back(235);
+            codewords.push_back(static_cast<uint8_t>(byte - 127));
+        }
+    }
+    return codewords;
+}
+
+// Module placement of ISO/IEC 16022 Annex F. Each cell holds
+// codeword * 8 + bit + 1 (bit 0 = most significant), or 0 while unset.
+class Placement {
+public:
+    Placement(int rows, int columns) : rows(rows), columns(columns), cells(rows * columns, 0) {}
+
+    void Place() {
+        int codeword = 0;
+        int row = 4;
+        int column = 0;
+        do {
+            if (row == this->rows && column == 0) {
+                this->Corner1(codeword++);
+            }
+            if (row == this->rows - 2 && column == 0 && this->columns % 4) {
+                this->Corner2(codeword++);
+            }
+            if (row == this->rows - 2 && column == 0 && this->columns % 8 == 4) {
+                this->Corner3(codeword++);
+            }
+            if (row == this->rows + 4 && column == 2 && !(this->columns % 8)) {
+                this->Corner4(codeword++);
+            }
+            // Sweep up and to the right
+            do {
+                if (row < this->rows && column >= 0 && !this->cells[row * this->columns + column]) {
+                    this->Utah(row, column, codeword++);
+                }
+                row -= 2;
+                column += 2;
+            } while (row >= 0 && column < this->columns);
+            row += 1;
+            column += 3;
+            // Then down and to the left
+            do {
+                if (row >= 0 && column < this->columns && !this->cells[row * this->columns + column]) {
+                    this->Utah(row, column, codeword++);
+                }
+                row += 2;
+                column -= 2;
+            } while (row < this->rows && column >= 0);
+            row += 3;
+            column += 1;
+        } while (row < this->rows || column < this->columns);
+    }
+
+    // Cells the codewords leave unset in some sizes get the fixed pattern
+    bool Dark(int row, int column, const std::vector<uint8_t>& codewords) const {
+        int cell = this->cells[row * this->columns + column];
+        if (cell == 0) {
+            return (row + column) % 2 == 0;
+        }
+        int codeword = (cell - 1) / 8;
+        int bit = (cell - 1) % 8;
+        return (codewords[codeword] >> (7 - bit)) & 1;
+    }
+
+private:
+    void Module(int row, int column, int codeword, int bit) {
+        if (row < 0) {
+            row += this->rows;
+            column += 4 - ((this->rows + 4) % 8);
+        }
+        if (column < 0) {
+            column += this->columns;
+            row += 4 - ((this->columns + 4) % 8);
+        }
+        this->cells[row * this->columns + column] = codeword * 8 + bit + 1;
+    }
+
+    void Utah(int row, int column, int codeword) {
+        this->Module(row - 2, column - 2, codeword, 0);
+        this->Module(row - 2, column - 1, codeword, 1);
+        this->Module(row - 1, column - 2, codeword, 2);
+        this->Module(row - 1, column - 1, codeword, 3);
+        this->Module(row - 1, column, codeword, 4);
+        this->Module(row, column - 2, codeword, 5);
+        this->Module(row, column - 1, codeword, 6);
+        this->Module(row, column, codeword, 7);
+    }
+
+    void Corner1(int codeword) {
+        this->Module(this->rows - 1, 0, codeword, 0);
+        this->Module(this->rows - 1, 1, codeword, 1);
+        this->Module(this->rows - 1, 2, codeword, 2);
+        this->Module(0, this->columns - 2, codeword, 3);
+        this->Module(0, this->columns - 1, codeword, 4);
+        this->Module(1, this->columns - 1, codeword, 5);
+        this->Module(2, this->columns - 1, codeword, 6);
+        this->Module(3, this->columns - 1, codeword, 7);
+    }
+
+    void Corner2(int codeword) {
+        this->Module(this->rows - 3, 0, codeword, 0);
+        this->Module(this->rows - 2, 0, codeword, 1);
+        this->Module(this->rows - 1, 0, codeword, 2);
+        this->Module(0, this->columns - 4, codeword, 3);
+        this->Module(0, this->columns - 3, codeword, 4);
+        this->Module(0, this->columns - 2, codeword, 5);
+        this->Module(0, this->columns - 1, codeword, 6);
+        this->Module(1, this->columns - 1, codeword, 7);
+    }
+
+    void Corner3(int codeword) {
+        this->Module(this->rows - 3, 0, codeword, 0);
+        this->Module(this->rows - 2, 0, codeword, 1);
+        this->Module(this->rows - 1, 0, codeword, 2);
+        this->Module(0, this->columns - 2, codeword, 3);
+        this->Module(0, this->columns - 1, codeword, 4);
+        this->Module(1, this->columns - 1, codeword, 5);
+        this->Module(2, this->columns - 1, codeword, 6);
+        this->Module(3, this->columns - 1, codeword, 7);
+    }
+
+    void Corner4(int codeword) {
+        this->Module(this->rows - 1, 0, codeword, 0);
+        this->Module(this->rows - 1, this->columns - 1, codeword, 1);
+        this->Module(0, this->columns - 3, codeword, 2);
+        this->Module(0, this->columns - 2, codeword, 3);
+        this->Module(0, this->columns - 1, codeword, 4);
+        this->Module(1, this->columns - 3, codeword, 5);
+        this->Module(1, this->columns - 2, codeword, 6);
+        this->Module(1, this->columns - 1, codeword, 7);
+    }
+
+    int rows;
+    int columns;
+    std::vector<int> cells;
+};
+
+}  // namespace
+
+ModuleMatrix EncodeDataMatrix(const uint8_t* data, size_t length) {
+    std::vector<uint8_t> codewords = EncodeAscii(data, length);
+    const SymbolSize* symbol = nullptr;
+    for (const SymbolSize& candidate : kSymbolSizes) {
+        if (codewords.size() <= static_cast<size_t>(candidate.dataCodewords)) {
+            symbol = &candidate;
+            break;
+        }
+    }
+    if (!symbol) {
+        throw SymbolError("Data is too long for a Data Matrix symbol");
+    }
+
+    // Pad: 129 first, then the 253-state randomised pad
+    if (codewords.size() < static_cast<size_t>(symbol->dataCodewords)) {
+        codewords.push_back(129);
+    }
+    while (codewords.size() < static_cast<size_t>(symbol->dataCodewords)) {
+        int position = static_cast<int>(codewords.size()) + 1;
+        int pad = 129 + ((149 * position) % 253) + 1;
+        codewords.push_back(static_cast<uint8_t>(pad > 254 ? pad - 254 : pad));
+    }
+
+    // Larger symbols interleave the data over several Reed-Solomon blocks
+    int blocks = symbol->blocks;
+    int ecPerBlock = symbol->ecCodewords / blocks;
+    codewords.resize(symbol->dataCodewords + symbol->ecCodewords);
+    for (int block = 0; block < blocks; block++) {
+        std::vector<uint8_t> blockData;
+        for (int i = block; i < symbol->dataCodewords; i += blocks) {
+            blockData.push_back(codewords[i]);
+        }
+        std::vector<uint8_t> check = ReedSolomon(blockData, ecPerBlock);
+        for (int i = 0; i < ecPerBlock; i++) {
+            codewords[symbol->dataCodewords + i * blocks + block] = check[i];
+        }
+    }
+
+    int mappingSize = symbol->regionSize * symbol->regionsPerSide;
+    Placement placement(mappingSize, mappingSize);
+    placement.Place();
+
+    ModuleMatrix matrix;
+    matrix.size = static_cast<size_t>(symbol->size);
+    matrix.modules.assign(matrix.size * matrix.size, 0);
+    int regionSpan = symbol->regionSize + 2;
+    for (int row = 0; row < symbol->size; row++) {
+        for (int column = 0; column < symbol->size; column++) {
+            int regionRow = row % regionSpan;
+            int regionColumn = column % regionSpan;
+            bool dark;
+            if (regionColumn == 0 || regionRow == regionSpan - 1) {
+                // Solid L of the finder pattern
+                dark = true;
+            } else if (regionRow == 0) {
+                dark = regionColumn % 2 == 0;
+            } else if (regionColumn == regionSpan - 1) {
+                dark = regionRow % 2 == 1;
+            } else {
+                int mappingRow = row / regionSpan * symbol->regionSize + regionRow - 1;
+                int mappingColumn = column / regionSpan * symbol->regionSize + regionColumn - 1;
+                dark = placement.Dark(mappingRow, mappingColumn, codewords);
+            }
+            matrix.modules[row * matrix.size + column] = dark ? 1 : 0;
+        }
+    }
+    return matrix;
+}
+
+std::vector<uint8_t> RasterizeModules(const ModuleMatrix& matrix, size_t moduleSize, size_t quietZone) {
+    size_t dots = (matrix.size + 2 * quietZone) * moduleSize;
+    size_t bytesPerLine = (dots + 7) / 8;
+    if (bytesPerLine > 0xffff || dots > 0xffff) {
+        throw SymbolError("Symbol is too large for a single raster block");
+    }
+
+    std::vector<uint8_t> block(RasterBlockSize(dots, dots), 0);
+    block[0] = 0x1d;
+    block[1] = 0x76;
+    block[2] = 0x30;
+    block[3] = 0x00;
+    block[4] = static_cast<uint8_t>(bytesPerLine & 0xff);
+    block[5] = static_cast<uint8_t>(bytesPerLine >> 8);
+    block[6] = static_cast<uint8_t>(dots & 0xff);
+    block[7] = static_cast<uint8_t>(dots >> 8);
+
+    for (size_t row = 0; row < matrix.size; row++) {
+        uint8_t* line = block.data() + 8 + (quietZone + row) * moduleSize * bytesPerLine;
+        for (size_t column = 0; column < matrix.size; column++) {
+            if (!matrix.modules[row * matrix.size + column]) {
+                continue;
+            }
+            size_t left = (quietZone + column) * moduleSize;
+            for (size_t x = left; x < left + moduleSize; x++) {
+                line[x >> 3] |= static_cast<uint8_t>(0x80 >> (x & 7));
+            }
+        }
+        // Every dot row of a module row is identical
+        for (size_t copy = 1; copy < moduleSize; copy++) {
+            std::copy_n(line, bytesPerLine, line + copy * bytesPerLine);
+        }
+    }
+    return block;
+}
+
+}  // namespace escpos
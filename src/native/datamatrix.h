@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace escpos {
+
+class SymbolError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Square grid of modules, row-major, 1 = dark
+struct ModuleMatrix {
+    size_t size = 0;
+    std::vector<uint8_t> modules;
+};
+
+// ECC 200 Data Matrix in ASCII encodation (digit pairs compressed, upper
+// shift for bytes above 127) in the smallest square symbol that fits.
+// Throws SymbolError when the data exceeds a 144x144 symbol.
+ModuleMatrix EncodeDataMatrix(const uint8_t* data, size_t length);
+
+// GS v 0 raster block of the matrix at moduleSize dots per module,
+// surrounded by quietZone light modules
+std::vector<uint8_t> RasterizeModules(const ModuleMatrix& matrix, size_t moduleSize, size_t quietZone);
+
+}  // namespace escpos
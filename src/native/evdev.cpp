@@ -0,0 +1,313 @@
+#include "evdev.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef __linux__
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "thread_pool.h"
+#endif
+
+namespace escpos {
+
+// Event type and key codes from linux/input-event-codes.h (stable ABI)
+namespace key {
+constexpr uint16_t EventKey = 1;
+constexpr uint16_t Enter = 28;
+constexpr uint16_t LeftCtrl = 29;
+constexpr uint16_t LeftShift = 42;
+constexpr uint16_t RightShift = 54;
+constexpr uint16_t LeftAlt = 56;
+constexpr uint16_t CapsLock = 58;
+constexpr uint16_t KeypadEnter = 96;
+constexpr uint16_t RightCtrl = 97;
+constexpr uint16_t RightAlt = 100;
+}  // namespace key
+
+size_t ParseInputEvents(const uint8_t* data, size_t length, std::vector<InputEvent>& events) {
+    size_t offset = 0;
+    for (; offset + kInputEventSize <= length; offset += kInputEventSize) {
+        const uint8_t* record = data + offset + 2 * sizeof(long);
+        InputEvent event;
+        std::memcpy(&event.type, record, 2);
+        std::memcpy(&event.code, record + 2, 2);
+        std::memcpy(&event.value, record + 4, 4);
+        events.push_back(event);
+    }
+    return offset;
+}
+
+Keymap UsKeymap() {
+    Keymap keymap(128);
+    auto row = [&keymap](uint16_t first, const char* normal, const char* shifted) {
+        for (size_t i = 0; normal[i]; i++) {
+            keymap[first + i] = {std::string(1, normal[i]), std::string(1, shifted[i])};
+        }
+    };
+    row(2, "1234567890-=", "!@#$%^&*()_+");
+    row(15, "\tqwertyuiop[]", "\tQWERTYUIOP{}");
+    row(30, "asdfghjkl;'`", "ASDFGHJKL:\"~");
+    row(43, "\\zxcvbnm,./", "|ZXCVBNM<>?");
+    row(55, "*", "*");
+    row(57, " ", " ");
+    row(71, "789-456+1230.", "789-456+1230.");
+    row(86, "<", ">");
+    row(98, "/", "/");
+    return keymap;
+}
+
+static void AppendUtf8(std::string& text, uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        text += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        text += static_cast<char>(0xC0 | (codePoint >> 6));
+        text += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        text += static_cast<char>(0xE0 | (codePoint >> 12));
+        text += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        text += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x110000) {
+        text += static_cast<char>(0xF0 | (codePoint >> 18));
+        text += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        text += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        text += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+// Keypad digit of a key code, -1 for other keys
+static int KeypadDigit(uint16_t code) {
+    switch (code) {
+        case 71: return 7;
+        case 72: return 8;
+        case 73: return 9;
+        case 75: return 4;
+        case 76: return 5;
+        case 77: return 6;
+        case 79: return 1;
+        case 80: return 2;
+        case 81: return 3;
+        case 82: return 0;
+        default: return -1;
+    }
+}
+
+bool ScanDecoder::Feed(const InputEvent& event, std::string& scan) {
+    // Autorepeat (2) only says a key is still down
+    if (event.type != key::EventKey || event.value == 2) {
+        return false;
+    }
+    bool pressed = event.value == 1;
+
+    switch (event.code) {
+        case key::LeftShift:
+            this->leftShift = pressed;
+            return false;
+        case key::RightShift:
+            this->rightShift = pressed;
+            return false;
+        case key::LeftCtrl:
+        case key::RightCtrl:
+            this->ctrl = pressed;
+            return false;
+        case key::LeftAlt:
+        case key::RightAlt:
+            this->alt = pressed;
+            if (pressed) {
+                this->altCode = -1;
+            } else if (this->altCode > 0) {
+                AppendUtf8(this->pending, static_cast<uint32_t>(this->altCode));
+                this->altCode = -1;
+            }
+            return false;
+        case key::CapsLock:
+            if (pressed) {
+                this->capsLock = !this->capsLock;
+            }
+            return false;
+        case key::Enter:
+        case key::KeypadEnter:
+            if (!pressed || this->pending.empty()) {
+                return false;
+            }
+            scan = std::move(this->pending);
+            this->pending.clear();
+            return true;
+        default:
+            if (pressed) {
+                this->Press(event.code);
+            }
+            return false;
+    }
+}
+
+void ScanDecoder::Press(uint16_t code) {
+    int digit = KeypadDigit(code);
+    if (this->alt && digit >= 0) {
+        this->altCode = (std::max<int32_t>(this->altCode, 0) * 10 + digit) % 0x110000;
+        return;
+    }
+    if (code >= this->keymap.size() || this->keymap[code].first.empty()) {
+        return;
+    }
+
+    const std::string& normal = this->keymap[code].first;
+    if (this->ctrl) {
+        // Control characters: Ctrl+A..Z, Ctrl+[ \ ] and Ctrl+^ _
+        char c = normal.size() == 1 ? normal[0] : 0;
+        if (c >= 'a' && c <= 'z') {
+            this->pending += static_cast<char>(c - 'a' + 1);
+        } else if (c == '[' || c == '\\' || c == ']') {
+            this->pending += static_cast<char>(c - '[' + 0x1B);
+        } else if (c == '6') {
+            this->pending += '\x1E';
+        } else if (c == '-') {
+            this->pending += '\x1F';
+        }
+        return;
+    }
+
+    bool shifted = this->leftShift || this->rightShift;
+    bool letter = normal.size() == 1 && normal[0] >= 'a' && normal[0] <= 'z';
+    if (letter && this->capsLock) {
+        shifted = !shifted;
+    }
+    this->pending += shifted ? this->keymap[code].second : normal;
+}
+
+void ScanDecoder::Reset() {
+    this->pending.clear();
+    this->leftShift = this->rightShift = this->ctrl = this->alt = this->capsLock = false;
+    this->altCode = -1;
+}
+
+EvdevReader::EvdevReader(std::string path, bool grab, Keymap keymap)
+    : path(std::move(path)), grab(grab), decoder(std::move(keymap)) {}
+
+EvdevReader::~EvdevReader() {
+    this->Stop();
+}
+
+#ifdef __linux__
+
+void EvdevReader::Start(ScanHandler onScan, EndHandler onEnd) {
+    // A reader whose stream ended is restarted
+    this->Stop();
+
+    int handle = ::open(this->path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (handle < 0) {
+        int error = errno;
+        throw EvdevError("Failed to open " + this->path + ": " + std::strerror(error),
+                         error == EACCES ? "EACCES" : "ENOENT");
+    }
+
+    struct stat info;
+    if (fstat(handle, &info) != 0 || (!S_ISCHR(info.st_mode) && !S_ISREG(info.st_mode))) {
+        ::close(handle);
+        throw EvdevError(this->path + " is not an input device or recording", "EINVAL");
+    }
+    // Exclusive access: the scanner stops typing into the focused window
+    if (S_ISCHR(info.st_mode) && this->grab && ioctl(handle, EVIOCGRAB, 1) != 0) {
+        int error = errno;
+        ::close(handle);
+        throw EvdevError("Failed to grab " + this->path + ": " + std::strerror(error),
+                         error == EBUSY ? "EBUSY" : "EIO");
+    }
+
+    this->fd = handle;
+    this->onScan = std::move(onScan);
+    this->onEnd = std::move(onEnd);
+    this->decoder.Reset();
+    this->stopToken.Reset();
+    this->running = ThreadPool::Instance().SubmitBlocking([this]() { this->Run(); }, &this->stopToken);
+}
+
+void EvdevReader::Run() {
+    std::vector<uint8_t> buffer(kInputEventSize * 64);
+    std::vector<InputEvent> events;
+    size_t filled = 0;
+    std::string scan;
+    std::string message;
+    std::string code;
+
+    while (!this->stopToken.IsCancelled()) {
+        struct pollfd fds[2] = {{this->fd, POLLIN, 0}, {this->stopToken.PollFd(), POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            message = std::string("poll failed: ") + std::strerror(errno);
+            code = "EIO";
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            break;
+        }
+
+        ssize_t count = ::read(this->fd, buffer.data() + filled, buffer.size() - filled);
+        if (count < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            if (errno == ENODEV) {
+                message = "Scanner was disconnected";
+                code = "ENODEV";
+            } else {
+                message = std::string("read failed: ") + std::strerror(errno);
+                code = "EIO";
+            }
+            break;
+        }
+        if (count == 0) {
+            // End of a recording
+            break;
+        }
+
+        filled += static_cast<size_t>(count);
+        events.clear();
+        size_t used = ParseInputEvents(buffer.data(), filled, events);
+        std::memmove(buffer.data(), buffer.data() + used, filled - used);
+        filled -= used;
+        for (const InputEvent& event : events) {
+            if (this->decoder.Feed(event, scan)) {
+                this->onScan(std::move(scan));
+                scan.clear();
+            }
+        }
+    }
+
+    this->onEnd(message, code);
+}
+
+void EvdevReader::Stop() {
+    this->stopToken.Cancel();
+    if (this->running.valid()) {
+        this->running.wait();
+        this->running = std::future<void>();
+    }
+    if (this->fd >= 0) {
+        // Closing releases the grab
+        ::close(this->fd);
+        this->fd = -1;
+    }
+}
+
+#else
+
+void EvdevReader::Start(ScanHandler, EndHandler) {
+    throw EvdevError("evdev capture is only available on Linux", "ENOSYS");
+}
+
+void EvdevReader::Run() {}
+
+void EvdevReader::Stop() {}
+
+#endif
+
+}  // namespace escpos
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <future>
+#include <utility>
+#include <vector>
+
+#include "cancel_token.h"
+
+namespace escpos {
+
+class EvdevError : public std::runtime_error {
+public:
+    EvdevError(const std::string& message, const std::string& code)
+        : std::runtime_error(message), code(code) {}
+
+    const std::string code;
+};
+
+// The fields of struct input_event that matter here. EV_KEY values are
+// 0 release, 1 press, 2 autorepeat.
+struct InputEvent {
+    uint16_t type;
+    uint16_t code;
+    int32_t value;
+};
+
+// struct input_event as the kernel writes it on this platform: a timeval
+// (two longs), then type, code and value
+constexpr size_t kInputEventSize = 2 * sizeof(long) + 8;
+
+// Appends every whole record in data to events
+// @returns Bytes consumed; a trailing partial record is left for the next call
+size_t ParseInputEvents(const uint8_t* data, size_t length, std::vector<InputEvent>& events);
+
+// UTF-8 text of a key code without and with shift, indexed by code
+using Keymap = std::vector<std::pair<std::string, std::string>>;
+
+// US layout, including the keypad
+Keymap UsKeymap();
+
+// Turns key events from a keyboard-wedge scanner into scans. Presses are
+// decoded as they come, so neither focus nor repeat timing matter; a scan
+// ends at Enter. Shift, Caps Lock, Ctrl (Ctrl+] is GS, the GS1 separator)
+// and Alt+keypad code points are understood.
+class ScanDecoder {
+public:
+    explicit ScanDecoder(Keymap keymap = UsKeymap()) : keymap(std::move(keymap)) {}
+
+    // @returns true with scan set when event completed a non-empty scan
+    bool Feed(const InputEvent& event, std::string& scan);
+    void Reset();
+
+private:
+    void Press(uint16_t code);
+
+    Keymap keymap;
+    std::string pending;
+    bool leftShift = false;
+    bool rightShift = false;
+    bool ctrl = false;
+    bool alt = false;
+    bool capsLock = false;
+    // Code point typed on the keypad while Alt is held, -1 when none
+    int32_t altCode = -1;
+};
+
+// Reads a scanner's /dev/input/event node on the thread pool's blocking
+// lane, grabbing it so keystrokes stop reaching the focused window. A
+// regular file holding a recording of such a node is replayed to its end,
+// without its timing.
+class EvdevReader {
+public:
+    using ScanHandler = std::function<void(std::string scan)>;
+    // Empty message: the recording ended or Stop() was called
+    using EndHandler = std::function<void(const std::string& message, const std::string& code)>;
+
+    EvdevReader(std::string path, bool grab, Keymap keymap);
+    ~EvdevReader();
+
+    EvdevReader(const EvdevReader&) = delete;
+    EvdevReader& operator=(const EvdevReader&) = delete;
+
+    // Throws EvdevError when the node cannot be opened or grabbed. A
+    // previous run is stopped first.
+    void Start(ScanHandler onScan, EndHandler onEnd);
+    // Waits for the reader; onEnd has been called when this returns
+    void Stop();
+
+private:
+    void Run();
+
+    std::string path;
+    bool grab;
+    ScanDecoder decoder;
+    int fd = -1;
+    CancelToken stopToken;
+    std::future<void> running;
+    ScanHandler onScan;
+    EndHandler onEnd;
+};
+
+}  // namespace escpos
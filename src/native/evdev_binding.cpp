@@ -0,0 +1,180 @@
+#include <napi.h>
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "addon.h"
+#include "evdev.h"
+
+namespace escpos {
+
+// KEY_MAX in linux/input-event-codes.h
+constexpr uint32_t kMaxKeyCode = 0x2ff;
+
+// US layout with { [code]: [normal, shifted?] } overrides on top
+static Keymap KeymapArg(Napi::Value value) {
+    Keymap keymap = UsKeymap();
+    if (!value.IsObject()) {
+        return keymap;
+    }
+
+    Napi::Object overrides = value.As<Napi::Object>();
+    Napi::Array codes = overrides.GetPropertyNames();
+    for (uint32_t i = 0; i < codes.Length(); i++) {
+        std::string name = codes.Get(i).ToString().Utf8Value();
+        uint32_t code = static_cast<uint32_t>(std::strtoul(name.c_str(), nullptr, 10));
+        Napi::Value entry = overrides.Get(name);
+        if (code == 0 || code > kMaxKeyCode || !entry.IsArray()) {
+            continue;
+        }
+        Napi::Array chars = entry.As<Napi::Array>();
+        std::string normal = chars.Length() > 0 ? chars.Get(0u).ToString().Utf8Value() : "";
+        std::string shifted = chars.Length() > 1 ? chars.Get(1u).ToString().Utf8Value() : normal;
+        if (code >= keymap.size()) {
+            keymap.resize(code + 1);
+        }
+        keymap[code] = {normal, shifted};
+    }
+    return keymap;
+}
+
+static Napi::Error ErrorWithCode(Napi::Env env, const std::string& message, const std::string& code) {
+    Napi::Error error = Napi::Error::New(env, message);
+    error.Set("code", Napi::String::New(env, code));
+    return error;
+}
+
+// JS face of EvdevReader. Scans and the end of the stream are marshalled
+// to the main thread; the wrapper stays referenced while it reads.
+class EvdevReaderWrap : public Napi::ObjectWrap<EvdevReaderWrap> {
+public:
+    static void Init(Napi::Env env, Napi::Object exports) {
+        Napi::Function func = DefineClass(env, "EvdevReader", {
+            InstanceMethod("start", &EvdevReaderWrap::Start),
+            InstanceMethod("stop", &EvdevReaderWrap::Stop)
+        });
+        exports.Set("EvdevReader", func);
+    }
+
+    // new EvdevReader(path, { grab = true, keymap })
+    EvdevReaderWrap(const Napi::CallbackInfo& info) : Napi::ObjectWrap<EvdevReaderWrap>(info) {
+        Napi::Env env = info.Env();
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Input device path expected").ThrowAsJavaScriptException();
+            return;
+        }
+
+        bool grab = true;
+        Napi::Value keymap = env.Undefined();
+        if (info.Length() > 1 && info[1].IsObject()) {
+            Napi::Object options = info[1].As<Napi::Object>();
+            if (options.Get("grab").IsBoolean()) {
+                grab = options.Get("grab").As<Napi::Boolean>().Value();
+            }
+            keymap = options.Get("keymap");
+        }
+        std::string path = info[0].As<Napi::String>().Utf8Value();
+        this->reader = std::make_unique<EvdevReader>(path, grab, KeymapArg(keymap));
+    }
+
+private:
+    // start(onScan(scan), onEnd(error | null))
+    Napi::Value Start(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (info.Length() < 2 || !info[0].IsFunction() || !info[1].IsFunction()) {
+            Napi::TypeError::New(env, "Scan and end callbacks expected").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        if (this->running) {
+            ErrorWithCode(env, "Reader is already running", "EBUSY").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+
+        this->onEnd = Napi::Persistent(info[1].As<Napi::Function>());
+        this->scanCallback =
+            Napi::ThreadSafeFunction::New(env, info[0].As<Napi::Function>(), "escpos-evdev-reader", 0, 1);
+
+        try {
+            this->reader->Start(
+                [this](std::string scan) {
+                    this->scanCallback.NonBlockingCall([scan = std::move(scan)](Napi::Env env, Napi::Function onScan) {
+                        onScan.Call({Napi::String::New(env, scan)});
+                    });
+                },
+                [this](const std::string& message, const std::string& code) {
+                    Napi::ThreadSafeFunction callback = this->scanCallback;
+                    callback.NonBlockingCall([this, message, code](Napi::Env env, Napi::Function) {
+                        this->Ended(env, message, code);
+                    });
+                    callback.Release();
+                });
+        } catch (const EvdevError& e) {
+            this->scanCallback.Release();
+            this->onEnd.Reset();
+            ErrorWithCode(env, e.what(), e.code).ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+
+        this->running = true;
+        this->Ref();
+        napi_add_env_cleanup_hook(env, StopOnExit, this);
+        return env.Undefined();
+    }
+
+    // Stops reading; onEnd(null) follows unless the stream had already ended
+    Napi::Value Stop(const Napi::CallbackInfo& info) {
+        this->reader->Stop();
+        return info.Env().Undefined();
+    }
+
+    // Runs when the environment is torn down while still reading (a worker ending, Node exiting on its
+    // own): the thread would otherwise outlive the callbacks it reports to
+    static void StopOnExit(void* data) { static_cast<EvdevReaderWrap*>(data)->reader->Stop(); }
+
+    void Ended(Napi::Env env, const std::string& message, const std::string& code) {
+        Napi::HandleScope scope(env);
+        napi_remove_env_cleanup_hook(env, StopOnExit, this);
+        this->running = false;
+        Napi::Value error = message.empty() ? env.Null() : ErrorWithCode(env, message, code).Value();
+        Napi::FunctionReference onEnd = std::move(this->onEnd);
+        this->Unref();
+        onEnd.Call({error});
+    }
+
+    std::unique_ptr<EvdevReader> reader;
+    Napi::ThreadSafeFunction scanCallback;
+    Napi::FunctionReference onEnd;
+    bool running = false;
+};
+
+// decodeEvdevEvents(buffer, keymap?) => scans in a recorded event stream
+static Napi::Value DecodeEvdevEvents(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsBuffer()) {
+        Napi::TypeError::New(env, "Buffer expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Buffer<uint8_t> buffer = info[0].As<Napi::Buffer<uint8_t>>();
+    std::vector<InputEvent> events;
+    ParseInputEvents(buffer.Data(), buffer.Length(), events);
+
+    ScanDecoder decoder(KeymapArg(info.Length() > 1 ? info[1] : env.Undefined()));
+    Napi::Array scans = Napi::Array::New(env);
+    std::string scan;
+    for (const InputEvent& event : events) {
+        if (decoder.Feed(event, scan)) {
+            scans.Set(scans.Length(), Napi::String::New(env, scan));
+            scan.clear();
+        }
+    }
+    return scans;
+}
+
+void InitEvdev(Napi::Env env, Napi::Object exports) {
+    EvdevReaderWrap::Init(env, exports);
+    exports.Set("decodeEvdevEvents", Napi::Function::New(env, DecodeEvdevEvents));
+}
+
+}  // namespace escpos
@@ -0,0 +1,286 @@
+#include "handoff.h"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "thread_pool.h"
+#endif
+
+namespace escpos {
+
+#ifndef _WIN32
+
+namespace {
+
+// A connected sender gets this long to deliver its descriptor and tag
+constexpr int kReceiveTimeoutMs = 1000;
+
+sockaddr_un SocketAddress(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        throw HandoffError("Invalid handoff socket path: " + path, "ENAMETOOLONG");
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+// SOCK_CLOEXEC is not available everywhere (macOS)
+int OpenSocket() {
+    int handle = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (handle < 0) {
+        int error = errno;
+        throw HandoffError(std::string("socket failed: ") + std::strerror(error), "EIO");
+    }
+    fcntl(handle, F_SETFD, FD_CLOEXEC);
+    return handle;
+}
+
+bool SameUser(int connection) {
+#ifdef SO_PEERCRED
+    struct ucred credentials;
+    socklen_t length = sizeof(credentials);
+    if (getsockopt(connection, SOL_SOCKET, SO_PEERCRED, &credentials, &length) != 0) {
+        return false;
+    }
+    return credentials.uid == geteuid();
+#else
+    uid_t uid;
+    gid_t gid;
+    return getpeereid(connection, &uid, &gid) == 0 && uid == geteuid();
+#endif
+}
+
+// Descriptors carried by a received message; any beyond the first are closed
+int TakeDescriptor(msghdr& message) {
+    int fd = -1;
+    for (cmsghdr* header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header)) {
+        if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+        size_t count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (size_t i = 0; i < count; i++) {
+            int received;
+            std::memcpy(&received, CMSG_DATA(header) + i * sizeof(int), sizeof(int));
+            if (fd < 0) {
+                fd = received;
+            } else {
+                ::close(received);
+            }
+        }
+    }
+    return fd;
+}
+
+}  // namespace
+
+void SendDescriptor(const std::string& socketPath, const std::string& tag, int fd) {
+    if (tag.empty() || tag.size() > kMaxHandoffTag) {
+        throw HandoffError("Handoff tag must be 1 to 128 bytes", "EINVAL");
+    }
+    sockaddr_un address = SocketAddress(socketPath);
+
+    int handle = OpenSocket();
+    if (::connect(handle, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        int error = errno;
+        ::close(handle);
+        throw HandoffError("Failed to connect to " + socketPath + ": " + std::strerror(error),
+                           error == ENOENT || error == ECONNREFUSED ? "ECONNREFUSED" : "EIO");
+    }
+
+    iovec data{const_cast<char*>(tag.data()), tag.size()};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    msghdr message{};
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    cmsghdr* header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(header), &fd, sizeof(int));
+
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+    ssize_t sent;
+    do {
+        sent = ::sendmsg(handle, &message, flags);
+    } while (sent < 0 && errno == EINTR);
+    int error = errno;
+    // The descriptor in flight stays valid after the connection closes
+    ::close(handle);
+    if (sent != static_cast<ssize_t>(tag.size())) {
+        throw HandoffError(std::string("Failed to send descriptor: ") + std::strerror(sent < 0 ? error : EIO),
+                           "EIO");
+    }
+}
+
+DescriptorReceiver::~DescriptorReceiver() {
+    this->Stop();
+}
+
+void DescriptorReceiver::Start(DescriptorHandler onDescriptor, EndHandler onEnd) {
+    this->Stop();
+
+    sockaddr_un address = SocketAddress(this->path);
+    int handle = OpenSocket();
+    fcntl(handle, F_SETFL, fcntl(handle, F_GETFL) | O_NONBLOCK);
+    if (::bind(handle, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        int error = errno;
+        ::close(handle);
+        throw HandoffError("Failed to bind " + this->path + ": " + std::strerror(error),
+                           error == EADDRINUSE ? "EADDRINUSE" : "EIO");
+    }
+    if (::listen(handle, 16) != 0) {
+        int error = errno;
+        ::close(handle);
+        ::unlink(this->path.c_str());
+        throw HandoffError(std::string("listen failed: ") + std::strerror(error), "EIO");
+    }
+
+    this->listener = handle;
+    this->onDescriptor = std::move(onDescriptor);
+    this->onEnd = std::move(onEnd);
+    this->stopToken.Reset();
+    this->running = ThreadPool::Instance().SubmitBlocking([this]() { this->Run(); }, &this->stopToken);
+}
+
+void DescriptorReceiver::Run() {
+    std::string message;
+    std::string code;
+
+    while (!this->stopToken.IsCancelled()) {
+        struct pollfd fds[2] = {{this->listener, POLLIN, 0}, {this->stopToken.PollFd(), POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            message = std::string("poll failed: ") + std::strerror(errno);
+            code = "EIO";
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            break;
+        }
+
+        int connection = ::accept(this->listener, nullptr, nullptr);
+        if (connection < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK || errno == ECONNABORTED) {
+                continue;
+            }
+            message = std::string("accept failed: ") + std::strerror(errno);
+            code = "EIO";
+            break;
+        }
+        fcntl(connection, F_SETFD, FD_CLOEXEC);
+        if (SameUser(connection)) {
+            this->ReceiveOne(connection);
+        }
+        ::close(connection);
+    }
+
+    this->onEnd(message, code);
+}
+
+// Reads the tag up to the sender closing; a sender that stalls, sends no
+// descriptor or too long a tag is dropped
+void DescriptorReceiver::ReceiveOne(int connection) {
+    Deadline deadline = Deadline::After(kReceiveTimeoutMs);
+    std::string tag;
+    int fd = -1;
+    char chunk[kMaxHandoffTag + 1];
+
+    while (tag.size() <= kMaxHandoffTag) {
+        struct pollfd ready = {connection, POLLIN, 0};
+        int remaining = deadline.RemainingMs(kReceiveTimeoutMs);
+        if (remaining == 0 || poll(&ready, 1, remaining) <= 0) {
+            break;
+        }
+
+        iovec data{chunk, sizeof(chunk)};
+        alignas(cmsghdr) char control[CMSG_SPACE(4 * sizeof(int))];
+        msghdr received{};
+        received.msg_iov = &data;
+        received.msg_iovlen = 1;
+        received.msg_control = control;
+        received.msg_controllen = sizeof(control);
+#ifdef MSG_CMSG_CLOEXEC
+        ssize_t count = ::recvmsg(connection, &received, MSG_CMSG_CLOEXEC);
+#else
+        ssize_t count = ::recvmsg(connection, &received, 0);
+#endif
+        if (count < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            break;
+        }
+
+        int descriptor = TakeDescriptor(received);
+        if (descriptor >= 0) {
+            fcntl(descriptor, F_SETFD, FD_CLOEXEC);
+            if (fd >= 0 || (received.msg_flags & MSG_CTRUNC)) {
+                ::close(descriptor);
+            } else {
+                fd = descriptor;
+            }
+        }
+        if (count == 0) {
+            if (fd >= 0 && !tag.empty()) {
+                this->onDescriptor(std::move(tag), fd);
+                return;
+            }
+            break;
+        }
+        tag.append(chunk, static_cast<size_t>(count));
+    }
+
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+void DescriptorReceiver::Stop() {
+    this->stopToken.Cancel();
+    if (this->running.valid()) {
+        this->running.wait();
+        this->running = std::future<void>();
+    }
+    if (this->listener >= 0) {
+        ::close(this->listener);
+        this->listener = -1;
+        ::unlink(this->path.c_str());
+    }
+}
+
+#else
+
+void SendDescriptor(const std::string&, const std::string&, int) {
+    throw HandoffError("Descriptor passing is not available on Windows", "ENOSYS");
+}
+
+DescriptorReceiver::~DescriptorReceiver() {}
+
+void DescriptorReceiver::Start(DescriptorHandler, EndHandler) {
+    throw HandoffError("Descriptor passing is not available on Windows", "ENOSYS");
+}
+
+void DescriptorReceiver::Run() {}
+
+void DescriptorReceiver::ReceiveOne(int) {}
+
+void DescriptorReceiver::Stop() {}
+
+#endif
+
+}  // namespace escpos
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <functional>
+#include <future>
+#include <stdexcept>
+#include <string>
+
+#include "cancel_token.h"
+
+namespace escpos {
+
+class HandoffError : public std::runtime_error {
+public:
+    HandoffError(const std::string& message, const std::string& code)
+        : std::runtime_error(message), code(code) {}
+
+    const std::string code;
+};
+
+// Longest tag sent along with a descriptor
+constexpr size_t kMaxHandoffTag = 128;
+
+// Passes an open descriptor to the process listening on socketPath
+// (SCM_RIGHTS), labelled with tag. The receiver gets its own copy; the
+// caller still closes fd. Throws HandoffError, with code ENOSYS on Windows.
+void SendDescriptor(const std::string& socketPath, const std::string& tag, int fd);
+
+// Receives descriptors sent with SendDescriptor on a Unix domain socket,
+// on the thread pool's blocking lane. Only peers running as the same user
+// are accepted. The socket file is created with the process umask and
+// removed by Stop().
+class DescriptorReceiver {
+public:
+    // Owns fd (close-on-exec)
+    using DescriptorHandler = std::function<void(std::string tag, int fd)>;
+    // Empty message: Stop() was called
+    using EndHandler = std::function<void(const std::string& message, const std::string& code)>;
+
+    explicit DescriptorReceiver(std::string path) : path(std::move(path)) {}
+    ~DescriptorReceiver();
+
+    DescriptorReceiver(const DescriptorReceiver&) = delete;
+    DescriptorReceiver& operator=(const DescriptorReceiver&) = delete;
+
+    // Throws HandoffError when the socket cannot be created. A previous run
+    // is stopped first.
+    void Start(DescriptorHandler onDescriptor, EndHandler onEnd);
+    // Waits for the receiver; onEnd has been called when this returns
+    void Stop();
+
+private:
+    void Run();
+    void ReceiveOne(int connection);
+
+    std::string path;
+    int listener = -1;
+    CancelToken stopToken;
+    std::future<void> running;
+    DescriptorHandler onDescriptor;
+    EndHandler onEnd;
+};
+
+}  // namespace escpos
@@ -0,0 +1,185 @@
+#include <napi.h>
+
+#include <memory>
+#include <string>
+
+#include "addon.h"
+#include "handoff.h"
+#include "mapped_file.h"
+#include "pool_task.h"
+
+namespace escpos {
+
+static Napi::Error ErrorWithCode(Napi::Env env, const std::string& message, const std::string& code) {
+    Napi::Error error = Napi::Error::New(env, message);
+    error.Set("code", Napi::String::New(env, code));
+    return error;
+}
+
+// Read-only Buffer over a mapping, unmapped once the buffer is collected;
+// copied where the runtime forbids external buffers (Electron's V8 sandbox)
+static Napi::Value MappedBuffer(Napi::Env env, MappedFile* file) {
+    napi_value buffer;
+    napi_status status = napi_create_external_buffer(
+        env, file->Size(), file->Data(),
+        [](napi_env, void*, void* hint) { delete static_cast<MappedFile*>(hint); }, file, &buffer);
+    if (status != napi_ok) {
+        Napi::Buffer<uint8_t> copy = Napi::Buffer<uint8_t>::Copy(env, file->Data(), file->Size());
+        delete file;
+        return copy;
+    }
+    return Napi::Value(env, buffer);
+}
+
+class SendDescriptorTask : public PoolTask {
+public:
+    SendDescriptorTask(Napi::Env env, std::string socketPath, std::string tag, int fd)
+        : PoolTask(env), socketPath(std::move(socketPath)), tag(std::move(tag)), fd(fd) {}
+
+protected:
+    void Execute() override {
+        try {
+            SendDescriptor(this->socketPath, this->tag, this->fd);
+        } catch (const HandoffError& e) {
+            this->SetError(e.what(), e.code);
+        }
+    }
+
+private:
+    std::string socketPath;
+    std::string tag;
+    int fd;
+};
+
+// sendDescriptor(socketPath, tag, fd) => Promise<void>; fd stays open
+static Napi::Value SendDescriptorBinding(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 3 || !info[0].IsString() || !info[1].IsString() || !info[2].IsNumber()) {
+        Napi::TypeError::New(env, "Socket path, tag and descriptor expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    auto* task = new SendDescriptorTask(env, info[0].As<Napi::String>().Utf8Value(),
+                                        info[1].As<Napi::String>().Utf8Value(),
+                                        info[2].As<Napi::Number>().Int32Value());
+    return task->Queue(TaskPriority::High);
+}
+
+// JS face of DescriptorReceiver. Each descriptor is mapped read-only on the
+// receiving thread and reaches JS as a Buffer over the mapping; the wrapper
+// stays referenced while it listens.
+class DescriptorReceiverWrap : public Napi::ObjectWrap<DescriptorReceiverWrap> {
+public:
+    static void Init(Napi::Env env, Napi::Object exports) {
+        Napi::Function func = DefineClass(env, "DescriptorReceiver", {
+            InstanceMethod("start", &DescriptorReceiverWrap::Start),
+            InstanceMethod("stop", &DescriptorReceiverWrap::Stop)
+        });
+        exports.Set("DescriptorReceiver", func);
+    }
+
+    // new DescriptorReceiver(socketPath)
+    DescriptorReceiverWrap(const Napi::CallbackInfo& info) : Napi::ObjectWrap<DescriptorReceiverWrap>(info) {
+        Napi::Env env = info.Env();
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Socket path expected").ThrowAsJavaScriptException();
+            return;
+        }
+        this->receiver = std::make_unique<DescriptorReceiver>(info[0].As<Napi::String>().Utf8Value());
+    }
+
+private:
+    // start(onPayload(tag, buffer | error), onEnd(error | null))
+    Napi::Value Start(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (info.Length() < 2 || !info[0].IsFunction() || !info[1].IsFunction()) {
+            Napi::TypeError::New(env, "Payload and end callbacks expected").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        if (this->running) {
+            ErrorWithCode(env, "Receiver is already running", "EBUSY").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+
+        this->onEnd = Napi::Persistent(info[1].As<Napi::Function>());
+        this->payloadCallback =
+            Napi::ThreadSafeFunction::New(env, info[0].As<Napi::Function>(), "escpos-handoff", 0, 1);
+
+        try {
+            this->receiver->Start(
+                [this](std::string tag, int fd) { this->Received(std::move(tag), fd); },
+                [this](const std::string& message, const std::string& code) {
+                    Napi::ThreadSafeFunction callback = this->payloadCallback;
+                    callback.NonBlockingCall([this, message, code](Napi::Env env, Napi::Function) {
+                        this->Ended(env, message, code);
+                    });
+                    callback.Release();
+                });
+        } catch (const HandoffError& e) {
+            this->payloadCallback.Release();
+            this->onEnd.Reset();
+            ErrorWithCode(env, e.what(), e.code).ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+
+        this->running = true;
+        this->Ref();
+        napi_add_env_cleanup_hook(env, StopOnExit, this);
+        return env.Undefined();
+    }
+
+    // Stops listening and removes the socket; onEnd(null) follows
+    Napi::Value Stop(const Napi::CallbackInfo& info) {
+        this->receiver->Stop();
+        return info.Env().Undefined();
+    }
+
+    // Receiving thread
+    void Received(std::string tag, int fd) {
+        std::string message;
+        std::string code;
+        MappedFile* file = nullptr;
+        try {
+            file = MappedFile::FromDescriptor(fd).release();
+        } catch (const MappedFileError& e) {
+            message = e.what();
+            code = e.code;
+        }
+
+        napi_status status = this->payloadCallback.NonBlockingCall(
+            [tag, file, message, code](Napi::Env env, Napi::Function onPayload) {
+                Napi::Value payload =
+                    file ? MappedBuffer(env, file) : ErrorWithCode(env, message, code).Value();
+                onPayload.Call({Napi::String::New(env, tag), payload});
+            });
+        if (status != napi_ok) {
+            delete file;
+        }
+    }
+
+    // Runs when the environment is torn down while still listening (a worker ending, Node exiting on its
+    // own): the thread would otherwise outlive the callbacks it reports to
+    static void StopOnExit(void* data) { static_cast<DescriptorReceiverWrap*>(data)->receiver->Stop(); }
+
+    void Ended(Napi::Env env, const std::string& message, const std::string& code) {
+        Napi::HandleScope scope(env);
+        napi_remove_env_cleanup_hook(env, StopOnExit, this);
+        this->running = false;
+        Napi::Value error = message.empty() ? env.Null() : ErrorWithCode(env, message, code).Value();
+        Napi::FunctionReference onEnd = std::move(this->onEnd);
+        this->Unref();
+        onEnd.Call({error});
+    }
+
+    std::unique_ptr<DescriptorReceiver> receiver;
+    Napi::ThreadSafeFunction payloadCallback;
+    Napi::FunctionReference onEnd;
+    bool running = false;
+};
+
+void InitHandoff(Napi::Env env, Napi::Object exports) {
+    DescriptorReceiverWrap::Init(env, exports);
+    exports.Set("sendDescriptor", Napi::Function::New(env, SendDescriptorBinding));
+}
+
+}  // namespace escpos
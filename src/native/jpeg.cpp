@@ -0,0 +1,594 @@
+#include "jpeg.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace escpos {
+
+namespace {
+
+// Zigzag position -> row-major position in the 8x8 block
+const uint8_t kZigzag[64] = {0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18, 11, 4,  5,
+                             12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6,  7,  14, 21, 28,
+                             35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+                             58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
+
+// Codes up to this long resolve with a single table lookup
+constexpr int kLookupBits = 9;
+
+struct HuffmanTable {
+    bool defined = false;
+    // (length << 8) | symbol for every code prefix of kLookupBits bits, 0 for longer codes
+    uint16_t lookup[1 << kLookupBits] = {};
+    // Canonical decoding tables of ITU T.81 F.2.2.3, indexed by code length
+    int32_t maxCode[18] = {};
+    int32_t valueOffset[18] = {};
+    uint8_t values[256] = {};
+};
+
+struct Component {
+    int id = 0;
+    int h = 1;
+    int v = 1;
+    int quant = 0;
+    int dcTable = 0;
+    int acTable = 0;
+    int predictor = 0;
+};
+
+inline uint32_t ReadBE16(const uint8_t* bytes) { return (bytes[0] << 8) | bytes[1]; }
+
+inline bool IsFrameMarker(uint8_t marker) {
+    return marker >= 0xc0 && marker <= 0xcf && marker != 0xc4 && marker != 0xc8 && marker != 0xcc;
+}
+
+// Steps to the next marker from `pos`. Standalone markers have an empty
+// payload; others leave [segment, segment + size) on theirs.
+bool NextSegment(const uint8_t* data, size_t length, size_t& pos, uint8_t& marker, const uint8_t*& segment,
+                 size_t& size) {
+    while (pos < length && data[pos] != 0xff) {
+        pos++;
+    }
+    while (pos < length && data[pos] == 0xff) {
+        pos++;
+    }
+    if (pos >= length) {
+        return false;
+    }
+    marker = data[pos++];
+    segment = data + pos;
+    size = 0;
+    if (marker == 0xd8 || marker == 0xd9 || marker == 0x01 || (marker >= 0xd0 && marker <= 0xd7)) {
+        return true;
+    }
+    if (pos + 2 > length) {
+        throw JpegError("Truncated JPEG");
+    }
+    size_t segmentLength = ReadBE16(data + pos);
+    if (segmentLength < 2 || pos + segmentLength > length) {
+        throw JpegError("Truncated JPEG");
+    }
+    segment = data + pos + 2;
+    size = segmentLength - 2;
+    pos += segmentLength;
+    return true;
+}
+
+int ExifOrientation(const uint8_t* segment, size_t size) {
+    if (size < 14 || std::memcmp(segment, "Exif\0\0", 6) != 0) {
+        return 1;
+    }
+    const uint8_t* tiff = segment + 6;
+    size_t tiffSize = size - 6;
+    bool little = tiff[0] == 'I';
+    auto read16 = [&](size_t offset) -> uint32_t {
+        return little ? tiff[offset] | (tiff[offset + 1] << 8) : (tiff[offset] << 8) | tiff[offset + 1];
+    };
+    auto read32 = [&](size_t offset) -> uint32_t {
+        return little ? read16(offset) | (read16(offset + 2) << 16) : (read16(offset) << 16) | read16(offset + 2);
+    };
+
+    size_t ifd = read32(4);
+    if (ifd + 2 > tiffSize) {
+        return 1;
+    }
+    size_t entries = read16(ifd);
+    for (size_t i = 0; i < entries; i++) {
+        size_t entry = ifd + 2 + i * 12;
+        if (entry + 12 > tiffSize) {
+            break;
+        }
+        if (read16(entry) == 0x0112) {
+            uint32_t value = read16(entry + 8);
+            return value >= 1 && value <= 8 ? static_cast<int>(value) : 1;
+        }
+    }
+    return 1;
+}
+
+void BuildHuffmanTable(HuffmanTable& table, const uint8_t* counts, const uint8_t* values, size_t total) {
+    table = HuffmanTable();
+    std::copy(values, values + total, table.values);
+    int32_t code = 0;
+    int32_t index = 0;
+    for (int length = 1; length <= 16; length++) {
+        table.valueOffset[length] = index - code;
+        for (int i = 0; i < counts[length - 1]; i++, index++, code++) {
+            if (code >= (1 << length)) {
+                throw JpegError("Invalid Huffman table");
+            }
+            if (length <= kLookupBits) {
+                int shift = kLookupBits - length;
+                for (int fill = 0; fill < (1 << shift); fill++) {
+                    table.lookup[(code << shift) | fill] = static_cast<uint16_t>((length << 8) | values[index]);
+                }
+            }
+        }
+        table.maxCode[length] = counts[length - 1] ? code - 1 : -1;
+        code <<= 1;
+    }
+    table.maxCode[17] = INT32_MAX;
+    table.defined = true;
+}
+
+// Entropy-coded segment reader; byte stuffing is undone here and a marker
+// ends the data (zeros are fed past it, as libjpeg does)
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t length, size_t pos) : data(data), length(length), pos(pos) {}
+
+    int Bits(int count) {
+        this->Fill();
+        int value = static_cast<int>(this->buffer >> (32 - count));
+        this->Consume(count);
+        return value;
+    }
+
+    int Decode(const HuffmanTable& table) {
+        this->Fill();
+        uint16_t entry = table.lookup[this->buffer >> (32 - kLookupBits)];
+        if (entry) {
+            this->Consume(entry >> 8);
+            return entry & 0xff;
+        }
+        for (int length = kLookupBits + 1; length <= 16; length++) {
+            int32_t code = static_cast<int32_t>(this->buffer >> (32 - length));
+            if (code <= table.maxCode[length]) {
+                int32_t index = table.valueOffset[length] + code;
+                if (index < 0 || index > 255) {
+                    break;
+                }
+                this->Consume(length);
+                return table.values[index];
+            }
+        }
+        throw JpegError("Corrupt JPEG data");
+    }
+
+    // Drops buffered bits and steps past the next RSTn marker
+    void Restart() {
+        this->buffer = 0;
+        this->count = 0;
+        this->atMarker = false;
+        while (this->pos + 1 < this->length &&
+               !(this->data[this->pos] == 0xff && this->data[this->pos + 1] >= 0xd0 &&
+                 this->data[this->pos + 1] <= 0xd7)) {
+            this->pos++;
+        }
+        this->pos = std::min(this->pos + 2, this->length);
+    }
+
+    size_t Position() const { return this->pos; }
+
+private:
+    void Fill() {
+        while (this->count <= 24) {
+            uint32_t byte = 0;
+            if (!this->atMarker && this->pos < this->length) {
+                byte = this->data[this->pos];
+                if (byte == 0xff) {
+                    uint8_t next = this->pos + 1 < this->length ? this->data[this->pos + 1] : 0xd9;
+                    if (next == 0x00) {
+                        this->pos += 2;
+                    } else {
+                        this->atMarker = true;
+                        byte = 0;
+                    }
+                } else {
+                    this->pos++;
+                }
+            }
+            this->buffer |= byte << (24 - this->count);
+            this->count += 8;
+        }
+    }
+
+    void Consume(int bits) {
+        this->buffer <<= bits;
+        this->count -= bits;
+    }
+
+    const uint8_t* data;
+    size_t length;
+    size_t pos;
+    uint32_t buffer = 0;
+    int count = 0;
+    bool atMarker = false;
+};
+
+inline int Extend(int value, int bits) { return value < (1 << (bits - 1)) ? value - (1 << bits) + 1 : value; }
+
+// cos((2x + 1) u pi / 2n), with the C(0) = 1/sqrt(2) factor folded in, for
+// n = 1, 2, 4 and 8; entry [x * 8 + u]
+const float* DctBasis(int size) {
+    static const std::array<std::array<float, 64>, 4> tables = [] {
+        std::array<std::array<float, 64>, 4> result{};
+        const double pi = std::acos(-1.0);
+        for (int level = 0; level < 4; level++) {
+            int n = 1 << level;
+            for (int x = 0; x < n; x++) {
+                for (int u = 0; u < n; u++) {
+                    double scale = u == 0 ? std::sqrt(0.5) : 1.0;
+                    result[level][x * 8 + u] = static_cast<float>(scale * std::cos((2 * x + 1) * u * pi / (2 * n)));
+                }
+            }
+        }
+        return result;
+    }();
+    int level = size == 8 ? 3 : size == 4 ? 2 : size == 2 ? 1 : 0;
+    return tables[level].data();
+}
+
+// n x n inverse DCT over the top-left n x n coefficients of a dequantized
+// 8x8 block. With the JPEG normalization the 1/4 factor holds for every n,
+// so n = 1 is the block average and n = 8 the ordinary IDCT.
+void ReducedInverseDct(const int* coefficients, int n, uint8_t* out) {
+    const float* basis = DctBasis(n);
+    float rows[64];
+    for (int v = 0; v < n; v++) {
+        for (int x = 0; x < n; x++) {
+            float sum = 0;
+            for (int u = 0; u < n; u++) {
+                sum += basis[x * 8 + u] * static_cast<float>(coefficients[v * 8 + u]);
+            }
+            rows[v * 8 + x] = sum;
+        }
+    }
+    for (int y = 0; y < n; y++) {
+        for (int x = 0; x < n; x++) {
+            float sum = 0;
+            for (int v = 0; v < n; v++) {
+                sum += basis[y * 8 + v] * rows[v * 8 + x];
+            }
+            int value = static_cast<int>(std::floor(sum * 0.25f + 128.5f));
+            out[y * n + x] = static_cast<uint8_t>(std::max(0, std::min(255, value)));
+        }
+    }
+}
+
+class LumaDecoder {
+public:
+    LumaDecoder(const uint8_t* data, size_t length, int scale) : data(data), length(length), scale(scale) {}
+
+    LumaPlane Decode() {
+        if (this->length < 4 || this->data[0] != 0xff || this->data[1] != 0xd8) {
+            throw JpegError("Not a JPEG");
+        }
+
+        size_t pos = 2;
+        uint8_t marker;
+        const uint8_t* segment;
+        size_t size;
+        while (NextSegment(this->data, this->length, pos, marker, segment, size)) {
+            if (marker == 0xdb) {
+                this->ReadQuantTables(segment, size);
+            } else if (marker == 0xc4) {
+                this->ReadHuffmanTables(segment, size);
+            } else if (marker == 0xdd) {
+                if (size < 2) {
+                    throw JpegError("Truncated JPEG");
+                }
+                this->restartInterval = ReadBE16(segment);
+            } else if (marker == 0xc0 || marker == 0xc1) {
+                this->ReadFrame(segment, size);
+            } else if (IsFrameMarker(marker)) {
+                throw JpegError("Only baseline JPEGs are supported");
+            } else if (marker == 0xda) {
+                if (this->components.empty()) {
+                    throw JpegError("JPEG scan before the frame header");
+                }
+                pos = this->DecodeScan(segment, size, pos);
+                if (this->lumaDecoded) {
+                    // Later scans only carry chroma
+                    return std::move(this->plane);
+                }
+            } else if (marker == 0xd9) {
+                break;
+            }
+        }
+        throw JpegError("JPEG has no luma scan");
+    }
+
+private:
+    void ReadQuantTables(const uint8_t* segment, size_t size) {
+        for (size_t i = 0; i < size;) {
+            int precision = segment[i] >> 4;
+            int id = segment[i] & 15;
+            i++;
+            size_t bytes = precision ? 128 : 64;
+            if (id > 3 || i + bytes > size) {
+                throw JpegError("Invalid quantization table");
+            }
+            for (int k = 0; k < 64; k++) {
+                this->quant[id][k] = static_cast<uint16_t>(precision ? ReadBE16(segment + i + k * 2) : segment[i + k]);
+            }
+            i += bytes;
+        }
+    }
+
+    void ReadHuffmanTables(const uint8_t* segment, size_t size) {
+        for (size_t i = 0; i < size;) {
+            if (i + 17 > size) {
+                throw JpegError("Invalid Huffman table");
+            }
+            int tableClass = segment[i] >> 4;
+            int id = segment[i] & 15;
+            const uint8_t* counts = segment + i + 1;
+            size_t total = 0;
+            for (int k = 0; k < 16; k++) {
+                total += counts[k];
+            }
+            if (tableClass > 1 || id > 3 || total > 256 || i + 17 + total > size) {
+                throw JpegError("Invalid Huffman table");
+            }
+            BuildHuffmanTable(tableClass ? this->acTables[id] : this->dcTables[id], counts, segment + i + 17, total);
+            i += 17 + total;
+        }
+    }
+
+    void ReadFrame(const uint8_t* segment, size_t size) {
+        if (size < 6 || segment[0] != 8) {
+            throw JpegError("Only 8-bit JPEGs are supported");
+        }
+        this->height = ReadBE16(segment + 1);
+        this->width = ReadBE16(segment + 3);
+        size_t count = segment[5];
+        if (this->width == 0 || this->height == 0) {
+            throw JpegError("JPEG dimensions are missing");
+        }
+        if ((count != 1 && count != 3) || size < 6 + count * 3) {
+            throw JpegError("Only grayscale and YCbCr JPEGs are supported");
+        }
+
+        this->components.assign(count, Component());
+        for (size_t i = 0; i < count; i++) {
+            const uint8_t* spec = segment + 6 + i * 3;
+            Component& component = this->components[i];
+            component.id = spec[0];
+            component.h = spec[1] >> 4;
+            component.v = spec[1] & 15;
+            component.quant = spec[2];
+            if (component.h < 1 || component.h > 4 || component.v < 1 || component.v > 4 || component.quant > 3) {
+                throw JpegError("Invalid JPEG frame header");
+            }
+            this->hMax = std::max(this->hMax, component.h);
+            this->vMax = std::max(this->vMax, component.v);
+        }
+
+        // Y is the first component in JFIF; its plane may be subsampled in odd files
+        const Component& luma = this->components[0];
+        size_t lumaWidth = (this->width * luma.h + this->hMax - 1) / this->hMax;
+        size_t lumaHeight = (this->height * luma.v + this->vMax - 1) / this->vMax;
+        this->plane.width = (lumaWidth + this->scale - 1) / this->scale;
+        this->plane.height = (lumaHeight + this->scale - 1) / this->scale;
+        this->plane.pixels.assign(this->plane.width * this->plane.height, 0xff);
+    }
+
+    // Returns the position of the marker that follows the scan
+    size_t DecodeScan(const uint8_t* segment, size_t size, size_t dataStart) {
+        size_t count = size > 0 ? segment[0] : 0;
+        if (count < 1 || count > 4 || size < 1 + count * 2 + 3) {
+            throw JpegError("Invalid JPEG scan header");
+        }
+        std::vector<Component*> scan;
+        for (size_t i = 0; i < count; i++) {
+            int id = segment[1 + i * 2];
+            int tables = segment[2 + i * 2];
+            auto found = std::find_if(this->components.begin(), this->components.end(),
+                                      [id](const Component& component) { return component.id == id; });
+            if (found == this->components.end()) {
+                throw JpegError("JPEG scan references an unknown component");
+            }
+            found->dcTable = tables >> 4;
+            found->acTable = tables & 15;
+            if (found->dcTable > 3 || found->acTable > 3 || !this->dcTables[found->dcTable].defined ||
+                !this->acTables[found->acTable].defined) {
+                throw JpegError("JPEG scan references a missing Huffman table");
+            }
+            found->predictor = 0;
+            scan.push_back(&*found);
+        }
+
+        Component* luma = &this->components[0];
+        bool hasLuma = std::find(scan.begin(), scan.end(), luma) != scan.end();
+        BitReader reader(this->data, this->length, dataStart);
+        int coefficients[64];
+        size_t mcu = 0;
+        auto restart = [&]() {
+            if (this->restartInterval && mcu > 0 && mcu % this->restartInterval == 0) {
+                reader.Restart();
+                for (Component* component : scan) {
+                    component->predictor = 0;
+                }
+            }
+            mcu++;
+        };
+
+        if (count == 1) {
+            // Non-interleaved: one block per MCU over the component's own plane
+            Component& component = *scan[0];
+            size_t planeWidth = (this->width * component.h + this->hMax - 1) / this->hMax;
+            size_t planeHeight = (this->height * component.v + this->vMax - 1) / this->vMax;
+            size_t blocksX = (planeWidth + 7) / 8;
+            size_t blocksY = (planeHeight + 7) / 8;
+            for (size_t blockY = 0; blockY < blocksY; blockY++) {
+                for (size_t blockX = 0; blockX < blocksX; blockX++) {
+                    restart();
+                    this->DecodeBlock(reader, component, coefficients, hasLuma);
+                    if (hasLuma) {
+                        this->StoreBlock(coefficients, blockX, blockY);
+                    }
+                }
+            }
+        } else {
+            size_t mcusX = (this->width + 8 * this->hMax - 1) / (8 * this->hMax);
+            size_t mcusY = (this->height + 8 * this->vMax - 1) / (8 * this->vMax);
+            for (size_t mcuY = 0; mcuY < mcusY; mcuY++) {
+                for (size_t mcuX = 0; mcuX < mcusX; mcuX++) {
+                    restart();
+                    for (Component* component : scan) {
+                        bool keep = component == luma;
+                        for (int v = 0; v < component->v; v++) {
+                            for (int h = 0; h < component->h; h++) {
+                                this->DecodeBlock(reader, *component, coefficients, keep);
+                                if (keep) {
+                                    this->StoreBlock(coefficients, mcuX * component->h + h, mcuY * component->v + v);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        this->lumaDecoded = this->lumaDecoded || hasLuma;
+
+        size_t pos = reader.Position();
+        while (pos + 1 < this->length &&
+               !(this->data[pos] == 0xff && this->data[pos + 1] != 0x00 && this->data[pos + 1] != 0xff &&
+                 !(this->data[pos + 1] >= 0xd0 && this->data[pos + 1] <= 0xd7))) {
+            pos++;
+        }
+        return pos;
+    }
+
+    // Entropy-decodes one block; only kept blocks are dequantized
+    void DecodeBlock(BitReader& reader, Component& component, int* coefficients, bool keep) {
+        const HuffmanTable& dc = this->dcTables[component.dcTable];
+        const HuffmanTable& ac = this->acTables[component.acTable];
+        const uint16_t* quant = this->quant[component.quant];
+
+        int bits = reader.Decode(dc);
+        if (bits > 11) {
+            throw JpegError("Corrupt JPEG data");
+        }
+        component.predictor += bits ? Extend(reader.Bits(bits), bits) : 0;
+        if (keep) {
+            std::fill(coefficients, coefficients + 64, 0);
+            coefficients[0] = component.predictor * quant[0];
+        }
+
+        for (int k = 1; k < 64;) {
+            int symbol = reader.Decode(ac);
+            int run = symbol >> 4;
+            bits = symbol & 15;
+            if (bits == 0) {
+                if (run != 15) {
+                    break;
+                }
+                k += 16;
+                continue;
+            }
+            k += run;
+            if (k > 63) {
+                throw JpegError("Corrupt JPEG data");
+            }
+            int value = Extend(reader.Bits(bits), bits);
+            if (keep) {
+                coefficients[kZigzag[k]] = value * quant[k];
+            }
+            k++;
+        }
+    }
+
+    void StoreBlock(const int* coefficients, size_t blockX, size_t blockY) {
+        int n = 8 / this->scale;
+        uint8_t pixels[64];
+        ReducedInverseDct(coefficients, n, pixels);
+
+        size_t left = blockX * n;
+        size_t top = blockY * n;
+        for (int y = 0; y < n && top + y < this->plane.height; y++) {
+            uint8_t* row = this->plane.pixels.data() + (top + y) * this->plane.width;
+            for (int x = 0; x < n && left + x < this->plane.width; x++) {
+                row[left + x] = pixels[y * n + x];
+            }
+        }
+    }
+
+    const uint8_t* data;
+    size_t length;
+    int scale;
+    uint16_t quant[4][64] = {};
+    HuffmanTable dcTables[4];
+    HuffmanTable acTables[4];
+    size_t restartInterval = 0;
+    size_t width = 0;
+    size_t height = 0;
+    int hMax = 1;
+    int vMax = 1;
+    std::vector<Component> components;
+    LumaPlane plane;
+    bool lumaDecoded = false;
+};
+
+}  // namespace
+
+JpegInfo ReadJpegInfo(const uint8_t* data, size_t length) {
+    if (length < 4 || data[0] != 0xff || data[1] != 0xd8) {
+        throw JpegError("Not a JPEG");
+    }
+
+    JpegInfo info;
+    size_t pos = 2;
+    uint8_t marker;
+    const uint8_t* segment;
+    size_t size;
+    while (NextSegment(data, length, pos, marker, segment, size)) {
+        if (marker == 0xe1) {
+            info.orientation = ExifOrientation(segment, size);
+        } else if (IsFrameMarker(marker)) {
+            if (size < 6) {
+                throw JpegError("Truncated JPEG");
+            }
+            info.height = ReadBE16(segment + 1);
+            info.width = ReadBE16(segment + 3);
+            info.components = segment[5];
+            info.supported = (marker == 0xc0 || marker == 0xc1) && segment[0] == 8 && info.width > 0 &&
+                             info.height > 0 && (info.components == 1 || info.components == 3);
+            return info;
+        } else if (marker == 0xda || marker == 0xd9) {
+            break;
+        }
+    }
+    throw JpegError("JPEG has no frame header");
+}
+
+LumaPlane DecodeJpegLuma(const uint8_t* data, size_t length, int scale) {
+    if (scale != 1 && scale != 2 && scale != 4 && scale != 8) {
+        throw std::invalid_argument("JPEG scale must be 1, 2, 4 or 8");
+    }
+    return LumaDecoder(data, length, scale).Decode();
+}
+
+int ChooseJpegScale(size_t width, size_t targetWidth) {
+    for (int scale = 8; scale > 1; scale /= 2) {
+        if ((width + scale - 1) / scale >= targetWidth) {
+            return scale;
+        }
+    }
+    return 1;
+}
+
+}  // namespace escpos
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "raster.h"
+
+namespace escpos {
+
+class JpegError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+struct JpegInfo {
+    size_t width = 0;
+    size_t height = 0;
+    int components = 0;
+    // Progressive, lossless and arithmetic-coded files need another decoder
+    bool supported = false;
+    // EXIF orientation tag, 1 (upright) when absent
+    int orientation = 1;
+};
+
+// Reads the frame header (and EXIF orientation) without decoding any
+// image data. Throws JpegError when the data is not a JPEG.
+JpegInfo ReadJpegInfo(const uint8_t* data, size_t length);
+
+// Decodes only the luma component of a baseline JPEG at 1/scale size
+// (scale 1, 2, 4 or 8). Each 8x8 block goes through a reduced inverse DCT
+// over its low-frequency coefficients, so the full-size image is never
+// built. Chroma is entropy-decoded to stay in sync but never transformed.
+LumaPlane DecodeJpegLuma(const uint8_t* data, size_t length, int scale);
+
+// Coarsest DCT scale whose decoded width still covers targetWidth
+int ChooseJpegScale(size_t width, size_t targetWidth);
+
+}  // namespace escpos
@@ -0,0 +1,258 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+#include <cwchar>
+#else
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace escpos {
+
+#ifdef _WIN32
+
+namespace {
+
+std::wstring Widen(const std::string& text) {
+    int length = MultiByteToWideChar(CP_UTF8, 0, text.c_str(), -1, nullptr, 0);
+    std::wstring wide(length > 0 ? length : 1, L'\0');
+    if (length > 0) {
+        MultiByteToWideChar(CP_UTF8, 0, text.c_str(), -1, &wide[0], length);
+    }
+    wide.resize(wcslen(wide.c_str()));
+    return wide;
+}
+
+MappedFileError LastError(const std::string& message) {
+    DWORD error = GetLastError();
+    return MappedFileError(message + " (error " + std::to_string(error) + ")",
+                           error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND ? "ENOENT" : "EIO");
+}
+
+}  // namespace
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string& path) {
+    // FILE_SHARE_DELETE lets writers replace or remove the file while mapped
+    HANDLE file = CreateFileW(Widen(path).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw LastError("Failed to open " + path);
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        throw MappedFileError(path + " is empty", "EINVAL");
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) {
+        throw LastError("Failed to map " + path);
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    // The view keeps the section alive
+    CloseHandle(mapping);
+    if (!view) {
+        throw LastError("Failed to map " + path);
+    }
+    return std::unique_ptr<MappedFile>(
+        new MappedFile(static_cast<uint8_t*>(view), static_cast<size_t>(size.QuadPart)));
+}
+
+std::unique_ptr<MappedFile> MappedFile::FromDescriptor(int) {
+    throw MappedFileError("Descriptor mappings are not supported on Windows", "ENOSYS");
+}
+
+MappedFile::~MappedFile() { UnmapViewOfFile(this->data); }
+
+std::unique_ptr<SharedMemory> SharedMemory::Create(const std::string&, size_t) {
+    throw MappedFileError("Shared memory handles are not supported on Windows", "ENOSYS");
+}
+
+SharedMemory::~SharedMemory() {}
+
+void SharedMemory::Seal() {}
+
+void SharedMemory::CloseFd() {}
+
+#else
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string& path) {
+    int handle = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (handle < 0) {
+        int error = errno;
+        throw MappedFileError("Failed to open " + path + ": " + std::strerror(error),
+                              error == ENOENT ? "ENOENT" : "EIO");
+    }
+    return MapDescriptor(handle, path);
+}
+
+namespace {
+
+#ifdef __linux__
+constexpr int kPayloadSeals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE;
+#endif
+
+}  // namespace
+
+std::unique_ptr<MappedFile> MappedFile::FromDescriptor(int fd) {
+    std::string name = "descriptor " + std::to_string(fd);
+#ifdef __linux__
+    // Unsealed, the sender could change the bytes mid-print or shrink the
+    // memory under the mapping, which faults (SIGBUS) on the next read
+    int seals = fcntl(fd, F_GET_SEALS);
+    if (seals < 0 || (seals & kPayloadSeals) != kPayloadSeals) {
+        ::close(fd);
+        throw MappedFileError(name + " is not a sealed memfd", "EPERM");
+    }
+    return MapDescriptor(fd, name);
+#else
+    // Nothing stops the sender from resizing it; copied with reads, which
+    // report a shrink as a short read instead of faulting
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        throw MappedFileError(name + " is empty", "EINVAL");
+    }
+    std::vector<uint8_t> copy(static_cast<size_t>(info.st_size));
+    size_t offset = 0;
+    while (offset < copy.size()) {
+        ssize_t count = pread(fd, copy.data() + offset, copy.size() - offset, static_cast<off_t>(offset));
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            ::close(fd);
+            throw MappedFileError(name + " was truncated while being read", "EIO");
+        }
+        offset += static_cast<size_t>(count);
+    }
+    ::close(fd);
+    return std::unique_ptr<MappedFile>(new MappedFile(std::move(copy)));
+#endif
+}
+
+std::unique_ptr<MappedFile> MappedFile::MapDescriptor(int handle, const std::string& name) {
+    struct stat info;
+    if (fstat(handle, &info) != 0 || info.st_size <= 0) {
+        ::close(handle);
+        throw MappedFileError(name + " is empty", "EINVAL");
+    }
+
+    size_t size = static_cast<size_t>(info.st_size);
+    void* view = mmap(nullptr, size, PROT_READ, MAP_SHARED, handle, 0);
+    int error = errno;
+    // The mapping holds its own reference to the file
+    ::close(handle);
+    if (view == MAP_FAILED) {
+        throw MappedFileError("Failed to map " + name + ": " + std::strerror(error), "EIO");
+    }
+    return std::unique_ptr<MappedFile>(new MappedFile(static_cast<uint8_t*>(view), size));
+}
+
+MappedFile::~MappedFile() {
+    if (this->copy.empty()) {
+        munmap(this->data, this->size);
+    }
+}
+
+namespace {
+
+// Unnamed, private to whoever holds the descriptor; not inherited by child
+// processes
+int CreateAnonymous(const std::string& name) {
+#ifdef __linux__
+    int handle = memfd_create(name.c_str(), MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (handle < 0) {
+        int error = errno;
+        throw MappedFileError(std::string("memfd_create failed: ") + std::strerror(error),
+                              error == ENOSYS ? "ENOSYS" : "EIO");
+    }
+    return handle;
+#else
+    // Unlinked as soon as it exists, which leaves only the descriptor
+    static std::atomic<unsigned> counter{0};
+    std::string path = "/" + name + "-" + std::to_string(getpid()) + "-" + std::to_string(counter++);
+    int handle = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (handle < 0) {
+        int error = errno;
+        throw MappedFileError(std::string("shm_open failed: ") + std::strerror(error), "EIO");
+    }
+    shm_unlink(path.c_str());
+    fcntl(handle, F_SETFD, FD_CLOEXEC);
+    return handle;
+#endif
+}
+
+}  // namespace
+
+std::unique_ptr<SharedMemory> SharedMemory::Create(const std::string& name, size_t size) {
+    if (size == 0) {
+        throw MappedFileError("Shared memory must not be empty", "EINVAL");
+    }
+    int handle = CreateAnonymous(name);
+    if (ftruncate(handle, static_cast<off_t>(size)) != 0) {
+        int error = errno;
+        ::close(handle);
+        throw MappedFileError(std::string("Failed to size shared memory: ") + std::strerror(error), "EIO");
+    }
+
+    void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, handle, 0);
+    if (view == MAP_FAILED) {
+        int error = errno;
+        ::close(handle);
+        throw MappedFileError(std::string("Failed to map shared memory: ") + std::strerror(error), "EIO");
+    }
+    return std::unique_ptr<SharedMemory>(new SharedMemory(static_cast<uint8_t*>(view), size, handle));
+}
+
+// The descriptor belongs to JavaScript once handed out
+SharedMemory::~SharedMemory() { munmap(this->data, this->size); }
+
+void SharedMemory::Seal() {
+#ifdef __linux__
+    // F_SEAL_WRITE fails while a shared mapping that may be written exists,
+    // even a read-only one. The view's address range is held by an
+    // inaccessible private mapping meanwhile, so buffers over it stay valid
+    // and nothing else is mapped there.
+    int prot = PROT_READ | PROT_WRITE;
+    if (mmap(this->data, this->size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED) {
+        int error = errno;
+        throw MappedFileError(std::string("Failed to unmap shared memory: ") + std::strerror(error), "EIO");
+    }
+    int error = 0;
+    if (fcntl(this->fd, F_ADD_SEALS, kPayloadSeals | F_SEAL_SEAL) == 0) {
+        prot = PROT_READ;
+    } else {
+        error = errno;
+    }
+    if (mmap(this->data, this->size, prot, MAP_SHARED | MAP_FIXED, this->fd, 0) == MAP_FAILED) {
+        // Cannot happen short of running out of mappings; the view would be
+        // left inaccessible
+        std::abort();
+    }
+    if (error != 0) {
+        throw MappedFileError(std::string("Failed to seal shared memory: ") + std::strerror(error), "EIO");
+    }
+#endif
+}
+
+void SharedMemory::CloseFd() {
+    if (this->fd >= 0) {
+        ::close(this->fd);
+        this->fd = -1;
+    }
+}
+
+#endif
+
+}  // namespace escpos
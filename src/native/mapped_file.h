@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace escpos {
+
+class MappedFileError : public std::runtime_error {
+public:
+    MappedFileError(const std::string& message, const std::string& code)
+        : std::runtime_error(message), code(code) {}
+
+    const std::string code;
+};
+
+// Whole-file read-only mapping. Pages are shared with every other process
+// mapping the same file. Writing through Data() faults, so code that needs
+// to patch the bytes copies them out first. The file may be renamed over
+// or deleted while mapped; the view keeps the old contents.
+class MappedFile {
+public:
+    // Throws MappedFileError when the file cannot be opened or is empty
+    static std::unique_ptr<MappedFile> Open(const std::string& path);
+    // Same over a descriptor received from another process; takes ownership
+    // of fd and closes it. The sender keeps its own descriptor, so only a
+    // memfd sealed against writes and resizing is mapped (EPERM otherwise);
+    // where memfds do not exist the contents are copied instead. Throws
+    // MappedFileError, with code ENOSYS on Windows.
+    static std::unique_ptr<MappedFile> FromDescriptor(int fd);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    uint8_t* Data() const { return this->data; }
+    size_t Size() const { return this->size; }
+
+private:
+    MappedFile(uint8_t* data, size_t size) : data(data), size(size) {}
+    explicit MappedFile(std::vector<uint8_t> contents)
+        : data(contents.data()), size(contents.size()), copy(std::move(contents)) {}
+    // Closes handle in every case; name is used in errors
+    static std::unique_ptr<MappedFile> MapDescriptor(int handle, const std::string& name);
+
+    uint8_t* data;
+    size_t size;
+    // Holds the contents when they were copied rather than mapped
+    std::vector<uint8_t> copy;
+};
+
+// Anonymous shared memory for handing a large payload to another local
+// process: a sealable memfd on Linux, an unlinked shm_open object
+// elsewhere. Only the descriptor gives access to it; fill it, Seal() it and
+// pass it with SendDescriptor (handoff.h). The owner closes the descriptor;
+// the mapping outlives it.
+class SharedMemory {
+public:
+    // Throws MappedFileError, with code ENOSYS on Windows
+    static std::unique_ptr<SharedMemory> Create(const std::string& name, size_t size);
+    ~SharedMemory();
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    uint8_t* Data() const { return this->data; }
+    size_t Size() const { return this->size; }
+    int Fd() const { return this->fd; }
+    // Makes the contents final for every holder of the descriptor: the view
+    // is replaced in place by a read-only one and the memfd is sealed
+    // against writes and resizing. Nothing to seal where memfds do not
+    // exist; receivers copy such memory. Throws MappedFileError.
+    void Seal();
+    // For when the descriptor could not be handed out after all
+    void CloseFd();
+
+private:
+    SharedMemory(uint8_t* data, size_t size, int fd) : data(data), size(size), fd(fd) {}
+
+    uint8_t* data;
+    size_t size;
+    int fd;
+};
+
+}  // namespace escpos
@@ -0,0 +1,122 @@
+#include "pool_task.h"
+
+#include <exception>
+
+#include "addon.h"
+
+namespace escpos {
+
+PoolTask::PoolTask(Napi::Env env)
+    : env(env), deferred(Napi::Promise::Deferred::New(env)) {}
+
+Napi::Promise PoolTask::Queue(TaskPriority priority) {
+    this->completion = Napi::ThreadSafeFunction::New(
+        this->env,
+        Napi::Function::New(this->env, [](const Napi::CallbackInfo&) {}),
+        "escpos-pool-task",
+        0,
+        1);
+
+    Napi::Promise promise = this->deferred.Promise();
+
+    ThreadPool::Instance().Submit([this]() {
+        try {
+            this->Execute();
+        } catch (const std::exception& e) {
+            this->SetError(e.what());
+        } catch (...) {
+            this->SetError("Unknown native error");
+        }
+
+        Napi::ThreadSafeFunction completion = this->completion;
+        napi_status status = completion.BlockingCall(
+            [this](Napi::Env env, Napi::Function) { this->Complete(env); });
+        if (status != napi_ok) {
+            // Environment is shutting down; nobody is left to settle the promise
+            delete this;
+        }
+        completion.Release();
+    }, priority);
+
+    return promise;
+}
+
+Napi::Value PoolTask::GetResult(Napi::Env env) {
+    return env.Undefined();
+}
+
+void PoolTask::SetError(const std::string& message, const std::string& code) {
+    this->failed = true;
+    this->errorMessage = message;
+    this->errorCode = code;
+}
+
+void PoolTask::Complete(Napi::Env env) {
+    Napi::HandleScope scope(env);
+
+    if (this->failed) {
+        Napi::Error error = Napi::Error::New(env, this->errorMessage);
+        if (!this->errorCode.empty()) {
+            error.Set("code", Napi::String::New(env, this->errorCode));
+        }
+        this->deferred.Reject(error.Value());
+    } else {
+        Napi::Value result = this->GetResult(env);
+        if (env.IsExceptionPending()) {
+            this->deferred.Reject(env.GetAndClearPendingException().Value());
+        } else {
+            this->deferred.Resolve(result);
+        }
+    }
+
+    this->OnSettled(env);
+    delete this;
+}
+
+static Napi::Value ConfigureThreadPool(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Thread pool size expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    int64_t size = info[0].As<Napi::Number>().Int64Value();
+    if (size < 0 || size > 64) {
+        Napi::RangeError::New(env, "Thread pool size must be between 0 and 64").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    ThreadPool::Instance().Configure(static_cast<size_t>(size));
+    return Napi::Number::New(env, static_cast<double>(ThreadPool::Instance().Size()));
+}
+
+static Napi::Value GetThreadPoolStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    ThreadPoolStats stats = ThreadPool::Instance().Stats();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("size", static_cast<double>(stats.workers));
+    result.Set("queuedHigh", static_cast<double>(stats.queuedHigh));
+    result.Set("queuedNormal", static_cast<double>(stats.queuedNormal));
+    result.Set("submitted", static_cast<double>(stats.submitted));
+    result.Set("executed", static_cast<double>(stats.executed));
+    result.Set("steals", static_cast<double>(stats.steals));
+    result.Set("blockingThreads", static_cast<double>(stats.blockingThreads));
+    result.Set("blockingActive", static_cast<double>(stats.blockingActive));
+
+    Napi::Array depths = Napi::Array::New(env, stats.workerQueueDepth.size());
+    for (size_t i = 0; i < stats.workerQueueDepth.size(); i++) {
+        depths[static_cast<uint32_t>(i)] = Napi::Number::New(env, static_cast<double>(stats.workerQueueDepth[i]));
+    }
+    result.Set("workerQueueDepth", depths);
+
+    return result;
+}
+
+void InitThreadPool(Napi::Env env, Napi::Object exports) {
+    exports.Set("configureThreadPool", Napi::Function::New(env, ConfigureThreadPool));
+    exports.Set("getThreadPoolStats", Napi::Function::New(env, GetThreadPoolStats));
+}
+
+}  // namespace escpos
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <napi.h>
+#include <string>
+
+#include "thread_pool.h"
+
+namespace escpos {
+
+// Promise-returning unit of work executed on the shared ThreadPool.
+// Execute() runs on a pool worker; GetResult() runs back on the JS thread.
+// Tasks delete themselves once the promise has been settled.
+class PoolTask {
+public:
+    explicit PoolTask(Napi::Env env);
+    virtual ~PoolTask() = default;
+
+    Napi::Promise Queue(TaskPriority priority = TaskPriority::Normal);
+
+protected:
+    virtual void Execute() = 0;
+    virtual Napi::Value GetResult(Napi::Env env);
+    // Runs on the JS thread after success or failure, before the task is deleted
+    virtual void OnSettled(Napi::Env env) {}
+
+    // code becomes error.code on the rejected JS error (e.g. ECANCELED, ETIMEDOUT)
+    void SetError(const std::string& message, const std::string& code = "");
+    bool HasError() const { return this->failed; }
+
+private:
+    void Complete(Napi::Env env);
+
+    Napi::Env env;
+    Napi::Promise::Deferred deferred;
+    Napi::ThreadSafeFunction completion;
+    std::string errorMessage;
+    std::string errorCode;
+    bool failed = false;
+};
+
+}  // namespace escpos
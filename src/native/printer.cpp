@@ -7,6 +7,13 @@
 #include <map>
 #include <algorithm>
 #include <cctype>
+#include <atomic>
+#include <mutex>
+
+#include "addon.h"
+#include "cancel_token.h"
+#include "pool_task.h"
+#include "transport.h"
 
 #pragma comment(lib, "wbemuuid.lib")
 
@@ -20,6 +27,9 @@ class Printer : public Napi::ObjectWrap<Printer> {
 public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
     Printer(const Napi::CallbackInfo& info);
+    // Finalizer: a session the JS side forgot to close() still gives its handle back.
+    // Pending async tasks Ref() the wrapper, so this never runs mid-write.
+    ~Printer();
 
 private:
     static Napi::FunctionReference constructor;
@@ -27,16 +37,39 @@ private:
     std::wstring printerName;
     std::vector<wchar_t> docName;
     std::vector<wchar_t> dataType;
+    bool documentOpen = false;
+    escpos::CancelToken cancelToken;
+    std::atomic<bool> busy{false};
+    bool closeRequested = false;
+    bool endRequested = false;
+    // Pool thread blocked in WritePrinter; guarded so cancel() never
+    // interrupts a thread that has already moved on to other work
+    std::mutex ioMutex;
+    DWORD activeThreadId = 0;
 
     Napi::Value Print(const Napi::CallbackInfo& info);
+    Napi::Value PrintAsync(const Napi::CallbackInfo& info);
+    Napi::Value Cancel(const Napi::CallbackInfo& info);
+    Napi::Value StartDocument(const Napi::CallbackInfo& info);
+    Napi::Value WriteAsync(const Napi::CallbackInfo& info);
+    Napi::Value EndDocument(const Napi::CallbackInfo& info);
     Napi::Value Close(const Napi::CallbackInfo& info);
+    Napi::Value IsHealthy(const Napi::CallbackInfo& info);
     static Napi::Value GetPrinterList(const Napi::CallbackInfo& info);
 
     bool SendDataToPrinter(const std::vector<unsigned char>& data);
+    bool BeginOperation(Napi::Env env);
+    void EndOperation();
+    void SetActiveThread(DWORD threadId);
+    void EndDocumentNow();
+    void Release();
     static std::map<std::string, PrinterDeviceInfo> GetUsbPrinterDevices();
     static void ParseVidPid(const std::string& deviceId, std::string& vid, std::string& pid);
     static bool IsUsbPort(const std::string& portName);
     static std::string ToLower(const std::string& str);
+
+    friend class PrinterWriteTask;
+    friend class PrinterJobTask;
 };
 
 Napi::FunctionReference Printer::constructor;
@@ -46,7 +79,13 @@ Napi::Object Printer::Init(Napi::Env env, Napi::Object exports) {
 
     Napi::Function func = DefineClass(env, "Printer", {
         InstanceMethod("print", &Printer::Print),
+        InstanceMethod("printAsync", &Printer::PrintAsync),
+        InstanceMethod("cancel", &Printer::Cancel),
+        InstanceMethod("startDocument", &Printer::StartDocument),
+        InstanceMethod("writeAsync", &Printer::WriteAsync),
+        InstanceMethod("endDocument", &Printer::EndDocument),
         InstanceMethod("close", &Printer::Close),
+        InstanceMethod("isHealthy", &Printer::IsHealthy),
         StaticMethod("getPrinterList", &Printer::GetPrinterList)
     });
 
@@ -293,7 +332,8 @@ std::map<std::string, PrinterDeviceInfo> Printer::GetUsbPrinterDevices() {
 }
 
 bool Printer::SendDataToPrinter(const std::vector<unsigned char>& data) {
-    if (!this->printerHandle) return false;
+    // The synchronous path must not share the handle with a pool write
+    if (!this->printerHandle || this->busy) return false;
 
     DOC_INFO_1W docInfo = {0};
     docInfo.pDocName = this->docName.data();
@@ -327,17 +367,342 @@ Napi::Value Printer::Print(const Napi::CallbackInfo& info) {
     return Napi::Boolean::New(env, success);
 }
 
-Napi::Value Printer::Close(const Napi::CallbackInfo& info) {
+// Spooler writes are issued in slices so cancellation and deadlines are
+// observed between them; CancelSynchronousIo interrupts a blocked slice.
+static const size_t kWriteSliceSize = 4096;
+
+using escpos::WriteOutcome;
+
+static WriteOutcome WriteSlices(HANDLE handle, const unsigned char* data, size_t length, const escpos::Deadline& deadline,
+                                escpos::CancelToken& token, size_t& written);
+
+// Writes one chunk of an open document on the shared pool. The JS buffer
+// and the Printer object are pinned until the write settles.
+class PrinterWriteTask : public escpos::PoolTask {
+public:
+    PrinterWriteTask(Napi::Env env, Printer* owner, Napi::Buffer<unsigned char> buffer, int64_t timeoutMs)
+        : escpos::PoolTask(env),
+          owner(owner),
+          bufferRef(Napi::Persistent(buffer)),
+          data(buffer.Data()),
+          length(buffer.Length()),
+          deadline(escpos::Deadline::After(timeoutMs)) {
+        this->owner->Ref();
+    }
+
+protected:
+    void Execute() override {
+        ReportOutcome(this->Write(this->owner->printerHandle));
+    }
+
+    Napi::Value GetResult(Napi::Env env) override {
+        return Napi::Number::New(env, static_cast<double>(this->written));
+    }
+
+    void OnSettled(Napi::Env env) override {
+        this->bufferRef.Reset();
+        this->owner->EndOperation();
+        this->owner->Unref();
+    }
+
+    // Publishes this thread to cancel() for the duration of the write
+    WriteOutcome Write(HANDLE handle) {
+        this->owner->SetActiveThread(GetCurrentThreadId());
+        WriteOutcome outcome = WriteSlices(handle, this->data, this->length, this->deadline, this->owner->cancelToken,
+                                           this->written);
+        this->owner->SetActiveThread(0);
+        return outcome;
+    }
+
+    void ReportOutcome(WriteOutcome outcome) {
+        switch (outcome) {
+            case WriteOutcome::Ok:
+                break;
+            case WriteOutcome::Cancelled:
+                this->SetError("Print job cancelled", "ECANCELED");
+                break;
+            case WriteOutcome::TimedOut:
+                this->SetError("Print job timed out", "ETIMEDOUT");
+                break;
+            default:
+                this->SetError("WritePrinter failed");
+                break;
+        }
+    }
+
+    Printer* owner;
+    Napi::Reference<Napi::Buffer<unsigned char>> bufferRef;
+    const unsigned char* data;
+    size_t length;
+    escpos::Deadline deadline;
+    size_t written = 0;
+};
+
+// Complete job in its own spooler document. A cancelled or timed-out job is
+// deleted from the spool queue so nothing half-sent reaches the printer.
+class PrinterJobTask : public PrinterWriteTask {
+public:
+    using PrinterWriteTask::PrinterWriteTask;
+
+protected:
+    void Execute() override {
+        HANDLE handle = this->owner->printerHandle;
+
+        DOC_INFO_1W docInfo = {0};
+        docInfo.pDocName = this->owner->docName.data();
+        docInfo.pOutputFile = NULL;
+        docInfo.pDatatype = this->owner->dataType.data();
+
+        DWORD jobId = StartDocPrinterW(handle, 1, (LPBYTE)&docInfo);
+        if (!jobId) {
+            this->SetError("StartDocPrinter failed");
+            return;
+        }
+
+        WriteOutcome outcome = WriteOutcome::Failed;
+        if (StartPagePrinter(handle)) {
+            outcome = this->Write(handle);
+            EndPagePrinter(handle);
+        }
+
+        if (outcome == WriteOutcome::Cancelled || outcome == WriteOutcome::TimedOut) {
+            SetJobW(handle, jobId, 0, NULL, JOB_CONTROL_DELETE);
+        }
+        EndDocPrinter(handle);
+
+        ReportOutcome(outcome);
+    }
+};
+
+static WriteOutcome WriteSlices(HANDLE handle, const unsigned char* data, size_t length, const escpos::Deadline& deadline,
+                                escpos::CancelToken& token, size_t& written) {
+    WriteOutcome outcome = WriteOutcome::Ok;
+
+    written = 0;
+    while (written < length) {
+        if (token.IsCancelled()) {
+            outcome = WriteOutcome::Cancelled;
+            break;
+        }
+        if (deadline.Expired()) {
+            outcome = WriteOutcome::TimedOut;
+            break;
+        }
+
+        DWORD slice = (DWORD)std::min(kWriteSliceSize, length - written);
+        DWORD sliceWritten = 0;
+        if (!WritePrinter(handle, (LPVOID)(data + written), slice, &sliceWritten)) {
+            outcome = token.IsCancelled() ? WriteOutcome::Cancelled : WriteOutcome::Failed;
+            break;
+        }
+        written += sliceWritten;
+        if (sliceWritten == 0) {
+            outcome = WriteOutcome::Failed;
+            break;
+        }
+    }
+
+    return outcome;
+}
+
+void Printer::SetActiveThread(DWORD threadId) {
+    std::lock_guard<std::mutex> lock(this->ioMutex);
+    this->activeThreadId = threadId;
+}
+
+bool Printer::BeginOperation(Napi::Env env) {
+    if (!this->printerHandle) {
+        Napi::Error::New(env, "Printer is closed").ThrowAsJavaScriptException();
+        return false;
+    }
+    if (this->busy.exchange(true)) {
+        Napi::Error error = Napi::Error::New(env, "Printer is busy");
+        error.Set("code", Napi::String::New(env, "EBUSY"));
+        error.ThrowAsJavaScriptException();
+        return false;
+    }
+    this->closeRequested = false;
+    this->endRequested = false;
+    return true;
+}
+
+void Printer::EndOperation() {
+    this->busy = false;
+    if (this->endRequested) {
+        this->endRequested = false;
+        this->EndDocumentNow();
+    }
+    if (this->closeRequested) {
+        this->closeRequested = false;
+        this->Release();
+    }
+}
+
+Napi::Value Printer::StartDocument(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
+    if (!this->printerHandle) {
+        Napi::Error::New(env, "Printer is closed").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (this->documentOpen) {
+        return Napi::Boolean::New(env, true);
+    }
+    if (this->busy) {
+        Napi::Error error = Napi::Error::New(env, "Printer is busy");
+        error.Set("code", Napi::String::New(env, "EBUSY"));
+        error.ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    this->cancelToken.Reset();
+
+    DOC_INFO_1W docInfo = {0};
+    docInfo.pDocName = this->docName.data();
+    docInfo.pOutputFile = NULL;
+    docInfo.pDatatype = this->dataType.data();
+
+    if (!StartDocPrinterW(this->printerHandle, 1, (LPBYTE)&docInfo)) {
+        return Napi::Boolean::New(env, false);
+    }
+    if (!StartPagePrinter(this->printerHandle)) {
+        EndDocPrinter(this->printerHandle);
+        return Napi::Boolean::New(env, false);
+    }
+
+    this->documentOpen = true;
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value Printer::WriteAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsBuffer()) {
+        Napi::TypeError::New(env, "Buffer expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (!this->documentOpen) {
+        Napi::Error::New(env, "No document started").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (!this->BeginOperation(env)) {
+        return env.Null();
+    }
+
+    int64_t timeoutMs = info.Length() > 1 && info[1].IsNumber() ? info[1].As<Napi::Number>().Int64Value() : 0;
+    auto* task = new PrinterWriteTask(env, this, info[0].As<Napi::Buffer<unsigned char>>(), timeoutMs);
+    return task->Queue(escpos::TaskPriority::High);
+}
+
+Napi::Value Printer::PrintAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsBuffer()) {
+        Napi::TypeError::New(env, "Buffer expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (!this->BeginOperation(env)) {
+        return env.Null();
+    }
+
+    // A new job starts from a clean slate; cancel() only affects work in flight
+    this->cancelToken.Reset();
+
+    int64_t timeoutMs = info.Length() > 1 && info[1].IsNumber() ? info[1].As<Napi::Number>().Int64Value() : 0;
+    auto* task = new PrinterJobTask(env, this, info[0].As<Napi::Buffer<unsigned char>>(), timeoutMs);
+    return task->Queue(escpos::TaskPriority::High);
+}
+
+Napi::Value Printer::Cancel(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    this->cancelToken.Cancel();
+
+    // Interrupt a WritePrinter call blocked on a jammed device. The worker
+    // clears activeThreadId under the same lock, so the id cannot go stale
+    // between the check and the cancel.
+    std::lock_guard<std::mutex> lock(this->ioMutex);
+    if (this->activeThreadId) {
+        HANDLE thread = OpenThread(THREAD_TERMINATE, FALSE, this->activeThreadId);
+        if (thread) {
+            CancelSynchronousIo(thread);
+            CloseHandle(thread);
+        }
+    }
+
+    return env.Undefined();
+}
+
+Napi::Value Printer::EndDocument(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (this->busy) {
+        // A chunk is still being written; end the document once it lets go
+        this->endRequested = true;
+    } else {
+        this->EndDocumentNow();
+    }
+
+    return env.Undefined();
+}
+
+void Printer::EndDocumentNow() {
+    if (this->documentOpen) {
+        EndPagePrinter(this->printerHandle);
+        EndDocPrinter(this->printerHandle);
+        this->documentOpen = false;
+    }
+}
+
+Printer::~Printer() {
+    this->Release();
+}
+
+void Printer::Release() {
     if (this->printerHandle) {
+        this->EndDocumentNow();
         ClosePrinter(this->printerHandle);
         this->printerHandle = NULL;
     }
+}
 
+Napi::Value Printer::Close(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (this->busy) {
+        // The pool worker still uses the handle; close once it lets go
+        this->closeRequested = true;
+        this->Cancel(info);
+    } else {
+        this->Release();
+    }
     return env.Undefined();
 }
 
+// Cheap liveness probe for pooled sessions: the handle is open and the
+// spooler does not report the queue as offline or in error.
+Napi::Value Printer::IsHealthy(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!this->printerHandle) {
+        return Napi::Boolean::New(env, false);
+    }
+
+    DWORD needed = 0;
+    GetPrinterW(this->printerHandle, 6, NULL, 0, &needed);
+    if (needed == 0) {
+        return Napi::Boolean::New(env, false);
+    }
+
+    std::vector<BYTE> buffer(needed);
+    if (!GetPrinterW(this->printerHandle, 6, buffer.data(), needed, &needed)) {
+        return Napi::Boolean::New(env, false);
+    }
+
+    DWORD status = reinterpret_cast<PRINTER_INFO_6*>(buffer.data())->dwStatus;
+    const DWORD unhealthy = PRINTER_STATUS_OFFLINE | PRINTER_STATUS_ERROR | PRINTER_STATUS_NOT_AVAILABLE;
+    return Napi::Boolean::New(env, (status & unhealthy) == 0);
+}
+
 Napi::Value Printer::GetPrinterList(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
@@ -447,6 +812,12 @@ Napi::Value Printer::GetPrinterList(const Napi::CallbackInfo& info) {
 }
 
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
+    escpos::InitThreadPool(env, exports);
+    escpos::InitTransport(env, exports);
+    escpos::InitRaster(env, exports);
+    escpos::InitEvdev(env, exports);
+    escpos::InitWeighLabel(env, exports);
+    escpos::InitHandoff(env, exports);
     return Printer::Init(env, exports);
 }
 
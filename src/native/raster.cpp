@@ -0,0 +1,117 @@
+#include "raster.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace escpos {
+
+void RasterizeLuma(size_t width, size_t height, const RasterOptions& options, const LumaRowSource& source,
+                   uint8_t* out) {
+    size_t bytesPerLine = (width + 7) / 8;
+    if (bytesPerLine > 0xffff || height > 0xffff) {
+        throw std::invalid_argument("Image is too large for a single raster block");
+    }
+
+    out[0] = 0x1d;
+    out[1] = 0x76;
+    out[2] = 0x30;
+    out[3] = 0x00;
+    out[4] = static_cast<uint8_t>(bytesPerLine & 0xff);
+    out[5] = static_cast<uint8_t>(bytesPerLine >> 8);
+    out[6] = static_cast<uint8_t>(height & 0xff);
+    out[7] = static_cast<uint8_t>(height >> 8);
+    // Pooled output buffers arrive with stale contents
+    uint8_t* rows = out + 8;
+    std::fill(rows, rows + bytesPerLine * height, 0);
+
+    std::vector<uint8_t> luma(width);
+    if (!options.dither) {
+        for (size_t y = 0; y < height; y++) {
+            source(y, luma.data());
+            uint8_t* row = rows + y * bytesPerLine;
+            for (size_t x = 0; x < width; x++) {
+                if (luma[x] < options.threshold) {
+                    row[x >> 3] |= static_cast<uint8_t>(0x80 >> (x & 7));
+                }
+            }
+        }
+        return;
+    }
+
+    // Two rows of accumulated error (in 1/16ths), padded by one pixel each side
+    std::vector<int> current(width + 2, 0);
+    std::vector<int> next(width + 2, 0);
+    for (size_t y = 0; y < height; y++) {
+        source(y, luma.data());
+        uint8_t* row = rows + y * bytesPerLine;
+        for (size_t x = 0; x < width; x++) {
+            int value = luma[x] + current[x + 1] / 16;
+            int error = value;
+            if (value < 128) {
+                row[x >> 3] |= static_cast<uint8_t>(0x80 >> (x & 7));
+            } else {
+                error = value - 255;
+            }
+            current[x + 2] += error * 7;
+            next[x] += error * 3;
+            next[x + 1] += error * 5;
+            next[x + 2] += error;
+        }
+        std::swap(current, next);
+        std::fill(next.begin(), next.end(), 0);
+    }
+}
+
+void RasterizeRgba(const uint8_t* rgba, size_t width, size_t height, const RasterOptions& options, uint8_t* out) {
+    RasterizeLuma(
+        width, height, options,
+        [rgba, width](size_t y, uint8_t* row) {
+            const uint8_t* pixel = rgba + y * width * 4;
+            for (size_t x = 0; x < width; x++, pixel += 4) {
+                row[x] = PaperLuma(pixel);
+            }
+        },
+        out);
+}
+
+LumaRowSource ResampleLuma(const uint8_t* pixels, size_t sourceWidth, size_t sourceHeight, size_t width,
+                           size_t height) {
+    // Source indices either side of each target sample, weight of the second in 1/256ths
+    struct Tap {
+        size_t first;
+        size_t second;
+        int weight;
+    };
+    auto taps = [](size_t source, size_t target) {
+        std::vector<Tap> result(target);
+        for (size_t i = 0; i < target; i++) {
+            double position = (static_cast<double>(i) + 0.5) * static_cast<double>(source) / target - 0.5;
+            position = std::max(0.0, std::min(position, static_cast<double>(source - 1)));
+            size_t first = static_cast<size_t>(position);
+            result[i] = {first, std::min(first + 1, source - 1),
+                         static_cast<int>((position - static_cast<double>(first)) * 256)};
+        }
+        return result;
+    };
+
+    return [pixels, sourceWidth, columns = taps(sourceWidth, width), rows = taps(sourceHeight, height)](
+               size_t y, uint8_t* out) {
+        const Tap& row = rows[y];
+        const uint8_t* top = pixels + row.first * sourceWidth;
+        const uint8_t* bottom = pixels + row.second * sourceWidth;
+        for (size_t x = 0; x < columns.size(); x++) {
+            const Tap& column = columns[x];
+            int upper = top[column.first] * (256 - column.weight) + top[column.second] * column.weight;
+            int lower = bottom[column.first] * (256 - column.weight) + bottom[column.second] * column.weight;
+            out[x] = static_cast<uint8_t>((upper * (256 - row.weight) + lower * row.weight + (1 << 15)) >> 16);
+        }
+    };
+}
+
+std::vector<uint8_t> RasterizeRgba(const uint8_t* rgba, size_t width, size_t height, const RasterOptions& options) {
+    std::vector<uint8_t> block(RasterBlockSize(width, height));
+    RasterizeRgba(rgba, width, height, options, block.data());
+    return block;
+}
+
+}  // namespace escpos
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace escpos {
+
+struct RasterOptions {
+    // Luma below this prints black when not dithering
+    int threshold = 128;
+    // Floyd-Steinberg error diffusion instead of a hard threshold
+    bool dither = true;
+};
+
+// 8-bit luma (BT.601) of an RGBA pixel composited over white paper
+inline uint8_t PaperLuma(const uint8_t* pixel) {
+    int luma = (pixel[0] * 77 + pixel[1] * 150 + pixel[2] * 29) >> 8;
+    return static_cast<uint8_t>((luma * pixel[3] + 255 * (255 - pixel[3])) / 255);
+}
+
+// Bytes RasterizeRgba produces for a width x height bitmap
+inline size_t RasterBlockSize(size_t width, size_t height) { return 8 + (width + 7) / 8 * height; }
+
+// 8-bit luma image, rows of `width` bytes, 0 = black
+struct LumaPlane {
+    size_t width = 0;
+    size_t height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+// Fills `row` with `width` luma values (0 = black) for output row `y`;
+// rows are requested once each, top to bottom
+using LumaRowSource = std::function<void(size_t y, uint8_t* row)>;
+
+// Dithers rows pulled from `source` into a GS v 0 raster block, so
+// decoders and resamplers never need a full-size intermediate bitmap.
+// `out` must hold RasterBlockSize() bytes.
+void RasterizeLuma(size_t width, size_t height, const RasterOptions& options, const LumaRowSource& source,
+                   uint8_t* out);
+
+// Bilinear rows of a width x height rendition of an 8-bit luma plane. Meant
+// for the last, less-than-2x step after a coarse (e.g. DCT-domain) resize.
+LumaRowSource ResampleLuma(const uint8_t* pixels, size_t sourceWidth, size_t sourceHeight, size_t width,
+                           size_t height);
+
+// Packs an RGBA bitmap into a GS v 0 raster block (header plus
+// MSB-first rows), ready to append to an ESC/POS job. `out` must hold
+// RasterBlockSize() bytes; contents beyond that are left alone.
+void RasterizeRgba(const uint8_t* rgba, size_t width, size_t height, const RasterOptions& options, uint8_t* out);
+
+std::vector<uint8_t> RasterizeRgba(const uint8_t* rgba, size_t width, size_t height, const RasterOptions& options);
+
+}  // namespace escpos
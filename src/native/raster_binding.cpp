@@ -0,0 +1,440 @@
+#include <napi.h>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "addon.h"
+#include "datamatrix.h"
+#include "jpeg.h"
+#include "mapped_file.h"
+#include "pool_task.h"
+#include "raster.h"
+#include "svg.h"
+
+namespace escpos {
+
+// Dithers and packs a decoded bitmap on the pool straight into the
+// caller's (pooled) output buffer. Both JS buffers are pinned until the
+// promise settles.
+class RasterTask : public PoolTask {
+public:
+    RasterTask(Napi::Env env, Napi::Buffer<uint8_t> rgba, size_t width, size_t height, RasterOptions options,
+               Napi::Buffer<uint8_t> output)
+        : PoolTask(env),
+          rgbaRef(Napi::Persistent(rgba)),
+          outputRef(Napi::Persistent(output)),
+          rgba(rgba.Data()),
+          output(output.Data()),
+          width(width),
+          height(height),
+          options(options) {}
+
+protected:
+    void Execute() override {
+        try {
+            RasterizeRgba(this->rgba, this->width, this->height, this->options, this->output);
+        } catch (const std::exception& e) {
+            this->SetError(e.what(), "EINVAL");
+        }
+    }
+
+    Napi::Value GetResult(Napi::Env env) override {
+        return Napi::Number::New(env, static_cast<double>(RasterBlockSize(this->width, this->height)));
+    }
+
+    void OnSettled(Napi::Env env) override {
+        this->rgbaRef.Reset();
+        this->outputRef.Reset();
+    }
+
+private:
+    Napi::Reference<Napi::Buffer<uint8_t>> rgbaRef;
+    Napi::Reference<Napi::Buffer<uint8_t>> outputRef;
+    const uint8_t* rgba;
+    uint8_t* output;
+    size_t width;
+    size_t height;
+    RasterOptions options;
+};
+
+// rasterize(rgba, width, height, threshold, dither, output) => Promise<bytes written>
+static Napi::Value Rasterize(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 6 || !info[0].IsBuffer() || !info[1].IsNumber() || !info[2].IsNumber() ||
+        !info[5].IsBuffer()) {
+        Napi::TypeError::New(env, "RGBA buffer, width, height, threshold, dither and output buffer expected")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Buffer<uint8_t> rgba = info[0].As<Napi::Buffer<uint8_t>>();
+    int64_t width = info[1].As<Napi::Number>().Int64Value();
+    int64_t height = info[2].As<Napi::Number>().Int64Value();
+    if (width <= 0 || height <= 0 || static_cast<uint64_t>(width) * static_cast<uint64_t>(height) * 4 > rgba.Length()) {
+        Napi::RangeError::New(env, "Bitmap size does not match the buffer").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Buffer<uint8_t> output = info[5].As<Napi::Buffer<uint8_t>>();
+    if (output.Length() < RasterBlockSize(static_cast<size_t>(width), static_cast<size_t>(height))) {
+        Napi::RangeError::New(env, "Output buffer is too small for the raster block").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    RasterOptions options;
+    if (info[3].IsNumber()) {
+        options.threshold = info[3].As<Napi::Number>().Int32Value();
+    }
+    if (info[4].IsBoolean()) {
+        options.dither = info[4].As<Napi::Boolean>().Value();
+    }
+
+    auto* task = new RasterTask(env, rgba, static_cast<size_t>(width), static_cast<size_t>(height), options, output);
+    return task->Queue(TaskPriority::Normal);
+}
+
+// Decodes a JPEG's luma at the coarsest DCT scale that still covers the
+// target width, then resamples and dithers it row by row into the output
+class JpegRasterTask : public PoolTask {
+public:
+    JpegRasterTask(Napi::Env env, Napi::Buffer<uint8_t> jpeg, size_t width, size_t height, RasterOptions options,
+                   Napi::Buffer<uint8_t> output)
+        : PoolTask(env),
+          jpegRef(Napi::Persistent(jpeg)),
+          outputRef(Napi::Persistent(output)),
+          jpeg(jpeg.Data()),
+          jpegLength(jpeg.Length()),
+          output(output.Data()),
+          width(width),
+          height(height),
+          options(options) {}
+
+protected:
+    void Execute() override {
+        try {
+            JpegInfo info = ReadJpegInfo(this->jpeg, this->jpegLength);
+            LumaPlane plane = DecodeJpegLuma(this->jpeg, this->jpegLength, ChooseJpegScale(info.width, this->width));
+            RasterizeLuma(this->width, this->height, this->options,
+                          ResampleLuma(plane.pixels.data(), plane.width, plane.height, this->width, this->height),
+                          this->output);
+        } catch (const std::exception& e) {
+            this->SetError(e.what(), "EINVAL");
+        }
+    }
+
+    Napi::Value GetResult(Napi::Env env) override {
+        return Napi::Number::New(env, static_cast<double>(RasterBlockSize(this->width, this->height)));
+    }
+
+    void OnSettled(Napi::Env env) override {
+        this->jpegRef.Reset();
+        this->outputRef.Reset();
+    }
+
+private:
+    Napi::Reference<Napi::Buffer<uint8_t>> jpegRef;
+    Napi::Reference<Napi::Buffer<uint8_t>> outputRef;
+    const uint8_t* jpeg;
+    size_t jpegLength;
+    uint8_t* output;
+    size_t width;
+    size_t height;
+    RasterOptions options;
+};
+
+// readJpegInfo(jpeg) => { width, height, components, supported, orientation } | null when not a JPEG
+static Napi::Value ReadJpegInfoBinding(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsBuffer()) {
+        Napi::TypeError::New(env, "JPEG buffer expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Buffer<uint8_t> jpeg = info[0].As<Napi::Buffer<uint8_t>>();
+    try {
+        JpegInfo header = ReadJpegInfo(jpeg.Data(), jpeg.Length());
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("width", Napi::Number::New(env, static_cast<double>(header.width)));
+        result.Set("height", Napi::Number::New(env, static_cast<double>(header.height)));
+        result.Set("components", Napi::Number::New(env, header.components));
+        result.Set("supported", Napi::Boolean::New(env, header.supported));
+        result.Set("orientation", Napi::Number::New(env, header.orientation));
+        return result;
+    } catch (const JpegError&) {
+        return env.Null();
+    }
+}
+
+// rasterizeJpeg(jpeg, width, height, threshold, dither, output) => Promise<bytes written>
+static Napi::Value RasterizeJpeg(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 6 || !info[0].IsBuffer() || !info[1].IsNumber() || !info[2].IsNumber() ||
+        !info[5].IsBuffer()) {
+        Napi::TypeError::New(env, "JPEG buffer, width, height, threshold, dither and output buffer expected")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    int64_t width = info[1].As<Napi::Number>().Int64Value();
+    int64_t height = info[2].As<Napi::Number>().Int64Value();
+    if (width <= 0 || height <= 0) {
+        Napi::RangeError::New(env, "Target size must be positive").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Buffer<uint8_t> output = info[5].As<Napi::Buffer<uint8_t>>();
+    if (output.Length() < RasterBlockSize(static_cast<size_t>(width), static_cast<size_t>(height))) {
+        Napi::RangeError::New(env, "Output buffer is too small for the raster block").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    RasterOptions options;
+    if (info[3].IsNumber()) {
+        options.threshold = info[3].As<Napi::Number>().Int32Value();
+    }
+    if (info[4].IsBoolean()) {
+        options.dither = info[4].As<Napi::Boolean>().Value();
+    }
+
+    auto* task = new JpegRasterTask(env, info[0].As<Napi::Buffer<uint8_t>>(), static_cast<size_t>(width),
+                                    static_cast<size_t>(height), options, output);
+    return task->Queue(TaskPriority::Normal);
+}
+
+// Renders an SVG at exactly the requested dot width and dithers it. The
+// block goes to a fresh buffer since callers cache it.
+class SvgRasterTask : public PoolTask {
+public:
+    SvgRasterTask(Napi::Env env, Napi::Buffer<char> svg, size_t width, RasterOptions options)
+        : PoolTask(env),
+          svgRef(Napi::Persistent(svg)),
+          svg(svg.Data()),
+          svgLength(svg.Length()),
+          width(width),
+          options(options) {}
+
+protected:
+    void Execute() override {
+        try {
+            LumaPlane plane = RenderSvg(this->svg, this->svgLength, this->width);
+            this->block.resize(RasterBlockSize(plane.width, plane.height));
+            RasterizeLuma(
+                plane.width, plane.height, this->options,
+                [&plane](size_t y, uint8_t* row) {
+                    std::copy_n(plane.pixels.data() + y * plane.width, plane.width, row);
+                },
+                this->block.data());
+        } catch (const std::exception& e) {
+            this->SetError(e.what(), "EINVAL");
+        }
+    }
+
+    Napi::Value GetResult(Napi::Env env) override {
+        return Napi::Buffer<uint8_t>::Copy(env, this->block.data(), this->block.size());
+    }
+
+    void OnSettled(Napi::Env env) override { this->svgRef.Reset(); }
+
+private:
+    Napi::Reference<Napi::Buffer<char>> svgRef;
+    const char* svg;
+    size_t svgLength;
+    size_t width;
+    RasterOptions options;
+    std::vector<uint8_t> block;
+};
+
+// rasterizeSvg(svg, width, threshold, dither) => Promise<Buffer> (GS v 0 block)
+static Napi::Value RasterizeSvg(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 4 || !info[0].IsBuffer() || !info[1].IsNumber()) {
+        Napi::TypeError::New(env, "SVG buffer, width, threshold and dither expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    int64_t width = info[1].As<Napi::Number>().Int64Value();
+    if (width <= 0 || width > 0xffff * 8) {
+        Napi::RangeError::New(env, "Width is out of range").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    RasterOptions options;
+    if (info[2].IsNumber()) {
+        options.threshold = info[2].As<Napi::Number>().Int32Value();
+    }
+    if (info[3].IsBoolean()) {
+        options.dither = info[3].As<Napi::Boolean>().Value();
+    }
+
+    auto* task = new SvgRasterTask(env, info[0].As<Napi::Buffer<char>>(), static_cast<size_t>(width), options);
+    return task->Queue(TaskPriority::Normal);
+}
+
+// encodeDataMatrix(data, moduleSize) => Buffer (GS v 0 block with a one-module quiet zone).
+// Synchronous: even a 144x144 symbol encodes in well under a millisecond.
+static Napi::Value EncodeDataMatrixBinding(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsNumber()) {
+        Napi::TypeError::New(env, "Data buffer and module size expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    int64_t moduleSize = info[1].As<Napi::Number>().Int64Value();
+    if (moduleSize <= 0 || moduleSize > 64) {
+        Napi::RangeError::New(env, "Module size is out of range").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Buffer<uint8_t> data = info[0].As<Napi::Buffer<uint8_t>>();
+    try {
+        ModuleMatrix matrix = EncodeDataMatrix(data.Data(), data.Length());
+        std::vector<uint8_t> block = RasterizeModules(matrix, static_cast<size_t>(moduleSize), 1);
+        return Napi::Buffer<uint8_t>::Copy(env, block.data(), block.size());
+    } catch (const SymbolError& e) {
+        Napi::RangeError::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// mapFile(path) => Buffer over a read-only mapping of the whole file, unmapped once the
+// buffer is collected; null where the runtime forbids external buffers (Electron's V8 sandbox)
+static Napi::Value MapFile(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "File path expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::unique_ptr<MappedFile> file;
+    try {
+        file = MappedFile::Open(info[0].As<Napi::String>().Utf8Value());
+    } catch (const MappedFileError& e) {
+        Napi::Error error = Napi::Error::New(env, e.what());
+        error.Set("code", Napi::String::New(env, e.code));
+        error.ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    napi_value buffer;
+    napi_status status = napi_create_external_buffer(
+        env, file->Size(), file->Data(),
+        [](napi_env, void*, void* hint) { delete static_cast<MappedFile*>(hint); }, file.get(), &buffer);
+    if (status != napi_ok) {
+        // napi_no_external_buffers_allowed; the caller reads the file instead
+        return env.Null();
+    }
+    file.release();
+    return Napi::Value(env, buffer);
+}
+
+// Shared memory handed to JS, by view address, so sealSharedMemory only ever
+// remaps a view createSharedMemory made. Shared by every env (workers).
+static std::mutex sharedMemoryMutex;
+static std::unordered_map<const uint8_t*, SharedMemory*> sharedMemoryViews;
+
+static Napi::Error MappedFileException(Napi::Env env, const MappedFileError& e) {
+    Napi::Error error = Napi::Error::New(env, e.what());
+    error.Set("code", Napi::String::New(env, e.code));
+    return error;
+}
+
+// createSharedMemory(name, size) => { fd, buffer } over writable anonymous shared memory; the caller
+// closes fd. null where the runtime forbids external buffers
+static Napi::Value CreateSharedMemory(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsNumber()) {
+        Napi::TypeError::New(env, "Name and size expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    double size = info[1].As<Napi::Number>().DoubleValue();
+    if (!(size >= 1) || size > static_cast<double>(SIZE_MAX)) {
+        Napi::RangeError::New(env, "Invalid shared memory size").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::unique_ptr<SharedMemory> memory;
+    try {
+        memory = SharedMemory::Create(info[0].As<Napi::String>().Utf8Value(), static_cast<size_t>(size));
+    } catch (const MappedFileError& e) {
+        MappedFileException(env, e).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    int fd = memory->Fd();
+    napi_value buffer;
+    napi_status status = napi_create_external_buffer(
+        env, memory->Size(), memory->Data(),
+        [](napi_env, void*, void* hint) {
+            auto* memory = static_cast<SharedMemory*>(hint);
+            {
+                std::lock_guard<std::mutex> lock(sharedMemoryMutex);
+                sharedMemoryViews.erase(memory->Data());
+            }
+            delete memory;
+        },
+        memory.get(), &buffer);
+    if (status != napi_ok) {
+        memory->CloseFd();
+        return env.Null();
+    }
+    {
+        std::lock_guard<std::mutex> lock(sharedMemoryMutex);
+        sharedMemoryViews[memory->Data()] = memory.get();
+    }
+    memory.release();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("fd", Napi::Number::New(env, fd));
+    result.Set("buffer", Napi::Value(env, buffer));
+    return result;
+}
+
+// sealSharedMemory(buffer): the buffer createSharedMemory returned becomes read-only and its memory
+// immutable for every process holding the descriptor, which must still be open
+static Napi::Value SealSharedMemory(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsBuffer()) {
+        Napi::TypeError::New(env, "Shared memory buffer expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    Napi::Buffer<uint8_t> buffer = info[0].As<Napi::Buffer<uint8_t>>();
+
+    std::lock_guard<std::mutex> lock(sharedMemoryMutex);
+    auto found = sharedMemoryViews.find(buffer.Data());
+    if (found == sharedMemoryViews.end() || found->second->Size() != buffer.Length()) {
+        Napi::TypeError::New(env, "Buffer was not created by createSharedMemory").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    try {
+        found->second->Seal();
+    } catch (const MappedFileError& e) {
+        MappedFileException(env, e).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    return env.Undefined();
+}
+
+void InitRaster(Napi::Env env, Napi::Object exports) {
+    exports.Set("rasterize", Napi::Function::New(env, Rasterize));
+    exports.Set("readJpegInfo", Napi::Function::New(env, ReadJpegInfoBinding));
+    exports.Set("rasterizeJpeg", Napi::Function::New(env, RasterizeJpeg));
+    exports.Set("rasterizeSvg", Napi::Function::New(env, RasterizeSvg));
+    exports.Set("encodeDataMatrix", Napi::Function::New(env, EncodeDataMatrixBinding));
+    exports.Set("mapFile", Napi::Function::New(env, MapFile));
+    exports.Set("createSharedMemory", Napi::Function::New(env, CreateSharedMemory));
+    exports.Set("sealSharedMemory", Napi::Function::New(env, SealSharedMemory));
+}
+
+}  // namespace escpos
@@ -0,0 +1,227 @@
+#include "serial_latency.h"
+
+#ifndef _WIN32
+
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/serial.h>
+#endif
+#ifdef __APPLE__
+#include <IOKit/serial/ioss.h>
+#endif
+
+#endif
+
+namespace escpos {
+
+const char* TuningStatusName(TuningStatus status) {
+    switch (status) {
+        case TuningStatus::Applied: return "applied";
+        case TuningStatus::Skipped: return "skipped";
+        case TuningStatus::Unsupported: return "unsupported";
+        case TuningStatus::Denied: return "denied";
+        default: return "failed";
+    }
+}
+
+#ifndef _WIN32
+
+static TuningStep StepFromErrno(const char* what, int error) {
+    TuningStep step;
+    switch (error) {
+        case ENOTTY:
+        case EINVAL:
+        case ENOENT:
+        case ENOSYS:
+#if defined(ENOTSUP)
+        case ENOTSUP:
+#endif
+#if defined(EOPNOTSUPP) && EOPNOTSUPP != ENOTSUP
+        case EOPNOTSUPP:
+#endif
+            step.status = TuningStatus::Unsupported;
+            break;
+        case EPERM:
+        case EACCES:
+        case EROFS:
+            step.status = TuningStatus::Denied;
+            break;
+        default:
+            step.status = TuningStatus::Failed;
+            break;
+    }
+    step.detail = std::string(what) + ": " + std::strerror(error);
+    return step;
+}
+
+static TuningStep Applied() {
+    TuningStep step;
+    step.status = TuningStatus::Applied;
+    return step;
+}
+
+static TuningStep ApplyRaw(int fd) {
+    struct termios tty;
+    if (tcgetattr(fd, &tty) != 0) {
+        return StepFromErrno("tcgetattr", errno);
+    }
+
+    // cfmakeraw() also forces 8N1; keep the framing and flow control the
+    // port was opened with (7E1 scales exist) and take only the rest
+    tcflag_t cflag = tty.c_cflag;
+    tcflag_t softFlow = tty.c_iflag & (IXON | IXOFF | IXANY);
+    cfmakeraw(&tty);
+    tty.c_cflag = cflag;
+    tty.c_iflag |= softFlow;
+    tty.c_cc[VMIN] = 1;
+    tty.c_cc[VTIME] = 0;
+
+    if (tcsetattr(fd, TCSANOW, &tty) != 0) {
+        return StepFromErrno("tcsetattr", errno);
+    }
+    return Applied();
+}
+
+static TuningStep ApplyLowLatency(int fd) {
+#if defined(__linux__) && defined(TIOCGSERIAL) && defined(ASYNC_LOW_LATENCY)
+    struct serial_struct serial;
+    std::memset(&serial, 0, sizeof(serial));
+    if (ioctl(fd, TIOCGSERIAL, &serial) != 0) {
+        return StepFromErrno("TIOCGSERIAL", errno);
+    }
+    if (serial.flags & ASYNC_LOW_LATENCY) {
+        return Applied();
+    }
+    serial.flags |= ASYNC_LOW_LATENCY;
+    if (ioctl(fd, TIOCSSERIAL, &serial) != 0) {
+        return StepFromErrno("TIOCSSERIAL", errno);
+    }
+    return Applied();
+#elif defined(__APPLE__) && defined(IOSSDATALAT)
+    // Microseconds the driver may hold received bytes back
+    unsigned long latencyMicros = 1;
+    if (ioctl(fd, IOSSDATALAT, &latencyMicros) != 0) {
+        return StepFromErrno("IOSSDATALAT", errno);
+    }
+    return Applied();
+#else
+    (void)fd;
+    TuningStep step;
+    step.status = TuningStatus::Unsupported;
+    step.detail = "No low-latency ioctl on this platform";
+    return step;
+#endif
+}
+
+// usb-serial drivers with a latency timer expose it next to the tty in
+// sysfs: /sys/class/tty/ttyUSB0/device/latency_timer (milliseconds)
+static std::string LatencyTimerPath(int fd) {
+#ifdef __linux__
+    char link[64];
+    char target[PATH_MAX];
+    std::snprintf(link, sizeof(link), "/proc/self/fd/%d", fd);
+    ssize_t length = readlink(link, target, sizeof(target) - 1);
+    if (length <= 0) {
+        return "";
+    }
+    target[length] = '\0';
+    const char* name = std::strrchr(target, '/');
+    name = name ? name + 1 : target;
+    return std::string("/sys/class/tty/") + name + "/device/latency_timer";
+#else
+    (void)fd;
+    return "";
+#endif
+}
+
+static int ReadLatencyTimer(const std::string& path) {
+    FILE* file = std::fopen(path.c_str(), "r");
+    if (!file) {
+        return -1;
+    }
+    int value = -1;
+    if (std::fscanf(file, "%d", &value) != 1) {
+        value = -1;
+    }
+    std::fclose(file);
+    return value;
+}
+
+static TuningStep ApplyLatencyTimer(int fd, int wantedMs, int& currentMs) {
+    std::string path = LatencyTimerPath(fd);
+    currentMs = path.empty() ? -1 : ReadLatencyTimer(path);
+    if (currentMs < 0) {
+        TuningStep step;
+        step.status = TuningStatus::Unsupported;
+        step.detail = "Driver has no latency timer";
+        return step;
+    }
+    if (currentMs <= wantedMs) {
+        return Applied();
+    }
+
+    int handle = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (handle < 0) {
+        return StepFromErrno("latency_timer", errno);
+    }
+    std::string value = std::to_string(wantedMs) + "\n";
+    ssize_t written = ::write(handle, value.data(), value.size());
+    int error = errno;
+    ::close(handle);
+    if (written < 0) {
+        return StepFromErrno("latency_timer", error);
+    }
+
+    currentMs = ReadLatencyTimer(path);
+    return Applied();
+}
+
+SerialLatencyReport ConfigureSerialLatency(int fd, const SerialLatencyOptions& options) {
+    SerialLatencyReport report;
+    if (!isatty(fd)) {
+        report.raw = StepFromErrno("isatty", ENOTTY);
+        return report;
+    }
+
+    if (options.raw) {
+        report.raw = ApplyRaw(fd);
+    }
+    if (options.lowLatency) {
+        report.lowLatency = ApplyLowLatency(fd);
+    }
+    if (options.latencyTimerMs > 0) {
+        report.latencyTimer = ApplyLatencyTimer(fd, options.latencyTimerMs, report.latencyTimerMs);
+    } else {
+        std::string path = LatencyTimerPath(fd);
+        report.latencyTimerMs = path.empty() ? -1 : ReadLatencyTimer(path);
+    }
+    return report;
+}
+
+#else
+
+SerialLatencyReport ConfigureSerialLatency(int, const SerialLatencyOptions&) {
+    // COM port timeouts belong to the serialport binding on Windows
+    TuningStep unsupported;
+    unsupported.status = TuningStatus::Unsupported;
+    unsupported.detail = "Not available on Windows";
+
+    SerialLatencyReport report;
+    report.raw = unsupported;
+    report.lowLatency = unsupported;
+    report.latencyTimer = unsupported;
+    return report;
+}
+
+#endif
+
+}  // namespace escpos
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+
+namespace escpos {
+
+enum class TuningStatus {
+    Applied,
+    Skipped,
+    // The driver or platform has no such control (ptys, CDC-ACM, Windows)
+    Unsupported,
+    // The control exists but this process may not change it
+    Denied,
+    Failed
+};
+
+const char* TuningStatusName(TuningStatus status);
+
+struct TuningStep {
+    TuningStatus status = TuningStatus::Skipped;
+    std::string detail;
+};
+
+struct SerialLatencyOptions {
+    // Non-canonical termios with VMIN=1/VTIME=0: a read returns on the first byte
+    bool raw = true;
+    // ASYNC_LOW_LATENCY on Linux, IOSSDATALAT on macOS
+    bool lowLatency = true;
+    // usb-serial latency timer (FTDI and friends) lowered to at most this; 0 leaves it
+    int latencyTimerMs = 1;
+};
+
+struct SerialLatencyReport {
+    TuningStep raw;
+    TuningStep lowLatency;
+    TuningStep latencyTimer;
+    // Timer value in effect afterwards, -1 where there is none
+    int latencyTimerMs = -1;
+};
+
+// Applies whatever the options ask for to an open tty, step by step. A
+// step the driver does not support is reported rather than thrown, so the
+// caller decides whether that is acceptable. Line speed, framing and flow
+// control are left as configured.
+SerialLatencyReport ConfigureSerialLatency(int fd, const SerialLatencyOptions& options);
+
+}  // namespace escpos
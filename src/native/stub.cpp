@@ -2,6 +2,8 @@
 #include <string>
 #include <vector>
 
+#include "addon.h"
+
 class Printer : public Napi::ObjectWrap<Printer> {
 public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
@@ -12,7 +14,13 @@ private:
     std::string printerName;
 
     Napi::Value Print(const Napi::CallbackInfo& info);
+    Napi::Value PrintAsync(const Napi::CallbackInfo& info);
+    Napi::Value Cancel(const Napi::CallbackInfo& info);
+    Napi::Value StartDocument(const Napi::CallbackInfo& info);
+    Napi::Value WriteAsync(const Napi::CallbackInfo& info);
+    Napi::Value EndDocument(const Napi::CallbackInfo& info);
     Napi::Value Close(const Napi::CallbackInfo& info);
+    Napi::Value IsHealthy(const Napi::CallbackInfo& info);
     static Napi::Value GetPrinterList(const Napi::CallbackInfo& info);
 };
 
@@ -23,7 +31,13 @@ Napi::Object Printer::Init(Napi::Env env, Napi::Object exports) {
 
     Napi::Function func = DefineClass(env, "Printer", {
         InstanceMethod("print", &Printer::Print),
+        InstanceMethod("printAsync", &Printer::PrintAsync),
+        InstanceMethod("cancel", &Printer::Cancel),
+        InstanceMethod("startDocument", &Printer::StartDocument),
+        InstanceMethod("writeAsync", &Printer::WriteAsync),
+        InstanceMethod("endDocument", &Printer::EndDocument),
         InstanceMethod("close", &Printer::Close),
+        InstanceMethod("isHealthy", &Printer::IsHealthy),
         StaticMethod("getPrinterList", &Printer::GetPrinterList)
     });
 
@@ -58,12 +72,62 @@ Napi::Value Printer::Print(const Napi::CallbackInfo& info) {
     return Napi::Boolean::New(env, true);
 }
 
+Napi::Value Printer::PrintAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsBuffer()) {
+        Napi::TypeError::New(env, "Buffer expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    // Stub implementation - report the job as fully written without printing
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+    deferred.Resolve(Napi::Number::New(env, static_cast<double>(info[0].As<Napi::Buffer<unsigned char>>().Length())));
+    return deferred.Promise();
+}
+
+Napi::Value Printer::Cancel(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    // Stub implementation - nothing is ever in flight
+    return env.Undefined();
+}
+
+Napi::Value Printer::StartDocument(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    // Stub implementation - there is no spooler document to open
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value Printer::WriteAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsBuffer()) {
+        Napi::TypeError::New(env, "Buffer expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    // Stub implementation - report the chunk as fully written
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+    deferred.Resolve(Napi::Number::New(env, static_cast<double>(info[0].As<Napi::Buffer<unsigned char>>().Length())));
+    return deferred.Promise();
+}
+
+Napi::Value Printer::EndDocument(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    return env.Undefined();
+}
+
 Napi::Value Printer::Close(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     // Stub implementation - no actual cleanup needed
     return env.Undefined();
 }
 
+Napi::Value Printer::IsHealthy(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    return Napi::Boolean::New(env, true);
+}
+
 Napi::Value Printer::GetPrinterList(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
@@ -73,6 +137,12 @@ Napi::Value Printer::GetPrinterList(const Napi::CallbackInfo& info) {
 }
 
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
+    escpos::InitThreadPool(env, exports);
+    escpos::InitTransport(env, exports);
+    escpos::InitRaster(env, exports);
+    escpos::InitEvdev(env, exports);
+    escpos::InitWeighLabel(env, exports);
+    escpos::InitHandoff(env, exports);
     return Printer::Init(env, exports);
 }
 
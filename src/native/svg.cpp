@@ -0,0 +1,1141 @@
+#include "svg.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace escpos {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+// Sub-scanlines per row; horizontal coverage is computed exactly
+constexpr int kSamples = 4;
+// Refuse canvases beyond this many dots (a 576-dot-wide logo is far below)
+constexpr size_t kMaxCanvasDots = size_t(1) << 26;
+
+struct Point {
+    double x;
+    double y;
+};
+
+using Polygon = std::vector<Point>;
+
+struct Subpath {
+    Polygon points;
+    bool closed = false;
+};
+
+// Affine transform [a c e; b d f]
+struct Matrix {
+    double a = 1, b = 0, c = 0, d = 1, e = 0, f = 0;
+
+    Point Apply(double x, double y) const {
+        return {this->a * x + this->c * y + this->e, this->b * x + this->d * y + this->f};
+    }
+
+    // `child` applied first, then this
+    Matrix Then(const Matrix& child) const {
+        Matrix m;
+        m.a = this->a * child.a + this->c * child.b;
+        m.b = this->b * child.a + this->d * child.b;
+        m.c = this->a * child.c + this->c * child.d;
+        m.d = this->b * child.c + this->d * child.d;
+        m.e = this->a * child.e + this->c * child.f + this->e;
+        m.f = this->b * child.e + this->d * child.f + this->f;
+        return m;
+    }
+
+    double Scale() const { return std::sqrt(std::fabs(this->a * this->d - this->b * this->c)); }
+};
+
+struct Paint {
+    bool none = true;
+    // 0 = black, 255 = white
+    double luma = 0;
+};
+
+struct Style {
+    Paint fill{false, 0};
+    Paint stroke;
+    double fillOpacity = 1;
+    double strokeOpacity = 1;
+    // Accumulated group opacity (applied per shape, not per group)
+    double opacity = 1;
+    double strokeWidth = 1;
+    bool evenOdd = false;
+    bool hidden = false;
+};
+
+struct State {
+    Matrix matrix;
+    Style style;
+    // Inside an element whose content never renders (defs, text, ...)
+    bool skip = false;
+};
+
+using Attributes = std::vector<std::pair<std::string, std::string>>;
+
+const std::string& Attr(const Attributes& attributes, const char* name) {
+    static const std::string empty;
+    for (const auto& attribute : attributes) {
+        if (attribute.first == name) {
+            return attribute.second;
+        }
+    }
+    return empty;
+}
+
+std::string Trim(const std::string& text) {
+    size_t begin = 0;
+    size_t end = text.size();
+    while (begin < end && std::isspace(static_cast<unsigned char>(text[begin]))) {
+        begin++;
+    }
+    while (end > begin && std::isspace(static_cast<unsigned char>(text[end - 1]))) {
+        end--;
+    }
+    return text.substr(begin, end - begin);
+}
+
+// Number lists as SVG writes them: "1.5.5-2e1" is 1.5, .5, -20
+class Scanner {
+public:
+    Scanner(const char* begin, const char* end) : p(begin), end(end) {}
+    explicit Scanner(const std::string& text) : Scanner(text.data(), text.data() + text.size()) {}
+
+    void SkipSeparators() {
+        while (this->p < this->end && (std::isspace(static_cast<unsigned char>(*this->p)) || *this->p == ',')) {
+            this->p++;
+        }
+    }
+
+    bool AtEnd() {
+        this->SkipSeparators();
+        return this->p >= this->end;
+    }
+
+    char Peek() const { return this->p < this->end ? *this->p : '\0'; }
+    void Advance() { this->p++; }
+    const char* Position() const { return this->p; }
+
+    bool Number(double& out) {
+        this->SkipSeparators();
+        const char* s = this->p;
+        double sign = 1;
+        if (s < this->end && (*s == '+' || *s == '-')) {
+            sign = *s == '-' ? -1 : 1;
+            s++;
+        }
+        double value = 0;
+        bool digits = false;
+        while (s < this->end && std::isdigit(static_cast<unsigned char>(*s))) {
+            value = value * 10 + (*s++ - '0');
+            digits = true;
+        }
+        if (s < this->end && *s == '.') {
+            s++;
+            double place = 0.1;
+            while (s < this->end && std::isdigit(static_cast<unsigned char>(*s))) {
+                value += (*s++ - '0') * place;
+                place *= 0.1;
+                digits = true;
+            }
+        }
+        if (!digits) {
+            return false;
+        }
+        if (s < this->end && (*s == 'e' || *s == 'E')) {
+            const char* e = s + 1;
+            int exponentSign = 1;
+            if (e < this->end && (*e == '+' || *e == '-')) {
+                exponentSign = *e == '-' ? -1 : 1;
+                e++;
+            }
+            if (e < this->end && std::isdigit(static_cast<unsigned char>(*e))) {
+                int exponent = 0;
+                while (e < this->end && std::isdigit(static_cast<unsigned char>(*e))) {
+                    exponent = std::min(exponent * 10 + (*e++ - '0'), 400);
+                }
+                value *= std::pow(10.0, exponentSign * exponent);
+                s = e;
+            }
+        }
+        out = sign * value;
+        this->p = s;
+        return true;
+    }
+
+    // Arc flags may be written without separators ("a1 1 0 011 1")
+    bool Flag(bool& out) {
+        this->SkipSeparators();
+        if (this->p < this->end && (*this->p == '0' || *this->p == '1')) {
+            out = *this->p++ == '1';
+            return true;
+        }
+        return false;
+    }
+
+private:
+    const char* p;
+    const char* end;
+};
+
+// Length in user units (CSS px); false for percentages and garbage
+bool ParseLength(const std::string& text, double& out) {
+    Scanner scanner(text);
+    double value;
+    if (!scanner.Number(value)) {
+        return false;
+    }
+    std::string unit = Trim(std::string(scanner.Position(), text.data() + text.size()));
+    static const std::pair<const char*, double> units[] = {{"", 1},   {"px", 1},         {"pt", 96.0 / 72},
+                                                           {"pc", 16}, {"in", 96},        {"mm", 96 / 25.4},
+                                                           {"cm", 96 / 2.54}, {"em", 16}, {"ex", 8}};
+    for (const auto& candidate : units) {
+        if (unit == candidate.first) {
+            out = value * candidate.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+double LengthOr(const Attributes& attributes, const char* name, double fallback) {
+    double value;
+    return ParseLength(Attr(attributes, name), value) ? value : fallback;
+}
+
+Matrix ParseTransform(const std::string& text) {
+    Matrix result;
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (p < end) {
+        while (p < end && !std::isalpha(static_cast<unsigned char>(*p))) {
+            p++;
+        }
+        const char* nameStart = p;
+        while (p < end && std::isalpha(static_cast<unsigned char>(*p))) {
+            p++;
+        }
+        std::string name(nameStart, p);
+        const char* open = std::find(p, end, '(');
+        const char* close = std::find(open, end, ')');
+        if (name.empty() || open == end || close == end) {
+            break;
+        }
+        Scanner scanner(open + 1, close);
+        double args[6] = {0, 0, 0, 0, 0, 0};
+        int count = 0;
+        while (count < 6 && scanner.Number(args[count])) {
+            count++;
+        }
+        p = close + 1;
+
+        Matrix step;
+        if (name == "matrix" && count == 6) {
+            step = {args[0], args[1], args[2], args[3], args[4], args[5]};
+        } else if (name == "translate" && count >= 1) {
+            step.e = args[0];
+            step.f = count > 1 ? args[1] : 0;
+        } else if (name == "scale" && count >= 1) {
+            step.a = args[0];
+            step.d = count > 1 ? args[1] : args[0];
+        } else if (name == "rotate" && count >= 1) {
+            double angle = args[0] * kPi / 180;
+            Matrix rotation{std::cos(angle), std::sin(angle), -std::sin(angle), std::cos(angle), 0, 0};
+            if (count >= 3) {
+                Matrix to{1, 0, 0, 1, args[1], args[2]};
+                Matrix back{1, 0, 0, 1, -args[1], -args[2]};
+                step = to.Then(rotation).Then(back);
+            } else {
+                step = rotation;
+            }
+        } else if (name == "skewX" && count >= 1) {
+            step.c = std::tan(args[0] * kPi / 180);
+        } else if (name == "skewY" && count >= 1) {
+            step.b = std::tan(args[0] * kPi / 180);
+        }
+        result = result.Then(step);
+    }
+    return result;
+}
+
+double ColorLuma(double r, double g, double b) { return 0.299 * r + 0.587 * g + 0.114 * b; }
+
+int HexDigit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+// False for "inherit" and anything unparseable, which keeps the parent's paint
+bool ParsePaint(const std::string& raw, Paint& out) {
+    std::string text = Trim(raw);
+    if (text.empty() || text == "inherit") {
+        return false;
+    }
+    if (text == "none" || text == "transparent") {
+        out = {true, 0};
+        return true;
+    }
+    if (text.compare(0, 4, "url(") == 0) {
+        // Paint servers are not rendered; use the fallback colour, else black
+        size_t close = text.find(')');
+        std::string fallback = close == std::string::npos ? "" : Trim(text.substr(close + 1));
+        if (fallback.empty() || !ParsePaint(fallback, out)) {
+            out = {false, 0};
+        }
+        return true;
+    }
+    if (text[0] == '#') {
+        std::string hex = text.substr(1);
+        int digits[8];
+        for (size_t i = 0; i < hex.size() && i < 8; i++) {
+            digits[i] = HexDigit(hex[i]);
+            if (digits[i] < 0) {
+                return false;
+            }
+        }
+        if (hex.size() == 3 || hex.size() == 4) {
+            out = {false, ColorLuma(digits[0] * 17, digits[1] * 17, digits[2] * 17)};
+            return true;
+        }
+        if (hex.size() == 6 || hex.size() == 8) {
+            out = {false,
+                   ColorLuma(digits[0] * 16 + digits[1], digits[2] * 16 + digits[3], digits[4] * 16 + digits[5])};
+            return true;
+        }
+        return false;
+    }
+    if (text.compare(0, 4, "rgb(") == 0 || text.compare(0, 5, "rgba(") == 0) {
+        Scanner scanner(text.data() + text.find('(') + 1, text.data() + text.size());
+        double channels[3];
+        for (double& channel : channels) {
+            if (!scanner.Number(channel)) {
+                return false;
+            }
+            if (scanner.Peek() == '%') {
+                channel *= 2.55;
+                scanner.Advance();
+            }
+            channel = std::max(0.0, std::min(255.0, channel));
+        }
+        out = {false, ColorLuma(channels[0], channels[1], channels[2])};
+        return true;
+    }
+
+    static const std::pair<const char*, unsigned> named[] = {
+        {"black", 0x000000},  {"white", 0xffffff},  {"red", 0xff0000},    {"green", 0x008000}, {"lime", 0x00ff00},
+        {"blue", 0x0000ff},   {"yellow", 0xffff00}, {"cyan", 0x00ffff},   {"aqua", 0x00ffff},  {"magenta", 0xff00ff},
+        {"fuchsia", 0xff00ff}, {"gray", 0x808080},  {"grey", 0x808080},   {"silver", 0xc0c0c0}, {"maroon", 0x800000},
+        {"navy", 0x000080},   {"olive", 0x808000},  {"purple", 0x800080}, {"teal", 0x008080},  {"orange", 0xffa500}};
+    for (const auto& color : named) {
+        if (text == color.first) {
+            out = {false, ColorLuma(color.second >> 16, (color.second >> 8) & 0xff, color.second & 0xff)};
+            return true;
+        }
+    }
+    // currentColor and unknown names
+    out = {false, 0};
+    return true;
+}
+
+double Opacity(const std::string& text, double fallback) {
+    double value;
+    Scanner scanner(text);
+    if (!scanner.Number(value)) {
+        return fallback;
+    }
+    if (scanner.Peek() == '%') {
+        value /= 100;
+    }
+    return std::max(0.0, std::min(1.0, value));
+}
+
+void ApplyProperty(Style& style, const std::string& name, const std::string& value) {
+    if (name == "fill") {
+        ParsePaint(value, style.fill);
+    } else if (name == "stroke") {
+        ParsePaint(value, style.stroke);
+    } else if (name == "fill-opacity") {
+        style.fillOpacity = Opacity(value, style.fillOpacity);
+    } else if (name == "stroke-opacity") {
+        style.strokeOpacity = Opacity(value, style.strokeOpacity);
+    } else if (name == "opacity") {
+        style.opacity *= Opacity(value, 1);
+    } else if (name == "stroke-width") {
+        double width;
+        if (ParseLength(Trim(value), width) && width >= 0) {
+            style.strokeWidth = width;
+        }
+    } else if (name == "fill-rule") {
+        std::string rule = Trim(value);
+        if (rule == "evenodd" || rule == "nonzero") {
+            style.evenOdd = rule == "evenodd";
+        }
+    } else if (name == "display") {
+        style.hidden = style.hidden || Trim(value) == "none";
+    } else if (name == "visibility") {
+        std::string visibility = Trim(value);
+        if (visibility == "hidden" || visibility == "collapse") {
+            style.hidden = true;
+        } else if (visibility == "visible") {
+            style.hidden = false;
+        }
+    }
+}
+
+// style="" wins over presentation attributes
+void ApplyStyle(State& state, const Attributes& attributes) {
+    for (const auto& attribute : attributes) {
+        if (attribute.first != "style") {
+            ApplyProperty(state.style, attribute.first, attribute.second);
+        }
+    }
+    const std::string& declarations = Attr(attributes, "style");
+    size_t start = 0;
+    while (start < declarations.size()) {
+        size_t end = declarations.find(';', start);
+        if (end == std::string::npos) {
+            end = declarations.size();
+        }
+        std::string declaration = declarations.substr(start, end - start);
+        size_t colon = declaration.find(':');
+        if (colon != std::string::npos) {
+            ApplyProperty(state.style, Trim(declaration.substr(0, colon)), declaration.substr(colon + 1));
+        }
+        start = end + 1;
+    }
+}
+
+// Builds flattened device-space subpaths; the current point is kept in
+// user space so relative commands and arcs work on the original geometry
+class PathBuilder {
+public:
+    explicit PathBuilder(const Matrix& matrix) : matrix(matrix) {}
+
+    Point Current() const { return this->current; }
+
+    void MoveTo(double x, double y) {
+        this->Flush();
+        this->current = this->start = {x, y};
+        this->open.points.push_back(this->matrix.Apply(x, y));
+    }
+
+    void LineTo(double x, double y) {
+        this->Begin();
+        this->current = {x, y};
+        this->open.points.push_back(this->matrix.Apply(x, y));
+    }
+
+    void CubicTo(double x1, double y1, double x2, double y2, double x, double y) {
+        this->Begin();
+        Point p0 = this->open.points.back();
+        Point p1 = this->matrix.Apply(x1, y1);
+        Point p2 = this->matrix.Apply(x2, y2);
+        Point p3 = this->matrix.Apply(x, y);
+        double hull = std::hypot(p1.x - p0.x, p1.y - p0.y) + std::hypot(p2.x - p1.x, p2.y - p1.y) +
+                      std::hypot(p3.x - p2.x, p3.y - p2.y);
+        int steps = static_cast<int>(std::max(1.0, std::min(256.0, std::ceil(std::sqrt(hull * 2)))));
+        for (int i = 1; i <= steps; i++) {
+            double t = static_cast<double>(i) / steps;
+            double u = 1 - t;
+            double w0 = u * u * u, w1 = 3 * u * u * t, w2 = 3 * u * t * t, w3 = t * t * t;
+            this->open.points.push_back({w0 * p0.x + w1 * p1.x + w2 * p2.x + w3 * p3.x,
+                                         w0 * p0.y + w1 * p1.y + w2 * p2.y + w3 * p3.y});
+        }
+        this->current = {x, y};
+    }
+
+    void QuadTo(double qx, double qy, double x, double y) {
+        Point c = this->current;
+        this->CubicTo(c.x + 2.0 / 3 * (qx - c.x), c.y + 2.0 / 3 * (qy - c.y), x + 2.0 / 3 * (qx - x),
+                      y + 2.0 / 3 * (qy - y), x, y);
+    }
+
+    // Endpoint arc (SVG 1.1 F.6.5) as cubic segments of at most 90 degrees
+    void ArcTo(double rx, double ry, double rotation, bool large, bool sweep, double x, double y) {
+        Point from = this->current;
+        rx = std::fabs(rx);
+        ry = std::fabs(ry);
+        if (rx == 0 || ry == 0 || (from.x == x && from.y == y)) {
+            this->LineTo(x, y);
+            return;
+        }
+        double phi = rotation * kPi / 180;
+        double cosPhi = std::cos(phi);
+        double sinPhi = std::sin(phi);
+        double dx = (from.x - x) / 2;
+        double dy = (from.y - y) / 2;
+        double x1 = cosPhi * dx + sinPhi * dy;
+        double y1 = -sinPhi * dx + cosPhi * dy;
+        double lambda = (x1 * x1) / (rx * rx) + (y1 * y1) / (ry * ry);
+        if (lambda > 1) {
+            rx *= std::sqrt(lambda);
+            ry *= std::sqrt(lambda);
+        }
+        double numerator = rx * rx * ry * ry - rx * rx * y1 * y1 - ry * ry * x1 * x1;
+        double denominator = rx * rx * y1 * y1 + ry * ry * x1 * x1;
+        double coefficient = std::sqrt(std::max(0.0, numerator / denominator));
+        if (large == sweep) {
+            coefficient = -coefficient;
+        }
+        double cx1 = coefficient * rx * y1 / ry;
+        double cy1 = -coefficient * ry * x1 / rx;
+        double cx = cosPhi * cx1 - sinPhi * cy1 + (from.x + x) / 2;
+        double cy = sinPhi * cx1 + cosPhi * cy1 + (from.y + y) / 2;
+
+        auto angle = [](double ux, double uy, double vx, double vy) {
+            return std::atan2(ux * vy - uy * vx, ux * vx + uy * vy);
+        };
+        double theta = angle(1, 0, (x1 - cx1) / rx, (y1 - cy1) / ry);
+        double delta = angle((x1 - cx1) / rx, (y1 - cy1) / ry, (-x1 - cx1) / rx, (-y1 - cy1) / ry);
+        if (!sweep && delta > 0) {
+            delta -= 2 * kPi;
+        } else if (sweep && delta < 0) {
+            delta += 2 * kPi;
+        }
+
+        int segments = static_cast<int>(std::ceil(std::fabs(delta) / (kPi / 2) - 1e-9));
+        double step = delta / std::max(1, segments);
+        double k = 4.0 / 3 * std::tan(step / 4);
+        auto map = [&](double ux, double uy) {
+            return Point{cx + rx * ux * cosPhi - ry * uy * sinPhi, cy + rx * ux * sinPhi + ry * uy * cosPhi};
+        };
+        for (int i = 0; i < segments; i++) {
+            double a1 = theta + i * step;
+            double a2 = a1 + step;
+            Point c1 = map(std::cos(a1) - k * std::sin(a1), std::sin(a1) + k * std::cos(a1));
+            Point c2 = map(std::cos(a2) + k * std::sin(a2), std::sin(a2) - k * std::cos(a2));
+            Point end = i == segments - 1 ? Point{x, y} : map(std::cos(a2), std::sin(a2));
+            this->CubicTo(c1.x, c1.y, c2.x, c2.y, end.x, end.y);
+        }
+    }
+
+    void Close() {
+        if (!this->open.points.empty()) {
+            this->open.closed = true;
+            this->Flush();
+        }
+        this->current = this->start;
+    }
+
+    std::vector<Subpath> Finish() {
+        this->Flush();
+        return std::move(this->paths);
+    }
+
+private:
+    // Drawing after Z (or before any M) continues from the current point
+    void Begin() {
+        if (this->open.points.empty()) {
+            this->start = this->current;
+            this->open.points.push_back(this->matrix.Apply(this->current.x, this->current.y));
+        }
+    }
+
+    void Flush() {
+        if (this->open.points.size() > 1) {
+            this->paths.push_back(std::move(this->open));
+        }
+        this->open = Subpath();
+    }
+
+    Matrix matrix;
+    Point current{0, 0};
+    Point start{0, 0};
+    Subpath open;
+    std::vector<Subpath> paths;
+};
+
+// Path data up to the first error, which is what browsers render
+void ParsePathData(const std::string& data, PathBuilder& path) {
+    Scanner scanner(data);
+    char command = 0;
+    char previous = 0;
+    Point cubicControl{0, 0};
+    Point quadControl{0, 0};
+
+    while (!scanner.AtEnd()) {
+        if (std::isalpha(static_cast<unsigned char>(scanner.Peek()))) {
+            command = scanner.Peek();
+            scanner.Advance();
+        } else if (command == 0 || command == 'Z' || command == 'z') {
+            return;
+        }
+
+        bool relative = std::islower(static_cast<unsigned char>(command));
+        char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(command)));
+        Point current = path.Current();
+        double ox = relative ? current.x : 0;
+        double oy = relative ? current.y : 0;
+        double v[6];
+        auto read = [&](int count) {
+            for (int i = 0; i < count; i++) {
+                if (!scanner.Number(v[i])) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        switch (upper) {
+            case 'Z':
+                path.Close();
+                break;
+            case 'M':
+                if (!read(2)) {
+                    return;
+                }
+                path.MoveTo(ox + v[0], oy + v[1]);
+                // Further pairs are implicit line-tos
+                command = relative ? 'l' : 'L';
+                break;
+            case 'L':
+                if (!read(2)) {
+                    return;
+                }
+                path.LineTo(ox + v[0], oy + v[1]);
+                break;
+            case 'H':
+                if (!read(1)) {
+                    return;
+                }
+                path.LineTo(ox + v[0], current.y);
+                break;
+            case 'V':
+                if (!read(1)) {
+                    return;
+                }
+                path.LineTo(current.x, oy + v[0]);
+                break;
+            case 'C':
+                if (!read(6)) {
+                    return;
+                }
+                path.CubicTo(ox + v[0], oy + v[1], ox + v[2], oy + v[3], ox + v[4], oy + v[5]);
+                cubicControl = {ox + v[2], oy + v[3]};
+                break;
+            case 'S': {
+                if (!read(4)) {
+                    return;
+                }
+                Point reflected = previous == 'C' || previous == 'S'
+                                      ? Point{2 * current.x - cubicControl.x, 2 * current.y - cubicControl.y}
+                                      : current;
+                path.CubicTo(reflected.x, reflected.y, ox + v[0], oy + v[1], ox + v[2], oy + v[3]);
+                cubicControl = {ox + v[0], oy + v[1]};
+                break;
+            }
+            case 'Q':
+                if (!read(4)) {
+                    return;
+                }
+                path.QuadTo(ox + v[0], oy + v[1], ox + v[2], oy + v[3]);
+                quadControl = {ox + v[0], oy + v[1]};
+                break;
+            case 'T': {
+                if (!read(2)) {
+                    return;
+                }
+                quadControl = previous == 'Q' || previous == 'T'
+                                  ? Point{2 * current.x - quadControl.x, 2 * current.y - quadControl.y}
+                                  : current;
+                path.QuadTo(quadControl.x, quadControl.y, ox + v[0], oy + v[1]);
+                break;
+            }
+            case 'A': {
+                bool large;
+                bool sweep;
+                if (!read(3) || !scanner.Flag(large) || !scanner.Flag(sweep) || !scanner.Number(v[3]) ||
+                    !scanner.Number(v[4])) {
+                    return;
+                }
+                path.ArcTo(v[0], v[1], v[2], large, sweep, ox + v[3], oy + v[4]);
+                break;
+            }
+            default:
+                return;
+        }
+        previous = upper;
+    }
+}
+
+// Anti-aliased scanline coverage over a float luma canvas
+class Canvas {
+public:
+    Canvas(size_t width, size_t height)
+        : width(width), height(height), pixels(width * height, 255.0f), coverage(width + 1, 0.0f) {}
+
+    void Fill(const std::vector<Polygon>& polygons, bool evenOdd, double luma, double alpha) {
+        if (alpha <= 0) {
+            return;
+        }
+        struct Edge {
+            double x0;
+            double y0;
+            double y1;
+            double slope;
+            int direction;
+        };
+        std::vector<Edge> edges;
+        for (const Polygon& polygon : polygons) {
+            size_t count = polygon.size();
+            for (size_t i = 0; i < count; i++) {
+                Point p = polygon[i];
+                Point q = polygon[(i + 1) % count];
+                if (p.y == q.y || !std::isfinite(p.x + p.y + q.x + q.y)) {
+                    continue;
+                }
+                int direction = 1;
+                if (p.y > q.y) {
+                    std::swap(p, q);
+                    direction = -1;
+                }
+                edges.push_back({p.x, p.y, q.y, (q.x - p.x) / (q.y - p.y), direction});
+            }
+        }
+        if (edges.empty()) {
+            return;
+        }
+        std::sort(edges.begin(), edges.end(), [](const Edge& l, const Edge& r) { return l.y0 < r.y0; });
+        double bottom = 0;
+        for (const Edge& edge : edges) {
+            bottom = std::max(bottom, edge.y1);
+        }
+        double top = std::max(0.0, std::floor(edges.front().y0));
+        size_t firstRow = static_cast<size_t>(top);
+        size_t lastRow = static_cast<size_t>(std::min(static_cast<double>(this->height), std::ceil(bottom)));
+
+        std::vector<const Edge*> active;
+        std::vector<std::pair<double, int>> crossings;
+        size_t next = 0;
+        for (size_t row = firstRow; row < lastRow; row++) {
+            size_t minX = this->width;
+            size_t maxX = 0;
+            for (int sample = 0; sample < kSamples; sample++) {
+                double y = row + (sample + 0.5) / kSamples;
+                while (next < edges.size() && edges[next].y0 <= y) {
+                    active.push_back(&edges[next++]);
+                }
+                auto finished = [y](const Edge* edge) { return edge->y1 <= y; };
+                active.erase(std::remove_if(active.begin(), active.end(), finished), active.end());
+
+                crossings.clear();
+                for (const Edge* edge : active) {
+                    crossings.push_back({edge->x0 + (y - edge->y0) * edge->slope, edge->direction});
+                }
+                std::sort(crossings.begin(), crossings.end());
+                int winding = 0;
+                for (size_t i = 0; i + 1 < crossings.size(); i++) {
+                    winding += evenOdd ? 1 : crossings[i].second;
+                    bool inside = evenOdd ? (winding & 1) != 0 : winding != 0;
+                    if (inside) {
+                        this->AddSpan(crossings[i].first, crossings[i + 1].first, minX, maxX);
+                    }
+                }
+            }
+
+            float* out = this->pixels.data() + row * this->width;
+            for (size_t x = minX; x <= maxX && x < this->width; x++) {
+                float amount = std::min(1.0f, this->coverage[x]) * static_cast<float>(alpha);
+                out[x] += (static_cast<float>(luma) - out[x]) * amount;
+                this->coverage[x] = 0;
+            }
+            this->coverage[this->width] = 0;
+        }
+    }
+
+    LumaPlane ToPlane() const {
+        LumaPlane plane;
+        plane.width = this->width;
+        plane.height = this->height;
+        plane.pixels.resize(this->pixels.size());
+        for (size_t i = 0; i < this->pixels.size(); i++) {
+            plane.pixels[i] = static_cast<uint8_t>(std::max(0.0f, std::min(255.0f, this->pixels[i] + 0.5f)));
+        }
+        return plane;
+    }
+
+private:
+    void AddSpan(double x0, double x1, size_t& minX, size_t& maxX) {
+        double a = std::max(0.0, x0);
+        double b = std::min(static_cast<double>(this->width), x1);
+        if (b <= a) {
+            return;
+        }
+        const float weight = 1.0f / kSamples;
+        size_t first = static_cast<size_t>(a);
+        size_t last = static_cast<size_t>(b);
+        if (first == last) {
+            this->coverage[first] += static_cast<float>(b - a) * weight;
+        } else {
+            this->coverage[first] += static_cast<float>(first + 1 - a) * weight;
+            for (size_t x = first + 1; x < last; x++) {
+                this->coverage[x] += weight;
+            }
+            this->coverage[last] += static_cast<float>(b - last) * weight;
+        }
+        minX = std::min(minX, first);
+        maxX = std::max(maxX, last);
+    }
+
+    size_t width;
+    size_t height;
+    std::vector<float> pixels;
+    // One spare slot so spans ending exactly at the right edge need no check
+    std::vector<float> coverage;
+};
+
+// Stroke outlines as positively wound quads per segment plus round joins
+// where the path turns, so the union fills under the nonzero rule
+std::vector<Polygon> StrokePolygons(const std::vector<Subpath>& paths, double halfWidth) {
+    std::vector<Polygon> result;
+    auto add = [&result](Polygon polygon) {
+        double area = 0;
+        for (size_t i = 0; i < polygon.size(); i++) {
+            const Point& p = polygon[i];
+            const Point& q = polygon[(i + 1) % polygon.size()];
+            area += p.x * q.y - q.x * p.y;
+        }
+        if (area < 0) {
+            std::reverse(polygon.begin(), polygon.end());
+        }
+        result.push_back(std::move(polygon));
+    };
+
+    for (const Subpath& path : paths) {
+        const Polygon& points = path.points;
+        size_t count = points.size();
+        size_t segments = path.closed ? count : count - 1;
+        for (size_t i = 0; i < segments; i++) {
+            const Point& p = points[i];
+            const Point& q = points[(i + 1) % count];
+            double length = std::hypot(q.x - p.x, q.y - p.y);
+            if (length == 0) {
+                continue;
+            }
+            double nx = -(q.y - p.y) / length * halfWidth;
+            double ny = (q.x - p.x) / length * halfWidth;
+            add({{p.x + nx, p.y + ny}, {q.x + nx, q.y + ny}, {q.x - nx, q.y - ny}, {p.x - nx, p.y - ny}});
+        }
+
+        if (halfWidth < 0.5) {
+            continue;
+        }
+        for (size_t i = path.closed ? 0 : 1; i < (path.closed ? count : count - 1); i++) {
+            const Point& before = points[(i + count - 1) % count];
+            const Point& at = points[i];
+            const Point& after = points[(i + 1) % count];
+            double inX = at.x - before.x;
+            double inY = at.y - before.y;
+            double outX = after.x - at.x;
+            double outY = after.y - at.y;
+            double turn = std::fabs(std::atan2(inX * outY - inY * outX, inX * outX + inY * outY));
+            // Flattened curves turn a little at every vertex; those need no join
+            if (turn < 0.2) {
+                continue;
+            }
+            Polygon join;
+            for (int k = 0; k < 16; k++) {
+                double angle = k * kPi / 8;
+                join.push_back({at.x + halfWidth * std::cos(angle), at.y + halfWidth * std::sin(angle)});
+            }
+            add(std::move(join));
+        }
+    }
+    return result;
+}
+
+class SvgRenderer {
+public:
+    SvgRenderer(const char* text, size_t length, size_t width) : text(text), end(text + length), width(width) {}
+
+    LumaPlane Render() {
+        const char* p = this->text;
+        while (p < this->end) {
+            p = static_cast<const char*>(std::memchr(p, '<', this->end - p));
+            if (!p) {
+                break;
+            }
+            p++;
+            if (this->StartsWith(p, "!--")) {
+                p = this->Skip(p, "-->");
+            } else if (this->StartsWith(p, "![CDATA[")) {
+                p = this->Skip(p, "]]>");
+            } else if (*p == '?' || *p == '!') {
+                p = this->Skip(p, ">");
+            } else if (*p == '/') {
+                p = this->Skip(p, ">");
+                if (!this->stack.empty()) {
+                    this->stack.pop_back();
+                }
+            } else {
+                p = this->ParseTag(p);
+            }
+        }
+        if (!this->canvas) {
+            throw SvgError("No <svg> element found");
+        }
+        return this->canvas->ToPlane();
+    }
+
+private:
+    bool StartsWith(const char* p, const char* prefix) const {
+        size_t length = std::strlen(prefix);
+        return static_cast<size_t>(this->end - p) >= length && std::memcmp(p, prefix, length) == 0;
+    }
+
+    const char* Skip(const char* p, const char* terminator) const {
+        const char* found = std::search(p, this->end, terminator, terminator + std::strlen(terminator));
+        return found == this->end ? this->end : found + std::strlen(terminator);
+    }
+
+    const char* ParseTag(const char* p) {
+        auto isName = [](char c) {
+            return !std::isspace(static_cast<unsigned char>(c)) && c != '/' && c != '>' && c != '=';
+        };
+        const char* nameStart = p;
+        while (p < this->end && isName(*p)) {
+            p++;
+        }
+        std::string name(nameStart, p);
+        size_t colon = name.find(':');
+        if (colon != std::string::npos) {
+            name = name.substr(colon + 1);
+        }
+
+        Attributes attributes;
+        bool selfClosing = false;
+        while (p < this->end) {
+            while (p < this->end && std::isspace(static_cast<unsigned char>(*p))) {
+                p++;
+            }
+            if (p >= this->end) {
+                break;
+            }
+            if (*p == '>') {
+                p++;
+                break;
+            }
+            if (*p == '/') {
+                selfClosing = true;
+                p++;
+                continue;
+            }
+            const char* attributeStart = p;
+            while (p < this->end && isName(*p)) {
+                p++;
+            }
+            std::string attribute(attributeStart, p);
+            while (p < this->end && std::isspace(static_cast<unsigned char>(*p))) {
+                p++;
+            }
+            if (p >= this->end || *p != '=') {
+                if (attribute.empty()) {
+                    p++;
+                }
+                continue;
+            }
+            p++;
+            while (p < this->end && std::isspace(static_cast<unsigned char>(*p))) {
+                p++;
+            }
+            if (p >= this->end || (*p != '"' && *p != '\'')) {
+                continue;
+            }
+            char quote = *p++;
+            const char* valueStart = p;
+            while (p < this->end && *p != quote) {
+                p++;
+            }
+            attributes.emplace_back(attribute, std::string(valueStart, p));
+            if (p < this->end) {
+                p++;
+            }
+        }
+
+        this->StartElement(name, attributes, selfClosing);
+        return p;
+    }
+
+    void StartElement(const std::string& name, const Attributes& attributes, bool selfClosing) {
+        State state;
+        if (!this->canvas) {
+            // Nothing renders before the root element
+            if (name != "svg") {
+                return;
+            }
+            state.matrix = this->SetupViewport(attributes);
+        } else {
+            state = this->stack.empty() ? State() : this->stack.back();
+        }
+
+        static const char* const hiddenContainers[] = {"defs",   "clipPath",       "mask",           "symbol",
+                                                       "pattern", "marker",        "linearGradient", "radialGradient",
+                                                       "style",  "text",           "title",          "desc",
+                                                       "metadata", "foreignObject", "script",        "use",
+                                                       "image",  "switch"};
+        if (!state.skip) {
+            for (const char* hidden : hiddenContainers) {
+                if (name == hidden) {
+                    state.skip = true;
+                    break;
+                }
+            }
+        }
+
+        if (!state.skip) {
+            ApplyStyle(state, attributes);
+            const std::string& transform = Attr(attributes, "transform");
+            if (!transform.empty()) {
+                state.matrix = state.matrix.Then(ParseTransform(transform));
+            }
+            if (name == "svg" && !this->stack.empty()) {
+                Matrix offset{1, 0, 0, 1, LengthOr(attributes, "x", 0), LengthOr(attributes, "y", 0)};
+                state.matrix = state.matrix.Then(offset);
+            }
+            if (!state.style.hidden) {
+                this->Draw(name, attributes, state);
+            }
+        }
+
+        if (!selfClosing) {
+            this->stack.push_back(state);
+        }
+    }
+
+    Matrix SetupViewport(const Attributes& attributes) {
+        double box[4];
+        Scanner scanner(Attr(attributes, "viewBox"));
+        bool hasViewBox = scanner.Number(box[0]) && scanner.Number(box[1]) && scanner.Number(box[2]) &&
+                          scanner.Number(box[3]) && box[2] > 0 && box[3] > 0;
+        if (!hasViewBox) {
+            box[0] = box[1] = 0;
+            if (!ParseLength(Attr(attributes, "width"), box[2]) || !ParseLength(Attr(attributes, "height"), box[3]) ||
+                box[2] <= 0 || box[3] <= 0) {
+                throw SvgError("SVG needs a viewBox or absolute width and height");
+            }
+        }
+
+        // Bounded as doubles: a huge or infinite height must not reach the
+        // size_t cast or wrap the pixel count
+        double scale = static_cast<double>(this->width) / box[2];
+        double rows = std::max(1.0, std::round(box[3] * scale));
+        if (this->width == 0 || !std::isfinite(scale) || !std::isfinite(rows) ||
+            rows > static_cast<double>(kMaxCanvasDots / this->width)) {
+            throw SvgError("SVG render size is out of range");
+        }
+        this->canvas.reset(new Canvas(this->width, static_cast<size_t>(rows)));
+        return Matrix{scale, 0, 0, scale, -box[0] * scale, -box[1] * scale};
+    }
+
+    void Draw(const std::string& name, const Attributes& attributes, const State& state) {
+        PathBuilder path(state.matrix);
+        if (name == "path") {
+            ParsePathData(Attr(attributes, "d"), path);
+        } else if (name == "rect") {
+            double x = LengthOr(attributes, "x", 0);
+            double y = LengthOr(attributes, "y", 0);
+            double w = LengthOr(attributes, "width", 0);
+            double h = LengthOr(attributes, "height", 0);
+            if (w <= 0 || h <= 0) {
+                return;
+            }
+            double rx = LengthOr(attributes, "rx", -1);
+            double ry = LengthOr(attributes, "ry", -1);
+            rx = rx < 0 ? std::max(0.0, ry) : rx;
+            ry = ry < 0 ? rx : ry;
+            rx = std::min(rx, w / 2);
+            ry = std::min(ry, h / 2);
+            if (rx > 0 && ry > 0) {
+                path.MoveTo(x + rx, y);
+                path.LineTo(x + w - rx, y);
+                path.ArcTo(rx, ry, 0, false, true, x + w, y + ry);
+                path.LineTo(x + w, y + h - ry);
+                path.ArcTo(rx, ry, 0, false, true, x + w - rx, y + h);
+                path.LineTo(x + rx, y + h);
+                path.ArcTo(rx, ry, 0, false, true, x, y + h - ry);
+                path.LineTo(x, y + ry);
+                path.ArcTo(rx, ry, 0, false, true, x + rx, y);
+            } else {
+                path.MoveTo(x, y);
+                path.LineTo(x + w, y);
+                path.LineTo(x + w, y + h);
+                path.LineTo(x, y + h);
+            }
+            path.Close();
+        } else if (name == "circle" || name == "ellipse") {
+            double cx = LengthOr(attributes, "cx", 0);
+            double cy = LengthOr(attributes, "cy", 0);
+            double rx = LengthOr(attributes, name == "circle" ? "r" : "rx", 0);
+            double ry = name == "circle" ? rx : LengthOr(attributes, "ry", 0);
+            if (rx <= 0 || ry <= 0) {
+                return;
+            }
+            path.MoveTo(cx + rx, cy);
+            path.ArcTo(rx, ry, 0, false, true, cx - rx, cy);
+            path.ArcTo(rx, ry, 0, false, true, cx + rx, cy);
+            path.Close();
+        } else if (name == "line") {
+            path.MoveTo(LengthOr(attributes, "x1", 0), LengthOr(attributes, "y1", 0));
+            path.LineTo(LengthOr(attributes, "x2", 0), LengthOr(attributes, "y2", 0));
+        } else if (name == "polyline" || name == "polygon") {
+            Scanner scanner(Attr(attributes, "points"));
+            double x;
+            double y;
+            bool first = true;
+            while (scanner.Number(x) && scanner.Number(y)) {
+                if (first) {
+                    path.MoveTo(x, y);
+                    first = false;
+                } else {
+                    path.LineTo(x, y);
+                }
+            }
+            if (name == "polygon") {
+                path.Close();
+            }
+        } else {
+            return;
+        }
+
+        std::vector<Subpath> subpaths = path.Finish();
+        if (subpaths.empty()) {
+            return;
+        }
+        const Style& style = state.style;
+        if (!style.fill.none) {
+            std::vector<Polygon> polygons;
+            for (const Subpath& subpath : subpaths) {
+                polygons.push_back(subpath.points);
+            }
+            this->canvas->Fill(polygons, style.evenOdd, style.fill.luma, style.fillOpacity * style.opacity);
+        }
+        if (!style.stroke.none && style.strokeWidth > 0) {
+            double halfWidth = style.strokeWidth / 2 * state.matrix.Scale();
+            this->canvas->Fill(StrokePolygons(subpaths, halfWidth), false, style.stroke.luma,
+                               style.strokeOpacity * style.opacity);
+        }
+    }
+
+    const char* text;
+    const char* end;
+    size_t width;
+    std::unique_ptr<Canvas> canvas;
+    std::vector<State> stack;
+};
+
+}  // namespace
+
+LumaPlane RenderSvg(const char* svg, size_t length, size_t width) { return SvgRenderer(svg, length, width).Render(); }
+
+}  // namespace escpos
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+
+#include "raster.h"
+
+namespace escpos {
+
+class SvgError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Renders an SVG document exactly `width` dots wide (height follows the
+// viewBox aspect ratio) into an anti-aliased luma plane over white paper.
+//
+// Supported: path, rect, circle, ellipse, line, polyline and polygon inside
+// nested g/svg groups; transforms; solid fill and stroke colours with
+// opacity; nonzero and evenodd fill rules; presentation attributes and
+// inline style="". Text, gradients (drawn in their fallback colour or
+// black), clipping, masks, <use> and CSS stylesheets are ignored.
+LumaPlane RenderSvg(const char* svg, size_t length, size_t width);
+
+}  // namespace escpos
@@ -0,0 +1,342 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace escpos {
+
+namespace {
+// Generation and index of the pool worker running on this thread; null and
+// -1 for foreign threads
+thread_local void* currentGeneration = nullptr;
+thread_local int currentWorker = -1;
+}
+
+ThreadPool& ThreadPool::Instance() {
+    static ThreadPool instance;
+    return instance;
+}
+
+ThreadPool::~ThreadPool() {
+    std::shared_ptr<Generation> generation;
+    {
+        std::unique_lock<std::shared_mutex> lock(this->configMutex);
+        generation = std::move(this->current);
+    }
+    if (generation) {
+        this->Stop(*generation);
+    }
+
+    // Lane threads finish what is queued (including retired generations
+    // being joined) and exit. Readers still running are stopped first:
+    // process.exit() on the main thread skips the environment's cleanup
+    // hooks, so nothing else ends them and the joins below would never return.
+    {
+        std::lock_guard<std::mutex> lock(this->laneMutex);
+        this->laneStopping = true;
+        for (CancelToken* stop : this->laneStops) {
+            stop->Cancel();
+        }
+    }
+    this->laneWake.notify_all();
+    for (auto& thread : this->laneThreads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+size_t ThreadPool::DefaultSize() {
+    // Same override convention as UV_THREADPOOL_SIZE
+    const char* env = std::getenv("ESCPOS_THREADPOOL_SIZE");
+    if (env) {
+        long requested = std::strtol(env, nullptr, 10);
+        if (requested > 0) {
+            return static_cast<size_t>(std::min<long>(requested, 64));
+        }
+    }
+
+    size_t cores = std::thread::hardware_concurrency();
+    return std::max<size_t>(2, std::min<size_t>(cores == 0 ? 4 : cores, 8));
+}
+
+void ThreadPool::Configure(size_t workerCount) {
+    if (workerCount == 0) {
+        workerCount = DefaultSize();
+    }
+
+    std::shared_ptr<Generation> retired;
+    {
+        std::unique_lock<std::shared_mutex> lock(this->configMutex);
+        if (this->current && this->current->workers.size() == workerCount) {
+            return;
+        }
+        retired = std::move(this->current);
+        this->current = this->Start(workerCount);
+    }
+
+    // The retired workers may be in the middle of a blocking write; the
+    // caller (the JS thread) does not wait for them
+    if (retired) {
+        this->SubmitBlocking([this, retired]() { this->Stop(*retired); });
+    }
+}
+
+std::shared_ptr<ThreadPool::Generation> ThreadPool::Start(size_t workerCount) {
+    auto generation = std::make_shared<Generation>();
+    generation->workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; i++) {
+        generation->workers.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < workerCount; i++) {
+        generation->workers[i]->thread = std::thread(&ThreadPool::Run, this, std::ref(*generation), i);
+    }
+    return generation;
+}
+
+void ThreadPool::Stop(Generation& generation) {
+    {
+        std::lock_guard<std::mutex> wakeLock(generation.wakeMutex);
+        generation.stopping = true;
+    }
+    generation.wake.notify_all();
+
+    for (auto& worker : generation.workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+void ThreadPool::Submit(Task task, TaskPriority priority) {
+    const size_t level = static_cast<size_t>(priority);
+
+    // Tasks spawned by a worker go to its own deque, even when its
+    // generation has been retired: it drains its queues before exiting
+    if (currentGeneration) {
+        this->Push(*static_cast<Generation*>(currentGeneration), static_cast<size_t>(currentWorker),
+                   std::move(task), level);
+        return;
+    }
+
+    // Held while pushing, so Configure() cannot retire the generation
+    // between choosing it and queueing the task
+    std::shared_lock<std::shared_mutex> lock(this->configMutex);
+    while (!this->current) {
+        lock.unlock();
+        {
+            std::unique_lock<std::shared_mutex> startLock(this->configMutex);
+            if (!this->current) {
+                this->current = this->Start(DefaultSize());
+            }
+        }
+        lock.lock();
+    }
+
+    Generation& generation = *this->current;
+    size_t index = this->nextWorker.fetch_add(1) % generation.workers.size();
+    this->Push(generation, index, std::move(task), level);
+}
+
+void ThreadPool::Push(Generation& generation, size_t index, Task task, size_t level) {
+    Worker& target = *generation.workers[index];
+    {
+        std::lock_guard<std::mutex> queueLock(target.mutex);
+        target.queues[level].push_back(std::move(task));
+        this->queued[level]++;
+    }
+
+    this->submitted++;
+    {
+        std::lock_guard<std::mutex> wakeLock(generation.wakeMutex);
+        generation.pending++;
+    }
+    generation.wake.notify_one();
+}
+
+std::future<void> ThreadPool::SubmitBlocking(Task task, CancelToken* stop) {
+    // The token is forgotten before the future is ready: its owner may
+    // destroy it as soon as it has waited
+    std::packaged_task<void()> job([this, task = std::move(task), stop]() {
+        try {
+            task();
+        } catch (...) {
+            this->ForgetStop(stop);
+            throw;
+        }
+        this->ForgetStop(stop);
+    });
+    std::future<void> done = job.get_future();
+    {
+        std::lock_guard<std::mutex> lock(this->laneMutex);
+        if (stop) {
+            this->laneStops.push_back(stop);
+        }
+        this->laneQueue.push_back(std::move(job));
+        // Each queued task needs a thread of its own: it may never return
+        if (this->laneQueue.size() > this->laneIdle) {
+            this->laneThreads.emplace_back(&ThreadPool::RunBlocking, this);
+        }
+    }
+    this->laneWake.notify_one();
+    return done;
+}
+
+void ThreadPool::RunBlocking() {
+    std::unique_lock<std::mutex> lock(this->laneMutex);
+    while (true) {
+        if (!this->laneQueue.empty()) {
+            std::packaged_task<void()> job = std::move(this->laneQueue.front());
+            this->laneQueue.pop_front();
+            lock.unlock();
+            job();
+            lock.lock();
+            continue;
+        }
+        if (this->laneStopping) {
+            break;
+        }
+
+        this->laneIdle++;
+        this->laneWake.wait(lock, [this] {
+            return !this->laneQueue.empty() || this->laneStopping;
+        });
+        this->laneIdle--;
+    }
+}
+
+void ThreadPool::ForgetStop(CancelToken* stop) {
+    if (!stop) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(this->laneMutex);
+    auto found = std::find(this->laneStops.begin(), this->laneStops.end(), stop);
+    if (found != this->laneStops.end()) {
+        this->laneStops.erase(found);
+    }
+}
+
+bool ThreadPool::PopLocal(Generation& generation, size_t index, Task& task) {
+    Worker& self = *generation.workers[index];
+    std::lock_guard<std::mutex> lock(self.mutex);
+    for (size_t level = 0; level < kPriorityLevels; level++) {
+        auto& queue = self.queues[level];
+        if (!queue.empty()) {
+            task = std::move(queue.back());
+            queue.pop_back();
+            this->queued[level]--;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::Steal(Generation& generation, size_t index, Task& task) {
+    const size_t count = generation.workers.size();
+    // Scan every victim for high-priority work before touching normal work
+    for (size_t level = 0; level < kPriorityLevels; level++) {
+        for (size_t offset = 1; offset < count; offset++) {
+            Worker& victim = *generation.workers[(index + offset) % count];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            auto& queue = victim.queues[level];
+            if (!queue.empty()) {
+                task = std::move(queue.front());
+                queue.pop_front();
+                this->queued[level]--;
+                this->steals++;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ThreadPool::Run(Generation& generation, size_t index) {
+    currentGeneration = &generation;
+    currentWorker = static_cast<int>(index);
+
+    while (true) {
+        Task task;
+        bool found = false;
+
+        // Local high, then stolen high, and only then any normal work
+        {
+            Worker& self = *generation.workers[index];
+            std::lock_guard<std::mutex> lock(self.mutex);
+            auto& high = self.queues[static_cast<size_t>(TaskPriority::High)];
+            if (!high.empty()) {
+                task = std::move(high.back());
+                high.pop_back();
+                this->queued[static_cast<size_t>(TaskPriority::High)]--;
+                found = true;
+            }
+        }
+        if (!found && this->queued[static_cast<size_t>(TaskPriority::High)] > 0) {
+            found = this->Steal(generation, index, task);
+        }
+        if (!found) {
+            found = this->PopLocal(generation, index, task) || this->Steal(generation, index, task);
+        }
+
+        if (found) {
+            {
+                std::lock_guard<std::mutex> wakeLock(generation.wakeMutex);
+                generation.pending--;
+            }
+            task();
+            this->executed++;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> wakeLock(generation.wakeMutex);
+        if (generation.stopping && generation.pending <= 0) {
+            break;
+        }
+        generation.wake.wait(wakeLock, [&generation] {
+            return generation.pending > 0 || generation.stopping;
+        });
+        if (generation.stopping && generation.pending <= 0) {
+            break;
+        }
+    }
+
+    currentGeneration = nullptr;
+    currentWorker = -1;
+}
+
+size_t ThreadPool::Size() const {
+    std::shared_lock<std::shared_mutex> lock(this->configMutex);
+    return this->current ? this->current->workers.size() : 0;
+}
+
+ThreadPoolStats ThreadPool::Stats() const {
+    ThreadPoolStats stats;
+    {
+        std::shared_lock<std::shared_mutex> lock(this->configMutex);
+        if (this->current) {
+            stats.workers = this->current->workers.size();
+            for (const auto& worker : this->current->workers) {
+                std::lock_guard<std::mutex> queueLock(worker->mutex);
+                size_t depth = 0;
+                for (size_t level = 0; level < kPriorityLevels; level++) {
+                    depth += worker->queues[level].size();
+                }
+                stats.workerQueueDepth.push_back(depth);
+            }
+        }
+    }
+    stats.queuedHigh = this->queued[static_cast<size_t>(TaskPriority::High)];
+    stats.queuedNormal = this->queued[static_cast<size_t>(TaskPriority::Normal)];
+    stats.submitted = this->submitted;
+    stats.executed = this->executed;
+    stats.steals = this->steals;
+
+    {
+        std::lock_guard<std::mutex> lock(this->laneMutex);
+        stats.blockingThreads = this->laneThreads.size();
+        stats.blockingActive = this->laneThreads.size() - this->laneIdle;
+    }
+    return stats;
+}
+
+}  // namespace escpos
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "cancel_token.h"
+
+namespace escpos {
+
+// I/O completions are always drained before image/encoding work
+enum class TaskPriority {
+    High = 0,
+    Normal = 1
+};
+
+struct ThreadPoolStats {
+    size_t workers = 0;
+    size_t queuedHigh = 0;
+    size_t queuedNormal = 0;
+    std::vector<size_t> workerQueueDepth;
+    uint64_t submitted = 0;
+    uint64_t executed = 0;
+    uint64_t steals = 0;
+    // Blocking lane: threads kept for long-running readers, and how many run one
+    size_t blockingThreads = 0;
+    size_t blockingActive = 0;
+};
+
+// Work-stealing pool shared by every native subsystem of the addon.
+// Each worker owns a deque per priority; the owner pops from the back,
+// idle workers steal from the front of their siblings' deques.
+//
+// Tasks that block for their whole life (a scanner or scale reader) go to
+// the blocking lane instead, so they never hold a work-stealing worker.
+// The lane reuses idle threads and grows to the number of such tasks.
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    static ThreadPool& Instance();
+
+    ~ThreadPool();
+
+    // Swaps in a new worker set. The old workers drain their queued tasks
+    // and are joined from the blocking lane, not by the caller.
+    void Configure(size_t workerCount);
+    void Submit(Task task, TaskPriority priority = TaskPriority::Normal);
+    // Runs task on the blocking lane; the future is ready once it returned.
+    // stop, when given, is cancelled if the pool is torn down (process exit)
+    // while the task still runs; it must outlive the task.
+    std::future<void> SubmitBlocking(Task task, CancelToken* stop = nullptr);
+
+    size_t Size() const;
+    ThreadPoolStats Stats() const;
+
+    static size_t DefaultSize();
+
+private:
+    static constexpr size_t kPriorityLevels = 2;
+
+    struct Worker {
+        mutable std::mutex mutex;
+        std::deque<Task> queues[kPriorityLevels];
+        std::thread thread;
+    };
+
+    // One worker set. Configure() retires a generation while its workers
+    // may still be running, so each keeps its own queues and wakeup.
+    struct Generation {
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::mutex wakeMutex;
+        std::condition_variable wake;
+        long pending = 0;
+        bool stopping = false;
+    };
+
+    ThreadPool() = default;
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::shared_ptr<Generation> Start(size_t workerCount);
+    void Stop(Generation& generation);
+    void Push(Generation& generation, size_t index, Task task, size_t level);
+    void Run(Generation& generation, size_t index);
+    bool PopLocal(Generation& generation, size_t index, Task& task);
+    bool Steal(Generation& generation, size_t index, Task& task);
+    void RunBlocking();
+    void ForgetStop(CancelToken* stop);
+
+    mutable std::shared_mutex configMutex;
+    std::shared_ptr<Generation> current;
+    std::atomic<size_t> nextWorker{0};
+    std::atomic<uint64_t> submitted{0};
+    std::atomic<uint64_t> executed{0};
+    std::atomic<uint64_t> steals{0};
+    std::atomic<size_t> queued[kPriorityLevels] = {};
+
+    mutable std::mutex laneMutex;
+    std::condition_variable laneWake;
+    std::deque<std::packaged_task<void()>> laneQueue;
+    std::vector<std::thread> laneThreads;
+    // Stop tokens of the lane tasks queued or running
+    std::vector<CancelToken*> laneStops;
+    size_t laneIdle = 0;
+    bool laneStopping = false;
+};
+
+}  // namespace escpos
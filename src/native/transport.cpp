@@ -0,0 +1,304 @@
+#include "transport.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+
+#include "thread_pool.h"
+
+namespace escpos {
+
+static std::string PercentDecode(const std::string& value) {
+    std::string decoded;
+    decoded.reserve(value.size());
+    for (size_t i = 0; i < value.size(); i++) {
+        if (value[i] == '%' && i + 2 < value.size() && std::isxdigit(static_cast<unsigned char>(value[i + 1])) &&
+            std::isxdigit(static_cast<unsigned char>(value[i + 2]))) {
+            decoded.push_back(static_cast<char>(std::strtol(value.substr(i + 1, 2).c_str(), nullptr, 16)));
+            i += 2;
+        } else if (value[i] == '+') {
+            decoded.push_back(' ');
+        } else {
+            decoded.push_back(value[i]);
+        }
+    }
+    return decoded;
+}
+
+TransportUri TransportUri::Parse(const std::string& uri) {
+    TransportUri parsed;
+
+    size_t schemeEnd = uri.find("://");
+    if (schemeEnd == std::string::npos || schemeEnd == 0) {
+        throw TransportError("Invalid transport URI: " + uri, "EINVAL");
+    }
+    parsed.scheme = uri.substr(0, schemeEnd);
+    std::transform(parsed.scheme.begin(), parsed.scheme.end(), parsed.scheme.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    std::string rest = uri.substr(schemeEnd + 3);
+    size_t queryStart = rest.find('?');
+    if (queryStart != std::string::npos) {
+        std::string query = rest.substr(queryStart + 1);
+        rest = rest.substr(0, queryStart);
+
+        size_t pos = 0;
+        while (pos <= query.size()) {
+            size_t amp = query.find('&', pos);
+            std::string pair = query.substr(pos, amp == std::string::npos ? std::string::npos : amp - pos);
+            if (!pair.empty()) {
+                size_t eq = pair.find('=');
+                std::string key = PercentDecode(pair.substr(0, eq));
+                parsed.query[key] = eq == std::string::npos ? "" : PercentDecode(pair.substr(eq + 1));
+            }
+            if (amp == std::string::npos) {
+                break;
+            }
+            pos = amp + 1;
+        }
+    }
+
+    size_t pathStart = rest.find('/');
+    std::string authority = rest.substr(0, pathStart);
+    if (pathStart != std::string::npos) {
+        parsed.path = PercentDecode(rest.substr(pathStart));
+    }
+
+    // [v6]:port, host:port or a bare host / printer name
+    size_t portSep = authority.rfind(':');
+    size_t bracket = authority.rfind(']');
+    if (portSep != std::string::npos && (bracket == std::string::npos || portSep > bracket)) {
+        std::string port = authority.substr(portSep + 1);
+        char* end = nullptr;
+        long value = std::strtol(port.c_str(), &end, 10);
+        if (port.empty() || *end != '\0' || value <= 0 || value > 65535) {
+            throw TransportError("Invalid port in transport URI: " + uri, "EINVAL");
+        }
+        parsed.port = static_cast<int>(value);
+        authority = authority.substr(0, portSep);
+    }
+    if (authority.size() >= 2 && authority.front() == '[' && authority.back() == ']') {
+        authority = authority.substr(1, authority.size() - 2);
+    }
+    parsed.host = PercentDecode(authority);
+
+    return parsed;
+}
+
+std::string TransportUri::Param(const std::string& key, const std::string& fallback) const {
+    auto it = this->query.find(key);
+    return it == this->query.end() ? fallback : it->second;
+}
+
+int64_t TransportUri::IntParam(const std::string& key, int64_t fallback) const {
+    auto it = this->query.find(key);
+    if (it == this->query.end() || it->second.empty()) {
+        return fallback;
+    }
+    char* end = nullptr;
+    long long value = std::strtoll(it->second.c_str(), &end, 10);
+    if (*end != '\0') {
+        throw TransportError("Invalid value for '" + key + "': " + it->second, "EINVAL");
+    }
+    return static_cast<int64_t>(value);
+}
+
+WriteOutcome Transport::WriteJob(const uint8_t* data, size_t length, const Deadline& deadline, CancelToken& token,
+                                 size_t& written) {
+    this->jobs.fetch_add(1, std::memory_order_relaxed);
+    this->BeginJob();
+    WriteOutcome outcome = this->WriteAll(data, length, deadline, token, written);
+    this->EndJob(outcome);
+    return outcome;
+}
+
+WriteOutcome Transport::WriteAll(const uint8_t* data, size_t length, const Deadline& deadline, CancelToken& token,
+                                 size_t& written) {
+    auto started = Clock::now();
+    WriteOutcome outcome = WriteOutcome::Ok;
+
+    written = 0;
+    while (written < length) {
+        if (token.IsCancelled()) {
+            outcome = WriteOutcome::Cancelled;
+            break;
+        }
+        if (deadline.Expired()) {
+            outcome = WriteOutcome::TimedOut;
+            break;
+        }
+
+        size_t chunk = std::min(this->chunkSize, length - written);
+        size_t accepted = 0;
+        outcome = this->WriteChunk(data + written, chunk, deadline, token, accepted);
+        written += accepted;
+        if (accepted > 0) {
+            this->chunksWritten.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (outcome != WriteOutcome::Ok) {
+            break;
+        }
+    }
+
+    // A write interrupted by Cancel() can surface as a plain I/O failure
+    if (outcome == WriteOutcome::Failed && token.IsCancelled()) {
+        outcome = WriteOutcome::Cancelled;
+    }
+
+    this->bytesWritten.fetch_add(written, std::memory_order_relaxed);
+    this->busyMicros.fetch_add(
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - started).count(),
+        std::memory_order_relaxed);
+    switch (outcome) {
+        case WriteOutcome::TimedOut:
+            this->timeouts.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case WriteOutcome::Cancelled:
+            this->cancellations.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case WriteOutcome::Failed:
+            this->errors.fetch_add(1, std::memory_order_relaxed);
+            break;
+        default:
+            break;
+    }
+    return outcome;
+}
+
+TransportMetrics Transport::Metrics() const {
+    TransportMetrics metrics;
+    metrics.jobs = this->jobs.load(std::memory_order_relaxed);
+    metrics.bytesWritten = this->bytesWritten.load(std::memory_order_relaxed);
+    metrics.chunksWritten = this->chunksWritten.load(std::memory_order_relaxed);
+    metrics.stalls = this->stalls.load(std::memory_order_relaxed);
+    metrics.timeouts = this->timeouts.load(std::memory_order_relaxed);
+    metrics.cancellations = this->cancellations.load(std::memory_order_relaxed);
+    metrics.errors = this->errors.load(std::memory_order_relaxed);
+    metrics.busyMicros = this->busyMicros.load(std::memory_order_relaxed);
+    return metrics;
+}
+
+std::string Transport::LastError() const {
+    std::lock_guard<std::mutex> lock(this->errorMutex);
+    return this->lastError;
+}
+
+void Transport::SetLastError(const std::string& message) {
+    std::lock_guard<std::mutex> lock(this->errorMutex);
+    this->lastError = message;
+}
+
+EmuTransport::EmuTransport(TransportUri uri) : Transport(std::move(uri)) {
+    this->bitsPerSecond = this->uri.IntParam("bps", 0);
+    this->chunkSize = static_cast<size_t>(std::max<int64_t>(1, this->uri.IntParam("chunk", 4096)));
+}
+
+void EmuTransport::Open(const Deadline&, CancelToken&) {
+    this->open = true;
+}
+
+void EmuTransport::Close() {
+    this->open = false;
+}
+
+std::string EmuTransport::TakeOutput() {
+    std::lock_guard<std::mutex> lock(this->outputMutex);
+    std::string taken;
+    taken.swap(this->output);
+    return taken;
+}
+
+WriteOutcome EmuTransport::WriteChunk(const uint8_t* data, size_t length, const Deadline& deadline,
+                                      CancelToken& token, size_t& accepted) {
+    if (!this->open) {
+        this->SetLastError("Transport is closed");
+        return WriteOutcome::Failed;
+    }
+
+    if (this->bitsPerSecond > 0) {
+        // Ten bits on the wire per byte: start, eight data, stop
+        int64_t drainMs = static_cast<int64_t>(length) * 10000 / this->bitsPerSecond;
+        this->NoteStall();
+        // Waited in slices: a large chunk on a slow line may drain for longer
+        // than one WaitFor() can sleep
+        const Clock::time_point drained = Clock::now() + std::chrono::milliseconds(drainMs);
+        while (true) {
+            int64_t leftMs =
+                std::chrono::duration_cast<std::chrono::milliseconds>(drained - Clock::now()).count();
+            if (leftMs <= 0) {
+                break;
+            }
+            if (deadline.Expired()) {
+                return WriteOutcome::TimedOut;
+            }
+            if (token.WaitFor(deadline.RemainingMs(static_cast<int>(std::min<int64_t>(leftMs, 60000))))) {
+                return WriteOutcome::Cancelled;
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(this->outputMutex);
+    this->output.append(reinterpret_cast<const char*>(data), length);
+    accepted = length;
+    return WriteOutcome::Ok;
+}
+
+WriteOutcome RunInterruptible(std::function<void()> call, std::function<void()> abandon, const Deadline& deadline,
+                              CancelToken& token) {
+    struct State {
+        std::mutex mutex;
+        std::condition_variable settled;
+        bool done = false;
+        bool abandoned = false;
+    };
+    auto state = std::make_shared<State>();
+
+    ThreadPool::Instance().SubmitBlocking([state, call = std::move(call), abandon = std::move(abandon)]() {
+        call();
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->done = true;
+        if (state->abandoned) {
+            abandon();
+        } else {
+            state->settled.notify_all();
+        }
+    });
+
+    // The token has no waitable handle shared by both platforms, so it is
+    // checked between short waits
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while (!state->done) {
+        if (token.IsCancelled() || deadline.Expired()) {
+            state->abandoned = true;
+            return token.IsCancelled() ? WriteOutcome::Cancelled : WriteOutcome::TimedOut;
+        }
+        state->settled.wait_for(lock, std::chrono::milliseconds(deadline.RemainingMs(20)));
+    }
+    return WriteOutcome::Ok;
+}
+
+std::unique_ptr<Transport> CreateTransport(const std::string& uri) {
+    TransportUri parsed = TransportUri::Parse(uri);
+
+    if (parsed.scheme == "emu") {
+        return std::make_unique<EmuTransport>(std::move(parsed));
+    }
+    if (parsed.scheme == "file") {
+        return CreateFileTransport(std::move(parsed));
+    }
+    if (parsed.scheme == "tcp") {
+        return CreateTcpTransport(std::move(parsed));
+    }
+    if (parsed.scheme == "serial") {
+        return CreateSerialTransport(std::move(parsed));
+    }
+    if (parsed.scheme == "spool") {
+        return CreateSpoolTransport(std::move(parsed));
+    }
+
+    throw TransportError("Unsupported transport scheme: " + parsed.scheme, "EINVAL");
+}
+
+}  // namespace escpos
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "cancel_token.h"
+
+namespace escpos {
+
+// Raised by Open() and the URI parser; code becomes error.code in JS
+class TransportError : public std::runtime_error {
+public:
+    TransportError(const std::string& message, const std::string& code = "EIO")
+        : std::runtime_error(message), code(code) {}
+
+    const std::string& Code() const { return this->code; }
+
+private:
+    std::string code;
+};
+
+// scheme://host:port/path?key=value
+//   spool://POS-80          host = printer name
+//   file:///dev/usb/lp0     path = /dev/usb/lp0
+//   tcp://10.0.0.5:9100     host, port
+//   serial:///dev/ttyUSB0?baud=115200&flow=rtscts
+//   emu://?bps=9600
+struct TransportUri {
+    std::string scheme;
+    std::string host;
+    int port = 0;
+    std::string path;
+    std::map<std::string, std::string> query;
+
+    static TransportUri Parse(const std::string& uri);
+
+    std::string Param(const std::string& key, const std::string& fallback = "") const;
+    int64_t IntParam(const std::string& key, int64_t fallback) const;
+};
+
+enum class WriteOutcome {
+    Ok,
+    Failed,
+    Cancelled,
+    TimedOut
+};
+
+struct TransportMetrics {
+    uint64_t jobs = 0;
+    uint64_t bytesWritten = 0;
+    uint64_t chunksWritten = 0;
+    // Times a writer had to wait for the device (flow control, full buffers)
+    uint64_t stalls = 0;
+    uint64_t timeouts = 0;
+    uint64_t cancellations = 0;
+    uint64_t errors = 0;
+    uint64_t busyMicros = 0;
+};
+
+// A byte sink for one printer connection. Backends only implement opening,
+// closing and a single bounded WriteChunk(); chunking, deadlines,
+// cancellation and metrics are shared through WriteAll().
+class Transport {
+public:
+    explicit Transport(TransportUri uri) : uri(std::move(uri)) {}
+    virtual ~Transport() = default;
+
+    Transport(const Transport&) = delete;
+    Transport& operator=(const Transport&) = delete;
+
+    virtual void Open(const Deadline& deadline, CancelToken& token) = 0;
+    virtual void Close() = 0;
+    virtual bool IsOpen() const = 0;
+
+    // Job framing for backends with a document model (the spooler)
+    virtual void BeginJob() {}
+    virtual void EndJob(WriteOutcome outcome) {}
+
+    // Wakes a writer blocked in a call that cannot poll the cancel token
+    virtual void Interrupt() {}
+
+    WriteOutcome WriteJob(const uint8_t* data, size_t length, const Deadline& deadline, CancelToken& token,
+                          size_t& written);
+    WriteOutcome WriteAll(const uint8_t* data, size_t length, const Deadline& deadline, CancelToken& token,
+                          size_t& written);
+
+    TransportMetrics Metrics() const;
+    std::string LastError() const;
+    const TransportUri& Uri() const { return this->uri; }
+
+protected:
+    // Writes up to length bytes, waiting until the deadline for the device
+    // to accept at least one. accepted may be less than length.
+    virtual WriteOutcome WriteChunk(const uint8_t* data, size_t length, const Deadline& deadline,
+                                    CancelToken& token, size_t& accepted) = 0;
+
+    void SetLastError(const std::string& message);
+    void NoteStall() { this->stalls.fetch_add(1, std::memory_order_relaxed); }
+
+    TransportUri uri;
+    size_t chunkSize = 4096;
+
+private:
+    std::atomic<uint64_t> jobs{0};
+    std::atomic<uint64_t> bytesWritten{0};
+    std::atomic<uint64_t> chunksWritten{0};
+    std::atomic<uint64_t> stalls{0};
+    std::atomic<uint64_t> timeouts{0};
+    std::atomic<uint64_t> cancellations{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> busyMicros{0};
+
+    mutable std::mutex errorMutex;
+    std::string lastError;
+};
+
+// Records everything written; bps > 0 paces writes like a serial line (8N1)
+class EmuTransport : public Transport {
+public:
+    explicit EmuTransport(TransportUri uri);
+
+    void Open(const Deadline& deadline, CancelToken& token) override;
+    void Close() override;
+    bool IsOpen() const override { return this->open; }
+
+    std::string TakeOutput();
+
+protected:
+    WriteOutcome WriteChunk(const uint8_t* data, size_t length, const Deadline& deadline, CancelToken& token,
+                            size_t& accepted) override;
+
+private:
+    std::atomic<bool> open{false};
+    int64_t bitsPerSecond;
+    std::mutex outputMutex;
+    std::string output;
+};
+
+std::unique_ptr<Transport> CreateTransport(const std::string& uri);
+
+// Runs a call that cannot watch the cancel token (getaddrinfo) on the pool's
+// blocking lane and waits for it until the deadline passes or the token is
+// cancelled. If the caller gives up first, abandon runs once the call
+// returns, to free whatever it produced.
+WriteOutcome RunInterruptible(std::function<void()> call, std::function<void()> abandon, const Deadline& deadline,
+                              CancelToken& token);
+
+// Platform backends (transport_posix.cpp, transport_serial.cpp / transport_win.cpp)
+std::unique_ptr<Transport> CreateFileTransport(TransportUri uri);
+std::unique_ptr<Transport> CreateTcpTransport(TransportUri uri);
+std::unique_ptr<Transport> CreateSerialTransport(TransportUri uri);
+std::unique_ptr<Transport> CreateSpoolTransport(TransportUri uri);
+
+}  // namespace escpos
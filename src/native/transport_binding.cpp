@@ -0,0 +1,323 @@
+#include <napi.h>
+
+#include <atomic>
+#include <memory>
+
+#include "addon.h"
+#include "pool_task.h"
+#include "serial_latency.h"
+#include "transport.h"
+
+namespace escpos {
+
+// JS face of a Transport: open()/write() settle on the shared pool at I/O
+// priority, cancel() interrupts whichever of them is in flight.
+class TransportWrap : public Napi::ObjectWrap<TransportWrap> {
+public:
+    static void Init(Napi::Env env, Napi::Object exports);
+    TransportWrap(const Napi::CallbackInfo& info);
+
+private:
+    Napi::Value Open(const Napi::CallbackInfo& info);
+    Napi::Value Write(const Napi::CallbackInfo& info);
+    Napi::Value Cancel(const Napi::CallbackInfo& info);
+    Napi::Value Close(const Napi::CallbackInfo& info);
+    Napi::Value IsOpen(const Napi::CallbackInfo& info);
+    Napi::Value GetMetrics(const Napi::CallbackInfo& info);
+    Napi::Value TakeOutput(const Napi::CallbackInfo& info);
+
+    bool BeginOperation(Napi::Env env);
+    void EndOperation();
+
+    std::unique_ptr<Transport> transport;
+    CancelToken cancelToken;
+    std::atomic<bool> busy{false};
+    bool closeRequested = false;
+
+    friend class TransportTask;
+};
+
+// Pins the wrapper (and, for writes, the JS buffer) until the operation settles
+class TransportTask : public PoolTask {
+public:
+    TransportTask(Napi::Env env, TransportWrap* owner, int64_t timeoutMs)
+        : PoolTask(env), owner(owner), deadline(Deadline::After(timeoutMs)) {
+        this->owner->Ref();
+    }
+
+protected:
+    void Execute() override {
+        try {
+            this->Run(*this->owner->transport);
+        } catch (const TransportError& e) {
+            this->SetError(e.what(), e.Code());
+        }
+    }
+
+    virtual void Run(Transport& transport) = 0;
+
+    // Friendship is not inherited; subclasses reach the token through here
+    CancelToken& Token() { return this->owner->cancelToken; }
+
+    void OnSettled(Napi::Env env) override {
+        this->owner->EndOperation();
+        this->owner->Unref();
+    }
+
+    void ReportOutcome(Transport& transport, WriteOutcome outcome) {
+        switch (outcome) {
+            case WriteOutcome::Ok:
+                break;
+            case WriteOutcome::Cancelled:
+                this->SetError("Print job cancelled", "ECANCELED");
+                break;
+            case WriteOutcome::TimedOut:
+                this->SetError("Print job timed out", "ETIMEDOUT");
+                break;
+            default: {
+                std::string detail = transport.LastError();
+                this->SetError(detail.empty() ? "Transport write failed" : detail, "EIO");
+                break;
+            }
+        }
+    }
+
+    TransportWrap* owner;
+    Deadline deadline;
+};
+
+class TransportOpenTask : public TransportTask {
+public:
+    using TransportTask::TransportTask;
+
+protected:
+    void Run(Transport& transport) override {
+        transport.Open(this->deadline, this->Token());
+    }
+};
+
+class TransportWriteTask : public TransportTask {
+public:
+    TransportWriteTask(Napi::Env env, TransportWrap* owner, Napi::Buffer<uint8_t> buffer, int64_t timeoutMs)
+        : TransportTask(env, owner, timeoutMs),
+          bufferRef(Napi::Persistent(buffer)),
+          data(buffer.Data()),
+          length(buffer.Length()) {}
+
+protected:
+    void Run(Transport& transport) override {
+        if (!transport.IsOpen()) {
+            throw TransportError("Transport is not open", "ENOTCONN");
+        }
+        WriteOutcome outcome =
+            transport.WriteJob(this->data, this->length, this->deadline, this->Token(), this->written);
+        this->ReportOutcome(transport, outcome);
+    }
+
+    Napi::Value GetResult(Napi::Env env) override {
+        return Napi::Number::New(env, static_cast<double>(this->written));
+    }
+
+    void OnSettled(Napi::Env env) override {
+        this->bufferRef.Reset();
+        TransportTask::OnSettled(env);
+    }
+
+private:
+    Napi::Reference<Napi::Buffer<uint8_t>> bufferRef;
+    const uint8_t* data;
+    size_t length;
+    size_t written = 0;
+};
+
+void TransportWrap::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "Transport", {
+        InstanceMethod("open", &TransportWrap::Open),
+        InstanceMethod("write", &TransportWrap::Write),
+        InstanceMethod("cancel", &TransportWrap::Cancel),
+        InstanceMethod("close", &TransportWrap::Close),
+        InstanceMethod("isOpen", &TransportWrap::IsOpen),
+        InstanceMethod("getMetrics", &TransportWrap::GetMetrics),
+        InstanceMethod("takeOutput", &TransportWrap::TakeOutput)
+    });
+
+    exports.Set("Transport", func);
+}
+
+TransportWrap::TransportWrap(const Napi::CallbackInfo& info) : Napi::ObjectWrap<TransportWrap>(info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Transport URI expected").ThrowAsJavaScriptException();
+        return;
+    }
+
+    try {
+        this->transport = CreateTransport(info[0].As<Napi::String>().Utf8Value());
+    } catch (const TransportError& e) {
+        Napi::Error error = Napi::Error::New(env, e.what());
+        error.Set("code", Napi::String::New(env, e.Code()));
+        error.ThrowAsJavaScriptException();
+    }
+}
+
+bool TransportWrap::BeginOperation(Napi::Env env) {
+    if (!this->transport) {
+        Napi::Error::New(env, "Transport was not created").ThrowAsJavaScriptException();
+        return false;
+    }
+    if (this->busy.exchange(true)) {
+        Napi::Error error = Napi::Error::New(env, "Transport is busy");
+        error.Set("code", Napi::String::New(env, "EBUSY"));
+        error.ThrowAsJavaScriptException();
+        return false;
+    }
+    this->closeRequested = false;
+    this->cancelToken.Reset();
+    return true;
+}
+
+void TransportWrap::EndOperation() {
+    this->busy = false;
+    if (this->closeRequested) {
+        this->closeRequested = false;
+        this->transport->Close();
+    }
+}
+
+static int64_t TimeoutArg(const Napi::CallbackInfo& info, size_t index) {
+    return info.Length() > index && info[index].IsNumber() ? info[index].As<Napi::Number>().Int64Value() : 0;
+}
+
+Napi::Value TransportWrap::Open(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (!this->BeginOperation(env)) {
+        return env.Null();
+    }
+
+    auto* task = new TransportOpenTask(env, this, TimeoutArg(info, 0));
+    return task->Queue(TaskPriority::High);
+}
+
+Napi::Value TransportWrap::Write(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsBuffer()) {
+        Napi::TypeError::New(env, "Buffer expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (!this->BeginOperation(env)) {
+        return env.Null();
+    }
+
+    auto* task = new TransportWriteTask(env, this, info[0].As<Napi::Buffer<uint8_t>>(), TimeoutArg(info, 1));
+    return task->Queue(TaskPriority::High);
+}
+
+Napi::Value TransportWrap::Cancel(const Napi::CallbackInfo& info) {
+    this->cancelToken.Cancel();
+    if (this->transport) {
+        this->transport->Interrupt();
+    }
+    return info.Env().Undefined();
+}
+
+Napi::Value TransportWrap::Close(const Napi::CallbackInfo& info) {
+    if (this->transport) {
+        if (this->busy) {
+            // The pool worker still uses the connection; close once it lets go
+            this->closeRequested = true;
+            this->cancelToken.Cancel();
+            this->transport->Interrupt();
+        } else {
+            this->transport->Close();
+        }
+    }
+    return info.Env().Undefined();
+}
+
+Napi::Value TransportWrap::IsOpen(const Napi::CallbackInfo& info) {
+    return Napi::Boolean::New(info.Env(), this->transport && this->transport->IsOpen());
+}
+
+Napi::Value TransportWrap::GetMetrics(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Object result = Napi::Object::New(env);
+    if (!this->transport) {
+        return result;
+    }
+
+    TransportMetrics metrics = this->transport->Metrics();
+    result.Set("scheme", Napi::String::New(env, this->transport->Uri().scheme));
+    result.Set("jobs", static_cast<double>(metrics.jobs));
+    result.Set("bytesWritten", static_cast<double>(metrics.bytesWritten));
+    result.Set("chunksWritten", static_cast<double>(metrics.chunksWritten));
+    result.Set("stalls", static_cast<double>(metrics.stalls));
+    result.Set("timeouts", static_cast<double>(metrics.timeouts));
+    result.Set("cancellations", static_cast<double>(metrics.cancellations));
+    result.Set("errors", static_cast<double>(metrics.errors));
+    result.Set("busyMs", static_cast<double>(metrics.busyMicros) / 1000.0);
+    return result;
+}
+
+Napi::Value TransportWrap::TakeOutput(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    auto* emu = dynamic_cast<EmuTransport*>(this->transport.get());
+    if (!emu) {
+        Napi::TypeError::New(env, "takeOutput() is only available on emu:// transports").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::string output = emu->TakeOutput();
+    return Napi::Buffer<uint8_t>::Copy(env, reinterpret_cast<const uint8_t*>(output.data()), output.size());
+}
+
+static Napi::Object TuningStepObject(Napi::Env env, const TuningStep& step) {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("status", Napi::String::New(env, TuningStatusName(step.status)));
+    if (!step.detail.empty()) {
+        result.Set("detail", Napi::String::New(env, step.detail));
+    }
+    return result;
+}
+
+// configureSerialLatency(fd, { raw, lowLatency, latencyTimerMs }) tunes a tty opened elsewhere
+// (the serialport binding) and reports each step. Synchronous: a few ioctls and a sysfs write.
+static Napi::Value ConfigureSerialLatencyBinding(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "File descriptor expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    SerialLatencyOptions options;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object given = info[1].As<Napi::Object>();
+        if (given.Get("raw").IsBoolean()) {
+            options.raw = given.Get("raw").As<Napi::Boolean>().Value();
+        }
+        if (given.Get("lowLatency").IsBoolean()) {
+            options.lowLatency = given.Get("lowLatency").As<Napi::Boolean>().Value();
+        }
+        if (given.Get("latencyTimerMs").IsNumber()) {
+            options.latencyTimerMs = given.Get("latencyTimerMs").As<Napi::Number>().Int32Value();
+        }
+    }
+
+    SerialLatencyReport report = ConfigureSerialLatency(info[0].As<Napi::Number>().Int32Value(), options);
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("raw", TuningStepObject(env, report.raw));
+    result.Set("lowLatency", TuningStepObject(env, report.lowLatency));
+    result.Set("latencyTimer", TuningStepObject(env, report.latencyTimer));
+    result.Set("latencyTimerMs", Napi::Number::New(env, report.latencyTimerMs));
+    return result;
+}
+
+void InitTransport(Napi::Env env, Napi::Object exports) {
+    TransportWrap::Init(env, exports);
+    exports.Set("configureSerialLatency", Napi::Function::New(env, ConfigureSerialLatencyBinding));
+}
+
+}  // namespace escpos
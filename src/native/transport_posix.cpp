@@ -0,0 +1,166 @@
+#ifndef _WIN32
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "transport_posix.h"
+
+namespace escpos {
+
+// file:///dev/usb/lp0, a FIFO or a plain file (appended to)
+class FileTransport : public FdTransport {
+public:
+    using FdTransport::FdTransport;
+
+    void Open(const Deadline& deadline, CancelToken& token) override {
+        if (this->IsOpen()) {
+            return;
+        }
+        if (this->uri.path.empty()) {
+            throw TransportError("file:// transport needs a path", "EINVAL");
+        }
+
+        int flags = O_WRONLY | O_NOCTTY | O_NONBLOCK | O_APPEND;
+        if (this->uri.Param("create") == "1") {
+            flags |= O_CREAT;
+        }
+
+        // A FIFO without a reader refuses nonblocking opens; wait for one
+        while (true) {
+            int handle = ::open(this->uri.path.c_str(), flags, 0644);
+            if (handle >= 0) {
+                this->AdoptFd(handle);
+                return;
+            }
+            // Saved before waiting: the token's wait may clobber errno
+            int error = errno;
+            if (error != ENXIO || deadline.Expired() || token.WaitFor(std::min(50, deadline.RemainingMs(50)))) {
+                throw TransportError(ErrnoMessage("Failed to open " + this->uri.path, error),
+                                     token.IsCancelled() ? "ECANCELED" : "EIO");
+            }
+        }
+    }
+};
+
+// tcp://host:9100 raw socket printers (JetDirect / AppSocket)
+class TcpTransport : public FdTransport {
+public:
+    using FdTransport::FdTransport;
+
+    void Open(const Deadline& deadline, CancelToken& token) override {
+        if (this->IsOpen()) {
+            return;
+        }
+        if (this->uri.host.empty()) {
+            throw TransportError("tcp:// transport needs a host", "EINVAL");
+        }
+
+        std::string port = std::to_string(this->uri.port > 0 ? this->uri.port : 9100);
+        struct addrinfo hints;
+        std::memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+
+        // Resolution can stall on a dead DNS server; it must not outlive the
+        // deadline or ignore cancel()
+        struct Lookup {
+            int status = EAI_FAIL;
+            struct addrinfo* addresses = nullptr;
+        };
+        auto lookup = std::make_shared<Lookup>();
+        std::string host = this->uri.host;
+        WriteOutcome resolved = RunInterruptible(
+            [lookup, host, port, hints]() {
+                lookup->status = getaddrinfo(host.c_str(), port.c_str(), &hints, &lookup->addresses);
+            },
+            [lookup]() {
+                if (lookup->addresses) {
+                    freeaddrinfo(lookup->addresses);
+                }
+            },
+            deadline, token);
+        if (resolved != WriteOutcome::Ok) {
+            throw TransportError("Resolving " + this->uri.host + " interrupted",
+                                 resolved == WriteOutcome::Cancelled ? "ECANCELED" : "ETIMEDOUT");
+        }
+
+        int status = lookup->status;
+        struct addrinfo* addresses = lookup->addresses;
+        if (status != 0) {
+            throw TransportError("Cannot resolve " + this->uri.host + ": " + gai_strerror(status), "ENOTFOUND");
+        }
+
+        std::string lastError = "No usable address";
+        for (struct addrinfo* address = addresses; address; address = address->ai_next) {
+            int handle = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+            if (handle < 0) {
+                continue;
+            }
+            fcntl(handle, F_SETFL, fcntl(handle, F_GETFL) | O_NONBLOCK);
+
+            int result = connect(handle, address->ai_addr, address->ai_addrlen);
+            if (result < 0 && errno == EINPROGRESS) {
+                WriteOutcome ready = WaitReady(handle, POLLOUT, deadline, token);
+                int error = 0;
+                socklen_t length = sizeof(error);
+                getsockopt(handle, SOL_SOCKET, SO_ERROR, &error, &length);
+                if (ready == WriteOutcome::Ok && error == 0) {
+                    result = 0;
+                } else if (ready == WriteOutcome::Cancelled || ready == WriteOutcome::TimedOut) {
+                    ::close(handle);
+                    freeaddrinfo(addresses);
+                    throw TransportError("Connect to " + this->uri.host + " interrupted",
+                                         ready == WriteOutcome::Cancelled ? "ECANCELED" : "ETIMEDOUT");
+                } else {
+                    errno = error;
+                }
+            }
+
+            if (result == 0) {
+                int on = 1;
+                setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+                this->AdoptFd(handle);
+                freeaddrinfo(addresses);
+                return;
+            }
+
+            lastError = ErrnoMessage("Connect to " + this->uri.host + " failed", errno);
+            ::close(handle);
+        }
+
+        freeaddrinfo(addresses);
+        throw TransportError(lastError, "ECONNREFUSED");
+    }
+
+protected:
+    ssize_t RawWrite(int handle, const uint8_t* data, size_t length) override {
+#ifdef MSG_NOSIGNAL
+        return ::send(handle, data, length, MSG_NOSIGNAL);
+#else
+        return ::send(handle, data, length, 0);
+#endif
+    }
+};
+
+std::unique_ptr<Transport> CreateFileTransport(TransportUri uri) {
+    return std::make_unique<FileTransport>(std::move(uri));
+}
+
+std::unique_ptr<Transport> CreateTcpTransport(TransportUri uri) {
+    return std::make_unique<TcpTransport>(std::move(uri));
+}
+
+std::unique_ptr<Transport> CreateSpoolTransport(TransportUri uri) {
+    throw TransportError("spool:// transport is only available on Windows", "ENOTSUP");
+}
+
+}  // namespace escpos
+
+#endif
@@ -0,0 +1,137 @@
+#pragma once
+
+#ifndef _WIN32
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "transport.h"
+
+namespace escpos {
+
+inline std::string ErrnoMessage(const std::string& what, int error) {
+    return what + ": " + std::strerror(error);
+}
+
+// termios speed for a baud rate; throws EINVAL for rates without one
+inline speed_t BaudConstant(int64_t baud) {
+    switch (baud) {
+        case 1200: return B1200;
+        case 2400: return B2400;
+        case 4800: return B4800;
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+#ifdef B230400
+        case 230400: return B230400;
+#endif
+        default:
+            throw TransportError("Unsupported baud rate: " + std::to_string(baud), "EINVAL");
+    }
+}
+
+// Waits until fd is ready for events, the token is cancelled or the deadline passes
+inline WriteOutcome WaitReady(int fd, short events, const Deadline& deadline, CancelToken& token) {
+    while (true) {
+        if (token.IsCancelled()) {
+            return WriteOutcome::Cancelled;
+        }
+        if (deadline.Expired()) {
+            return WriteOutcome::TimedOut;
+        }
+
+        struct pollfd fds[2] = {{fd, events, 0}, {token.PollFd(), POLLIN, 0}};
+        int count = token.PollFd() >= 0 ? 2 : 1;
+        int ready = poll(fds, count, deadline.RemainingMs(1000));
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return WriteOutcome::Failed;
+        }
+        if (count == 2 && (fds[1].revents & POLLIN)) {
+            return WriteOutcome::Cancelled;
+        }
+        if (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            return WriteOutcome::Failed;
+        }
+        if (fds[0].revents & events) {
+            return WriteOutcome::Ok;
+        }
+    }
+}
+
+// Nonblocking file descriptor backend: writes what the device accepts and
+// polls for POLLOUT alongside the cancel token when it pushes back.
+class FdTransport : public Transport {
+public:
+    using Transport::Transport;
+
+    ~FdTransport() override { this->CloseFd(); }
+
+    void Close() override { this->CloseFd(); }
+    bool IsOpen() const override { return this->fd.load() >= 0; }
+
+protected:
+    virtual ssize_t RawWrite(int handle, const uint8_t* data, size_t length) {
+        return ::write(handle, data, length);
+    }
+
+    WriteOutcome WriteChunk(const uint8_t* data, size_t length, const Deadline& deadline, CancelToken& token,
+                            size_t& accepted) override {
+        int handle = this->fd.load();
+        if (handle < 0) {
+            this->SetLastError("Transport is closed");
+            return WriteOutcome::Failed;
+        }
+
+        while (true) {
+            ssize_t result = this->RawWrite(handle, data, length);
+            if (result > 0) {
+                accepted = static_cast<size_t>(result);
+                return WriteOutcome::Ok;
+            }
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            if (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                this->SetLastError(ErrnoMessage("write failed", errno));
+                return WriteOutcome::Failed;
+            }
+
+            this->NoteStall();
+            WriteOutcome ready = WaitReady(handle, POLLOUT, deadline, token);
+            if (ready != WriteOutcome::Ok) {
+                if (ready == WriteOutcome::Failed) {
+                    this->SetLastError("Device hung up");
+                }
+                return ready;
+            }
+        }
+    }
+
+    void AdoptFd(int handle) {
+        fcntl(handle, F_SETFL, fcntl(handle, F_GETFL) | O_NONBLOCK);
+        fcntl(handle, F_SETFD, FD_CLOEXEC);
+        this->fd.store(handle);
+    }
+
+    void CloseFd() {
+        int handle = this->fd.exchange(-1);
+        if (handle >= 0) {
+            ::close(handle);
+        }
+    }
+
+    std::atomic<int> fd{-1};
+};
+
+}  // namespace escpos
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef _WIN32
+
+#include <sys/ioctl.h>
+
+#include <algorithm>
+
+#include "transport_posix.h"
+
+namespace escpos {
+
+enum class FlowControl {
+    None,
+    RtsCts,
+    XonXoff
+};
+
+// serial:///dev/ttyUSB0?baud=115200&flow=rtscts, raw 8N1.
+//
+// The kernel honours the flow-control lines, but anything already in its
+// transmit queue can no longer be cancelled. Writes are therefore paced:
+// at most `window` bytes (default ~100ms of line time) sit in the queue,
+// the rest waits here where cancellation and deadlines still apply.
+// An interrupted job flushes whatever the kernel still holds.
+class SerialTransport : public FdTransport {
+public:
+    explicit SerialTransport(TransportUri uri) : FdTransport(std::move(uri)) {
+        this->baud = this->uri.IntParam("baud", 9600);
+        this->speed = BaudConstant(this->baud);
+
+        std::string flow = this->uri.Param("flow", "none");
+        if (flow == "rtscts") {
+            this->flow = FlowControl::RtsCts;
+        } else if (flow == "xonxoff") {
+            this->flow = FlowControl::XonXoff;
+        } else if (flow != "none") {
+            throw TransportError("Unsupported flow control: " + flow, "EINVAL");
+        }
+
+        // Ten bits per byte on the wire (start, eight data, stop)
+        int64_t defaultWindow = std::max<int64_t>(64, this->baud / 100);
+        this->window = static_cast<size_t>(std::max<int64_t>(1, this->uri.IntParam("window", defaultWindow)));
+        this->chunkSize = std::min(this->chunkSize, this->window);
+    }
+
+    void Open(const Deadline&, CancelToken&) override {
+        if (this->IsOpen()) {
+            return;
+        }
+        if (this->uri.path.empty()) {
+            throw TransportError("serial:// transport needs a device path", "EINVAL");
+        }
+
+        int handle = ::open(this->uri.path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (handle < 0) {
+            throw TransportError(ErrnoMessage("Failed to open " + this->uri.path, errno));
+        }
+
+        struct termios tty;
+        if (tcgetattr(handle, &tty) != 0) {
+            int error = errno;
+            ::close(handle);
+            throw TransportError(ErrnoMessage("Not a serial device: " + this->uri.path, error));
+        }
+        cfmakeraw(&tty);
+        cfsetispeed(&tty, this->speed);
+        cfsetospeed(&tty, this->speed);
+        tty.c_cflag |= CLOCAL | CREAD;
+#ifdef CRTSCTS
+        if (this->flow == FlowControl::RtsCts) {
+            tty.c_cflag |= CRTSCTS;
+        } else {
+            tty.c_cflag &= ~CRTSCTS;
+        }
+#else
+        if (this->flow == FlowControl::RtsCts) {
+            ::close(handle);
+            throw TransportError("RTS/CTS flow control is not supported on this platform", "ENOTSUP");
+        }
+#endif
+        if (this->flow == FlowControl::XonXoff) {
+            tty.c_iflag |= IXON | IXOFF;
+            tty.c_cc[VSTART] = 0x11;
+            tty.c_cc[VSTOP] = 0x13;
+        }
+        if (tcsetattr(handle, TCSANOW, &tty) != 0) {
+            int error = errno;
+            ::close(handle);
+            throw TransportError(ErrnoMessage("Failed to configure " + this->uri.path, error));
+        }
+
+        this->AdoptFd(handle);
+    }
+
+    void EndJob(WriteOutcome outcome) override {
+        int handle = this->fd.load();
+        if (handle >= 0 && (outcome == WriteOutcome::Cancelled || outcome == WriteOutcome::TimedOut)) {
+            tcflush(handle, TCOFLUSH);
+        }
+    }
+
+protected:
+    WriteOutcome WriteChunk(const uint8_t* data, size_t length, const Deadline& deadline, CancelToken& token,
+                            size_t& accepted) override {
+        int handle = this->fd.load();
+        if (handle < 0) {
+            this->SetLastError("Transport is closed");
+            return WriteOutcome::Failed;
+        }
+
+        size_t room = 0;
+        bool stalled = false;
+        while ((room = this->QueueRoom(handle)) == 0) {
+            if (!stalled) {
+                this->NoteStall();
+                stalled = true;
+            }
+            if (token.IsCancelled()) {
+                return WriteOutcome::Cancelled;
+            }
+            if (deadline.Expired()) {
+                return WriteOutcome::TimedOut;
+            }
+            // Roughly the time the line needs to drain half the window
+            int drainMs = static_cast<int>(std::max<int64_t>(1, static_cast<int64_t>(this->window) * 5000 / this->baud));
+            if (token.WaitFor(deadline.RemainingMs(std::min(drainMs, 50)))) {
+                return WriteOutcome::Cancelled;
+            }
+        }
+
+        return FdTransport::WriteChunk(data, std::min(length, room), deadline, token, accepted);
+    }
+
+private:
+    // Bytes that may be queued without exceeding the window
+    size_t QueueRoom(int handle) const {
+#ifdef TIOCOUTQ
+        int queued = 0;
+        if (ioctl(handle, TIOCOUTQ, &queued) == 0 && queued >= 0) {
+            size_t pending = static_cast<size_t>(queued);
+            return pending >= this->window ? 0 : this->window - pending;
+        }
+#endif
+        return this->window;
+    }
+
+    int64_t baud = 9600;
+    speed_t speed = B9600;
+    FlowControl flow = FlowControl::None;
+    size_t window = 0;
+};
+
+std::unique_ptr<Transport> CreateSerialTransport(TransportUri uri) {
+    return std::make_unique<SerialTransport>(std::move(uri));
+}
+
+}  // namespace escpos
+
+#endif
@@ -0,0 +1,373 @@
+#ifdef _WIN32
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "transport.h"
+
+namespace escpos {
+
+static std::wstring Widen(const std::string& value) {
+    int length = MultiByteToWideChar(CP_UTF8, 0, value.c_str(), -1, NULL, 0);
+    std::vector<wchar_t> wide(length > 0 ? length : 1);
+    MultiByteToWideChar(CP_UTF8, 0, value.c_str(), -1, wide.data(), length);
+    return std::wstring(wide.data());
+}
+
+static std::string LastErrorMessage(const std::string& what) {
+    return what + " (error " + std::to_string(GetLastError()) + ")";
+}
+
+// Backends whose writes block inside the OS. Cancel() cannot be polled
+// there, so Interrupt() aborts the call on the writing thread instead.
+class BlockingTransport : public Transport {
+public:
+    using Transport::Transport;
+
+    void Interrupt() override {
+        DWORD threadId = this->writerThread.load();
+        if (threadId == 0) {
+            return;
+        }
+        HANDLE thread = OpenThread(THREAD_TERMINATE, FALSE, threadId);
+        if (thread) {
+            CancelSynchronousIo(thread);
+            CloseHandle(thread);
+        }
+    }
+
+protected:
+    struct WriterScope {
+        explicit WriterScope(std::atomic<DWORD>& slot) : slot(slot) { slot = GetCurrentThreadId(); }
+        ~WriterScope() { slot = 0; }
+        std::atomic<DWORD>& slot;
+    };
+
+    std::atomic<DWORD> writerThread{0};
+};
+
+// spool://Printer Name, RAW documents through the Windows print spooler.
+// A cancelled or timed-out job is deleted from the queue.
+class SpoolTransport : public BlockingTransport {
+public:
+    using BlockingTransport::BlockingTransport;
+
+    ~SpoolTransport() override { this->Close(); }
+
+    void Open(const Deadline&, CancelToken&) override {
+        if (this->handle) {
+            return;
+        }
+        std::wstring name = Widen(this->uri.host);
+        PRINTER_DEFAULTSW defaults = {0};
+        defaults.DesiredAccess = PRINTER_ACCESS_USE;
+        if (!OpenPrinterW((LPWSTR)name.c_str(), &this->handle, &defaults)) {
+            this->handle = NULL;
+            throw TransportError(LastErrorMessage("Failed to open printer " + this->uri.host));
+        }
+    }
+
+    void Close() override {
+        if (this->handle) {
+            if (this->jobId) {
+                EndPagePrinter(this->handle);
+                EndDocPrinter(this->handle);
+                this->jobId = 0;
+            }
+            ClosePrinter(this->handle);
+            this->handle = NULL;
+        }
+    }
+
+    bool IsOpen() const override { return this->handle != NULL; }
+
+    void BeginJob() override {
+        if (!this->handle) {
+            return;
+        }
+        wchar_t docName[] = L"ESC/POS Print Job";
+        wchar_t dataType[] = L"RAW";
+        DOC_INFO_1W docInfo = {0};
+        docInfo.pDocName = docName;
+        docInfo.pDatatype = dataType;
+
+        this->jobId = StartDocPrinterW(this->handle, 1, (LPBYTE)&docInfo);
+        if (this->jobId && !StartPagePrinter(this->handle)) {
+            EndDocPrinter(this->handle);
+            this->jobId = 0;
+        }
+    }
+
+    void EndJob(WriteOutcome outcome) override {
+        if (!this->handle || !this->jobId) {
+            return;
+        }
+        EndPagePrinter(this->handle);
+        if (outcome == WriteOutcome::Cancelled || outcome == WriteOutcome::TimedOut) {
+            SetJobW(this->handle, this->jobId, 0, NULL, JOB_CONTROL_DELETE);
+        }
+        EndDocPrinter(this->handle);
+        this->jobId = 0;
+    }
+
+protected:
+    WriteOutcome WriteChunk(const uint8_t* data, size_t length, const Deadline&, CancelToken&,
+                            size_t& accepted) override {
+        if (!this->handle || !this->jobId) {
+            this->SetLastError("No spooler document open");
+            return WriteOutcome::Failed;
+        }
+
+        WriterScope scope(this->writerThread);
+        DWORD written = 0;
+        if (!WritePrinter(this->handle, (LPVOID)data, (DWORD)length, &written) || written == 0) {
+            this->SetLastError(LastErrorMessage("WritePrinter failed"));
+            return WriteOutcome::Failed;
+        }
+        accepted = written;
+        return WriteOutcome::Ok;
+    }
+
+private:
+    HANDLE handle = NULL;
+    DWORD jobId = 0;
+};
+
+// file:///C:/receipts/out.bin, or file://server/share/path for UNC paths
+class FileTransport : public BlockingTransport {
+public:
+    using BlockingTransport::BlockingTransport;
+
+    ~FileTransport() override { this->Close(); }
+
+    void Open(const Deadline&, CancelToken&) override {
+        if (this->handle != INVALID_HANDLE_VALUE) {
+            return;
+        }
+        // file:///C:/out.bin parses with a leading slash before the drive
+        std::string path = this->uri.host.empty() ? this->uri.path : "\\\\" + this->uri.host + this->uri.path;
+        if (path.size() > 2 && path[0] == '/' && path[2] == ':') {
+            path = path.substr(1);
+        }
+        if (path.empty()) {
+            throw TransportError("file:// transport needs a path", "EINVAL");
+        }
+
+        DWORD disposition = this->uri.Param("create") == "1" ? OPEN_ALWAYS : OPEN_EXISTING;
+        this->handle = CreateFileW(Widen(path).c_str(), FILE_APPEND_DATA, FILE_SHARE_READ, NULL, disposition,
+                                   FILE_ATTRIBUTE_NORMAL, NULL);
+        if (this->handle == INVALID_HANDLE_VALUE) {
+            throw TransportError(LastErrorMessage("Failed to open " + path));
+        }
+    }
+
+    void Close() override {
+        if (this->handle != INVALID_HANDLE_VALUE) {
+            CloseHandle(this->handle);
+            this->handle = INVALID_HANDLE_VALUE;
+        }
+    }
+
+    bool IsOpen() const override { return this->handle != INVALID_HANDLE_VALUE; }
+
+protected:
+    WriteOutcome WriteChunk(const uint8_t* data, size_t length, const Deadline&, CancelToken&,
+                            size_t& accepted) override {
+        WriterScope scope(this->writerThread);
+        DWORD written = 0;
+        if (!WriteFile(this->handle, data, (DWORD)length, &written, NULL) || written == 0) {
+            this->SetLastError(LastErrorMessage("WriteFile failed"));
+            return WriteOutcome::Failed;
+        }
+        accepted = written;
+        return WriteOutcome::Ok;
+    }
+
+private:
+    HANDLE handle = INVALID_HANDLE_VALUE;
+};
+
+// tcp://host:9100 raw socket printers. Sends block for at most the time left
+// before the deadline; Interrupt() shuts the socket down to wake them.
+class TcpTransport : public Transport {
+public:
+    explicit TcpTransport(TransportUri uri) : Transport(std::move(uri)) {
+        WSADATA data;
+        this->wsaStarted = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }
+
+    ~TcpTransport() override {
+        this->Close();
+        if (this->wsaStarted) {
+            WSACleanup();
+        }
+    }
+
+    void Open(const Deadline& deadline, CancelToken& token) override {
+        if (this->socket != INVALID_SOCKET) {
+            return;
+        }
+        if (this->uri.host.empty()) {
+            throw TransportError("tcp:// transport needs a host", "EINVAL");
+        }
+
+        std::string port = std::to_string(this->uri.port > 0 ? this->uri.port : 9100);
+        addrinfo hints = {0};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_protocol = IPPROTO_TCP;
+
+        // Resolution can stall on a dead DNS server; it must not outlive the
+        // deadline or ignore cancel()
+        struct Lookup {
+            int status = EAI_FAIL;
+            addrinfo* addresses = nullptr;
+        };
+        auto lookup = std::make_shared<Lookup>();
+        std::string host = this->uri.host;
+        WriteOutcome resolved = RunInterruptible(
+            [lookup, host, port, hints]() {
+                lookup->status = getaddrinfo(host.c_str(), port.c_str(), &hints, &lookup->addresses);
+            },
+            [lookup]() {
+                if (lookup->addresses) {
+                    freeaddrinfo(lookup->addresses);
+                }
+            },
+            deadline, token);
+        if (resolved != WriteOutcome::Ok) {
+            throw TransportError("Resolving " + this->uri.host + " interrupted",
+                                 resolved == WriteOutcome::Cancelled ? "ECANCELED" : "ETIMEDOUT");
+        }
+
+        addrinfo* addresses = lookup->addresses;
+        if (lookup->status != 0) {
+            throw TransportError("Cannot resolve " + this->uri.host, "ENOTFOUND");
+        }
+
+        for (addrinfo* address = addresses; address; address = address->ai_next) {
+            SOCKET candidate = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+            if (candidate == INVALID_SOCKET) {
+                continue;
+            }
+
+            u_long nonblocking = 1;
+            ioctlsocket(candidate, FIONBIO, &nonblocking);
+            connect(candidate, address->ai_addr, (int)address->ai_addrlen);
+
+            // Wait in short slices so cancellation is noticed promptly
+            bool connected = false;
+            while (!token.IsCancelled() && !deadline.Expired()) {
+                fd_set writable, failed;
+                FD_ZERO(&writable);
+                FD_ZERO(&failed);
+                FD_SET(candidate, &writable);
+                FD_SET(candidate, &failed);
+                int sliceMs = deadline.RemainingMs(100);
+                timeval timeout = {sliceMs / 1000, (sliceMs % 1000) * 1000};
+                int ready = select(0, NULL, &writable, &failed, &timeout);
+                if (ready > 0) {
+                    connected = FD_ISSET(candidate, &writable) != 0;
+                    break;
+                }
+                if (ready < 0) {
+                    break;
+                }
+            }
+
+            if (connected) {
+                nonblocking = 0;
+                ioctlsocket(candidate, FIONBIO, &nonblocking);
+                BOOL on = TRUE;
+                setsockopt(candidate, IPPROTO_TCP, TCP_NODELAY, (const char*)&on, sizeof(on));
+                this->socket = candidate;
+                freeaddrinfo(addresses);
+                return;
+            }
+            closesocket(candidate);
+            if (token.IsCancelled() || deadline.Expired()) {
+                break;
+            }
+        }
+
+        freeaddrinfo(addresses);
+        if (token.IsCancelled()) {
+            throw TransportError("Connect to " + this->uri.host + " cancelled", "ECANCELED");
+        }
+        if (deadline.Expired()) {
+            throw TransportError("Connect to " + this->uri.host + " timed out", "ETIMEDOUT");
+        }
+        throw TransportError("Connect to " + this->uri.host + " failed", "ECONNREFUSED");
+    }
+
+    void Close() override {
+        SOCKET current = this->socket.exchange(INVALID_SOCKET);
+        if (current != INVALID_SOCKET) {
+            closesocket(current);
+        }
+    }
+
+    bool IsOpen() const override { return this->socket.load() != INVALID_SOCKET; }
+
+    void Interrupt() override {
+        SOCKET current = this->socket.load();
+        if (current != INVALID_SOCKET) {
+            shutdown(current, SD_BOTH);
+        }
+    }
+
+protected:
+    WriteOutcome WriteChunk(const uint8_t* data, size_t length, const Deadline& deadline, CancelToken&,
+                            size_t& accepted) override {
+        SOCKET current = this->socket.load();
+        if (current == INVALID_SOCKET) {
+            this->SetLastError("Transport is closed");
+            return WriteOutcome::Failed;
+        }
+
+        DWORD timeoutMs = (DWORD)deadline.RemainingMs(30000);
+        setsockopt(current, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeoutMs, sizeof(timeoutMs));
+
+        int sent = send(current, (const char*)data, (int)length, 0);
+        if (sent == SOCKET_ERROR) {
+            if (WSAGetLastError() == WSAETIMEDOUT) {
+                return WriteOutcome::TimedOut;
+            }
+            this->SetLastError("send failed (error " + std::to_string(WSAGetLastError()) + ")");
+            return WriteOutcome::Failed;
+        }
+        accepted = static_cast<size_t>(sent);
+        return WriteOutcome::Ok;
+    }
+
+private:
+    std::atomic<SOCKET> socket{INVALID_SOCKET};
+    bool wsaStarted = false;
+};
+
+std::unique_ptr<Transport> CreateFileTransport(TransportUri uri) {
+    return std::make_unique<FileTransport>(std::move(uri));
+}
+
+std::unique_ptr<Transport> CreateTcpTransport(TransportUri uri) {
+    return std::make_unique<TcpTransport>(std::move(uri));
+}
+
+std::unique_ptr<Transport> CreateSerialTransport(TransportUri uri) {
+    throw TransportError("serial:// transport is not available on Windows yet", "ENOTSUP");
+}
+
+std::unique_ptr<Transport> CreateSpoolTransport(TransportUri uri) {
+    if (uri.host.empty()) {
+        throw TransportError("spool:// transport needs a printer name", "EINVAL");
+    }
+    return std::make_unique<SpoolTransport>(std::move(uri));
+}
+
+}  // namespace escpos
+
+#endif
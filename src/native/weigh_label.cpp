@@ -0,0 +1,438 @@
+#include "weigh_label.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+
+#include "serial_latency.h"
+#include "thread_pool.h"
+#include "transport_posix.h"
+#endif
+
+namespace escpos {
+
+// Longer lines are not weights; the rest of such a line is dropped
+constexpr size_t kMaxLineLength = 128;
+
+static std::string Upper(const std::string& text) {
+    std::string result = text;
+    std::transform(result.begin(), result.end(), result.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    return result;
+}
+
+// Status words around the number: ST stable, US/M/MO in motion, OL overload
+static void ReadStatus(const std::string& text, WeightReading& reading) {
+    std::string word;
+    for (size_t i = 0; i <= text.size(); i++) {
+        unsigned char c = i < text.size() ? static_cast<unsigned char>(text[i]) : ' ';
+        if (std::isalpha(c)) {
+            word += static_cast<char>(std::toupper(c));
+            continue;
+        }
+        if (c == '?') {
+            reading.stability = Stability::Motion;
+        }
+        if (word == "ST") {
+            reading.stability = Stability::Stable;
+        } else if (word == "US" || word == "M" || word == "MO") {
+            reading.stability = Stability::Motion;
+        } else if (word == "OL" || word == "ERR") {
+            reading.valid = false;
+        }
+        word.clear();
+    }
+}
+
+WeightReading ParseWeightLine(const std::string& line) {
+    WeightReading reading;
+    size_t digit = line.find_first_of("0123456789");
+    if (digit == std::string::npos) {
+        return reading;
+    }
+
+    size_t end = digit;
+    while (end < line.size() && (std::isdigit(static_cast<unsigned char>(line[end])) || line[end] == '.')) {
+        end++;
+    }
+    reading.value = std::strtod(line.substr(digit, end - digit).c_str(), nullptr);
+    reading.valid = true;
+
+    // Sign, possibly separated from the digits by padding: "-  0.120"
+    size_t sign = digit;
+    while (sign > 0 && line[sign - 1] == ' ') {
+        sign--;
+    }
+    if (sign > 0 && line[sign - 1] == '-') {
+        reading.value = -reading.value;
+    }
+
+    size_t unit = end;
+    while (unit < line.size() && line[unit] == ' ') {
+        unit++;
+    }
+    size_t unitEnd = unit;
+    while (unitEnd < line.size() && std::isalpha(static_cast<unsigned char>(line[unitEnd]))) {
+        unitEnd++;
+    }
+    std::string unitText = Upper(line.substr(unit, unitEnd - unit));
+    if (unitText == "KG" || unitText == "G" || unitText == "LB" || unitText == "OZ") {
+        reading.unit = line.substr(unit, unitEnd - unit);
+    } else {
+        // A status word after the number, not a unit
+        unitEnd = end;
+    }
+
+    ReadStatus(line.substr(0, sign), reading);
+    ReadStatus(line.substr(unitEnd), reading);
+    return reading;
+}
+
+bool StableWeightDetector::Feed(const WeightReading& reading) {
+    if (!reading.valid) {
+        this->run = 0;
+        return false;
+    }
+    if (reading.value <= this->options.minWeight) {
+        // Platter emptied: the next item may trigger
+        this->armed = true;
+        this->run = 0;
+        return false;
+    }
+    if (!this->armed || reading.stability == Stability::Motion) {
+        this->run = 0;
+        return false;
+    }
+    if (reading.stability == Stability::Stable) {
+        this->armed = false;
+        this->run = 0;
+        return true;
+    }
+
+    double low = std::min(this->low, reading.value);
+    double high = std::max(this->high, reading.value);
+    if (this->run == 0 || high - low > this->options.tolerance + 1e-9) {
+        this->run = 1;
+        this->low = this->high = reading.value;
+    } else {
+        this->run++;
+        this->low = low;
+        this->high = high;
+    }
+    if (this->run >= std::max(1, this->options.readings)) {
+        this->armed = false;
+        this->run = 0;
+        return true;
+    }
+    return false;
+}
+
+void StableWeightDetector::Reset() {
+    this->armed = true;
+    this->run = 0;
+}
+
+double RoundTo(double value, int decimals) {
+    double scale = std::pow(10.0, decimals);
+    // The nudge keeps values stored just below a half (1.005) rounding up
+    return std::round(value * scale * (1 + 1e-12)) / scale;
+}
+
+static std::string FormatField(double value, const TemplatePiece& piece) {
+    int decimals = std::min(std::max(piece.decimals, 0), 9);
+    int64_t scale = 1;
+    for (int i = 0; i < decimals; i++) {
+        scale *= 10;
+    }
+    int64_t units = std::llround(RoundTo(value, decimals) * static_cast<double>(scale));
+    bool negative = units < 0;
+    int64_t magnitude = negative ? -units : units;
+
+    std::string digits;
+    if (piece.minorUnits || decimals == 0) {
+        digits = std::to_string(magnitude);
+    } else {
+        std::string fraction = std::to_string(magnitude % scale);
+        fraction.insert(0, static_cast<size_t>(decimals) - fraction.size(), '0');
+        digits = std::to_string(magnitude / scale) + "." + fraction;
+    }
+
+    std::string sign = negative ? "-" : "";
+    size_t length = sign.size() + digits.size();
+    size_t width = static_cast<size_t>(std::max(piece.width, 0));
+    std::string fill(width > length ? width - length : 0, piece.pad);
+    return piece.pad == '0' ? sign + fill + digits : fill + sign + digits;
+}
+
+std::string LabelTemplate::Render(double weight, double price) const {
+    std::string label;
+    for (const TemplatePiece& piece : this->pieces) {
+        label += piece.bytes;
+        if (piece.field == SlotField::Weight) {
+            label += FormatField(weight, piece);
+        } else if (piece.field == SlotField::Price) {
+            label += FormatField(price, piece);
+        }
+    }
+    return label;
+}
+
+WeighLabelPipeline::WeighLabelPipeline(WeighLabelOptions options)
+    : options(std::move(options)), detector(this->options.stability), unitPrice(this->options.unitPrice) {}
+
+WeighLabelPipeline::~WeighLabelPipeline() {
+    this->Stop();
+}
+
+void WeighLabelPipeline::SetUnitPrice(double unitPrice) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->unitPrice = unitPrice;
+}
+
+WeighLabelStats WeighLabelPipeline::Stats() const {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->stats;
+}
+
+void WeighLabelPipeline::HandleLine(const std::string& line, Clock::time_point readAt) {
+    WeighLabelEvent event;
+    event.line = line;
+    event.reading = ParseWeightLine(line);
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stats.readings++;
+    }
+
+    if (!this->detector.Feed(event.reading)) {
+        this->onEvent(std::move(event));
+        return;
+    }
+
+    // The label goes out before anyone hears of the weight
+    WeighLabelEvent print = event;
+    this->Print(print, readAt);
+    this->onEvent(std::move(event));
+    this->onEvent(std::move(print));
+}
+
+void WeighLabelPipeline::Print(WeighLabelEvent& event, Clock::time_point readAt) {
+    double unitPrice;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        unitPrice = this->unitPrice;
+        this->stats.triggers++;
+    }
+
+    event.kind = WeighLabelEvent::Kind::Print;
+    event.price = RoundTo(event.reading.value * unitPrice, this->options.priceDecimals);
+    std::string label = this->options.label.Render(event.reading.value, event.price);
+
+    Deadline deadline = Deadline::After(this->options.writeTimeoutMs);
+    WriteOutcome outcome = WriteOutcome::Failed;
+    size_t written = 0;
+    try {
+        // A connection dropped after an earlier failure is reopened here
+        if (!this->printer->IsOpen()) {
+            this->printer->Open(deadline, this->stopToken);
+        }
+        outcome = this->printer->WriteJob(reinterpret_cast<const uint8_t*>(label.data()), label.size(), deadline,
+                                          this->stopToken, written);
+    } catch (const TransportError& e) {
+        event.error = e.what();
+        event.code = e.Code();
+    }
+    event.bytes = written;
+    event.weighToPrintMs = std::chrono::duration<double, std::milli>(Clock::now() - readAt).count();
+
+    if (event.error.empty()) {
+        switch (outcome) {
+            case WriteOutcome::Ok:
+                break;
+            case WriteOutcome::Cancelled:
+                event.error = "Label print cancelled";
+                event.code = "ECANCELED";
+                break;
+            case WriteOutcome::TimedOut:
+                event.error = "Label print timed out";
+                event.code = "ETIMEDOUT";
+                break;
+            default: {
+                std::string detail = this->printer->LastError();
+                event.error = detail.empty() ? "Printer write failed" : detail;
+                event.code = "EIO";
+                this->printer->Close();
+                break;
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (!event.error.empty()) {
+        this->stats.failed++;
+        return;
+    }
+    this->stats.printed++;
+    this->stats.lastMs = event.weighToPrintMs;
+    this->stats.meanMs += (event.weighToPrintMs - this->stats.meanMs) / static_cast<double>(this->stats.printed);
+    this->stats.maxMs = std::max(this->stats.maxMs, event.weighToPrintMs);
+}
+
+#ifndef _WIN32
+
+// Raw 8N1 at baud with reads returning on the first byte, plus whatever
+// driver-level latency controls the port allows
+static void ConfigureScaleTty(int handle, const std::string& path, int64_t baud) {
+    speed_t speed = BaudConstant(baud);
+    struct termios tty;
+    if (tcgetattr(handle, &tty) != 0) {
+        throw TransportError(ErrnoMessage("Not a serial device: " + path, errno));
+    }
+    cfmakeraw(&tty);
+    cfsetispeed(&tty, speed);
+    cfsetospeed(&tty, speed);
+    tty.c_cflag |= CLOCAL | CREAD;
+    tty.c_cc[VMIN] = 1;
+    tty.c_cc[VTIME] = 0;
+    if (tcsetattr(handle, TCSANOW, &tty) != 0) {
+        throw TransportError(ErrnoMessage("Failed to configure " + path, errno));
+    }
+
+    SerialLatencyOptions latency;
+    latency.raw = false;
+    ConfigureSerialLatency(handle, latency);
+}
+
+void WeighLabelPipeline::Start(EventHandler onEvent, EndHandler onEnd) {
+    // A pipeline whose scale stream ended is restarted
+    this->Stop();
+    this->stopToken.Reset();
+
+    const std::string& path = this->options.scalePath;
+    int handle = ::open(path.c_str(), O_RDONLY | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (handle < 0) {
+        int error = errno;
+        throw TransportError(ErrnoMessage("Failed to open " + path, error), error == EACCES ? "EACCES" : "ENOENT");
+    }
+
+    std::unique_ptr<Transport> printer;
+    bool tty = isatty(handle) == 1;
+    try {
+        struct stat info;
+        if (tty) {
+            ConfigureScaleTty(handle, path, this->options.baud);
+        } else if (fstat(handle, &info) != 0 || !S_ISREG(info.st_mode)) {
+            throw TransportError(path + " is not a serial device or recording", "EINVAL");
+        }
+
+        // Opened by Run() and held for the whole run, so a trigger only has to write
+        printer = CreateTransport(this->options.printerUri);
+    } catch (const TransportError&) {
+        ::close(handle);
+        throw;
+    }
+
+    this->fd = handle;
+    this->tty = tty;
+    this->printer = std::move(printer);
+    this->onEvent = std::move(onEvent);
+    this->onEnd = std::move(onEnd);
+    this->detector.Reset();
+    this->running = ThreadPool::Instance().SubmitBlocking([this]() { this->Run(); }, &this->stopToken);
+}
+
+void WeighLabelPipeline::Run() {
+    char buffer[256];
+    std::string line;
+    std::string message;
+    std::string code;
+
+    // Here rather than in Start(): connecting to a network printer can take
+    // up to writeTimeoutMs, which must not block the caller's thread
+    try {
+        this->printer->Open(Deadline::After(this->options.writeTimeoutMs), this->stopToken);
+    } catch (const TransportError& e) {
+        // Stop() during the open is not an error
+        if (!this->stopToken.IsCancelled()) {
+            message = e.what();
+            code = e.Code();
+        }
+    }
+
+    while (message.empty() && !this->stopToken.IsCancelled()) {
+        struct pollfd fds[2] = {{this->fd, POLLIN, 0}, {this->stopToken.PollFd(), POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            message = ErrnoMessage("poll failed", errno);
+            code = "EIO";
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            break;
+        }
+
+        ssize_t count = ::read(this->fd, buffer, sizeof(buffer));
+        Clock::time_point readAt = Clock::now();
+        if (count < 0 && (errno == EINTR || errno == EAGAIN)) {
+            continue;
+        }
+        if (count <= 0) {
+            // End of a recording, or a tty that went away
+            if (count < 0 || this->tty) {
+                message = "Scale was disconnected";
+                code = "ENODEV";
+            }
+            break;
+        }
+
+        for (ssize_t i = 0; i < count; i++) {
+            char c = buffer[i];
+            if (c == '\r' || c == '\n') {
+                if (!line.empty()) {
+                    this->HandleLine(line, readAt);
+                    line.clear();
+                }
+            } else if (line.size() < kMaxLineLength) {
+                line += c;
+            }
+        }
+    }
+
+    this->printer->Close();
+    this->onEnd(message, code);
+}
+
+void WeighLabelPipeline::Stop() {
+    this->stopToken.Cancel();
+    if (this->printer) {
+        this->printer->Interrupt();
+    }
+    if (this->running.valid()) {
+        this->running.wait();
+        this->running = std::future<void>();
+    }
+    if (this->fd >= 0) {
+        ::close(this->fd);
+        this->fd = -1;
+    }
+    this->printer.reset();
+}
+
+#else
+
+void WeighLabelPipeline::Start(EventHandler, EndHandler) {
+    throw TransportError("Scale label pipelines are not available on Windows yet", "ENOTSUP");
+}
+
+void WeighLabelPipeline::Run() {}
+
+void WeighLabelPipeline::Stop() {}
+
+#endif
+
+}  // namespace escpos
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "cancel_token.h"
+#include "transport.h"
+
+namespace escpos {
+
+enum class Stability {
+    // The scale does not say; decided by repeated readings
+    Unknown,
+    Stable,
+    Motion
+};
+
+// One weight line from a scale's continuous output, e.g. "ST,GS,+  1.234kg"
+// or "   0.250 kg"
+struct WeightReading {
+    bool valid = false;
+    double value = 0;
+    std::string unit;
+    Stability stability = Stability::Unknown;
+};
+
+WeightReading ParseWeightLine(const std::string& line);
+
+struct StabilityOptions {
+    // Readings in a row within tolerance, for scales that do not flag stability
+    int readings = 3;
+    // Largest spread among those readings, in the scale's unit
+    double tolerance = 0;
+    // At or below this the platter counts as empty; a trigger needs more
+    double minWeight = 0;
+};
+
+// Fires once per item: on a stable reading above minWeight, then not again
+// until the platter has been emptied
+class StableWeightDetector {
+public:
+    explicit StableWeightDetector(StabilityOptions options = {}) : options(options) {}
+
+    // @returns true when reading is the stable weight of a new item
+    bool Feed(const WeightReading& reading);
+    void Reset();
+
+private:
+    StabilityOptions options;
+    bool armed = true;
+    int run = 0;
+    double low = 0;
+    double high = 0;
+};
+
+enum class SlotField {
+    None,
+    Weight,
+    Price
+};
+
+// Literal bytes followed by an optional field. Fields are right-aligned to
+// width with pad; minorUnits drops the decimal point (1.234 -> "1234") for
+// barcode digits.
+struct TemplatePiece {
+    std::string bytes;
+    SlotField field = SlotField::None;
+    int decimals = 0;
+    int width = 0;
+    char pad = ' ';
+    bool minorUnits = false;
+};
+
+// A label compiled once in JS (any command language) with its weight and
+// price fields cut out, so filling it in is a few string appends
+struct LabelTemplate {
+    std::vector<TemplatePiece> pieces;
+
+    std::string Render(double weight, double price) const;
+};
+
+// Rounds half away from zero to decimals places
+double RoundTo(double value, int decimals);
+
+struct WeighLabelOptions {
+    std::string scalePath;
+    int64_t baud = 9600;
+    std::string printerUri;
+    LabelTemplate label;
+    StabilityOptions stability;
+    double unitPrice = 0;
+    int priceDecimals = 2;
+    int64_t writeTimeoutMs = 5000;
+};
+
+struct WeighLabelEvent {
+    enum class Kind {
+        Weight,
+        Print
+    };
+
+    Kind kind = Kind::Weight;
+    WeightReading reading;
+    std::string line;
+    // Print only
+    double price = 0;
+    size_t bytes = 0;
+    // From the read that completed the weight line to the label's last byte
+    // being accepted by the printer connection
+    double weighToPrintMs = 0;
+    std::string error;
+    std::string code;
+};
+
+struct WeighLabelStats {
+    uint64_t readings = 0;
+    uint64_t triggers = 0;
+    uint64_t printed = 0;
+    uint64_t failed = 0;
+    double lastMs = 0;
+    double meanMs = 0;
+    double maxMs = 0;
+};
+
+// Binds a scale's stable weight to a label: opens the printer connection
+// and reads the scale tty on the thread pool's blocking lane and, when an
+// item settles, renders the label and writes it to that connection from
+// the same thread. Events are reported after the write, so the caller only
+// observes.
+class WeighLabelPipeline {
+public:
+    using EventHandler = std::function<void(WeighLabelEvent event)>;
+    // Empty message: the scale stream ended or Stop() was called
+    using EndHandler = std::function<void(const std::string& message, const std::string& code)>;
+
+    explicit WeighLabelPipeline(WeighLabelOptions options);
+    ~WeighLabelPipeline();
+
+    WeighLabelPipeline(const WeighLabelPipeline&) = delete;
+    WeighLabelPipeline& operator=(const WeighLabelPipeline&) = delete;
+
+    // Opens the scale and parses the printer URI; throws TransportError when
+    // either fails. The printer is opened on the pipeline's thread and a
+    // failure to open it ends the run through onEnd. A previous run is
+    // stopped first.
+    void Start(EventHandler onEvent, EndHandler onEnd);
+    // Waits for the pipeline; onEnd has been called when this returns
+    void Stop();
+
+    // Price per scale unit for labels printed from now on
+    void SetUnitPrice(double unitPrice);
+    WeighLabelStats Stats() const;
+
+private:
+    void Run();
+    void HandleLine(const std::string& line, Clock::time_point readAt);
+    void Print(WeighLabelEvent& event, Clock::time_point readAt);
+
+    WeighLabelOptions options;
+    StableWeightDetector detector;
+    std::unique_ptr<Transport> printer;
+    int fd = -1;
+    // False for a recording, whose end is not a disconnect
+    bool tty = false;
+    CancelToken stopToken;
+    std::future<void> running;
+    EventHandler onEvent;
+    EndHandler onEnd;
+
+    mutable std::mutex mutex;
+    double unitPrice = 0;
+    WeighLabelStats stats;
+};
+
+}  // namespace escpos
@@ -0,0 +1,266 @@
+#include <napi.h>
+
+#include <memory>
+#include <string>
+
+#include "addon.h"
+#include "weigh_label.h"
+
+namespace escpos {
+
+static Napi::Error ErrorWithCode(Napi::Env env, const std::string& message, const std::string& code) {
+    Napi::Error error = Napi::Error::New(env, message);
+    error.Set("code", Napi::String::New(env, code));
+    return error;
+}
+
+static int IntOption(Napi::Object options, const char* key, int fallback) {
+    Napi::Value value = options.Get(key);
+    return value.IsNumber() ? value.As<Napi::Number>().Int32Value() : fallback;
+}
+
+static double NumberOption(Napi::Object options, const char* key, double fallback) {
+    Napi::Value value = options.Get(key);
+    return value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : fallback;
+}
+
+// [bytes | string | { field: 'weight' | 'price', decimals, width, pad, minorUnits }, ...]
+// Returns false with a JS exception pending when a part is not understood.
+static bool TemplateArg(Napi::Env env, Napi::Value value, LabelTemplate& label) {
+    if (!value.IsArray()) {
+        Napi::TypeError::New(env, "Label template parts expected").ThrowAsJavaScriptException();
+        return false;
+    }
+
+    Napi::Array parts = value.As<Napi::Array>();
+    TemplatePiece piece;
+    for (uint32_t i = 0; i < parts.Length(); i++) {
+        Napi::Value part = parts.Get(i);
+        if (part.IsBuffer()) {
+            Napi::Buffer<char> bytes = part.As<Napi::Buffer<char>>();
+            piece.bytes.append(bytes.Data(), bytes.Length());
+            continue;
+        }
+        if (part.IsString()) {
+            piece.bytes += part.As<Napi::String>().Utf8Value();
+            continue;
+        }
+
+        Napi::Object slot = part.IsObject() ? part.As<Napi::Object>() : Napi::Object::New(env);
+        std::string field = slot.Get("field").IsString() ? slot.Get("field").As<Napi::String>().Utf8Value() : "";
+        if (field == "weight") {
+            piece.field = SlotField::Weight;
+        } else if (field == "price") {
+            piece.field = SlotField::Price;
+        } else {
+            Napi::TypeError::New(env, "Template part " + std::to_string(i) + " is not bytes, text or a field")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        piece.decimals = IntOption(slot, "decimals", piece.field == SlotField::Price ? 2 : 3);
+        piece.width = IntOption(slot, "width", 0);
+        std::string pad = slot.Get("pad").IsString() ? slot.Get("pad").As<Napi::String>().Utf8Value() : " ";
+        piece.pad = pad.empty() ? ' ' : pad[0];
+        piece.minorUnits = slot.Get("minorUnits").IsBoolean() && slot.Get("minorUnits").As<Napi::Boolean>().Value();
+        label.pieces.push_back(std::move(piece));
+        piece = TemplatePiece();
+    }
+    if (!piece.bytes.empty()) {
+        label.pieces.push_back(std::move(piece));
+    }
+    return true;
+}
+
+static const char* StabilityName(Stability stability) {
+    switch (stability) {
+        case Stability::Stable: return "stable";
+        case Stability::Motion: return "motion";
+        default: return "unknown";
+    }
+}
+
+static Napi::Object EventObject(Napi::Env env, const WeighLabelEvent& event) {
+    Napi::Object result = Napi::Object::New(env);
+    bool print = event.kind == WeighLabelEvent::Kind::Print;
+    result.Set("type", Napi::String::New(env, print ? "print" : "weight"));
+    result.Set("line", Napi::String::New(env, event.line));
+    result.Set("weight", event.reading.valid ? Napi::Number::New(env, event.reading.value) : env.Null());
+    result.Set("unit", Napi::String::New(env, event.reading.unit));
+    result.Set("stability", Napi::String::New(env, StabilityName(event.reading.stability)));
+    if (print) {
+        result.Set("price", Napi::Number::New(env, event.price));
+        result.Set("bytes", Napi::Number::New(env, static_cast<double>(event.bytes)));
+        result.Set("weighToPrintMs", Napi::Number::New(env, event.weighToPrintMs));
+        if (!event.error.empty()) {
+            result.Set("error", ErrorWithCode(env, event.error, event.code).Value());
+        }
+    }
+    return result;
+}
+
+// JS face of WeighLabelPipeline. Labels are printed on the pipeline thread;
+// weights and print results are marshalled to the main thread afterwards.
+class WeighLabelPipelineWrap : public Napi::ObjectWrap<WeighLabelPipelineWrap> {
+public:
+    static void Init(Napi::Env env, Napi::Object exports) {
+        Napi::Function func = DefineClass(env, "WeighLabelPipeline", {
+            InstanceMethod("start", &WeighLabelPipelineWrap::Start),
+            InstanceMethod("stop", &WeighLabelPipelineWrap::Stop),
+            InstanceMethod("setUnitPrice", &WeighLabelPipelineWrap::SetUnitPrice),
+            InstanceMethod("getStats", &WeighLabelPipelineWrap::GetStats)
+        });
+        exports.Set("WeighLabelPipeline", func);
+    }
+
+    // new WeighLabelPipeline({ scalePath, baudRate, printer, template, unitPrice, priceDecimals,
+    //                          stableReadings, tolerance, minWeight, writeTimeoutMs })
+    WeighLabelPipelineWrap(const Napi::CallbackInfo& info) : Napi::ObjectWrap<WeighLabelPipelineWrap>(info) {
+        Napi::Env env = info.Env();
+        if (info.Length() < 1 || !info[0].IsObject()) {
+            Napi::TypeError::New(env, "Pipeline options expected").ThrowAsJavaScriptException();
+            return;
+        }
+
+        Napi::Object given = info[0].As<Napi::Object>();
+        if (!given.Get("scalePath").IsString() || !given.Get("printer").IsString()) {
+            Napi::TypeError::New(env, "Scale path and printer transport URI expected").ThrowAsJavaScriptException();
+            return;
+        }
+
+        WeighLabelOptions options;
+        options.scalePath = given.Get("scalePath").As<Napi::String>().Utf8Value();
+        options.printerUri = given.Get("printer").As<Napi::String>().Utf8Value();
+        if (!TemplateArg(env, given.Get("template"), options.label)) {
+            return;
+        }
+        options.baud = IntOption(given, "baudRate", 9600);
+        options.unitPrice = NumberOption(given, "unitPrice", 0);
+        options.priceDecimals = IntOption(given, "priceDecimals", 2);
+        options.stability.readings = IntOption(given, "stableReadings", 3);
+        options.stability.tolerance = NumberOption(given, "tolerance", 0);
+        options.stability.minWeight = NumberOption(given, "minWeight", 0);
+        options.writeTimeoutMs = IntOption(given, "writeTimeoutMs", 5000);
+        this->pipeline = std::make_unique<WeighLabelPipeline>(std::move(options));
+    }
+
+private:
+    // start(onEvent(event), onEnd(error | null))
+    Napi::Value Start(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (info.Length() < 2 || !info[0].IsFunction() || !info[1].IsFunction()) {
+            Napi::TypeError::New(env, "Event and end callbacks expected").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        if (this->running) {
+            ErrorWithCode(env, "Pipeline is already running", "EBUSY").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+
+        this->onEnd = Napi::Persistent(info[1].As<Napi::Function>());
+        this->eventCallback =
+            Napi::ThreadSafeFunction::New(env, info[0].As<Napi::Function>(), "escpos-weigh-label", 0, 1);
+
+        try {
+            this->pipeline->Start(
+                [this](WeighLabelEvent event) {
+                    this->eventCallback.NonBlockingCall(
+                        [event = std::move(event)](Napi::Env env, Napi::Function onEvent) {
+                            onEvent.Call({EventObject(env, event)});
+                        });
+                },
+                [this](const std::string& message, const std::string& code) {
+                    Napi::ThreadSafeFunction callback = this->eventCallback;
+                    callback.NonBlockingCall([this, message, code](Napi::Env env, Napi::Function) {
+                        this->Ended(env, message, code);
+                    });
+                    callback.Release();
+                });
+        } catch (const TransportError& e) {
+            this->eventCallback.Release();
+            this->onEnd.Reset();
+            ErrorWithCode(env, e.what(), e.Code()).ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+
+        this->running = true;
+        this->Ref();
+        napi_add_env_cleanup_hook(env, StopOnExit, this);
+        return env.Undefined();
+    }
+
+    // Stops the pipeline; onEnd(null) follows unless the scale stream had already ended
+    Napi::Value Stop(const Napi::CallbackInfo& info) {
+        this->pipeline->Stop();
+        return info.Env().Undefined();
+    }
+
+    Napi::Value SetUnitPrice(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (info.Length() < 1 || !info[0].IsNumber()) {
+            Napi::TypeError::New(env, "Unit price expected").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        this->pipeline->SetUnitPrice(info[0].As<Napi::Number>().DoubleValue());
+        return env.Undefined();
+    }
+
+    Napi::Value GetStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        WeighLabelStats stats = this->pipeline->Stats();
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("readings", static_cast<double>(stats.readings));
+        result.Set("triggers", static_cast<double>(stats.triggers));
+        result.Set("printed", static_cast<double>(stats.printed));
+        result.Set("failed", static_cast<double>(stats.failed));
+        result.Set("lastMs", stats.lastMs);
+        result.Set("meanMs", stats.meanMs);
+        result.Set("maxMs", stats.maxMs);
+        return result;
+    }
+
+    // Runs when the environment is torn down while still running (a worker ending, Node exiting on its
+    // own): the thread would otherwise outlive the callbacks it reports to
+    static void StopOnExit(void* data) { static_cast<WeighLabelPipelineWrap*>(data)->pipeline->Stop(); }
+
+    void Ended(Napi::Env env, const std::string& message, const std::string& code) {
+        Napi::HandleScope scope(env);
+        napi_remove_env_cleanup_hook(env, StopOnExit, this);
+        this->running = false;
+        Napi::Value error = message.empty() ? env.Null() : ErrorWithCode(env, message, code).Value();
+        Napi::FunctionReference onEnd = std::move(this->onEnd);
+        this->Unref();
+        onEnd.Call({error});
+    }
+
+    std::unique_ptr<WeighLabelPipeline> pipeline;
+    Napi::ThreadSafeFunction eventCallback;
+    Napi::FunctionReference onEnd;
+    bool running = false;
+};
+
+// renderWeighLabel(template, weight, price) => the label bytes a pipeline would print
+static Napi::Value RenderWeighLabel(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    LabelTemplate label;
+    if (info.Length() < 3 || !TemplateArg(env, info[0], label)) {
+        if (!env.IsExceptionPending()) {
+            Napi::TypeError::New(env, "Template, weight and price expected").ThrowAsJavaScriptException();
+        }
+        return env.Null();
+    }
+    if (!info[1].IsNumber() || !info[2].IsNumber()) {
+        Napi::TypeError::New(env, "Weight and price must be numbers").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::string bytes =
+        label.Render(info[1].As<Napi::Number>().DoubleValue(), info[2].As<Napi::Number>().DoubleValue());
+    return Napi::Buffer<uint8_t>::Copy(env, reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+}
+
+void InitWeighLabel(Napi::Env env, Napi::Object exports) {
+    WeighLabelPipelineWrap::Init(env, exports);
+    exports.Set("renderWeighLabel", Napi::Function::New(env, RenderWeighLabel));
+}
+
+}  // namespace escpos
@@ -8,8 +8,11 @@ import {
 	saveDeviceConfig,
 	updateDeviceConfig as updateConfig,
 } from '../core/deviceConfig';
+import { getLogger } from '../core/logger';
 import type { DeviceConfig } from '../core/types';
 
+const log = getLogger('config');
+
 /**
  * Service for managing device configurations
  * Handles CRUD operations for device settings
@@ -31,7 +34,7 @@ export class DeviceConfigService {
 			saveDeviceConfig(vid, pid, config);
 			return true;
 		} catch (error) {
-			console.error(`Failed to set device config for ${vid}:${pid}:`, error);
+			log.error('Failed to set device config', { vid, pid, error });
 			return false;
 		}
 	}
@@ -52,7 +55,7 @@ export class DeviceConfigService {
 			const updatedConfig = updateConfig(vid, pid, config);
 			return updatedConfig;
 		} catch (error) {
-			console.error(`Failed to update device config for ${vid}:${pid}:`, error);
+			log.error('Failed to update device config', { vid, pid, error });
 			return null;
 		}
 	}
@@ -68,7 +71,7 @@ export class DeviceConfigService {
 			const deleted = deleteConfig(vid, pid);
 			return deleted;
 		} catch (error) {
-			console.error(`Failed to delete device config for ${vid}:${pid}:`, error);
+			log.error('Failed to delete device config', { vid, pid, error });
 			return false;
 		}
 	}
@@ -82,7 +85,7 @@ export class DeviceConfigService {
 			const deleted = clearAllDevices();
 			return deleted;
 		} catch (error) {
-			console.error('Failed to delete all device configs:', error);
+			log.error('Failed to delete all device configs', { error });
 			return false;
 		}
 	}
@@ -97,7 +100,7 @@ export class DeviceConfigService {
 		try {
 			return getDeviceConfig(vid, pid);
 		} catch (error) {
-			console.error(`Failed to get device config for ${vid}:${pid}:`, error);
+			log.error('Failed to get device config', { vid, pid, error });
 			return null;
 		}
 	}
@@ -110,7 +113,7 @@ export class DeviceConfigService {
 		try {
 			return getAllDeviceConfig();
 		} catch (error) {
-			console.error('Failed to get all device configs:', error);
+			log.error('Failed to get all device configs', { error });
 			return {};
 		}
 	}
@@ -125,7 +128,7 @@ export class DeviceConfigService {
 		try {
 			return hasDeviceConfig(vid, pid);
 		} catch (error) {
-			console.error(`Failed to check device config for ${vid}:${pid}:`, error);
+			log.error('Failed to check device config', { vid, pid, error });
 			return false;
 		}
 	}
@@ -138,7 +141,7 @@ export class DeviceConfigService {
 		try {
 			return getDeviceCount();
 		} catch (error) {
-			console.error('Failed to get device count:', error);
+			log.error('Failed to get device count', { error });
 			return 0;
 		}
 	}
@@ -175,7 +178,7 @@ export class DeviceConfigService {
 			});
 			return result !== null;
 		} catch (error) {
-			console.error(`Failed to set device ${vid}:${pid} as default:`, error);
+			log.error('Failed to set device as default', { vid, pid, error });
 			return false;
 		}
 	}
@@ -193,7 +196,7 @@ export class DeviceConfigService {
 			});
 			return result !== null;
 		} catch (error) {
-			console.error(`Failed to unset device ${vid}:${pid} as default:`, error);
+			log.error('Failed to unset device as default', { vid, pid, error });
 			return false;
 		}
 	}